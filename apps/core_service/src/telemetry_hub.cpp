@@ -9,6 +9,7 @@ namespace veilsight {
         const char* face_source_name(FaceSource source) {
             switch (source) {
                 case FaceSource::FullFrame: return "full_frame";
+                case FaceSource::HeadCrop: return "head_crop";
             }
             return "unknown";
         }
@@ -36,6 +36,7 @@ namespace {
         std::string output_dir;
         std::string split_mode = "protected";
         std::string gallery_db;
+        std::string precision;
         double deadline_ms = 40.0;
         double fps = 0.0;
     };
@@ -92,7 +93,8 @@ namespace {
     void usage(const char* prog) {
         std::cerr << "Usage: " << prog << " --config <yaml> --video <mp4> --sequence-id <id> "
                   << "--output-dir <dir> [--dataset ChokePoint] [--system-id veilsight] "
-                  << "[--split-mode gallery|protected] [--gallery-db path] [--deadline-ms n] [--fps n]\n";
+                  << "[--split-mode gallery|protected] [--gallery-db path] [--deadline-ms n] [--fps n] "
+                  << "[--precision fp32|int8]\n";
     }
 
     Args parse_args(int argc, char** argv) {
@@ -113,6 +115,7 @@ namespace {
             else if (arg == "--gallery-db") args.gallery_db = require_value("--gallery-db");
             else if (arg == "--deadline-ms") args.deadline_ms = std::stod(require_value("--deadline-ms"));
             else if (arg == "--fps") args.fps = std::stod(require_value("--fps"));
+            else if (arg == "--precision") args.precision = require_value("--precision");
             else if (arg == "--help" || arg == "-h") {
                 usage(argv[0]);
                 std::exit(0);
@@ -129,6 +132,9 @@ namespace {
         if (args.fps < 0.0) {
             throw std::runtime_error("fps must be >= 0");
         }
+        if (!args.precision.empty() && args.precision != "fp32" && args.precision != "int8") {
+            throw std::runtime_error("precision must be fp32 or int8");
+        }
         return args;
     }
 
@@ -169,6 +175,14 @@ int main(int argc, char** argv) {
 
     cfg.modules.face_detector.association_mode = "independent";
     cfg.modules.recognizer.gallery_path = args.gallery_db;
+    if (!args.precision.empty()) {
+        cfg.modules.person_detector.yolox.precision = args.precision;
+        cfg.modules.person_detector.scrfd.precision = args.precision;
+        cfg.modules.person_detector.yunet.precision = args.precision;
+        cfg.modules.face_detector.scrfd.precision = args.precision;
+        cfg.modules.face_detector.yunet.precision = args.precision;
+        cfg.modules.recognizer.precision = args.precision;
+    }
 
     std::unique_ptr<IPersonDetector> person_detector;
     std::unique_ptr<ITracker> tracker;
@@ -249,6 +263,7 @@ int main(int argc, char** argv) {
                 << "  \"base_config\": \"" << args.config_path << "\",\n"
                 << "  \"video_path\": \"" << args.video_path << "\",\n"
                 << "  \"fps\": " << fmt_float(args.fps) << ",\n"
+                << "  \"precision\": \"" << (args.precision.empty() ? "config" : args.precision) << "\",\n"
                 << "  \"gallery_db\": \"" << args.gallery_db << "\"\n"
                 << "}\n";
 
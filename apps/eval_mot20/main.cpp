@@ -7,6 +7,7 @@
 #include <opencv2/imgcodecs.hpp>
 
 #include <algorithm>
+#include <chrono>
 #include <cstdlib>
 #include <filesystem>
 #include <fstream>
@@ -69,7 +70,9 @@ static void print_usage(const char* prog) {
               << "  --sequences <seq1,seq2,...> Comma-separated list or \"all\" (default: all)\n"
               << "  --output <dir>              Tracker output directory (default: results)\n"
               << "  --tracker-name <name>       Tracker folder name (default: veilsight_tracker)\n"
+              << "  --tracker <type>            Tracker type: demo|bytetrack|ocsort (default: from config)\n"
               << "  --detector-thresh <float>   Override detector score threshold\n"
+              << "  --precision <fp32|int8>     Detector model precision (default: from config)\n"
               << "  --detections-only           Write raw detections with unique fake IDs, no tracking\n"
               << "  --help                      Show this message\n";
 }
@@ -87,6 +90,8 @@ int main(int argc, char** argv) {
     std::string tracker_name = "veilsight_tracker";
     float detector_thresh_override = -1.0f;
     bool detections_only = false;
+    std::string precision;
+    std::string tracker_type;
 
     for (int i = 1; i < argc; ++i) {
         std::string arg = argv[i];
@@ -103,6 +108,10 @@ int main(int argc, char** argv) {
             tracker_name = argv[++i];
         } else if (arg == "--detector-thresh" && i + 1 < argc) {
             detector_thresh_override = std::stof(argv[++i]);
+        } else if (arg == "--precision" && i + 1 < argc) {
+            precision = argv[++i];
+        } else if (arg == "--tracker" && i + 1 < argc) {
+            tracker_type = argv[++i];
         } else if (arg == "--detections-only") {
             detections_only = true;
         } else if (arg.empty() || arg[0] == '-') {
@@ -135,6 +144,16 @@ int main(int argc, char** argv) {
     if (detector_thresh_override >= 0.0f) {
         cfg.modules.person_detector.yolox.score_threshold = detector_thresh_override;
     }
+    if (!precision.empty()) {
+        if (precision != "fp32" && precision != "int8") {
+            std::cerr << "Error: --precision must be fp32 or int8\n";
+            return 1;
+        }
+        cfg.modules.person_detector.yolox.precision = precision;
+    }
+    if (!tracker_type.empty()) {
+        cfg.modules.tracker.type = tracker_type;
+    }
 
     // Create detector and tracker
     std::unique_ptr<IPersonDetector> detector;
@@ -215,7 +234,8 @@ int main(int argc, char** argv) {
     fs::create_directories(tracker_out);
 
     std::cout << "Evaluating " << selected.size() << " sequence(s) from MOT20-" << split << "\n";
-    std::cout << "Detector: yolox_nano (thresh=" << cfg.modules.person_detector.yolox.score_threshold << ")\n";
+    std::cout << "Detector: yolox_nano " << cfg.modules.person_detector.yolox.precision
+              << " (thresh=" << cfg.modules.person_detector.yolox.score_threshold << ")\n";
     if (detections_only) {
         std::cout << "Mode:     detections-only (no tracking)\n";
     } else {
@@ -237,6 +257,9 @@ int main(int argc, char** argv) {
         std::cout << "Processing " << seq.name << " (" << seq.seq_length << " frames)..." << std::flush;
         int written = 0;
         int fake_id = 1;
+        int detected_frames = 0;
+        double detector_ms = 0.0;
+        double tracker_ms = 0.0;
 
         for (int t = 1; t <= seq.seq_length; ++t) {
             std::ostringstream img_name;
@@ -256,7 +279,11 @@ int main(int argc, char** argv) {
                 }
             }
 
+            const auto detect_start = std::chrono::steady_clock::now();
             auto detections = detector->detect(frame);
+            detector_ms += std::chrono::duration<double, std::milli>(
+                std::chrono::steady_clock::now() - detect_start).count();
+            ++detected_frames;
 
             if (detections_only) {
                 for (const auto& box : detections) {
@@ -276,7 +303,10 @@ int main(int argc, char** argv) {
                 frame_info.width = frame.cols;
                 frame_info.height = frame.rows;
 
+                const auto track_start = std::chrono::steady_clock::now();
                 auto tracks = tracker->update(frame_info, detections);
+                tracker_ms += std::chrono::duration<double, std::milli>(
+                    std::chrono::steady_clock::now() - track_start).count();
 
                 for (const auto& box : tracks) {
                     if (box.id < 1) continue; // skip unconfirmed / invalid
@@ -293,7 +323,14 @@ int main(int argc, char** argv) {
         }
 
         out.close();
-        std::cout << " done (" << written << " detections)\n";
+        std::cout << " done (" << written << " detections, detector "
+                  << std::fixed << std::setprecision(2)
+                  << (detected_frames > 0 ? detector_ms / detected_frames : 0.0) << " ms/frame";
+        if (!detections_only) {
+            std::cout << ", tracker " << (detected_frames > 0 ? tracker_ms / detected_frames : 0.0) << " ms/frame";
+        }
+        std::cout << ")\n"
+                  << std::defaultfloat;
     }
 
     std::cout << "\nResults written to: " << tracker_out << "\n";
@@ -0,0 +1,187 @@
+#include <recognizer/gallery.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace veilsight;
+
+namespace {
+    constexpr int kDim = 128;
+
+    void normalize(std::vector<float>& v) {
+        double sum = 0.0;
+        for (const float x : v) sum += static_cast<double>(x) * x;
+        const float inv = 1.0f / static_cast<float>(std::sqrt(sum));
+        for (float& x : v) x *= inv;
+    }
+
+    // A sample of one identity: its unit center plus isotropic noise, so cosine to the center is about
+    // 1 / sqrt(1 + spread^2), the way repeated captures of one face cluster in embedding space.
+    std::vector<float> sample_identity(const std::vector<float>& center, float spread, std::mt19937& rng) {
+        std::normal_distribution<float> noise(0.0f, spread / std::sqrt(static_cast<float>(kDim)));
+        std::vector<float> v = center;
+        for (float& x : v) x += noise(rng);
+        normalize(v);
+        return v;
+    }
+
+    std::vector<int> parse_ints(const std::string& s) {
+        std::vector<int> out;
+        std::stringstream ss(s);
+        std::string part;
+        while (std::getline(ss, part, ',')) {
+            if (!part.empty()) out.push_back(std::stoi(part));
+        }
+        return out;
+    }
+
+    template <typename Fn>
+    double elapsed_ms(Fn&& fn) {
+        const auto start = std::chrono::steady_clock::now();
+        fn();
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+}
+
+static void print_usage(const char* prog) {
+    std::cerr << "Usage: " << prog << " [options]\n"
+              << "Recall and latency of the IVF-PQ gallery index against the exact scan on synthetic galleries.\n"
+              << "Options:\n"
+              << "  --rows <n1,n2,...>      Gallery sizes (default: 10000,100000,200000)\n"
+              << "  --per-identity <n>      Embeddings enrolled per identity (default: 3)\n"
+              << "  --queries <n>           Probe faces per size (default: 500)\n"
+              << "  --probes <p1,p2,...>    ivfpq probes to sweep (default: 4,8,16,32)\n"
+              << "  --lists <n>             ivfpq lists, 0 = sqrt(rows) (default: 0)\n"
+              << "  --subspaces <n>         PQ subspaces (default: 16)\n"
+              << "  --rerank <n>            Candidates re-scored exactly (default: 64)\n"
+              << "  --spread <f>            Within-identity noise (default: 0.6)\n"
+              << "  --seed <n>              RNG seed (default: 1)\n"
+              << "  --help                  Show this message\n";
+}
+
+int main(int argc, char** argv) {
+    std::vector<int> sizes = {10000, 100000, 200000};
+    std::vector<int> probes = {4, 8, 16, 32};
+    int per_identity = 3;
+    int num_queries = 500;
+    float spread = 0.6f;
+    unsigned seed = 1;
+    GalleryIndexConfig index_cfg;
+    index_cfg.type = "ivfpq";
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--help" || arg == "-h") {
+            print_usage(argv[0]);
+            return 0;
+        } else if (arg == "--rows" && i + 1 < argc) {
+            sizes = parse_ints(argv[++i]);
+        } else if (arg == "--per-identity" && i + 1 < argc) {
+            per_identity = std::max(1, std::stoi(argv[++i]));
+        } else if (arg == "--queries" && i + 1 < argc) {
+            num_queries = std::max(1, std::stoi(argv[++i]));
+        } else if (arg == "--probes" && i + 1 < argc) {
+            probes = parse_ints(argv[++i]);
+        } else if (arg == "--lists" && i + 1 < argc) {
+            index_cfg.lists = std::max(0, std::stoi(argv[++i]));
+        } else if (arg == "--subspaces" && i + 1 < argc) {
+            index_cfg.pq_subspaces = std::max(1, std::stoi(argv[++i]));
+        } else if (arg == "--rerank" && i + 1 < argc) {
+            index_cfg.rerank = std::max(1, std::stoi(argv[++i]));
+        } else if (arg == "--spread" && i + 1 < argc) {
+            spread = std::stof(argv[++i]);
+        } else if (arg == "--seed" && i + 1 < argc) {
+            seed = static_cast<unsigned>(std::stoul(argv[++i]));
+        } else {
+            std::cerr << "Unknown option: " << arg << "\n";
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+    if (kDim % index_cfg.pq_subspaces != 0) {
+        std::cerr << "--subspaces must divide " << kDim << "\n";
+        return 1;
+    }
+
+    std::mt19937 rng(seed);
+    std::normal_distribution<float> gauss(0.0f, 1.0f);
+    std::cout << "    rows  method        build_ms  ms/query  recall@1\n";
+    for (const int rows : sizes) {
+        const int identities = std::max(1, rows / per_identity);
+        std::vector<std::vector<float>> centers(static_cast<size_t>(identities), std::vector<float>(kDim));
+        for (auto& c : centers) {
+            for (float& x : c) x = gauss(rng);
+            normalize(c);
+        }
+
+        GalleryMatrix fp32(kDim);
+        GalleryMatrix int8(kDim);
+        for (int r = 0; r < rows; ++r) {
+            const int id = r % identities;
+            const auto v = sample_identity(centers[static_cast<size_t>(id)], spread, rng);
+            fp32.add("id" + std::to_string(id), v.data());
+            int8.add("id" + std::to_string(id), v.data());
+        }
+        const double int8_build = elapsed_ms([&] { int8.quantize_int8(); });
+
+        std::uniform_int_distribution<int> pick(0, identities - 1);
+        std::vector<float> queries;
+        for (int q = 0; q < num_queries; ++q) {
+            const auto v = sample_identity(centers[static_cast<size_t>(pick(rng))], spread, rng);
+            queries.insert(queries.end(), v.begin(), v.end());
+        }
+        const size_t nq = static_cast<size_t>(num_queries);
+
+        // Ground truth is the exact fp32 scan, one query at a time as the recognizer issues them.
+        std::vector<uint32_t> truth(nq);
+        const double exact_ms = elapsed_ms([&] {
+            for (size_t q = 0; q < nq; ++q) {
+                const float* query = queries.data() + q * kDim;
+                truth[q] = fp32.search(std::vector<float>(query, query + kDim), 1).front().identity;
+            }
+        });
+
+        const auto report = [&](const char* method, double build_ms, double total_ms, size_t hits) {
+            char line[160];
+            std::snprintf(line, sizeof(line), "%8d  %-12s %9.1f %9.4f %9.3f\n", rows, method, build_ms,
+                          total_ms / static_cast<double>(nq), static_cast<double>(hits) / static_cast<double>(nq));
+            std::cout << line;
+        };
+        report("flat_fp32", 0.0, exact_ms, nq);
+
+        size_t hits = 0;
+        double ms = elapsed_ms([&] {
+            for (size_t q = 0; q < nq; ++q) {
+                const float* query = queries.data() + q * kDim;
+                hits += int8.search(std::vector<float>(query, query + kDim), 1).front().identity == truth[q];
+            }
+        });
+        report("flat_int8", int8_build, ms, hits);
+
+        std::unique_ptr<GalleryIvfPqIndex> index;
+        const double build_ms = elapsed_ms([&] { index = std::make_unique<GalleryIvfPqIndex>(fp32, index_cfg, seed); });
+        for (const int p : probes) {
+            index->set_probes(p);
+            hits = 0;
+            ms = elapsed_ms([&] {
+                for (size_t q = 0; q < nq; ++q) {
+                    const float* query = queries.data() + q * kDim;
+                    const auto found = index->search(fp32, std::vector<float>(query, query + kDim), 1);
+                    hits += !found.empty() && found.front().identity == truth[q];
+                }
+            });
+            char method[32];
+            std::snprintf(method, sizeof(method), "ivfpq_p%d", p);
+            report(method, build_ms, ms, hits);
+        }
+    }
+    return 0;
+}
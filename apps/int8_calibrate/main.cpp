@@ -0,0 +1,399 @@
+#include <common/config.hpp>
+#include <common/ncnn_autotune.hpp>
+#include <face_detector/face_detector.hpp>
+#include <ingest/dual_source_factory.hpp>
+#include <person_detector/letterbox.hpp>
+
+#include <opencv2/core.hpp>
+#include <opencv2/imgcodecs.hpp>
+#include <opencv2/imgproc.hpp>
+
+#include <algorithm>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <ncnn/mat.h>
+
+namespace fs = std::filesystem;
+using namespace veilsight;
+
+namespace {
+    struct Args {
+        std::string config_path;
+        std::string model = "yolox";
+        std::string stream_id;
+        std::string output_dir = "calibration";
+        std::string ncnn_tools;
+        int frames = 300;
+        int every = 15;
+        bool skip_quantize = false;
+    };
+
+    // How the runtime feeds a model; ncnn2table must see the same input distribution.
+    struct CalibrationTarget {
+        std::string fp32_param;
+        std::string fp32_bin;
+        std::string int8_param;
+        std::string int8_bin;
+        int input_w = 0;
+        int input_h = 0;
+        std::string mean = "[0,0,0]";
+        std::string norm = "[1,1,1]";
+        std::string pixel = "BGR";
+        bool letterbox = false;
+        bool aligned_faces = false;
+        int threads = 1;
+    };
+
+    void usage(const char* prog) {
+        std::cerr << "Usage: " << prog << " <config.yaml> [options]\n"
+                  << "Samples frames from the config's file streams and builds an ncnn int8 model.\n"
+                  << "Options:\n"
+                  << "  --model <yolox|scrfd|yunet|mobilefacenet>  Model to quantize (default: yolox)\n"
+                  << "  --stream <id>        Only sample this stream (default: every file stream)\n"
+                  << "  --frames <n>         Calibration images to collect (default: 300)\n"
+                  << "  --every <n>          Keep one frame out of n (default: 15)\n"
+                  << "  --output <dir>       Image list and calibration table directory (default: calibration)\n"
+                  << "  --ncnn-tools <dir>   Directory holding ncnn2table and ncnn2int8 (default: PATH)\n"
+                  << "  --skip-quantize      Only write the images, image list and table/int8 commands\n"
+                  << "  --help               Show this message\n";
+    }
+
+    Args parse_args(int argc, char** argv) {
+        Args args;
+        for (int i = 1; i < argc; ++i) {
+            const std::string arg = argv[i];
+            auto require_value = [&](const char* name) -> std::string {
+                if (i + 1 >= argc) throw std::runtime_error(std::string("missing value for ") + name);
+                return argv[++i];
+            };
+            if (arg == "--model") args.model = require_value("--model");
+            else if (arg == "--stream") args.stream_id = require_value("--stream");
+            else if (arg == "--frames") args.frames = std::stoi(require_value("--frames"));
+            else if (arg == "--every") args.every = std::stoi(require_value("--every"));
+            else if (arg == "--output") args.output_dir = require_value("--output");
+            else if (arg == "--ncnn-tools") args.ncnn_tools = require_value("--ncnn-tools");
+            else if (arg == "--skip-quantize") args.skip_quantize = true;
+            else if (arg == "--help" || arg == "-h") {
+                usage(argv[0]);
+                std::exit(0);
+            } else if (!arg.empty() && arg[0] == '-') {
+                throw std::runtime_error("unknown option: " + arg);
+            } else {
+                args.config_path = arg;
+            }
+        }
+        if (args.config_path.empty()) throw std::runtime_error("config path required");
+        if (args.frames < 1 || args.every < 1) throw std::runtime_error("frames and every must be >= 1");
+        return args;
+    }
+
+    template <typename ModuleConfig>
+    void set_model_files(CalibrationTarget& target, const ModuleConfig& cfg) {
+        target.fp32_param = cfg.param_path;
+        target.fp32_bin = cfg.bin_path;
+        ModuleConfig int8_cfg = cfg;
+        int8_cfg.precision = "int8";
+        const auto [param, bin] = ncnn_model_files(int8_cfg);
+        target.int8_param = param;
+        target.int8_bin = bin;
+        target.input_w = cfg.input_w;
+        target.input_h = cfg.input_h;
+        target.threads = std::max(1, cfg.ncnn_threads);
+    }
+
+    CalibrationTarget make_target(const ModulesConfig& modules, const std::string& model) {
+        CalibrationTarget target;
+        if (model == "yolox") {
+            set_model_files(target, modules.person_detector.yolox);
+            target.norm = "[0.003921569,0.003921569,0.003921569]";
+            target.pixel = "RGB";
+            target.letterbox = modules.person_detector.yolox.letterbox;
+        } else if (model == "scrfd") {
+            set_model_files(target, modules.face_detector.scrfd);
+            target.mean = "[127.5,127.5,127.5]";
+            target.norm = "[0.0078125,0.0078125,0.0078125]";
+        } else if (model == "yunet") {
+            set_model_files(target, modules.face_detector.yunet);
+        } else if (model == "mobilefacenet") {
+            set_model_files(target, modules.recognizer);
+            target.pixel = "RGB";
+            target.aligned_faces = true;
+        } else {
+            throw std::runtime_error("unsupported model: " + model);
+        }
+        return target;
+    }
+
+    // Runs the YOLOX letterbox kernel itself (unnormalized) so the calibration images carry the same
+    // scale, centring and padding as the runtime input.
+    cv::Mat letterbox_image(const cv::Mat& bgr, int w, int h) {
+        const LetterboxLayout layout = make_letterbox_layout(bgr.cols, bgr.rows, w, h, true);
+        const size_t plane = static_cast<size_t>(w) * static_cast<size_t>(h);
+        std::vector<float> planar(plane * 3);
+        letterbox_bgr_to_planar_rgb(bgr, layout, 114.0f, 1.0f, planar.data(), plane);
+
+        std::vector<cv::Mat> channels;
+        for (int c = 2; c >= 0; --c) {
+            channels.emplace_back(h, w, CV_32F, planar.data() + plane * static_cast<size_t>(c));
+        }
+        cv::Mat merged;
+        cv::merge(channels, merged);
+        cv::Mat out;
+        merged.convertTo(out, CV_8UC3);
+        return out;
+    }
+
+    std::vector<cv::Mat> aligned_faces(IFaceDetector& detector,
+                                       const FaceDetectorModuleConfig& face_cfg,
+                                       const cv::Mat& bgr,
+                                       int w,
+                                       int h) {
+        static constexpr float canonical[10] = {
+            38.2946f, 51.6963f,
+            73.5318f, 51.5014f,
+            56.0252f, 71.7366f,
+            41.5493f, 92.3655f,
+            70.7299f, 92.2041f,
+        };
+        FaceDetectorRunConfig run;
+        run.input_w = face_cfg.type == "yunet" ? face_cfg.yunet.input_w : face_cfg.scrfd.input_w;
+        run.input_h = face_cfg.type == "yunet" ? face_cfg.yunet.input_h : face_cfg.scrfd.input_h;
+
+        std::vector<cv::Mat> out;
+        for (const auto& face : detector.detect_faces(bgr, run)) {
+            if (face.landmark_count != 5) continue;
+            float src[10] = {};
+            float dst[10] = {};
+            for (size_t i = 0; i < 5; ++i) {
+                src[i * 2] = face.landmarks[i].x;
+                src[i * 2 + 1] = face.landmarks[i].y;
+                dst[i * 2] = canonical[i * 2] * static_cast<float>(w) / 112.0f;
+                dst[i * 2 + 1] = canonical[i * 2 + 1] * static_cast<float>(h) / 112.0f;
+            }
+            float tm[6] = {};
+            ncnn::get_affine_transform(src, dst, 5, tm);
+            const cv::Mat m(2, 3, CV_32F, tm);
+            cv::Mat aligned;
+            cv::warpAffine(bgr, aligned, m, cv::Size(w, h), cv::INTER_LINEAR, cv::BORDER_CONSTANT);
+            out.push_back(aligned);
+        }
+        return out;
+    }
+
+    std::string tool_path(const Args& args, const char* name) {
+        return args.ncnn_tools.empty() ? std::string(name) : (fs::path(args.ncnn_tools) / name).string();
+    }
+
+    std::string quoted(const std::string& s) {
+        return "\"" + s + "\"";
+    }
+
+    std::vector<std::string> read_lines(const std::string& path) {
+        std::ifstream in(path);
+        if (!in.is_open()) throw std::runtime_error("cannot read " + path);
+        std::vector<std::string> lines;
+        std::string line;
+        while (std::getline(in, line)) lines.push_back(line);
+        return lines;
+    }
+
+    void write_lines(const std::string& path, const std::vector<std::string>& lines) {
+        std::ofstream out(path, std::ios::trunc);
+        if (!out.is_open()) throw std::runtime_error("cannot write " + path);
+        for (const auto& line : lines) out << line << '\n';
+    }
+
+    std::string param_field(const std::string& line, int index) {
+        std::istringstream ss(line);
+        std::string field;
+        for (int i = 0; i <= index; ++i) {
+            if (!(ss >> field)) return {};
+        }
+        return field;
+    }
+
+    // ncnn2table only knows built-in layers. YOLOX's YoloV5Focus is a space-to-depth, so calibrating with a
+    // stride-2 Reorg in its place sees the same values; the original line is restored in the int8 param.
+    std::vector<std::string> focus_layer_lines(const std::string& param) {
+        std::vector<std::string> focus;
+        for (const auto& line : read_lines(param)) {
+            if (param_field(line, 0) == "YoloV5Focus") focus.push_back(line);
+        }
+        return focus;
+    }
+
+    std::string write_calibration_param(const std::string& param, const fs::path& out_dir) {
+        auto lines = read_lines(param);
+        for (auto& line : lines) {
+            if (param_field(line, 0) != "YoloV5Focus") continue;
+            line.replace(line.find("YoloV5Focus"), std::string("YoloV5Focus").size(), "Reorg      ");
+            line += " 0=2";
+        }
+        const fs::path patched = out_dir / "calibration.param";
+        write_lines(patched.string(), lines);
+        return patched.string();
+    }
+
+    void restore_focus_layers(const std::string& int8_param, const std::vector<std::string>& focus) {
+        auto lines = read_lines(int8_param);
+        for (auto& line : lines) {
+            if (param_field(line, 0) != "Reorg") continue;
+            for (const auto& original : focus) {
+                if (param_field(original, 1) == param_field(line, 1)) line = original;
+            }
+        }
+        write_lines(int8_param, lines);
+    }
+} // namespace
+
+int main(int argc, char** argv) {
+    Args args;
+    try {
+        args = parse_args(argc, argv);
+    } catch (const std::exception& e) {
+        std::cerr << "Argument error: " << e.what() << "\n";
+        usage(argv[0]);
+        return 1;
+    }
+
+    AppConfig cfg;
+    CalibrationTarget target;
+    try {
+        cfg = load_config_yaml(args.config_path);
+        target = make_target(cfg.modules, args.model);
+    } catch (const std::exception& e) {
+        std::cerr << "Config error: " << e.what() << "\n";
+        return 1;
+    }
+
+    std::unique_ptr<IFaceDetector> face_detector;
+    if (target.aligned_faces) {
+        FaceDetectorModuleConfig face_cfg = cfg.modules.face_detector;
+        if (face_cfg.type == "none") face_cfg.type = "scrfd";
+        try {
+            face_detector = create_face_detector(face_cfg);
+        } catch (const std::exception& e) {
+            std::cerr << "Face detector init error: " << e.what() << "\n";
+            return 1;
+        }
+    }
+
+    const fs::path out_dir(args.output_dir);
+    const fs::path image_dir = out_dir / "images";
+    fs::create_directories(image_dir);
+    std::ofstream image_list(out_dir / "imagelist.txt", std::ios::trunc);
+
+    int saved = 0;
+    for (const auto& stream : cfg.streams) {
+        if (saved >= args.frames) break;
+        if (stream.type != "file") continue;
+        if (!args.stream_id.empty() && stream.id != args.stream_id) continue;
+
+        IngestConfig source_cfg = stream;
+        source_cfg.file.loop = false;
+        std::unique_ptr<GstDualSource> src;
+        try {
+            src = make_dual_source(source_cfg);
+        } catch (const std::exception& e) {
+            std::cerr << "Source error for " << stream.id << ": " << e.what() << "\n";
+            continue;
+        }
+        if (!src->start()) {
+            std::cerr << "Cannot start source " << stream.id << "\n";
+            continue;
+        }
+
+        std::cout << "Sampling " << stream.id << " (" << stream.file.path << ")" << std::flush;
+        DualFramePacket packet;
+        int64_t seen = 0;
+        int idle_reads = 0;
+        while (saved < args.frames && idle_reads < 50) {
+            if (!src->read(packet, 100)) {
+                ++idle_reads;
+                continue;
+            }
+            idle_reads = 0;
+            if (seen++ % args.every != 0 || packet.inf_frame.empty()) continue;
+
+            std::vector<cv::Mat> images;
+            if (target.aligned_faces) {
+                images = aligned_faces(*face_detector, cfg.modules.face_detector, packet.inf_frame,
+                                       target.input_w, target.input_h);
+            } else if (target.letterbox) {
+                images.push_back(letterbox_image(packet.inf_frame, target.input_w, target.input_h));
+            } else {
+                cv::Mat resized;
+                cv::resize(packet.inf_frame, resized, cv::Size(target.input_w, target.input_h));
+                images.push_back(resized);
+            }
+            for (const auto& image : images) {
+                if (saved >= args.frames) break;
+                std::ostringstream name;
+                name << stream.id << "_" << std::setw(6) << std::setfill('0') << saved << ".png";
+                const fs::path path = image_dir / name.str();
+                cv::imwrite(path.string(), image);
+                image_list << fs::absolute(path).string() << "\n";
+                ++saved;
+            }
+        }
+        src->stop();
+        std::cout << " -> " << saved << " images\n";
+    }
+    image_list.close();
+
+    if (saved == 0) {
+        std::cerr << "No calibration images collected; check that the config has file streams.\n";
+        return 1;
+    }
+
+    const std::vector<std::string> focus = focus_layer_lines(target.fp32_param);
+    const std::string calib_param =
+        focus.empty() ? target.fp32_param : write_calibration_param(target.fp32_param, out_dir);
+    const std::string table = (out_dir / (args.model + ".table")).string();
+    const std::string int8_param_out = focus.empty() ? target.int8_param : target.int8_param + ".tmp";
+
+    std::ostringstream table_cmd;
+    table_cmd << quoted(tool_path(args, "ncnn2table")) << " "
+              << quoted(calib_param) << " " << quoted(target.fp32_bin) << " "
+              << quoted((out_dir / "imagelist.txt").string()) << " " << quoted(table)
+              << " mean=" << target.mean << " norm=" << target.norm
+              << " shape=[" << target.input_w << "," << target.input_h << ",3]"
+              << " pixel=" << target.pixel << " thread=" << target.threads << " method=kl";
+    std::ostringstream int8_cmd;
+    int8_cmd << quoted(tool_path(args, "ncnn2int8")) << " "
+             << quoted(calib_param) << " " << quoted(target.fp32_bin) << " "
+             << quoted(int8_param_out) << " " << quoted(target.int8_bin) << " " << quoted(table);
+
+    std::cout << "\n" << table_cmd.str() << "\n" << int8_cmd.str() << "\n";
+    if (args.skip_quantize) return 0;
+
+    if (std::system(table_cmd.str().c_str()) != 0) {
+        std::cerr << "ncnn2table failed\n";
+        return 1;
+    }
+    if (std::system(int8_cmd.str().c_str()) != 0) {
+        std::cerr << "ncnn2int8 failed\n";
+        return 1;
+    }
+    if (!focus.empty()) {
+        try {
+            restore_focus_layers(int8_param_out, focus);
+            fs::rename(int8_param_out, target.int8_param);
+        } catch (const std::exception& e) {
+            std::cerr << "Restoring YoloV5Focus failed: " << e.what() << "\n";
+            return 1;
+        }
+    }
+
+    std::cout << "\nWrote " << target.int8_param << " and " << target.int8_bin << "\n"
+              << "Set precision: \"int8\" on the module to load it.\n";
+    return 0;
+}
@@ -0,0 +1,140 @@
+#include <common/config.hpp>
+#include <common/ncnn_autotune.hpp>
+#include <face_detector/scrfd_detector.hpp>
+#include <face_detector/yunet_detector.hpp>
+#include <person_detector/uhd_detector.hpp>
+#include <person_detector/yolox_detector.hpp>
+#include <recognizer/recognizer.hpp>
+
+#include <cstdio>
+#include <exception>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace veilsight;
+
+static void print_usage(const char* prog) {
+    std::cerr << "Usage: " << prog << " <config.yaml> [options]\n"
+              << "Benchmarks ncnn option sets for every configured model and stores the best in the cache.\n"
+              << "Options:\n"
+              << "  --iterations <n>   Timed runs per candidate (default: modules.ncnn_autotune.iterations)\n"
+              << "  --tolerance <f>    Max relative output deviation vs fp32 (default: modules.ncnn_autotune.tolerance)\n"
+              << "  --cache <path>     Cache file (default: modules.ncnn_autotune.cache_path)\n"
+              << "  --dry-run          Print results without writing the cache\n"
+              << "  --help             Show this message\n";
+}
+
+static std::vector<NcnnModelProbe> configured_probes(const ModulesConfig& modules) {
+    std::vector<NcnnModelProbe> probes;
+    const auto& person = modules.person_detector;
+    if (person.type == "yolox" || person.type == "cascade") probes.push_back(yolox_model_probe(person.yolox));
+    if (person.type == "uhd" || person.type == "cascade") probes.push_back(uhd_model_probe(person.uhd));
+    if (person.type == "yunet") probes.push_back(yunet_model_probe(person.yunet));
+    if (person.type == "scrfd") probes.push_back(scrfd_model_probe(person.scrfd));
+
+    const auto& face = modules.face_detector;
+    if (face.type == "scrfd") probes.push_back(scrfd_model_probe(face.scrfd));
+    if (face.type == "yunet") probes.push_back(yunet_model_probe(face.yunet));
+
+    if (modules.recognizer.type == "mobilefacenet") {
+        probes.push_back(mobilefacenet_model_probe(modules.recognizer));
+    }
+    return probes;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    std::string cfg_path;
+    int iterations = -1;
+    float tolerance = -1.0f;
+    std::string cache_path;
+    bool dry_run = false;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--help" || arg == "-h") {
+            print_usage(argv[0]);
+            return 0;
+        } else if (arg == "--iterations" && i + 1 < argc) {
+            iterations = std::stoi(argv[++i]);
+        } else if (arg == "--tolerance" && i + 1 < argc) {
+            tolerance = std::stof(argv[++i]);
+        } else if (arg == "--cache" && i + 1 < argc) {
+            cache_path = argv[++i];
+        } else if (arg == "--dry-run") {
+            dry_run = true;
+        } else if (arg.empty() || arg[0] == '-') {
+            std::cerr << "Unknown option: " << arg << "\n";
+            print_usage(argv[0]);
+            return 1;
+        } else {
+            cfg_path = arg;
+        }
+    }
+
+    if (cfg_path.empty()) {
+        std::cerr << "Error: config path required\n";
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    AppConfig cfg;
+    try {
+        cfg = load_config_yaml(cfg_path);
+    } catch (const std::exception& e) {
+        std::cerr << "Config error: " << e.what() << "\n";
+        return 1;
+    }
+
+    NcnnAutotuneConfig tune = cfg.modules.ncnn_autotune;
+    if (iterations > 0) tune.iterations = iterations;
+    if (tolerance >= 0.0f) tune.tolerance = tolerance;
+    if (!cache_path.empty()) tune.cache_path = cache_path;
+
+    std::vector<NcnnModelProbe> probes;
+    try {
+        probes = configured_probes(cfg.modules);
+    } catch (const std::exception& e) {
+        std::cerr << "Model error: " << e.what() << "\n";
+        return 1;
+    }
+    if (probes.empty()) {
+        std::cerr << "No ncnn-backed models configured\n";
+        return 1;
+    }
+
+    std::cout << "cpu: " << host_cpu_model() << "\n";
+    for (const auto& probe : probes) {
+        try {
+            const std::string key = ncnn_tuning_cache_key(probe);
+            const auto reports = benchmark_ncnn_tunings(probe, tune.iterations, tune.tolerance);
+            const NcnnTuning best = pick_ncnn_tuning(reports);
+
+            std::cout << "\n" << probe.name << " " << probe.input_w << "x" << probe.input_h
+                      << " threads=" << probe.threads << "\n";
+            std::cout << "  fp16p fp16s fp16a pack wino sgemm light   avg_ms  max_dev\n";
+            for (const auto& r : reports) {
+                const NcnnTuning& t = r.tuning;
+                char line[160];
+                std::snprintf(line, sizeof(line), "  %5d %5d %5d %4d %4d %5d %5d %8.3f %8.5f%s%s\n",
+                              t.use_fp16_packed, t.use_fp16_storage, t.use_fp16_arithmetic,
+                              t.use_packing_layout, t.use_winograd_convolution, t.use_sgemm_convolution,
+                              t.light_mode, t.avg_ms, r.max_deviation,
+                              r.within_tolerance ? "" : "  (rejected)",
+                              t == best ? "  <- best" : "");
+                std::cout << line;
+            }
+            if (!dry_run) store_cached_ncnn_tuning(tune.cache_path, key, best);
+        } catch (const std::exception& e) {
+            std::cerr << probe.name << ": " << e.what() << "\n";
+            return 1;
+        }
+    }
+    if (!dry_run) std::cout << "\nwrote " << tune.cache_path << "\n";
+    return 0;
+}
@@ -0,0 +1,541 @@
+#include <common/config.hpp>
+#include <pipeline/types.hpp>
+#include <tracking/association.hpp>
+#include <tracking/tracker.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace fs = std::filesystem;
+using namespace veilsight;
+
+struct SeqInfo {
+    std::string name;
+    int seq_length = 0;
+    int im_width = 0;
+    int im_height = 0;
+};
+
+struct GtBox {
+    int id = 0;
+    Box box;
+    int cls = 1;
+    bool considered = true; // MOT "conf" column: 0 marks boxes ignored by the metrics
+};
+
+struct TrackedBox {
+    int id = 0;
+    Box box;
+};
+
+struct FrameSample {
+    size_t objects = 0;
+    double ms = 0.0;
+};
+
+struct MotMetrics {
+    long num_gt = 0;
+    long num_pred = 0;
+    long tp = 0;
+    long fp = 0;
+    long fn = 0;
+    long idsw = 0;
+    double idtp = 0.0;
+
+    double mota() const { return num_gt > 0 ? 1.0 - static_cast<double>(fn + fp + idsw) / num_gt : 0.0; }
+    double idf1() const { return num_gt + num_pred > 0 ? 2.0 * idtp / static_cast<double>(num_gt + num_pred) : 0.0; }
+};
+
+static constexpr char kDumpMagic[8] = {'V', 'S', 'D', 'E', 'T', '0', '0', '1'};
+static constexpr float kMatchIou = 0.5f;
+
+struct DumpRecord {
+    int32_t frame;
+    float x;
+    float y;
+    float w;
+    float h;
+    float score;
+};
+
+static std::unordered_map<std::string, std::string> parse_ini(const fs::path& path) {
+    std::unordered_map<std::string, std::string> kv;
+    std::ifstream in(path);
+    if (!in) return kv;
+    std::string line;
+    while (std::getline(in, line)) {
+        auto pos = line.find('=');
+        if (pos == std::string::npos) continue;
+        std::string key = line.substr(0, pos);
+        std::string val = line.substr(pos + 1);
+        auto not_space = [](int ch) { return !std::isspace(ch); };
+        key.erase(key.begin(), std::find_if(key.begin(), key.end(), not_space));
+        key.erase(std::find_if(key.rbegin(), key.rend(), not_space).base(), key.end());
+        val.erase(val.begin(), std::find_if(val.begin(), val.end(), not_space));
+        val.erase(std::find_if(val.rbegin(), val.rend(), not_space).base(), val.end());
+        kv[key] = val;
+    }
+    return kv;
+}
+
+static std::vector<std::string> split_comma(const std::string& s) {
+    std::vector<std::string> parts;
+    std::stringstream ss(s);
+    std::string part;
+    while (std::getline(ss, part, ',')) {
+        auto not_space = [](int ch) { return !std::isspace(ch); };
+        part.erase(part.begin(), std::find_if(part.begin(), part.end(), not_space));
+        part.erase(std::find_if(part.rbegin(), part.rend(), not_space).base(), part.end());
+        if (!part.empty()) parts.push_back(part);
+    }
+    return parts;
+}
+
+static Box make_box(float x, float y, float w, float h, float score) {
+    Box b;
+    b.x = x;
+    b.y = y;
+    b.w = w;
+    b.h = h;
+    b.score = score;
+    return b;
+}
+
+// MOT text rows: frame,id,x,y,w,h,conf,... Covers MOTChallenge det.txt and eval_mot20 --detections-only output.
+static std::vector<std::vector<Box>> load_mot_detections(const fs::path& path, int frames, float min_score) {
+    std::vector<std::vector<Box>> out(static_cast<size_t>(frames) + 1);
+    std::ifstream in(path);
+    std::string line;
+    while (std::getline(in, line)) {
+        std::replace(line.begin(), line.end(), ',', ' ');
+        std::istringstream row(line);
+        int frame = 0;
+        int id = 0;
+        float x = 0.0f, y = 0.0f, w = 0.0f, h = 0.0f, score = 1.0f;
+        if (!(row >> frame >> id >> x >> y >> w >> h)) continue;
+        row >> score;
+        if (frame < 1 || frame > frames || score < min_score) continue;
+        out[static_cast<size_t>(frame)].push_back(make_box(x, y, w, h, score));
+    }
+    return out;
+}
+
+static std::vector<std::vector<Box>> load_dump(const fs::path& path, int frames, float min_score) {
+    std::vector<std::vector<Box>> out(static_cast<size_t>(frames) + 1);
+    std::ifstream in(path, std::ios::binary);
+    char magic[sizeof(kDumpMagic)] = {};
+    uint64_t count = 0;
+    in.read(magic, sizeof(magic));
+    in.read(reinterpret_cast<char*>(&count), sizeof(count));
+    if (!in || std::memcmp(magic, kDumpMagic, sizeof(magic)) != 0) {
+        throw std::runtime_error("not a detection dump: " + path.string());
+    }
+    std::vector<DumpRecord> records(count);
+    in.read(reinterpret_cast<char*>(records.data()), static_cast<std::streamsize>(count * sizeof(DumpRecord)));
+    if (!in) throw std::runtime_error("truncated detection dump: " + path.string());
+    for (const auto& r : records) {
+        if (r.frame < 1 || r.frame > frames || r.score < min_score) continue;
+        out[static_cast<size_t>(r.frame)].push_back(make_box(r.x, r.y, r.w, r.h, r.score));
+    }
+    return out;
+}
+
+static void write_dump(const fs::path& path, const std::vector<std::vector<Box>>& frames) {
+    std::vector<DumpRecord> records;
+    for (size_t f = 0; f < frames.size(); ++f) {
+        for (const auto& b : frames[f]) records.push_back(DumpRecord{static_cast<int32_t>(f), b.x, b.y, b.w, b.h, b.score});
+    }
+    if (path.has_parent_path()) fs::create_directories(path.parent_path());
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    const uint64_t count = records.size();
+    out.write(kDumpMagic, sizeof(kDumpMagic));
+    out.write(reinterpret_cast<const char*>(&count), sizeof(count));
+    out.write(reinterpret_cast<const char*>(records.data()), static_cast<std::streamsize>(count * sizeof(DumpRecord)));
+    if (!out) throw std::runtime_error("failed to write " + path.string());
+}
+
+static std::vector<std::vector<GtBox>> load_gt(const fs::path& path, int frames) {
+    std::vector<std::vector<GtBox>> out(static_cast<size_t>(frames) + 1);
+    std::ifstream in(path);
+    std::string line;
+    while (std::getline(in, line)) {
+        std::replace(line.begin(), line.end(), ',', ' ');
+        std::istringstream row(line);
+        int frame = 0;
+        GtBox gt;
+        float x = 0.0f, y = 0.0f, w = 0.0f, h = 0.0f, conf = 1.0f;
+        if (!(row >> frame >> gt.id >> x >> y >> w >> h)) continue;
+        row >> conf >> gt.cls;
+        if (frame < 1 || frame > frames) continue;
+        gt.box = make_box(x, y, w, h, 1.0f);
+        gt.considered = conf != 0.0f;
+        out[static_cast<size_t>(frame)].push_back(gt);
+    }
+    return out;
+}
+
+// Maximizes the summed score over pairs with a positive score; returns (row, col) pairs.
+static std::vector<std::pair<int, int>> match_positive(const CostMatrix& score) {
+    std::vector<std::pair<int, int>> pairs;
+    if (score.rows == 0 || score.cols == 0) return pairs;
+    CostMatrix cost = score;
+    for (float& v : cost.values) v = -v;
+    const std::vector<int> assignment = solve_assignment(cost);
+    for (int r = 0; r < score.rows; ++r) {
+        const int c = assignment[static_cast<size_t>(r)];
+        if (c >= 0 && score.at(r, c) > 0.0f) pairs.emplace_back(r, c);
+    }
+    return pairs;
+}
+
+// CLEAR MOT and identity metrics following MOTChallenge conventions: tracker boxes matched to distractor
+// classes are dropped, boxes marked zero are ignored, matches need IoU >= 0.5, and a ground-truth object keeps
+// last frame's tracker id when it still overlaps. The distractor set is MOT20's: person_on_vehicle, non_mot_vehicle,
+// static_person, distractor and reflection (MOT17 omits non_mot_vehicle).
+static MotMetrics evaluate(const std::vector<std::vector<GtBox>>& gt, const std::vector<std::vector<TrackedBox>>& tracks) {
+    static const std::unordered_set<int> kDistractors = {2, 6, 7, 8, 12};
+
+    MotMetrics m;
+    std::unordered_map<int, int> previous_frame_match;
+    std::unordered_map<int, int> last_match;
+    std::unordered_map<uint64_t, int> co_counts;
+    std::unordered_map<int, int> gt_index;
+    std::unordered_map<int, int> pred_index;
+
+    for (size_t f = 1; f < gt.size() && f < tracks.size(); ++f) {
+        const auto& all_gt = gt[f];
+        const auto& all_pred = tracks[f];
+
+        CostMatrix iou;
+        iou.reset(static_cast<int>(all_gt.size()), static_cast<int>(all_pred.size()), 0.0f);
+        for (size_t g = 0; g < all_gt.size(); ++g) {
+            for (size_t p = 0; p < all_pred.size(); ++p) {
+                const float v = box_iou(all_gt[g].box, all_pred[p].box);
+                iou.at(static_cast<int>(g), static_cast<int>(p)) = v >= kMatchIou ? v : 0.0f;
+            }
+        }
+        std::vector<char> keep_pred(all_pred.size(), 1);
+        for (const auto& [g, p] : match_positive(iou)) {
+            if (kDistractors.count(all_gt[static_cast<size_t>(g)].cls)) keep_pred[static_cast<size_t>(p)] = 0;
+        }
+
+        std::vector<int> gts;
+        std::vector<int> preds;
+        for (size_t g = 0; g < all_gt.size(); ++g) {
+            if (all_gt[g].considered && all_gt[g].cls == 1) gts.push_back(static_cast<int>(g));
+        }
+        for (size_t p = 0; p < all_pred.size(); ++p) {
+            if (keep_pred[p]) preds.push_back(static_cast<int>(p));
+        }
+        m.num_gt += static_cast<long>(gts.size());
+        m.num_pred += static_cast<long>(preds.size());
+
+        CostMatrix score;
+        score.reset(static_cast<int>(gts.size()), static_cast<int>(preds.size()), 0.0f);
+        for (size_t a = 0; a < gts.size(); ++a) {
+            const GtBox& g = all_gt[static_cast<size_t>(gts[a])];
+            gt_index.emplace(g.id, static_cast<int>(gt_index.size()));
+            for (size_t b = 0; b < preds.size(); ++b) {
+                const TrackedBox& p = all_pred[static_cast<size_t>(preds[b])];
+                const float v = iou.at(gts[a], preds[b]);
+                if (v <= 0.0f) continue;
+                pred_index.emplace(p.id, static_cast<int>(pred_index.size()));
+                co_counts[(static_cast<uint64_t>(static_cast<uint32_t>(g.id)) << 32) | static_cast<uint32_t>(p.id)] += 1;
+                const auto prev = previous_frame_match.find(g.id);
+                score.at(static_cast<int>(a), static_cast<int>(b)) = v + (prev != previous_frame_match.end() && prev->second == p.id ? 1000.0f : 0.0f);
+            }
+        }
+
+        std::unordered_map<int, int> current_match;
+        for (const auto& [a, b] : match_positive(score)) {
+            const int gid = all_gt[static_cast<size_t>(gts[static_cast<size_t>(a)])].id;
+            const int pid = all_pred[static_cast<size_t>(preds[static_cast<size_t>(b)])].id;
+            const auto last = last_match.find(gid);
+            if (last != last_match.end() && last->second != pid) ++m.idsw;
+            last_match[gid] = pid;
+            current_match[gid] = pid;
+            ++m.tp;
+        }
+        previous_frame_match = std::move(current_match);
+    }
+    m.fn = m.num_gt - m.tp;
+    m.fp = m.num_pred - m.tp;
+
+    // IDTP is the best one-to-one pairing of ground-truth and tracker ids by frames overlapped.
+    CostMatrix id_overlap;
+    id_overlap.reset(static_cast<int>(gt_index.size()), static_cast<int>(pred_index.size()), 0.0f);
+    for (const auto& [key, count] : co_counts) {
+        const int gid = static_cast<int>(static_cast<int32_t>(key >> 32));
+        const int pid = static_cast<int>(static_cast<int32_t>(key & 0xffffffffu));
+        id_overlap.at(gt_index.at(gid), pred_index.at(pid)) = static_cast<float>(count);
+    }
+    for (const auto& [g, p] : match_positive(id_overlap)) m.idtp += id_overlap.at(g, p);
+    return m;
+}
+
+static double percentile(std::vector<double> values, double q) {
+    if (values.empty()) return 0.0;
+    std::sort(values.begin(), values.end());
+    const size_t rank = static_cast<size_t>(std::ceil(q * static_cast<double>(values.size())));
+    return values[std::min(values.size() - 1, rank == 0 ? 0 : rank - 1)];
+}
+
+static void print_latency(const std::vector<FrameSample>& samples) {
+    static const size_t kEdges[] = {0, 25, 50, 100, 200, 400};
+    std::cout << "    objects      frames   mean_ms    p50_ms    p90_ms    p99_ms    max_ms\n";
+    for (size_t b = 0; b < std::size(kEdges); ++b) {
+        const size_t lo = kEdges[b];
+        const size_t hi = b + 1 < std::size(kEdges) ? kEdges[b + 1] : SIZE_MAX;
+        std::vector<double> ms;
+        for (const auto& s : samples) {
+            if (s.objects >= lo && s.objects < hi) ms.push_back(s.ms);
+        }
+        if (ms.empty()) continue;
+        double sum = 0.0;
+        for (double v : ms) sum += v;
+        char range[32];
+        if (hi == SIZE_MAX) std::snprintf(range, sizeof(range), "%zu+", lo);
+        else std::snprintf(range, sizeof(range), "%zu-%zu", lo, hi - 1);
+        char line[160];
+        std::snprintf(line, sizeof(line), "    %-10s %7zu %9.3f %9.3f %9.3f %9.3f %9.3f\n",
+                      range, ms.size(), sum / static_cast<double>(ms.size()), percentile(ms, 0.5),
+                      percentile(ms, 0.9), percentile(ms, 0.99), *std::max_element(ms.begin(), ms.end()));
+        std::cout << line;
+    }
+}
+
+static void print_usage(const char* prog) {
+    std::cerr << "Usage: " << prog << " <config.yaml> [options]\n"
+              << "Replays cached MOT20 detections through each tracker at full speed.\n"
+              << "Options:\n"
+              << "  --split <train|test>        Dataset split (default: train)\n"
+              << "  --sequences <seq1,...>      Comma-separated list or \"all\" (default: all)\n"
+              << "  --trackers <t1,t2,...>      Tracker types (default: demo,bytetrack,ocsort)\n"
+              << "  --dets <dir>                Read <dir>/<seq>.vsdet or <dir>/<seq>.txt instead of <seq>/det/det.txt\n"
+              << "  --min-score <float>         Drop detections below this score (default: 0)\n"
+              << "  --repeat <n>                Replays per sequence for timing; metrics use the first (default: 1)\n"
+              << "  --write-dump <dir>          Save the loaded detections as <dir>/<seq>.vsdet\n"
+              << "  --help                      Show this message\n";
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    std::string cfg_path;
+    std::string split = "train";
+    std::string sequences_arg = "all";
+    std::string trackers_arg = "demo,bytetrack,ocsort";
+    std::string dets_dir;
+    std::string dump_dir;
+    float min_score = 0.0f;
+    int repeat = 1;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--help" || arg == "-h") {
+            print_usage(argv[0]);
+            return 0;
+        } else if (arg == "--split" && i + 1 < argc) {
+            split = argv[++i];
+        } else if (arg == "--sequences" && i + 1 < argc) {
+            sequences_arg = argv[++i];
+        } else if (arg == "--trackers" && i + 1 < argc) {
+            trackers_arg = argv[++i];
+        } else if (arg == "--dets" && i + 1 < argc) {
+            dets_dir = argv[++i];
+        } else if (arg == "--min-score" && i + 1 < argc) {
+            min_score = std::stof(argv[++i]);
+        } else if (arg == "--repeat" && i + 1 < argc) {
+            repeat = std::max(1, std::stoi(argv[++i]));
+        } else if (arg == "--write-dump" && i + 1 < argc) {
+            dump_dir = argv[++i];
+        } else if (arg.empty() || arg[0] == '-') {
+            std::cerr << "Unknown option: " << arg << "\n";
+            print_usage(argv[0]);
+            return 1;
+        } else {
+            cfg_path = arg;
+        }
+    }
+
+    if (cfg_path.empty()) {
+        std::cerr << "Error: config path required\n";
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    AppConfig cfg;
+    try {
+        cfg = load_config_yaml(cfg_path);
+    } catch (const std::exception& e) {
+        std::cerr << "Config error: " << e.what() << "\n";
+        return 1;
+    }
+
+    fs::path mot20_base = fs::path("assets") / "MOT20";
+    if (!fs::exists(mot20_base)) {
+        mot20_base = fs::path("..") / ".." / ".." / "assets" / "MOT20";
+    }
+    const fs::path split_dir = mot20_base / split;
+    if (!fs::exists(split_dir)) {
+        std::cerr << "Split directory not found: " << split_dir << "\n";
+        return 1;
+    }
+
+    std::vector<SeqInfo> sequences;
+    for (const auto& entry : fs::directory_iterator(split_dir)) {
+        if (!entry.is_directory()) continue;
+        const fs::path seqinfo_path = entry.path() / "seqinfo.ini";
+        if (!fs::exists(seqinfo_path)) continue;
+        auto kv = parse_ini(seqinfo_path);
+        SeqInfo info;
+        info.name = entry.path().filename().string();
+        info.seq_length = std::stoi(kv.count("seqLength") ? kv.at("seqLength") : "0");
+        info.im_width = std::stoi(kv.count("imWidth") ? kv.at("imWidth") : "0");
+        info.im_height = std::stoi(kv.count("imHeight") ? kv.at("imHeight") : "0");
+        if (info.seq_length > 0) sequences.push_back(info);
+    }
+    std::sort(sequences.begin(), sequences.end(), [](const SeqInfo& a, const SeqInfo& b) { return a.name < b.name; });
+    if (sequences_arg != "all") {
+        const auto wanted = split_comma(sequences_arg);
+        sequences.erase(std::remove_if(sequences.begin(), sequences.end(),
+                                       [&wanted](const SeqInfo& s) {
+                                           return std::find(wanted.begin(), wanted.end(), s.name) == wanted.end();
+                                       }),
+                        sequences.end());
+    }
+    if (sequences.empty()) {
+        std::cerr << "No sequences selected.\n";
+        return 1;
+    }
+
+    struct Sequence {
+        SeqInfo info;
+        std::vector<std::vector<Box>> detections;
+        std::vector<std::vector<GtBox>> gt;
+    };
+    std::vector<Sequence> loaded;
+    for (const auto& info : sequences) {
+        Sequence seq;
+        seq.info = info;
+        try {
+            fs::path source = split_dir / info.name / "det" / "det.txt";
+            if (!dets_dir.empty()) {
+                source = fs::path(dets_dir) / (info.name + ".vsdet");
+                if (!fs::exists(source)) source = fs::path(dets_dir) / (info.name + ".txt");
+            }
+            if (!fs::exists(source)) {
+                std::cerr << "[WARNING] no detections for " << info.name << " at " << source << "\n";
+                continue;
+            }
+            seq.detections = source.extension() == ".vsdet"
+                ? load_dump(source, info.seq_length, min_score)
+                : load_mot_detections(source, info.seq_length, min_score);
+            if (!dump_dir.empty()) write_dump(fs::path(dump_dir) / (info.name + ".vsdet"), seq.detections);
+        } catch (const std::exception& e) {
+            std::cerr << "[ERROR] " << info.name << ": " << e.what() << "\n";
+            return 1;
+        }
+        const fs::path gt_path = split_dir / info.name / "gt" / "gt.txt";
+        if (fs::exists(gt_path)) seq.gt = load_gt(gt_path, info.seq_length);
+        loaded.push_back(std::move(seq));
+    }
+
+    for (const auto& type : split_comma(trackers_arg)) {
+        TrackerModuleConfig tracker_cfg = cfg.modules.tracker;
+        tracker_cfg.type = type;
+
+        std::cout << "\nTracker: " << type << "\n";
+        std::cout << "  sequence         frames  dets/frame     MOTA     IDF1   IDSW   ms/frame\n";
+        std::vector<FrameSample> samples;
+        MotMetrics total;
+        bool have_gt = false;
+        for (const auto& seq : loaded) {
+            std::vector<std::vector<TrackedBox>> outputs(seq.detections.size());
+            std::vector<FrameSample> seq_samples;
+            size_t det_count = 0;
+            for (int r = 0; r < repeat; ++r) {
+                std::unique_ptr<ITracker> tracker;
+                try {
+                    tracker = create_tracker(tracker_cfg);
+                } catch (const std::exception& e) {
+                    std::cerr << "Tracker error: " << e.what() << "\n";
+                    return 1;
+                }
+                for (size_t f = 1; f < seq.detections.size(); ++f) {
+                    TrackerFrameInfo frame_info;
+                    frame_info.stream_id = seq.info.name;
+                    frame_info.frame_id = static_cast<int64_t>(f);
+                    frame_info.width = seq.info.im_width;
+                    frame_info.height = seq.info.im_height;
+
+                    const auto start = std::chrono::steady_clock::now();
+                    const auto tracks = tracker->update(frame_info, seq.detections[f]);
+                    const double ms = std::chrono::duration<double, std::milli>(
+                        std::chrono::steady_clock::now() - start).count();
+                    seq_samples.push_back(FrameSample{seq.detections[f].size(), ms});
+                    if (r > 0) continue;
+
+                    det_count += seq.detections[f].size();
+                    for (const auto& box : tracks) {
+                        if (box.id < 1) continue;
+                        outputs[f].push_back(TrackedBox{box.id, box});
+                    }
+                }
+            }
+
+            double seq_ms = 0.0;
+            for (const auto& s : seq_samples) seq_ms += s.ms;
+            const double frames = static_cast<double>(std::max<size_t>(1, seq.detections.size() - 1));
+            char line[200];
+            if (!seq.gt.empty()) {
+                const MotMetrics m = evaluate(seq.gt, outputs);
+                have_gt = true;
+                total.num_gt += m.num_gt;
+                total.num_pred += m.num_pred;
+                total.tp += m.tp;
+                total.fp += m.fp;
+                total.fn += m.fn;
+                total.idsw += m.idsw;
+                total.idtp += m.idtp;
+                std::snprintf(line, sizeof(line), "  %-16s %6d %11.1f %8.3f %8.3f %6ld %10.3f\n",
+                              seq.info.name.c_str(), seq.info.seq_length, static_cast<double>(det_count) / frames,
+                              m.mota(), m.idf1(), m.idsw, seq_ms / static_cast<double>(seq_samples.size()));
+            } else {
+                std::snprintf(line, sizeof(line), "  %-16s %6d %11.1f %8s %8s %6s %10.3f\n",
+                              seq.info.name.c_str(), seq.info.seq_length, static_cast<double>(det_count) / frames,
+                              "-", "-", "-", seq_ms / static_cast<double>(seq_samples.size()));
+            }
+            std::cout << line;
+            samples.insert(samples.end(), seq_samples.begin(), seq_samples.end());
+        }
+
+        if (have_gt) {
+            char line[200];
+            std::snprintf(line, sizeof(line), "  %-16s %6s %11s %8.3f %8.3f %6ld\n",
+                          "combined", "", "", total.mota(), total.idf1(), total.idsw);
+            std::cout << line;
+        }
+        std::cout << "  update latency by detections per frame:\n";
+        print_latency(samples);
+    }
+    return 0;
+}
@@ -11,7 +11,12 @@ from fastapi.testclient import TestClient
 
 from controller.veilsight_controller.api import RunnerClientRegistry, router
 from controller.veilsight_controller.gallery_service import GalleryService
-from controller.veilsight_controller.gallery_store import GalleryStore
+from controller.veilsight_controller.gallery_store import (
+    SNAPSHOT_HEADER,
+    SNAPSHOT_HEADER_BYTES,
+    SNAPSHOT_MAGIC,
+    GalleryStore,
+)
 
 
 class GalleryTestSettings:
@@ -120,6 +125,76 @@ def test_store_hard_delete(tmp_path: Path) -> None:
     assert store.delete_identity(identity.identity_key) is False
 
 
+def test_store_logs_gallery_changes(tmp_path: Path) -> None:
+    store = GalleryStore(tmp_path / "gallery.sqlite3")
+    identity = store.create_identity("Alice", "alice")
+    embedding = store.add_embedding(
+        identity_key=identity.identity_key,
+        embedding=[0.01] * 128,
+        source_type="upload",
+        source_ref="alice.jpg",
+        quality={"usable": True},
+        face_bbox={"x": 1, "y": 2, "w": 3, "h": 4},
+    )
+    store.set_embedding_active(embedding.id, False)
+    store.update_identity(identity.identity_key, active=False)
+    store.delete_identity(identity.identity_key)
+
+    with sqlite3.connect(store.db_path) as conn:
+        changes = [row[0] for row in conn.execute("SELECT embedding_id FROM gallery_changes ORDER BY seq")]
+        generation = conn.execute("SELECT value FROM gallery_meta WHERE key = 'generation'").fetchone()
+    assert changes == [embedding.id] * 4
+    assert generation is not None and generation[0]
+
+    GalleryStore(store.db_path)
+    with sqlite3.connect(store.db_path) as conn:
+        again = conn.execute("SELECT value FROM gallery_meta WHERE key = 'generation'").fetchone()
+    assert again == generation
+
+
+def test_store_prunes_changes_covered_by_snapshot(tmp_path: Path) -> None:
+    store = GalleryStore(tmp_path / "gallery.sqlite3")
+    identity = store.create_identity("Alice", "alice")
+    for _ in range(3):
+        store.add_embedding(
+            identity_key=identity.identity_key,
+            embedding=[0.01] * 128,
+            source_type="upload",
+            source_ref="alice.jpg",
+            quality={"usable": True},
+            face_bbox={"x": 1, "y": 2, "w": 3, "h": 4},
+        )
+    with sqlite3.connect(store.db_path) as conn:
+        generation = conn.execute("SELECT value FROM gallery_meta WHERE key = 'generation'").fetchone()[0]
+
+    def write_snapshot(tag: str, change_seq: int) -> None:
+        header = SNAPSHOT_HEADER.pack(SNAPSHOT_MAGIC, 128, 128, 3, 1, change_seq, len(tag))
+        snapshot = header.ljust(SNAPSHOT_HEADER_BYTES, b"\0") + tag.encode()
+        store.db_path.with_name(store.db_path.name + ".vsgallery").write_bytes(snapshot)
+
+    def log_state() -> tuple[list[int], Any]:
+        with sqlite3.connect(store.db_path) as conn:
+            seqs = [row[0] for row in conn.execute("SELECT seq FROM gallery_changes ORDER BY seq")]
+            pruned = conn.execute("SELECT value FROM gallery_meta WHERE key = 'pruned_seq'").fetchone()
+        return seqs, pruned
+
+    write_snapshot("other-generation", 2)
+    store.update_identity(identity.identity_key, display_name="Alice A")
+    assert log_state() == ([1, 2, 3], None)
+
+    write_snapshot(generation, 2)
+    store.update_identity(identity.identity_key, display_name="Alice B")
+    seqs, pruned = log_state()
+    assert seqs == [3]
+    assert pruned is not None and int(pruned[0]) == 2
+
+    write_snapshot(generation, 1)
+    store.update_identity(identity.identity_key, active=False)
+    seqs, pruned = log_state()
+    assert seqs == [3, 4, 5, 6]
+    assert pruned is not None and int(pruned[0]) == 2
+
+
 def test_candidate_cache_expiry(tmp_path: Path) -> None:
     service = GalleryService(GalleryTestSettings(tmp_path / "gallery.sqlite3"))
     runner = FakeRunner()
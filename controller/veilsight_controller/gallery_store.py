@@ -13,6 +13,12 @@ from .gallery_models import GalleryEmbedding, GalleryIdentity
 
 SLUG_RE = re.compile(r"^[a-z0-9][a-z0-9_-]{0,126}$")
 
+# Leading fields of the recognizer's <gallery_path>.vsgallery header: magic, dim, stride, rows, identities,
+# change_seq, tag_bytes. The source tag (the gallery generation) follows the fixed 64-byte header.
+SNAPSHOT_MAGIC = b"VSGAL002"
+SNAPSHOT_HEADER = struct.Struct("<8s2i2QqI")
+SNAPSHOT_HEADER_BYTES = 64
+
 
 def now_ms() -> int:
     return int(time.time() * 1000)
@@ -38,6 +44,42 @@ def encode_embedding(values: list[float]) -> bytes:
     return struct.pack("<128f", *(float(v) for v in values))
 
 
+def snapshot_change_seq(db_path: Path, generation: str) -> int | None:
+    """Last change folded into the recognizer's gallery snapshot, if one was taken from this DB generation."""
+    try:
+        with db_path.with_name(db_path.name + ".vsgallery").open("rb") as snapshot:
+            header = snapshot.read(SNAPSHOT_HEADER_BYTES)
+            if len(header) < SNAPSHOT_HEADER_BYTES:
+                return None
+            magic, _dim, _stride, _rows, _identities, change_seq, tag_bytes = SNAPSHOT_HEADER.unpack_from(header)
+            if magic != SNAPSHOT_MAGIC:
+                return None
+            tag = snapshot.read(tag_bytes)
+    except OSError:
+        return None
+    return change_seq if tag == generation.encode() else None
+
+
+def prune_gallery_changes(conn: sqlite3.Connection, db_path: Path) -> int:
+    """Trim change-log rows the gallery snapshot already covers; returns how many were deleted.
+
+    The recognizer reads 'pruned_seq' to tell a trimmed log from an idle one: a gallery loaded before it fully
+    reloads instead of applying the log.
+    """
+    generation = conn.execute("SELECT value FROM gallery_meta WHERE key = 'generation'").fetchone()
+    seq = snapshot_change_seq(db_path, generation[0]) if generation else None
+    if not seq:
+        return 0
+    conn.execute(
+        """
+        INSERT INTO gallery_meta(key, value) VALUES ('pruned_seq', ?)
+        ON CONFLICT(key) DO UPDATE SET value = max(CAST(value AS INTEGER), CAST(excluded.value AS INTEGER))
+        """,
+        (seq,),
+    )
+    return conn.execute("DELETE FROM gallery_changes WHERE seq <= ?", (seq,)).rowcount
+
+
 class GalleryStore:
     def __init__(self, db_path: Path) -> None:
         self.db_path = db_path
@@ -78,11 +120,53 @@ class GalleryStore:
             self._add_column(conn, "face_embeddings", "source_ref", "TEXT")
             self._add_column(conn, "face_embeddings", "quality_json", "TEXT")
             self._add_column(conn, "face_embeddings", "face_bbox_json", "TEXT")
+            # Change log consumed by the recognizer's incremental gallery reload; see init_mobilefacenet_gallery_db.py.
+            conn.executescript(
+                """
+                CREATE TABLE IF NOT EXISTS gallery_meta (
+                  key TEXT PRIMARY KEY,
+                  value TEXT NOT NULL
+                );
+
+                INSERT OR IGNORE INTO gallery_meta(key, value) VALUES ('generation', lower(hex(randomblob(8))));
+
+                CREATE TABLE IF NOT EXISTS gallery_changes (
+                  seq INTEGER PRIMARY KEY AUTOINCREMENT,
+                  embedding_id INTEGER NOT NULL
+                );
+
+                CREATE TRIGGER IF NOT EXISTS face_embeddings_log_insert AFTER INSERT ON face_embeddings
+                BEGIN
+                  INSERT INTO gallery_changes(embedding_id) VALUES (NEW.id);
+                END;
+
+                CREATE TRIGGER IF NOT EXISTS face_embeddings_log_update
+                AFTER UPDATE OF identity_key, model, dim, embedding, active ON face_embeddings
+                BEGIN
+                  INSERT INTO gallery_changes(embedding_id) VALUES (NEW.id);
+                END;
+
+                CREATE TRIGGER IF NOT EXISTS face_embeddings_log_delete AFTER DELETE ON face_embeddings
+                BEGIN
+                  INSERT INTO gallery_changes(embedding_id) VALUES (OLD.id);
+                END;
+
+                CREATE TRIGGER IF NOT EXISTS identities_log_active AFTER UPDATE OF active ON identities
+                BEGIN
+                  INSERT INTO gallery_changes(embedding_id)
+                  SELECT id FROM face_embeddings WHERE identity_key = NEW.identity_key;
+                END;
+                """
+            )
             ts = now_ms()
             conn.execute("UPDATE identities SET created_at_ms = COALESCE(created_at_ms, ?)", (ts,))
             conn.execute("UPDATE identities SET updated_at_ms = COALESCE(updated_at_ms, created_at_ms, ?)", (ts,))
             conn.execute("UPDATE face_embeddings SET created_at_ms = COALESCE(created_at_ms, ?)", (ts,))
-            conn.commit()
+            self._commit(conn)
+
+    def _commit(self, conn: sqlite3.Connection) -> None:
+        prune_gallery_changes(conn, self.db_path)
+        conn.commit()
 
     @staticmethod
     def _add_column(conn: sqlite3.Connection, table: str, column: str, definition: str) -> None:
@@ -119,7 +203,7 @@ class GalleryStore:
                     """,
                     (key, display_name, int(active), ts, ts),
                 )
-                conn.commit()
+                self._commit(conn)
             except sqlite3.IntegrityError as exc:
                 raise ValueError("identity_key already exists") from exc
         found = self.get_identity(key)
@@ -167,7 +251,7 @@ class GalleryStore:
             values.append(identity_key)
             with self.connect() as conn:
                 conn.execute(f"UPDATE identities SET {', '.join(fields)} WHERE identity_key = ?", values)
-                conn.commit()
+                self._commit(conn)
         return self.get_identity(identity_key)
 
     def soft_delete_identity(self, identity_key: str) -> bool:
@@ -181,7 +265,7 @@ class GalleryStore:
                 return False
             conn.execute("DELETE FROM face_embeddings WHERE identity_key = ?", (identity_key,))
             conn.execute("DELETE FROM identities WHERE identity_key = ?", (identity_key,))
-            conn.commit()
+            self._commit(conn)
         return True
 
     def ensure_identity_active(self, identity_key: str) -> GalleryIdentity | None:
@@ -195,7 +279,7 @@ class GalleryStore:
                     "UPDATE identities SET active = 1, updated_at_ms = ? WHERE identity_key = ?",
                     (now_ms(), identity_key),
                 )
-                conn.commit()
+                self._commit(conn)
             identity = self.get_identity(identity_key)
         return identity
 
@@ -248,7 +332,7 @@ class GalleryStore:
                 ),
             )
             conn.execute("UPDATE identities SET updated_at_ms = ? WHERE identity_key = ?", (ts, identity_key))
-            conn.commit()
+            self._commit(conn)
             embedding_id = int(cur.lastrowid)
             row = conn.execute(
                 """
@@ -273,7 +357,7 @@ class GalleryStore:
                 """,
                 (embedding_id,),
             ).fetchone()
-            conn.commit()
+            self._commit(conn)
         return self._embedding(row) if row else None
 
     @staticmethod
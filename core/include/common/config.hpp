@@ -7,27 +7,46 @@
 #include <unordered_map>
 
 namespace veilsight {
+    struct NcnnAutotuneConfig {
+        std::string mode = "off"; // off|cached|auto
+        std::string cache_path = "cache/ncnn_autotune.tsv";
+        int iterations = 8;
+        float tolerance = 0.02f;  // max output deviation relative to the fp32 reference
+    };
+
     struct YuNetModuleConfig {
         std::string param_path = "models/detector/yunet/face_detection_yunet_2023mar.ncnn.param";
         std::string bin_path = "models/detector/yunet/face_detection_yunet_2023mar.ncnn.bin";
+        std::string precision = "fp32"; // fp32|int8
+        std::string int8_param_path;      // empty: int8_model_path(param_path)
+        std::string int8_bin_path;
         int input_w = 1088;
         int input_h = 608;
         float score_threshold = 0.6f;
         float nms_threshold = 0.3f;
         int top_k = 750;
+        std::string nms_mode = "hard"; // hard|soft
+        float soft_nms_sigma = 0.5f;
         int ncnn_threads = 1;
+        NcnnAutotuneConfig ncnn_autotune;
     };
 
     struct SCRFDModuleConfig {
         std::string variant = "500m";
         std::string param_path = "models/face_detectors/scrfd/500m/scrfd_500m.ncnn.param";
         std::string bin_path = "models/face_detectors/scrfd/500m/scrfd_500m.ncnn.bin";
+        std::string precision = "fp32"; // fp32|int8
+        std::string int8_param_path;      // empty: int8_model_path(param_path)
+        std::string int8_bin_path;
         int input_w = 640;
         int input_h = 640;
         float score_threshold = 0.35f;
         float nms_threshold = 0.3f;
         int top_k = 750;
+        std::string nms_mode = "hard"; // hard|soft
+        float soft_nms_sigma = 0.5f;
         int ncnn_threads = 1;
+        NcnnAutotuneConfig ncnn_autotune;
     };
 
     struct YoloXModuleConfig {
@@ -35,13 +54,19 @@ namespace veilsight {
         std::string model_path = "models/people_detectors/yolox_nano";
         std::string param_path = "models/people_detectors/yolox_nano/bytetrack_nano.ncnn.param";
         std::string bin_path = "models/people_detectors/yolox_nano/bytetrack_nano.ncnn.bin";
+        std::string precision = "fp32"; // fp32|int8
+        std::string int8_param_path;      // empty: int8_model_path(param_path)
+        std::string int8_bin_path;
         int input_w = 640;
         int input_h = 640;
         float score_threshold = 0.35f;
         float nms_threshold = 0.45f;
         int top_k = 300;
+        std::string nms_mode = "hard"; // hard|soft
+        float soft_nms_sigma = 0.5f;
         int class_id = 0;
         int ncnn_threads = 1;
+        NcnnAutotuneConfig ncnn_autotune;
         bool letterbox = true;
         bool decoded_output = false;
     };
@@ -56,16 +81,48 @@ namespace veilsight {
         float score_threshold = 0.15f;
         float nms_threshold = 0.45f;
         int top_k = 300;
+        std::string nms_mode = "hard"; // hard|soft
+        float soft_nms_sigma = 0.5f;
         int ncnn_threads = 1;
+        NcnnAutotuneConfig ncnn_autotune;
+    };
+
+    struct CascadeModuleConfig {
+        int refresh_interval = 15;          // frames between forced full YOLOX passes per stream
+        float crop_margin = 0.25f;          // UHD union box expansion, relative to its size
+        float max_crop_area_ratio = 0.5f;   // larger UHD unions run YOLOX on the whole frame
+    };
+
+    struct MotionGateConfig {
+        bool enabled = false;
+        int downscale_width = 160;
+        int grid_rows = 6;
+        int grid_cols = 8;
+        int pixel_threshold = 18;          // gray-level difference that marks a pixel as changed
+        float cell_change_ratio = 0.02f;   // changed-pixel fraction that marks a grid cell as active
+        int min_active_cells = 1;
+        int keyframe_interval = 30;        // run the detector at least every N frames
+    };
+
+    struct AdaptiveResolutionConfig {
+        bool enabled = false;
+        std::vector<int> levels = {416, 512, 640}; // long side of the detector input, aspect kept from input_w/h
+        float high_pressure = 0.75f;               // detector queue fill ratio that steps one level down
+        float low_pressure = 0.25f;                // fill ratio that steps back up
+        float min_track_height_px = 48.0f;         // keep small people (faces: 16) at least this tall in the input
+        int cooldown_frames = 30;                  // frames between level changes
     };
 
     struct PersonDetectorModuleConfig {
-        std::string type = "yolox"; // yolox|yunet|scrfd|uhd
+        std::string type = "yolox"; // yolox|yunet|scrfd|uhd|cascade
         int workers = 1;
+        MotionGateConfig motion_gate;
+        AdaptiveResolutionConfig adaptive_resolution;
         YuNetModuleConfig yunet;
         SCRFDModuleConfig scrfd;
         YoloXModuleConfig yolox;
         UhdModuleConfig uhd;
+        CascadeModuleConfig cascade; // UHD gate in front of YOLOX, both configured by their own sections
     };
 
     struct DemoTrackerModuleConfig {
@@ -89,6 +146,8 @@ namespace veilsight {
         float occupancy_decay = 0.92f;
         float transition_decay = 0.98f;
         int warmup_frames = 5;
+        std::string persist_dir;          // empty: learned grids are not kept across restarts
+        int persist_interval_frames = 0;  // 0: save only on shutdown
     };
 
     struct ByteTrackModuleConfig {
@@ -125,6 +184,23 @@ namespace veilsight {
         OCSortModuleConfig ocsort;
     };
 
+    struct FaceProbeConfig {
+        std::string mode = "full_frame"; // full_frame|head_crop
+        int crop_input = 128;             // head crops run at crop_input x crop_input
+        float head_fraction = 0.40f;      // top share of the person box searched for a face
+        float crop_padding = 0.20f;       // added on each side, relative to the head region
+        float min_track_height_px = 24.0f; // shorter tracks are left to the full-frame fallback
+        int full_frame_interval = 15;     // full-frame probe at least every N frames while head crops or reuse skip it
+        int reuse_interval = 0;           // carry a track's face for up to N frames unprobed; 0 disables
+        float reuse_max_shape_change = 0.20f; // relative person box w/h change that forces a re-probe
+    };
+
+    struct FaceMosaicConfig {
+        bool enabled = false; // pack head crops into one detector-sized canvas per forward
+        int max_tasks = 8;    // queued head-crop probes a worker gathers into one batch
+        int gap_px = 8;       // blank border between tiles
+    };
+
     struct FaceDetectorModuleConfig {
         FaceDetectorModuleConfig() {
             scrfd.variant = "500ml";
@@ -136,28 +212,64 @@ namespace veilsight {
             scrfd.nms_threshold = 0.30f;
             scrfd.top_k = 100;
             scrfd.ncnn_threads = 1;
+            adaptive_resolution.min_track_height_px = 16.0f; // smallest face, not person
         }
 
         std::string type = "scrfd"; // none|scrfd|yunet
         std::string association_mode = "person_bbox"; // person_bbox|independent
+        std::string assignment = "greedy"; // greedy|hungarian face-to-track matching
         int workers = 1;
+        FaceProbeConfig probes;
+        FaceMosaicConfig mosaic;
+        AdaptiveResolutionConfig adaptive_resolution; // full-frame probes only
         YuNetModuleConfig yunet;
         SCRFDModuleConfig scrfd;
     };
 
+    struct GalleryIndexConfig {
+        std::string type = "flat"; // flat|ivfpq
+        int min_rows = 50000;      // smaller galleries keep the exact scan even when ivfpq is selected
+        int lists = 0;             // inverted lists; 0: sqrt(rows)
+        int probes = 16;           // lists scanned per query
+        int pq_subspaces = 16;     // product-quantizer subspaces; must divide embedding_dim
+        int rerank = 64;           // candidates re-scored exactly against the float rows
+    };
+
+    struct RecognizerBatchConfig {
+        bool enabled = true; // embed the faces of several queued tasks together and score them in one gallery scan
+        int max_tasks = 4;   // queued recognition tasks a worker gathers into one batch
+        int max_faces = 16;  // faces aligned into the shared input buffer per batch; larger batches are split
+    };
+
+    struct RecognizerBestShotConfig {
+        bool enabled = false;   // buffer each track's usable faces and embed only the best ones per window
+        int window_frames = 8;  // frames a window spans, counted from the track's first usable face in it
+        int candidates = 2;     // highest-quality faces of a window that are embedded
+        int max_embeddings = 4; // per track; an unknown result opens another window until this is spent
+    };
+
     struct RecognizerModuleConfig {
         std::string type = "noop"; // noop|none|mobilefacenet
         int workers = 1;
         std::string gallery_path;
+        std::string gallery_precision = "fp32"; // fp32|int8: int8 scans a quantized copy, then re-scores exactly
+        GalleryIndexConfig gallery_index;
+        bool gallery_snapshot = true; // keep <gallery_path>.vsgallery and map it at startup
+        RecognizerBatchConfig batch;
+        RecognizerBestShotConfig best_shot;
         float unknown_threshold = 0.0f;
         std::string param_path = "models/face_embeddings/mobilefacenet/mobilefacenets.param";
         std::string bin_path = "models/face_embeddings/mobilefacenet/mobilefacenets.bin";
+        std::string precision = "fp32"; // fp32|int8
+        std::string int8_param_path;      // empty: int8_model_path(param_path)
+        std::string int8_bin_path;
         std::string input_blob = "data";
         std::string output_blob = "fc1";
         int input_w = 112;
         int input_h = 112;
         int embedding_dim = 128;
         int ncnn_threads = 1;
+        NcnnAutotuneConfig ncnn_autotune;
         int cache_ttl_frames = 900;
         float min_face_score = 0.70f;
         float min_face_size_px = 56.0f;
@@ -174,6 +286,7 @@ namespace veilsight {
     };
 
     struct ModulesConfig {
+        NcnnAutotuneConfig ncnn_autotune; // copied into every ncnn-backed module config
         PersonDetectorModuleConfig person_detector;
         TrackerModuleConfig tracker;
         FaceDetectorModuleConfig face_detector;
@@ -229,6 +342,22 @@ namespace veilsight {
         std::unordered_map<std::string, OutputConfig> profiles;
     };
 
+    struct NormalizedPoint {
+        float x = 0.0f;
+        float y = 0.0f;
+    };
+
+    struct DetectionRegionsConfig {
+        // Polygons in normalized [0, 1] inference-frame coordinates; empty means the whole frame.
+        std::vector<std::vector<NormalizedPoint>> polygons;
+        std::string tiling = "off";        // off|auto
+        int tile_w = 0;                    // 0 uses the person detector input size
+        int tile_h = 0;
+        float tile_overlap = 0.2f;
+        bool full_region_pass = true;      // also run each region once whole so people larger than a tile survive
+        float merge_iou_threshold = 0.5f;
+    };
+
     struct IngestConfig {
         std::string type; // webcam|file|rtsp
         std::string id;
@@ -242,6 +371,8 @@ namespace veilsight {
         OutputConfig output;
 
         OutputsConfig outputs;
+
+        DetectionRegionsConfig detection_regions;
     };
 
     struct ServerConfig {
@@ -338,6 +469,9 @@ namespace veilsight {
         std::vector<IngestConfig> streams;
     };
 
+    // Sibling path for the int8 build of an fp32 ncnn model: foo.ncnn.param -> foo_int8.ncnn.param.
+    std::string int8_model_path(const std::string& fp32_path);
+
     AppConfig load_config_yaml(const std::string& path);
     AppConfig load_config_yaml_string(const std::string& yaml);
     void validate_config(const AppConfig& config);
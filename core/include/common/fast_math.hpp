@@ -0,0 +1,43 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+namespace veilsight {
+    // exp(x) via 2^(x*log2(e)): the integer part goes into the exponent bits and 2^f, f in [-0.5, 0.5],
+    // comes from a degree-6 polynomial. Relative error stays below 4e-6, plenty for box decoding.
+    inline float fast_exp(float x) {
+        x = std::clamp(x, -87.0f, 88.0f);
+        const float t = x * 1.44269504088896341f;
+        const float fi = std::nearbyint(t);
+        const float f = t - fi;
+        float p = 1.535336188319500e-4f;
+        p = p * f + 1.339887440266574e-3f;
+        p = p * f + 9.618437357674640e-3f;
+        p = p * f + 5.550332471162809e-2f;
+        p = p * f + 2.402264791363012e-1f;
+        p = p * f + 6.931472028550421e-1f;
+        p = p * f + 1.0f;
+        const int32_t bits = (static_cast<int32_t>(fi) + 127) << 23;
+        float scale;
+        std::memcpy(&scale, &bits, sizeof(scale));
+        return p * scale;
+    }
+
+    inline float fast_sigmoid(float x) {
+        return 1.0f / (1.0f + fast_exp(-x));
+    }
+
+    inline float fast_softplus(float x) {
+        return std::log1p(fast_exp(-std::fabs(x))) + std::max(x, 0.0f);
+    }
+
+    // Smallest logit whose sigmoid reaches `probability`; lets decoders threshold raw logits.
+    inline float logit_threshold(float probability) {
+        if (probability <= 0.0f) return -INFINITY;
+        if (probability >= 1.0f) return INFINITY;
+        return std::log(probability / (1.0f - probability));
+    }
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <common/config.hpp>
+
+#include <functional>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace ncnn {
+    class Net;
+    class Option;
+}
+
+namespace veilsight {
+    // ncnn::Option switches the autotuner chooses between; defaults mirror ncnn's own.
+    struct NcnnTuning {
+        bool use_fp16_packed = true;
+        bool use_fp16_storage = true;
+        bool use_fp16_arithmetic = true;
+        bool use_packing_layout = true;
+        bool use_winograd_convolution = true;
+        bool use_sgemm_convolution = true;
+        bool light_mode = true;
+        double avg_ms = 0.0;
+
+        bool operator==(const NcnnTuning& other) const;
+    };
+
+    struct NcnnModelProbe {
+        std::string name;
+        std::string param_path;
+        std::string bin_path;
+        int input_w = 0;
+        int input_h = 0;
+        int input_c = 3;
+        int threads = 1;
+        // Registers custom layers and loads param/bin into the net; options are already applied.
+        std::function<void(ncnn::Net&)> load;
+    };
+
+    struct NcnnAutotuneReport {
+        NcnnTuning tuning;
+        float max_deviation = 0.0f;
+        bool within_tolerance = true;
+    };
+
+    // Param/bin pair a module loads for its configured precision.
+    template <typename ModuleConfig>
+    std::pair<std::string, std::string> ncnn_model_files(const ModuleConfig& cfg) {
+        if (cfg.precision != "int8") return {cfg.param_path, cfg.bin_path};
+        return {cfg.int8_param_path.empty() ? int8_model_path(cfg.param_path) : cfg.int8_param_path,
+                cfg.int8_bin_path.empty() ? int8_model_path(cfg.bin_path) : cfg.int8_bin_path};
+    }
+
+    const std::vector<NcnnTuning>& ncnn_tuning_candidates();
+    void apply_ncnn_tuning(ncnn::Option& opt, const NcnnTuning& tuning);
+
+    std::string host_cpu_model();
+    // Model content hash, CPU model, thread count and input shape; tuning results are only reused on an exact match.
+    std::string ncnn_tuning_cache_key(const NcnnModelProbe& probe);
+
+    std::optional<NcnnTuning> load_cached_ncnn_tuning(const std::string& cache_path, const std::string& key);
+    void store_cached_ncnn_tuning(const std::string& cache_path, const std::string& key, const NcnnTuning& tuning);
+
+    // Benchmarks every candidate on random input and reports each one; the reference is the fp32 candidate.
+    std::vector<NcnnAutotuneReport> benchmark_ncnn_tunings(const NcnnModelProbe& probe,
+                                                           int iterations,
+                                                           float tolerance);
+    NcnnTuning pick_ncnn_tuning(const std::vector<NcnnAutotuneReport>& reports);
+
+    // off: nullopt, keep ncnn defaults. cached: cache hit only. auto: cache hit, else benchmark and store.
+    std::optional<NcnnTuning> resolve_ncnn_tuning(const NcnnAutotuneConfig& cfg, const NcnnModelProbe& probe);
+}
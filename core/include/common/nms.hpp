@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace veilsight {
+    enum class NmsMode {
+        Hard,
+        Soft,
+    };
+
+    NmsMode nms_mode_from_str(const std::string& mode);
+
+    struct NmsOptions {
+        float iou_threshold = 0.45f;
+        int top_k = 0; // candidates kept before suppression; <= 0 keeps all
+        NmsMode mode = NmsMode::Hard;
+        float soft_sigma = 0.5f;
+        float soft_min_score = 0.001f;
+    };
+
+    // Structure-of-arrays candidate set: corners and score live in separate contiguous arrays.
+    struct NmsCandidates {
+        std::vector<float> x1;
+        std::vector<float> y1;
+        std::vector<float> x2;
+        std::vector<float> y2;
+        std::vector<float> score;
+
+        size_t size() const { return score.size(); }
+        bool empty() const { return score.empty(); }
+        void clear();
+        void reserve(size_t n);
+        void push(float left, float top, float right, float bottom, float s);
+    };
+
+    // Indices of the k highest scores, best first; ties keep the lower index first.
+    std::vector<int> top_k_indices(const std::vector<float>& scores, int k);
+
+    // Returns kept candidate indices ordered by descending score. Soft mode ignores iou_threshold
+    // and rewrites candidates.score with the decayed scores of the kept entries.
+    std::vector<int> non_max_suppression(NmsCandidates& candidates, const NmsOptions& options);
+}
@@ -12,6 +12,7 @@ namespace veilsight {
     struct FaceDetectorRunConfig {
         int input_w = 320;
         int input_h = 320;
+        std::shared_ptr<PreprocessCache> preprocess; // frame's tensor cache; only used for the full frame
     };
 
     class IFaceDetector {
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <face_detector/face_detector.hpp>
+#include <pipeline/tasks.hpp>
+
+#include <cstddef>
+#include <vector>
+
+#include <opencv2/core.hpp>
+
+namespace veilsight {
+    struct FaceMosaicLayout {
+        cv::Size canvas;  // detector input size
+        int tile = 128;   // each crop is resized to tile x tile
+        int gap = 8;      // blank pixels between tiles so faces cannot bridge two crops
+    };
+
+    struct FaceMosaicTile {
+        size_t task = 0; // index into the packed task list
+        size_t crop = 0; // index into that task's crops
+        cv::Rect cell;   // tile on the canvas
+    };
+
+    struct FaceMosaic {
+        cv::Mat canvas;
+        std::vector<FaceMosaicTile> tiles;
+    };
+
+    // Tiles that fit on one canvas; 0 when the tile does not fit at all.
+    size_t face_mosaic_capacity(const FaceMosaicLayout& layout);
+
+    // Packs the crops of every HeadCrops task row-major into as many canvases as needed.
+    std::vector<FaceMosaic> pack_face_mosaics(const std::vector<FaceDetectionTask>& tasks,
+                                              const FaceMosaicLayout& layout);
+
+    // One forward per canvas instead of one per crop. Faces are handed back to the task and track whose tile
+    // holds their center, in frame coordinates, exactly as run_face_detection_task would return them.
+    // Tasks that are not HeadCrops, or layouts that fit no tile, fall back to run_face_detection_task.
+    std::vector<FaceDetectionResult> run_face_mosaic_tasks(IFaceDetector& detector,
+                                                           const std::vector<FaceDetectionTask>& tasks,
+                                                           const FaceMosaicLayout& layout);
+}
@@ -7,41 +7,72 @@
 
 #include <memory>
 #include <mutex>
+#include <optional>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include <opencv2/core.hpp>
 
 namespace veilsight {
+    FaceDetectorRunConfig run_config_for_detector(const FaceDetectorModuleConfig& cfg);
+
+    // Square region around the head of `person`, clipped to the frame; empty when nothing is left.
+    cv::Rect head_crop_rect(const Box& person, cv::Size frame_size, const FaceProbeConfig& cfg);
+
+    // Runs one probe on `detector` and maps its faces back to frame coordinates.
+    FaceDetectionResult run_face_detection_task(IFaceDetector& detector, const FaceDetectionTask& task);
+
+    struct TrackFaceState {
+        FaceObservation face; // last detection
+        RectF person;         // person box of the frame the face was detected in
+    };
+
     class FaceStateStore {
     public:
         std::mutex mutex;
+        std::unordered_map<int, TrackFaceState> tracks; // by track id, guarded by mutex
     };
 
-    class HybridFacePolicy {
+    // Moves a track's last detected face with its person box. Returns nothing once the face is older than
+    // reuse_interval frames or the box changed shape by more than reuse_max_shape_change.
+    std::optional<FaceObservation> propagate_track_face(const TrackFaceState& state,
+                                                        const Box& track,
+                                                        int64_t frame_id,
+                                                        const FaceProbeConfig& cfg);
+
+    class FaceProbePlanner {
     public:
-        explicit HybridFacePolicy(FaceDetectorModuleConfig cfg,
+        explicit FaceProbePlanner(FaceDetectorModuleConfig cfg,
                                   std::shared_ptr<FaceStateStore> state = std::make_shared<FaceStateStore>());
 
-        void annotate(FrameCtx& frame,
-                      std::vector<Box>& tracks,
-                      IFaceDetector& detector);
+        std::vector<FaceDetectionTask> plan(FrameCtx& frame, std::vector<Box>& tracks);
+
+        // Head-crop probes and face reuse are planned from tracks, so they cannot run ahead of the tracker.
+        bool needs_tracks() const {
+            return cfg_.probes.mode == "head_crop" || cfg_.probes.reuse_interval > 0;
+        }
 
         std::shared_ptr<FaceStateStore> state_store() const {
             return state_;
         }
 
     private:
+        FaceDetectionTask full_frame_task_(const FrameCtx& frame) const;
+
         FaceDetectorModuleConfig cfg_;
         std::shared_ptr<FaceStateStore> state_;
+        int64_t last_full_frame_id_ = -1;
     };
 
-    class FaceProbePlanner {
+    class FaceResultApplier {
     public:
-        explicit FaceProbePlanner(FaceDetectorModuleConfig cfg,
-                                  std::shared_ptr<FaceStateStore> state = std::make_shared<FaceStateStore>());
+        explicit FaceResultApplier(FaceDetectorModuleConfig cfg,
+                                   std::shared_ptr<FaceStateStore> state = std::make_shared<FaceStateStore>());
 
-        std::vector<FaceDetectionTask> plan(FrameCtx& frame, std::vector<Box>& tracks);
+        void apply(FrameCtx& frame,
+                   std::vector<Box>& tracks,
+                   const std::vector<FaceDetectionResult>& results);
 
         std::shared_ptr<FaceStateStore> state_store() const {
             return state_;
@@ -52,14 +83,14 @@ namespace veilsight {
         std::shared_ptr<FaceStateStore> state_;
     };
 
-    class FaceResultApplier {
+    class HybridFacePolicy {
     public:
-        explicit FaceResultApplier(FaceDetectorModuleConfig cfg,
-                                   std::shared_ptr<FaceStateStore> state = std::make_shared<FaceStateStore>());
+        explicit HybridFacePolicy(FaceDetectorModuleConfig cfg,
+                                  std::shared_ptr<FaceStateStore> state = std::make_shared<FaceStateStore>());
 
-        void apply(FrameCtx& frame,
-                   std::vector<Box>& tracks,
-                   const std::vector<FaceDetectionResult>& results);
+        void annotate(FrameCtx& frame,
+                      std::vector<Box>& tracks,
+                      IFaceDetector& detector);
 
         std::shared_ptr<FaceStateStore> state_store() const {
             return state_;
@@ -68,5 +99,7 @@ namespace veilsight {
     private:
         FaceDetectorModuleConfig cfg_;
         std::shared_ptr<FaceStateStore> state_;
+        FaceProbePlanner planner_;
+        FaceResultApplier applier_;
     };
 }
@@ -1,7 +1,9 @@
 #pragma once
 
+#include <common/ncnn_autotune.hpp>
 #include <person_detector/person_detector.hpp>
 #include <face_detector/face_detector.hpp>
+#include <pipeline/preprocess_cache.hpp>
 
 #include <memory>
 
@@ -26,4 +28,7 @@ namespace veilsight {
         class Impl;
         std::unique_ptr<Impl> impl_;
     };
+
+    NcnnModelProbe yunet_model_probe(const YuNetModuleConfig& cfg);
+    PreprocessKey yunet_preprocess_key(const YuNetModuleConfig& cfg);
 }
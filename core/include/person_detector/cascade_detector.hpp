@@ -0,0 +1,32 @@
+#pragma once
+
+#include <person_detector/person_detector.hpp>
+
+#include <memory>
+
+namespace veilsight {
+    // Runs the ultra-tiny UHD model on every frame and YOLOX only where it matters: on frames with live tracks or a
+    // due refresh, and otherwise on a crop around the UHD hits (or the whole frame when the hits cover too much).
+    class CascadeDetector final : public IPersonDetector {
+    public:
+        explicit CascadeDetector(PersonDetectorModuleConfig cfg);
+        CascadeDetector(CascadeModuleConfig cfg,
+                        std::unique_ptr<IPersonDetector> gate,
+                        std::unique_ptr<IPersonDetector> full);
+        ~CascadeDetector();
+
+        CascadeDetector(CascadeDetector&&) noexcept;
+        CascadeDetector& operator=(CascadeDetector&&) noexcept;
+
+        CascadeDetector(const CascadeDetector&) = delete;
+        CascadeDetector& operator=(const CascadeDetector&) = delete;
+
+        std::vector<Box> detect(const cv::Mat& bgr) override;
+        std::vector<Box> detect(const cv::Mat& bgr, const PersonDetectionHints& hints) override;
+
+    private:
+        CascadeModuleConfig cfg_;
+        std::unique_ptr<IPersonDetector> gate_;
+        std::unique_ptr<IPersonDetector> full_;
+    };
+}
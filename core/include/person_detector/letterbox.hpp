@@ -0,0 +1,65 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <opencv2/core.hpp>
+
+namespace veilsight {
+    struct LetterboxLayout {
+        int src_w = 0;
+        int src_h = 0;
+        int dst_w = 0;
+        int dst_h = 0;
+        int resized_w = 0;
+        int resized_h = 0;
+        int pad_x = 0;
+        int pad_y = 0;
+        float scale_x = 1.0f;
+        float scale_y = 1.0f;
+        bool keep_aspect = true;
+
+        // Bilinear taps per resized column/row, precomputed once per source and input size.
+        // Column taps are byte offsets into a BGR8 row; row taps are source row indices.
+        std::vector<int> x0;
+        std::vector<int> x1;
+        std::vector<float> ax;
+        std::vector<int> y0;
+        std::vector<int> y1;
+        std::vector<float> ay;
+
+        bool matches(int source_w, int source_h, int input_w, int input_h, bool aspect) const {
+            return src_w == source_w && src_h == source_h && dst_w == input_w && dst_h == input_h &&
+                   keep_aspect == aspect;
+        }
+    };
+
+    LetterboxLayout make_letterbox_layout(int src_w, int src_h, int dst_w, int dst_h, bool keep_aspect);
+
+    // Keeps the most recently used layouts so callers that alternate source sizes (full frames,
+    // region tiles, cascade crops) reuse their taps instead of rebuilding them on every switch.
+    class LetterboxLayoutCache {
+    public:
+        static constexpr size_t kCapacity = 4;
+
+        const LetterboxLayout& get(int src_w, int src_h, int dst_w, int dst_h, bool keep_aspect);
+        size_t builds() const { return builds_; }
+
+    private:
+        std::array<LetterboxLayout, kCapacity> layouts_{};
+        std::array<uint64_t, kCapacity> last_used_{};
+        uint64_t clock_ = 0;
+        size_t builds_ = 0;
+    };
+
+    // Resizes a BGR8 image with bilinear sampling, pads it to dst_w x dst_h, swaps to RGB and writes
+    // normalized planar floats: plane c starts at dst + c * plane_stride.
+    void letterbox_bgr_to_planar_rgb(const cv::Mat& bgr,
+                                     const LetterboxLayout& layout,
+                                     float pad_value,
+                                     float norm,
+                                     float* dst,
+                                     size_t plane_stride);
+}
@@ -9,10 +9,22 @@
 #include <opencv2/core.hpp>
 
 namespace veilsight {
+    // Per-frame stream state the runtime knows and detectors may use to skip work.
+    struct PersonDetectionHints {
+        bool tracks_live = false;
+        bool refresh = false; // the stream's periodic full-detector refresh is due
+        cv::Size input_size;  // network input override for the full frame; empty keeps the configured size
+        std::shared_ptr<PreprocessCache> preprocess; // frame's tensor cache; only used for the full frame
+    };
+
     class IPersonDetector {
     public:
         virtual ~IPersonDetector() = default;
         virtual std::vector<Box> detect(const cv::Mat& bgr) = 0;
+        virtual std::vector<Box> detect(const cv::Mat& bgr, const PersonDetectionHints& hints) {
+            (void)hints;
+            return detect(bgr);
+        }
     };
 
     class IPersonDetectorFactory {
@@ -24,4 +36,5 @@ namespace veilsight {
 
     std::unique_ptr<IPersonDetectorFactory> create_person_detector_factory(const PersonDetectorModuleConfig& cfg);
     std::unique_ptr<IPersonDetector> create_person_detector(const PersonDetectorModuleConfig& cfg);
+    cv::Size person_detector_input_size(const PersonDetectorModuleConfig& cfg);
 }
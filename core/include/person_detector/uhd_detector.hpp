@@ -1,5 +1,6 @@
 #pragma once
 
+#include <common/ncnn_autotune.hpp>
 #include <person_detector/person_detector.hpp>
 
 #include <memory>
@@ -23,4 +24,6 @@ namespace veilsight {
         class Impl;
         std::unique_ptr<Impl> impl_;
     };
+
+    NcnnModelProbe uhd_model_probe(const UhdModuleConfig& cfg);
 }
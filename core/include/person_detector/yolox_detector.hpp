@@ -1,6 +1,8 @@
 #pragma once
 
+#include <common/ncnn_autotune.hpp>
 #include <person_detector/person_detector.hpp>
+#include <pipeline/preprocess_cache.hpp>
 
 #include <memory>
 
@@ -17,10 +19,14 @@ namespace veilsight {
         YoloXDetector& operator=(const YoloXDetector&) = delete;
 
         std::vector<Box> detect(const cv::Mat& bgr) override;
+        std::vector<Box> detect(const cv::Mat& bgr, const PersonDetectionHints& hints) override;
 
     private:
         YoloXModuleConfig cfg_;
         class Impl;
         std::unique_ptr<Impl> impl_;
     };
+
+    NcnnModelProbe yolox_model_probe(const YoloXModuleConfig& cfg);
+    PreprocessKey yolox_preprocess_key(const YoloXModuleConfig& cfg);
 }
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <common/config.hpp>
+#include <pipeline/types.hpp>
+
+#include <cstddef>
+#include <vector>
+
+#include <opencv2/core.hpp>
+
+namespace veilsight {
+    // Per-stream detector input size controller. Steps one level down while the detector queue is under
+    // pressure, unless the smallest objects it looks for (people, or faces for the face detector) would shrink
+    // below min_track_height_px in the input, and steps back up once the queue drains or they need the detail.
+    class AdaptiveResolution {
+    public:
+        AdaptiveResolution(AdaptiveResolutionConfig cfg, cv::Size configured_input);
+
+        // queue_pressure is the detector queue fill ratio; small_track_height is the small_track_height() or
+        // small_face_height() of recent frames in frame pixels, <= 0 if none.
+        // The configured input is always the top level; levels above its long side are dropped.
+        cv::Size update(float queue_pressure, float small_track_height, cv::Size frame_size);
+
+        cv::Size current() const {
+            return sizes_[level_];
+        }
+
+        size_t level() const {
+            return level_;
+        }
+
+        const std::vector<cv::Size>& sizes() const {
+            return sizes_;
+        }
+
+    private:
+        float input_height_of_(float frame_height_px, size_t level, cv::Size frame_size) const;
+
+        AdaptiveResolutionConfig cfg_;
+        std::vector<cv::Size> sizes_; // ascending
+        size_t level_ = 0;
+        int frames_since_change_ = 0;
+    };
+
+    // Height below which the smallest tenth of the boxes fall; 0 when there are none.
+    float small_track_height(const std::vector<Box>& boxes);
+
+    // The same percentile over the faces attached to the boxes; 0 when no box carries a face.
+    float small_face_height(const std::vector<Box>& boxes);
+}
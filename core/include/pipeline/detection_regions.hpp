@@ -0,0 +1,47 @@
+#pragma once
+
+#include <common/config.hpp>
+#include <pipeline/transforms.hpp>
+#include <pipeline/types.hpp>
+
+#include <memory>
+#include <vector>
+
+#include <opencv2/core.hpp>
+
+namespace veilsight {
+    // Crops the person detector runs on for one inference frame size: the bounding rectangle of each configured
+    // polygon and, with tiling enabled, overlapping tiles of the detector input size.
+    struct DetectionRegionLayout {
+        cv::Size frame_size;
+        std::vector<std::vector<cv::Point2f>> polygons;
+        std::vector<cv::Rect> crops;
+        float merge_iou_threshold = 0.5f;
+    };
+
+    class DetectionRegionPlanner {
+    public:
+        DetectionRegionPlanner(DetectionRegionsConfig cfg, cv::Size detector_input_size);
+
+        bool active() const;
+
+        // Rebuilt only when the frame size changes; the returned layout is immutable and safe to share.
+        std::shared_ptr<const DetectionRegionLayout> layout(cv::Size frame_size);
+
+    private:
+        void add_tiles_(DetectionRegionLayout& layout, const cv::Rect& region) const;
+
+        DetectionRegionsConfig cfg_;
+        cv::Size tile_size_;
+        std::shared_ptr<const DetectionRegionLayout> layout_;
+    };
+
+    // Zero-copy crop views of `frame` with their crop-to-frame transforms.
+    std::vector<StageImage> crop_detection_regions(const cv::Mat& frame, const DetectionRegionLayout& layout);
+
+    // Merges per-crop detections already mapped to frame coordinates: drops boxes centred outside every polygon,
+    // suppresses duplicates across crops and keeps the larger box when one crop only saw part of a person. A box is
+    // treated as partial only when it touches an interior edge of its crop, so nested people both survive.
+    std::vector<Box> merge_region_detections(const DetectionRegionLayout& layout,
+                                             const std::vector<std::vector<Box>>& crop_boxes);
+}
@@ -50,6 +50,7 @@ namespace veilsight {
             double uptime_s = 0.0;
             std::map<RuntimeStage, StageSnapshot> global;
             std::map<std::string, std::map<RuntimeStage, StageSnapshot>> streams;
+            std::map<std::string, std::map<std::string, uint64_t>> stream_counters;
         };
 
         RuntimeMetrics();
@@ -62,6 +63,7 @@ namespace veilsight {
 
         void observe_global(RuntimeStage stage, uint64_t duration_ns, bool ok = true);
         void observe_stream(const std::string& stream_id, RuntimeStage stage, uint64_t duration_ns, bool ok = true);
+        void add_stream_counter(const std::string& stream_id, const std::string& name, uint64_t delta = 1);
         Snapshot snapshot() const;
 
     private:
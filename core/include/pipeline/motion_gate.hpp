@@ -0,0 +1,44 @@
+#pragma once
+
+#include <common/config.hpp>
+
+#include <cstdint>
+#include <vector>
+
+#include <opencv2/core.hpp>
+
+namespace veilsight {
+    // Per-stream frame-differencing gate in front of the person detector. The frame is downscaled to gray and
+    // compared with the frame of the last detector run; the detector is skipped only when no grid cell changed,
+    // no tracks are live and the keyframe interval has not elapsed.
+    class MotionGate {
+    public:
+        explicit MotionGate(MotionGateConfig cfg);
+
+        bool should_detect(const cv::Mat& bgr, bool tracks_live);
+
+        int last_active_cells() const {
+            return last_active_cells_;
+        }
+
+        uint64_t skipped_frames() const {
+            return skipped_frames_;
+        }
+
+    private:
+        void prepare_(const cv::Mat& bgr);
+        int count_active_cells_() const;
+
+        MotionGateConfig cfg_;
+        cv::Mat small_;
+        cv::Mat gray_;
+        cv::Mat reference_;
+        std::vector<int> cell_of_col_;
+        std::vector<int> cell_of_row_;
+        std::vector<int> cell_area_;
+        mutable std::vector<int> cell_changed_;
+        int frames_since_detect_ = 0;
+        int last_active_cells_ = 0;
+        uint64_t skipped_frames_ = 0;
+    };
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+#include <common/config.hpp>
+
+#include <ncnn/mat.h>
+#include <opencv2/core.hpp>
+
+namespace veilsight {
+    enum class PreprocessResize {
+        Stretch,
+        Letterbox, // aspect-preserving, centred with equal padding on both sides
+    };
+
+    // A planar float network input computed from a BGR8 image: value = (pixel - mean) * norm.
+    struct PreprocessKey {
+        int width = 0;
+        int height = 0;
+        PreprocessResize resize = PreprocessResize::Stretch;
+        float pad_value = 0.0f; // letterbox border in pixel units
+        bool rgb = false;       // plane order; false keeps BGR
+        std::array<float, 3> mean{0.0f, 0.0f, 0.0f};
+        std::array<float, 3> norm{1.0f, 1.0f, 1.0f};
+
+        bool same_geometry(const PreprocessKey& other) const;
+        bool operator==(const PreprocessKey& other) const;
+    };
+
+    // Per-frame store of network inputs built from one source image, shared by every stage that
+    // preprocesses that image. A request whose geometry matches a cached tensor but whose channel
+    // order or normalization differs is derived from it with one pass instead of a new resize. Tensors with
+    // a different size or resize mode are never derived from each other, so YOLOX (letterbox) shares with
+    // SCRFD/YuNet (stretch) only when it runs with letterbox off at the same input size.
+    class PreprocessCache {
+    public:
+        explicit PreprocessCache(const cv::Mat& source);
+
+        // Returns the tensor for `key`, calling `build` only when nothing usable is cached. Images other
+        // than the source (crops, other frames) are always built and never cached. The returned tensor is
+        // shared: callers must treat it as read-only.
+        ncnn::Mat get(const cv::Mat& image, const PreprocessKey& key, const std::function<ncnn::Mat()>& build);
+
+        size_t hits() const;
+        size_t derived() const;
+        size_t misses() const;
+
+    private:
+        struct Entry {
+            PreprocessKey key;
+            ncnn::Mat tensor;
+        };
+
+        bool covers_(const cv::Mat& image) const;
+
+        const unsigned char* data_ = nullptr;
+        int cols_ = 0;
+        int rows_ = 0;
+        size_t step_ = 0;
+
+        mutable std::mutex mutex_;
+        std::vector<Entry> entries_;
+        size_t hits_ = 0;
+        size_t derived_ = 0;
+        size_t misses_ = 0;
+    };
+
+    // Re-expresses a tensor built for `from` in the channel order and normalization of `to`.
+    // Returns an empty Mat when the geometry differs or `from` has a zero norm.
+    ncnn::Mat convert_preprocessed(const ncnn::Mat& tensor, const PreprocessKey& from, const PreprocessKey& to);
+
+    // Whether the configured person and face detectors build full-frame inputs of the same geometry, so one
+    // can serve the other. Only then does the runtime attach a PreprocessCache to frames; otherwise each
+    // detector fills its own reused input buffer.
+    bool detectors_share_preprocess(const PersonDetectorModuleConfig& person, const FaceDetectorModuleConfig& face);
+}
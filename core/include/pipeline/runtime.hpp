@@ -16,8 +16,12 @@
 #include <identity/identity_decider.hpp>
 #include <ingest/gst_dual_source.hpp>
 #include <pipeline/bounded_queue.hpp>
+#include <pipeline/adaptive_resolution.hpp>
+#include <pipeline/detection_regions.hpp>
 #include <pipeline/lifecycle.hpp>
 #include <pipeline/metrics.hpp>
+#include <pipeline/motion_gate.hpp>
+#include <pipeline/preprocess_cache.hpp>
 #include <pipeline/publishers.hpp>
 #include <pipeline/stream_coordinator.hpp>
 #include <pipeline/tasks.hpp>
@@ -83,6 +87,14 @@ namespace veilsight {
             NamedQueue<IdentityResult> identities_in;
             NamedQueue<AnonymizeResult> encoder_in;
             std::unique_ptr<StreamCoordinator> coordinator;
+            std::unique_ptr<MotionGate> motion_gate;
+            std::unique_ptr<DetectionRegionPlanner> detection_regions;
+            std::unique_ptr<AdaptiveResolution> person_resolution;
+            std::unique_ptr<AdaptiveResolution> face_resolution;
+            std::atomic<size_t> live_tracks{0};
+            std::atomic<float> small_track_height{0.0f};
+            std::atomic<float> small_face_height{0.0f};
+            int detections_since_refresh = 0;
 
             std::thread ingest_thr;
             std::thread coordinator_thr;
@@ -136,6 +148,7 @@ namespace veilsight {
         Options opt_;
 
         std::atomic<bool> running_{false};
+        bool share_preprocess_ = false;
         std::atomic<uint64_t> person_detections_total_{0};
         std::atomic<uint64_t> face_detections_total_{0};
         std::atomic<uint64_t> committed_tracks_total_{0};
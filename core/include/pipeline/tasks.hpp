@@ -1,12 +1,15 @@
 #pragma once
 
 #include <cstdint>
+#include <memory>
 #include <string>
 #include <vector>
 
 #include <opencv2/core.hpp>
 
 #include <face_detector/face_detector.hpp>
+#include <person_detector/person_detector.hpp>
+#include <pipeline/detection_regions.hpp>
 #include <pipeline/transforms.hpp>
 #include <pipeline/types.hpp>
 
@@ -15,6 +18,8 @@ namespace veilsight {
         std::string stream_id;
         int64_t frame_id = 0;
         StageImage input;
+        std::shared_ptr<const DetectionRegionLayout> regions; // when set, detect on these crops of input
+        PersonDetectionHints hints;
         FramePtr frame_ctx;
     };
 
@@ -25,7 +30,13 @@ namespace veilsight {
     };
 
     enum class FaceProbeKind {
-        FullFrame
+        FullFrame,
+        HeadCrops
+    };
+
+    struct FaceProbeCrop {
+        StageImage input;
+        int track_id = -1;
     };
 
     struct FaceDetectionTask {
@@ -34,6 +45,7 @@ namespace veilsight {
         std::string probe_id;
         FaceProbeKind kind = FaceProbeKind::FullFrame;
         StageImage input;
+        std::vector<FaceProbeCrop> crops; // HeadCrops: detect on each crop instead of input
         FaceDetectorRunConfig run;
     };
 
@@ -43,6 +55,7 @@ namespace veilsight {
         std::string probe_id;
         FaceProbeKind kind = FaceProbeKind::FullFrame;
         std::vector<FaceObservation> faces;
+        std::vector<int> track_ids; // HeadCrops: track whose crop produced faces[i]
     };
 
     struct RecognitionTask {
@@ -18,6 +18,8 @@ namespace veilsight {
     };
 
     SpatialTransform identity_transform(cv::Size size);
+    // Maps coordinates inside `crop` (a sub-rectangle of a frame of `frame_size`) back to frame coordinates.
+    SpatialTransform crop_transform(const cv::Rect& crop, cv::Size frame_size);
     RectF map_rect(const SpatialTransform& transform, const RectF& rect);
     PointF map_point(const SpatialTransform& transform, const PointF& point);
     FaceObservation map_face(const SpatialTransform& transform, const FaceObservation& face);
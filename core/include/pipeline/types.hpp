@@ -22,7 +22,8 @@ namespace veilsight {
     };
 
     enum class FaceSource {
-        FullFrame
+        FullFrame,
+        HeadCrop
     };
 
     struct FaceObservation {
@@ -50,6 +51,8 @@ namespace veilsight {
         std::optional<FaceObservation> face;
     };
 
+    class PreprocessCache;
+
     struct FrameCtx {
         std::string stream_id;
         std::string source_type;
@@ -71,9 +74,12 @@ namespace veilsight {
 
         cv::Mat ui;  // will be mutated by anonymizer and output to user
         cv::Mat inf; // will be released after inference
+        std::shared_ptr<PreprocessCache> preprocess; // network inputs built from inf, released with it
         std::vector<Box> tracked_boxes;
         size_t person_detection_count = 0;
         size_t face_detection_count = 0;
+        size_t face_probes_issued = 0;  // full-frame probes plus head crops sent to the face detector
+        size_t face_probes_avoided = 0; // probes skipped because a track's face was reused
     };
 
     using FramePtr = std::shared_ptr<FrameCtx>;
@@ -0,0 +1,205 @@
+#pragma once
+
+#include <common/config.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace veilsight {
+    template <typename T, size_t Alignment>
+    struct AlignedAllocator {
+        using value_type = T;
+
+        template <typename U>
+        struct rebind {
+            using other = AlignedAllocator<U, Alignment>;
+        };
+
+        AlignedAllocator() noexcept = default;
+        template <typename U>
+        AlignedAllocator(const AlignedAllocator<U, Alignment>&) noexcept {}
+
+        T* allocate(size_t n) {
+            return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t{Alignment}));
+        }
+
+        void deallocate(T* p, size_t) noexcept {
+            ::operator delete(p, std::align_val_t{Alignment});
+        }
+
+        template <typename U>
+        bool operator==(const AlignedAllocator<U, Alignment>&) const noexcept { return true; }
+        template <typename U>
+        bool operator!=(const AlignedAllocator<U, Alignment>&) const noexcept { return false; }
+    };
+
+    struct GalleryMatch {
+        uint32_t identity = 0; // index into GalleryMatrix::identities()
+        float score = 0.0f;
+    };
+
+    // Identifies the database state a gallery snapshot was taken from.
+    struct GallerySnapshotInfo {
+        std::string source_tag; // e.g. the gallery DB generation
+        int64_t change_seq = 0; // last change folded into the rows
+    };
+
+    class GalleryIvfPqIndex;
+
+    // Enrolled embeddings as one 64-byte aligned row-major matrix, rows zero-padded to a 16-float stride so the
+    // dot-product kernels never need a tail. Identity keys are interned; each row carries a 32-bit identity index.
+    // An optional int8 copy (symmetric, one scale per row) is scanned first and only its best rows are re-scored
+    // against the float rows, which cuts the memory streamed per query by 4x on large galleries.
+    // A matrix can also be mapped read-only from a snapshot file, in which case its rows live in the mapping.
+    class GalleryMatrix {
+    public:
+        explicit GalleryMatrix(int dim = 128);
+
+        int dim() const { return dim_; }
+        size_t rows() const { return rows_; }
+        bool empty() const { return rows_ == 0; }
+        bool quantized() const { return quantize_; }
+        bool mapped() const { return mapping_ != nullptr; }
+
+        const std::vector<std::string>& identities() const { return identities_; }
+        uint32_t row_identity(size_t row) const { return identity_data_()[row]; }
+        int64_t row_id(size_t row) const { return id_data_()[row]; }
+        const float* row(size_t r) const { return values_data_() + r * stride_; }
+
+        // Appends one embedding; callers pass it L2-normalized. Rows of the same identity need not be adjacent.
+        // row_id is the caller's key for the row (the gallery DB embedding id). Mapped matrices are read-only.
+        void add(const std::string& identity_key, const float* embedding, int64_t row_id = -1);
+
+        // Builds the int8 copy now and keeps it in sync for later add() calls.
+        void quantize_int8();
+
+        // Best k distinct identities for each of num_queries row-major queries of dim() floats, highest cosine
+        // first. Rows are streamed in cache-sized blocks and every query is scored against a block before moving
+        // on, so a batch of queries reads the gallery once. Ties keep the earlier row. Rows whose skip_rows entry
+        // is nonzero are left out.
+        void search(const float* queries,
+                    size_t num_queries,
+                    size_t k,
+                    std::vector<std::vector<GalleryMatch>>& out,
+                    const uint8_t* skip_rows = nullptr) const;
+
+        std::vector<GalleryMatch> search(const std::vector<float>& query,
+                                         size_t k,
+                                         const uint8_t* skip_rows = nullptr) const;
+
+        // Exact scores for the candidate rows of one query, merged into the best k distinct identities.
+        std::vector<GalleryMatch> rerank(const float* query, std::vector<uint32_t> rows, size_t k) const;
+
+        // Writes rows, row ids, identity keys, the int8 copy when quantized() and, when given, an index built from
+        // this matrix to path (via a temporary file and rename) in the layout map_snapshot() reads back.
+        void save_snapshot(const std::string& path,
+                           const GallerySnapshotInfo& info,
+                           const GalleryIvfPqIndex* index = nullptr) const;
+
+        // Maps a snapshot written by save_snapshot(); the float rows and any int8 copy are used in place, and a
+        // GalleryIvfPqIndex built from the mapped matrix adopts a stored index instead of training. Throws
+        // std::runtime_error when the file is missing, truncated, or was written for another dim.
+        static GalleryMatrix map_snapshot(const std::string& path, int dim, GallerySnapshotInfo& info);
+
+    private:
+        friend class GalleryIvfPqIndex;
+
+        using FloatRows = std::vector<float, AlignedAllocator<float, 64>>;
+        using Int8Rows = std::vector<int8_t, AlignedAllocator<int8_t, 64>>;
+
+        const float* values_data_() const { return mapping_ ? mapped_values_ : values_.data(); }
+        const int8_t* qvalues_data_() const { return mapped_qvalues_ ? mapped_qvalues_ : qvalues_.data(); }
+        const float* qscales_data_() const { return mapped_qscales_ ? mapped_qscales_ : qscales_.data(); }
+        const uint32_t* identity_data_() const { return mapping_ ? mapped_identity_ : row_identity_.data(); }
+        const int64_t* id_data_() const { return mapping_ ? mapped_ids_ : row_ids_.data(); }
+        void quantize_row_(size_t row);
+
+        int dim_ = 0;
+        size_t stride_ = 0;
+        size_t qstride_ = 0;
+        size_t rows_ = 0;
+        bool quantize_ = false;
+        FloatRows values_;
+        Int8Rows qvalues_;
+        std::vector<float> qscales_;
+        std::vector<uint32_t> row_identity_;
+        std::vector<int64_t> row_ids_;
+        std::vector<std::string> identities_;
+        std::unordered_map<std::string, uint32_t> identity_index_;
+
+        std::shared_ptr<const void> mapping_; // keeps the snapshot mapped while any copy refers to it
+        const float* mapped_values_ = nullptr;
+        const uint32_t* mapped_identity_ = nullptr;
+        const int64_t* mapped_ids_ = nullptr;
+        const int8_t* mapped_qvalues_ = nullptr; // set when the snapshot holds the int8 copy
+        const float* mapped_qscales_ = nullptr;
+    };
+
+    // Inverted-file index with product-quantized residuals for galleries too large to scan per face. Rows are split
+    // into spherical k-means lists, and each row keeps one byte per subspace encoding its residual from the list
+    // centroid. A query scans its closest lists through a lookup table, then re-scores the best candidates exactly
+    // against the matrix, so returned scores are exact even when the ranking is approximate.
+    class GalleryIvfPqIndex {
+    public:
+        // When matrix was mapped from a snapshot holding an index with the same list and subspace counts, that
+        // index is used in place and nothing is trained.
+        GalleryIvfPqIndex(const GalleryMatrix& matrix, const GalleryIndexConfig& cfg, uint32_t seed = 0x5eed);
+
+        size_t lists() const { return lists_; }
+        bool mapped() const { return mapping_ != nullptr; }
+
+        // Search-time knob for sweeps; not safe while other threads search the same index.
+        void set_probes(int probes) { probes_ = static_cast<size_t>(probes < 1 ? 1 : probes); }
+
+        // matrix must be the one the index was built from; skip_rows as in GalleryMatrix::search.
+        void search(const GalleryMatrix& matrix,
+                    const float* queries,
+                    size_t num_queries,
+                    size_t k,
+                    std::vector<std::vector<GalleryMatch>>& out,
+                    const uint8_t* skip_rows = nullptr) const;
+
+        std::vector<GalleryMatch> search(const GalleryMatrix& matrix,
+                                         const std::vector<float>& query,
+                                         size_t k,
+                                         const uint8_t* skip_rows = nullptr) const;
+
+    private:
+        friend class GalleryMatrix;
+
+        const float* centroids_data_() const { return mapping_ ? mapped_centroids_ : centroids_.data(); }
+        const float* codebooks_data_() const { return mapping_ ? mapped_codebooks_ : codebooks_.data(); }
+        const uint32_t* list_offsets_data_() const { return mapping_ ? mapped_list_offsets_ : list_offsets_.data(); }
+        const uint32_t* list_rows_data_() const { return mapping_ ? mapped_list_rows_ : list_rows_.data(); }
+        const uint8_t* list_codes_data_() const { return mapping_ ? mapped_list_codes_ : list_codes_.data(); }
+
+        size_t dim_ = 0;
+        size_t stride_ = 0;
+        size_t subspaces_ = 0;
+        size_t dsub_ = 0;
+        size_t ksub_ = 0;
+        size_t lists_ = 0;
+        size_t rows_ = 0;
+        size_t probes_ = 0;
+        size_t rerank_ = 0;
+        // Lists are stored back to back: list l holds list_rows_[list_offsets_[l] .. list_offsets_[l + 1]), and
+        // each of those rows has subspaces bytes of codes at the same position in list_codes_.
+        std::vector<float, AlignedAllocator<float, 64>> centroids_; // lists x stride
+        std::vector<float> codebooks_;                              // subspaces x ksub x dsub
+        std::vector<uint32_t> list_offsets_;                        // lists + 1
+        std::vector<uint32_t> list_rows_;
+        std::vector<uint8_t> list_codes_;
+
+        std::shared_ptr<const void> mapping_; // the matrix's snapshot mapping when the index was adopted from it
+        const float* mapped_centroids_ = nullptr;
+        const float* mapped_codebooks_ = nullptr;
+        const uint32_t* mapped_list_offsets_ = nullptr;
+        const uint32_t* mapped_list_rows_ = nullptr;
+        const uint8_t* mapped_list_codes_ = nullptr;
+    };
+}
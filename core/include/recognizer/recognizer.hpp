@@ -1,6 +1,7 @@
 #pragma once
 
 #include <common/config.hpp>
+#include <common/ncnn_autotune.hpp>
 #include <pipeline/tasks.hpp>
 
 #include <opencv2/core.hpp>
@@ -14,6 +15,15 @@ namespace veilsight {
     public:
         virtual ~IRecognizer() = default;
         virtual RecognitionResult recognize(const RecognitionTask& task) = 0;
+
+        // One result per task, in order. Implementations that can share work across tasks (alignment buffers,
+        // one gallery scan) override this; the default recognizes each task on its own.
+        virtual std::vector<RecognitionResult> recognize_batch(const std::vector<RecognitionTask>& tasks) {
+            std::vector<RecognitionResult> results;
+            results.reserve(tasks.size());
+            for (const auto& task : tasks) results.push_back(recognize(task));
+            return results;
+        }
     };
 
     class IRecognizerFactory {
@@ -47,6 +57,8 @@ namespace veilsight {
         const RecognizerModuleConfig& recognizer_cfg,
         const cv::Mat& bgr);
 
+    NcnnModelProbe mobilefacenet_model_probe(const RecognizerModuleConfig& cfg);
+
     std::unique_ptr<IRecognizerFactory> create_recognizer_factory(const RecognizerModuleConfig& cfg);
     std::unique_ptr<IRecognizer> create_recognizer(const RecognizerModuleConfig& cfg);
 }
@@ -28,6 +28,23 @@ namespace veilsight {
         std::vector<int> unmatched_detections;
     };
 
+    // Row-major rows x cols cost matrix.
+    struct CostMatrix {
+        int rows = 0;
+        int cols = 0;
+        std::vector<float> values;
+
+        void reset(int r, int c, float fill) {
+            rows = r;
+            cols = c;
+            values.assign(static_cast<size_t>(r) * static_cast<size_t>(c), fill);
+        }
+        float& at(int r, int c) { return values[static_cast<size_t>(r) * static_cast<size_t>(cols) + static_cast<size_t>(c)]; }
+        float at(int r, int c) const {
+            return values[static_cast<size_t>(r) * static_cast<size_t>(cols) + static_cast<size_t>(c)];
+        }
+    };
+
     struct AssociationOptions {
         AssociationStage stage = AssociationStage::High;
         float iou_threshold = 0.5f;
@@ -36,10 +53,18 @@ namespace veilsight {
         std::string stream_id;
         int frame_width = 0;
         int frame_height = 0;
+        // Row-major tracks x detections reward subtracted from the pair cost; gating still uses IoU alone.
+        const CostMatrix* cost_bonus = nullptr;
     };
 
     float box_iou(const Box& a, const Box& b);
+    // Minimum-cost assignment (Jonker-Volgenant shortest augmenting paths). Returns the column of each row;
+    // when rows > cols the rows left over get -1.
+    std::vector<int> solve_assignment(const CostMatrix& cost);
     std::vector<int> hungarian_assignment(const std::vector<std::vector<float>>& cost);
+    // Only pairs with IoU >= iou_threshold are candidates. The candidate graph is split into connected
+    // components and each one is solved on its own, so sparse scenes never build a dense tracks x detections matrix;
+    // SceneGrid costs are likewise computed only for each component's rows and columns.
     AssociationResult associate_detections(const std::vector<Box>& tracks,
                                            const std::vector<Box>& detections,
                                            const AssociationOptions& options);
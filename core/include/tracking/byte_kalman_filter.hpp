@@ -0,0 +1,37 @@
+#pragma once
+
+#include <vector>
+
+#include <opencv2/core.hpp>
+
+namespace veilsight {
+    using KalmanMean = cv::Matx<float, 8, 1>;       // x, y, a, h, vx, vy, va, vh
+    using KalmanCovariance = cv::Matx<float, 8, 8>;
+
+    struct KalmanState {
+        KalmanMean mean;
+        KalmanCovariance covariance;
+    };
+
+    // Constant-velocity filter over (x, y, a, h). The motion matrix is [I I; 0 I] and the measurement
+    // matrix is [I 0], so predict and update are written blockwise on fixed-size state instead of as
+    // general matrix products.
+    class ByteKalmanFilter {
+    public:
+        void initiate(const cv::Vec4f& measurement, KalmanMean& mean, KalmanCovariance& covariance) const;
+
+        // Predicts every state in one pass: state is gathered into structure-of-arrays rows (one row per
+        // mean or covariance entry, one lane per state) so each blockwise step is a straight loop over lanes.
+        void predict(const std::vector<KalmanState*>& states);
+
+        void update(KalmanMean& mean, KalmanCovariance& covariance, const cv::Vec4f& measurement) const;
+
+        static constexpr float kStdWeightPosition = 1.0f / 20.0f;
+        static constexpr float kStdWeightVelocity = 1.0f / 160.0f;
+
+    private:
+        static constexpr int kRows = 8 + 64;
+
+        std::vector<float> soa_; // predict scratch, kept to reuse its capacity
+    };
+}
@@ -14,9 +14,25 @@ namespace veilsight {
         float extra_cost = 0.0f;
     };
 
+    // Row-major tracks x detections costs. Inactive (grid disabled or warming up) means every cost is zero.
+    struct SceneGridCostBlock {
+        int rows = 0;
+        int cols = 0;
+        bool active = false;
+        std::vector<float> raw_cost;
+        std::vector<float> extra_cost;
+
+        SceneGridAssociationCost at(int track, int detection) const {
+            if (!active) return {};
+            const size_t k = static_cast<size_t>(track) * static_cast<size_t>(cols) + static_cast<size_t>(detection);
+            return SceneGridAssociationCost{raw_cost[k], extra_cost[k]};
+        }
+    };
+
     class SceneGrid {
     public:
         explicit SceneGrid(SceneGridConfig cfg = {});
+        ~SceneGrid();
 
         const SceneGridConfig& config() const { return cfg_; }
 
@@ -34,17 +50,40 @@ namespace veilsight {
                                                   int height,
                                                   const Box& track,
                                                   const Box& detection) const;
+        // Same costs as association_cost for every pair, vectorized per track row. `out` keeps its buffers.
+        void association_costs(const std::string& stream_id,
+                               int width,
+                               int height,
+                               const std::vector<Box>& tracks,
+                               const std::vector<Box>& detections,
+                               SceneGridCostBlock& out) const;
+
+        // Writes every stream to persist_dir; a no-op when persistence is off.
+        void save() const;
 
     private:
+        // Decay is lazy: stored values are the true values divided by a per-stream scale, so a frame of decay
+        // is one multiply on the scale and ratios (all the costs use) never need it. The scale is folded back
+        // into the values only when it underflows.
         struct StreamState {
             int frames_seen = 0;
+            float occupancy_scale = 1.0f;
+            float transition_scale = 1.0f;
+            float occupancy_max = 0.0f;
             std::vector<float> occupancy;
             std::vector<float> transitions;
+            std::vector<float> transition_row_sums;
         };
 
         int cell_index_(int row, int col) const;
         StreamState& state_(const std::string& stream_id);
         const StreamState* find_state_(const std::string& stream_id) const;
+        bool active_(const StreamState* st, int width, int height) const;
+        void fold_occupancy_(StreamState& st) const;
+        void fold_transitions_(StreamState& st) const;
+        std::string persist_path_(const std::string& stream_id) const;
+        bool load_(const std::string& stream_id, StreamState& st) const;
+        void save_(const std::string& stream_id, const StreamState& st) const;
 
         SceneGridConfig cfg_;
         std::unordered_map<std::string, StreamState> streams_;
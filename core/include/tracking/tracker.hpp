@@ -29,6 +29,9 @@ namespace veilsight {
     class ITracker {
     public:
         virtual ~ITracker() = default;
+        // Returns this frame's confirmed tracks. The order is tracker-specific: ByteTrack keeps activation order
+        // (tracks that stayed tracked keep their place, new then re-found tracks are appended) and OC-SORT keeps
+        // creation order. Match tracks across frames by Box::id.
         virtual std::vector<Box> update(const TrackerFrameInfo& frame,
                                         const std::vector<Box>& detections) = 0;
     };
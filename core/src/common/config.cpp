@@ -1,4 +1,5 @@
 #include <common/config.hpp>
+#include <cmath>
 #include <stdexcept>
 #include <yaml-cpp/yaml.h>
 
@@ -99,6 +100,42 @@ namespace veilsight {
         return c;
     }
 
+    static DetectionRegionsConfig parse_detection_regions_config(const YAML::Node& n, const std::string& stream_id) {
+        DetectionRegionsConfig cfg;
+        if (!n) return cfg;
+
+        const YAML::Node polygons = n["polygons"];
+        if (polygons) {
+            if (!polygons.IsSequence()) {
+                throw std::runtime_error("[Config] stream " + stream_id + " detection_regions.polygons must be a list");
+            }
+            for (const auto& polygon : polygons) {
+                if (!polygon.IsSequence() || polygon.size() < 3) {
+                    throw std::runtime_error("[Config] stream " + stream_id +
+                                             " detection_regions polygon needs at least 3 [x, y] points");
+                }
+                std::vector<NormalizedPoint> points;
+                points.reserve(polygon.size());
+                for (const auto& point : polygon) {
+                    const auto xy = point.as<std::vector<float>>();
+                    if (xy.size() != 2) {
+                        throw std::runtime_error("[Config] stream " + stream_id +
+                                                 " detection_regions points must be [x, y] pairs");
+                    }
+                    points.push_back(NormalizedPoint{xy[0], xy[1]});
+                }
+                cfg.polygons.push_back(std::move(points));
+            }
+        }
+        cfg.tiling = get_str(n, "tiling", cfg.tiling);
+        cfg.tile_w = get_int(n, "tile_w", cfg.tile_w);
+        cfg.tile_h = get_int(n, "tile_h", cfg.tile_h);
+        cfg.tile_overlap = get_float(n, "tile_overlap", cfg.tile_overlap);
+        cfg.full_region_pass = get_bool(n, "full_region_pass", cfg.full_region_pass);
+        cfg.merge_iou_threshold = get_float(n, "merge_iou_threshold", cfg.merge_iou_threshold);
+        return cfg;
+    }
+
     static OutputConfig parse_output_config(const YAML::Node& o, const OutputConfig& def = {}) {
         OutputConfig c = def;
         if (!o) return c;
@@ -143,11 +180,16 @@ namespace veilsight {
 
         cfg.param_path = get_str(n, "param_path", cfg.param_path);
         cfg.bin_path = get_str(n, "bin_path", cfg.bin_path);
+        cfg.precision = get_str(n, "precision", cfg.precision);
+        cfg.int8_param_path = get_str(n, "int8_param_path", cfg.int8_param_path);
+        cfg.int8_bin_path = get_str(n, "int8_bin_path", cfg.int8_bin_path);
         cfg.input_w = get_int(n, "input_w", cfg.input_w);
         cfg.input_h = get_int(n, "input_h", cfg.input_h);
         cfg.score_threshold = n["score_threshold"] ? n["score_threshold"].as<float>() : cfg.score_threshold;
         cfg.nms_threshold = n["nms_threshold"] ? n["nms_threshold"].as<float>() : cfg.nms_threshold;
         cfg.top_k = get_int(n, "top_k", cfg.top_k);
+        cfg.nms_mode = get_str(n, "nms_mode", cfg.nms_mode);
+        cfg.soft_nms_sigma = get_float(n, "soft_nms_sigma", cfg.soft_nms_sigma);
         cfg.ncnn_threads = get_int(n, "ncnn_threads", cfg.ncnn_threads);
         return cfg;
     }
@@ -190,11 +232,16 @@ namespace veilsight {
         apply_scrfd_variant_profile(cfg);
         cfg.param_path = get_str(n, "param_path", cfg.param_path);
         cfg.bin_path = get_str(n, "bin_path", cfg.bin_path);
+        cfg.precision = get_str(n, "precision", cfg.precision);
+        cfg.int8_param_path = get_str(n, "int8_param_path", cfg.int8_param_path);
+        cfg.int8_bin_path = get_str(n, "int8_bin_path", cfg.int8_bin_path);
         cfg.input_w = get_int(n, "input_w", cfg.input_w);
         cfg.input_h = get_int(n, "input_h", cfg.input_h);
         cfg.score_threshold = n["score_threshold"] ? n["score_threshold"].as<float>() : cfg.score_threshold;
         cfg.nms_threshold = n["nms_threshold"] ? n["nms_threshold"].as<float>() : cfg.nms_threshold;
         cfg.top_k = get_int(n, "top_k", cfg.top_k);
+        cfg.nms_mode = get_str(n, "nms_mode", cfg.nms_mode);
+        cfg.soft_nms_sigma = get_float(n, "soft_nms_sigma", cfg.soft_nms_sigma);
         cfg.ncnn_threads = get_int(n, "ncnn_threads", cfg.ncnn_threads);
         return cfg;
     }
@@ -221,11 +268,16 @@ namespace veilsight {
             cfg.param_path = prefix.ends_with(".ncnn.param") ? prefix : prefix + ".ncnn.param";
             cfg.bin_path = prefix.ends_with(".ncnn.bin") ? prefix : prefix + ".ncnn.bin";
         }
+        cfg.precision = get_str(n, "precision", cfg.precision);
+        cfg.int8_param_path = get_str(n, "int8_param_path", cfg.int8_param_path);
+        cfg.int8_bin_path = get_str(n, "int8_bin_path", cfg.int8_bin_path);
         cfg.input_w = get_int(n, "input_w", cfg.input_w);
         cfg.input_h = get_int(n, "input_h", cfg.input_h);
         cfg.score_threshold = get_float(n, "score_threshold", cfg.score_threshold);
         cfg.nms_threshold = get_float(n, "nms_threshold", cfg.nms_threshold);
         cfg.top_k = get_int(n, "top_k", cfg.top_k);
+        cfg.nms_mode = get_str(n, "nms_mode", cfg.nms_mode);
+        cfg.soft_nms_sigma = get_float(n, "soft_nms_sigma", cfg.soft_nms_sigma);
         cfg.class_id = get_int(n, "class_id", get_int(n, "person_class_id", cfg.class_id));
         cfg.ncnn_threads = get_int(n, "ncnn_threads", cfg.ncnn_threads);
         cfg.letterbox = get_bool(n, "letterbox", cfg.letterbox);
@@ -251,6 +303,8 @@ namespace veilsight {
         cfg.score_threshold = get_float(n, "score_threshold", cfg.score_threshold);
         cfg.nms_threshold = get_float(n, "nms_threshold", cfg.nms_threshold);
         cfg.top_k = get_int(n, "top_k", cfg.top_k);
+        cfg.nms_mode = get_str(n, "nms_mode", cfg.nms_mode);
+        cfg.soft_nms_sigma = get_float(n, "soft_nms_sigma", cfg.soft_nms_sigma);
         cfg.ncnn_threads = get_int(n, "ncnn_threads", cfg.ncnn_threads);
         return cfg;
     }
@@ -270,6 +324,47 @@ namespace veilsight {
         cfg.occupancy_decay = get_float(n, "occupancy_decay", cfg.occupancy_decay);
         cfg.transition_decay = get_float(n, "transition_decay", cfg.transition_decay);
         cfg.warmup_frames = get_int(n, "warmup_frames", cfg.warmup_frames);
+        cfg.persist_dir = get_str(n, "persist_dir", cfg.persist_dir);
+        cfg.persist_interval_frames = get_int(n, "persist_interval_frames", cfg.persist_interval_frames);
+        return cfg;
+    }
+
+    static CascadeModuleConfig parse_cascade_module_config(const YAML::Node& n) {
+        CascadeModuleConfig cfg;
+        if (!n) return cfg;
+
+        cfg.refresh_interval = get_int(n, "refresh_interval", cfg.refresh_interval);
+        cfg.crop_margin = get_float(n, "crop_margin", cfg.crop_margin);
+        cfg.max_crop_area_ratio = get_float(n, "max_crop_area_ratio", cfg.max_crop_area_ratio);
+        return cfg;
+    }
+
+    static MotionGateConfig parse_motion_gate_config(const YAML::Node& n) {
+        MotionGateConfig cfg;
+        if (!n) return cfg;
+
+        cfg.enabled = get_bool(n, "enabled", cfg.enabled);
+        cfg.downscale_width = get_int(n, "downscale_width", cfg.downscale_width);
+        cfg.grid_rows = get_int(n, "grid_rows", cfg.grid_rows);
+        cfg.grid_cols = get_int(n, "grid_cols", cfg.grid_cols);
+        cfg.pixel_threshold = get_int(n, "pixel_threshold", cfg.pixel_threshold);
+        cfg.cell_change_ratio = get_float(n, "cell_change_ratio", cfg.cell_change_ratio);
+        cfg.min_active_cells = get_int(n, "min_active_cells", cfg.min_active_cells);
+        cfg.keyframe_interval = get_int(n, "keyframe_interval", cfg.keyframe_interval);
+        return cfg;
+    }
+
+    static AdaptiveResolutionConfig parse_adaptive_resolution_config(const YAML::Node& n,
+                                                                     const AdaptiveResolutionConfig& def = {}) {
+        AdaptiveResolutionConfig cfg = def;
+        if (!n) return cfg;
+
+        cfg.enabled = get_bool(n, "enabled", cfg.enabled);
+        if (n["levels"]) cfg.levels = n["levels"].as<std::vector<int>>();
+        cfg.high_pressure = get_float(n, "high_pressure", cfg.high_pressure);
+        cfg.low_pressure = get_float(n, "low_pressure", cfg.low_pressure);
+        cfg.min_track_height_px = get_float(n, "min_track_height_px", cfg.min_track_height_px);
+        cfg.cooldown_frames = get_int(n, "cooldown_frames", cfg.cooldown_frames);
         return cfg;
     }
 
@@ -279,11 +374,14 @@ namespace veilsight {
 
         cfg.type = get_str(n, "type", cfg.type);
         cfg.workers = get_positive_int_alias(n, "model_instances", "workers", cfg.workers);
+        cfg.motion_gate = parse_motion_gate_config(n["motion_gate"]);
+        cfg.adaptive_resolution = parse_adaptive_resolution_config(n["adaptive_resolution"]);
 
         cfg.yunet = parse_yunet_module_config(n["yunet"]);
         cfg.scrfd = parse_scrfd_module_config(n["scrfd"], cfg.scrfd);
         cfg.yolox = parse_yolox_module_config(n["yolox"]);
         cfg.uhd = parse_uhd_module_config(n["uhd"]);
+        cfg.cascade = parse_cascade_module_config(n["cascade"]);
         return cfg;
     }
 
@@ -333,6 +431,31 @@ namespace veilsight {
         return cfg;
     }
 
+    static FaceProbeConfig parse_face_probe_config(const YAML::Node& n) {
+        FaceProbeConfig cfg;
+        if (!n) return cfg;
+
+        cfg.mode = get_str(n, "mode", cfg.mode);
+        cfg.crop_input = get_int(n, "crop_input", cfg.crop_input);
+        cfg.head_fraction = get_float(n, "head_fraction", cfg.head_fraction);
+        cfg.crop_padding = get_float(n, "crop_padding", cfg.crop_padding);
+        cfg.min_track_height_px = get_float(n, "min_track_height_px", cfg.min_track_height_px);
+        cfg.full_frame_interval = get_int(n, "full_frame_interval", cfg.full_frame_interval);
+        cfg.reuse_interval = get_int(n, "reuse_interval", cfg.reuse_interval);
+        cfg.reuse_max_shape_change = get_float(n, "reuse_max_shape_change", cfg.reuse_max_shape_change);
+        return cfg;
+    }
+
+    static FaceMosaicConfig parse_face_mosaic_config(const YAML::Node& n) {
+        FaceMosaicConfig cfg;
+        if (!n) return cfg;
+
+        cfg.enabled = get_bool(n, "enabled", cfg.enabled);
+        cfg.max_tasks = get_int(n, "max_tasks", cfg.max_tasks);
+        cfg.gap_px = get_int(n, "gap_px", cfg.gap_px);
+        return cfg;
+    }
+
     static FaceDetectorModuleConfig parse_face_detector_module_config(const YAML::Node& n,
                                                                       const FaceDetectorModuleConfig& def = {}) {
         FaceDetectorModuleConfig cfg = def;
@@ -340,12 +463,50 @@ namespace veilsight {
 
         cfg.type = get_str(n, "type", cfg.type);
         cfg.association_mode = get_str(n, "association_mode", cfg.association_mode);
+        cfg.assignment = get_str(n, "assignment", cfg.assignment);
         cfg.workers = get_positive_int_alias(n, "model_instances", "workers", cfg.workers);
+        cfg.probes = parse_face_probe_config(n["probes"]);
+        cfg.mosaic = parse_face_mosaic_config(n["mosaic"]);
+        cfg.adaptive_resolution = parse_adaptive_resolution_config(n["adaptive_resolution"], cfg.adaptive_resolution);
         cfg.yunet = parse_yunet_module_config(n["yunet"]);
         cfg.scrfd = parse_scrfd_module_config(n["scrfd"], cfg.scrfd);
         return cfg;
     }
 
+    static GalleryIndexConfig parse_gallery_index_config(const YAML::Node& n) {
+        GalleryIndexConfig cfg;
+        if (!n) return cfg;
+
+        cfg.type = get_str(n, "type", cfg.type);
+        cfg.min_rows = get_int(n, "min_rows", cfg.min_rows);
+        cfg.lists = get_int(n, "lists", cfg.lists);
+        cfg.probes = get_int(n, "probes", cfg.probes);
+        cfg.pq_subspaces = get_int(n, "pq_subspaces", cfg.pq_subspaces);
+        cfg.rerank = get_int(n, "rerank", cfg.rerank);
+        return cfg;
+    }
+
+    static RecognizerBatchConfig parse_recognizer_batch_config(const YAML::Node& n) {
+        RecognizerBatchConfig cfg;
+        if (!n) return cfg;
+
+        cfg.enabled = get_bool(n, "enabled", cfg.enabled);
+        cfg.max_tasks = get_int(n, "max_tasks", cfg.max_tasks);
+        cfg.max_faces = get_int(n, "max_faces", cfg.max_faces);
+        return cfg;
+    }
+
+    static RecognizerBestShotConfig parse_recognizer_best_shot_config(const YAML::Node& n) {
+        RecognizerBestShotConfig cfg;
+        if (!n) return cfg;
+
+        cfg.enabled = get_bool(n, "enabled", cfg.enabled);
+        cfg.window_frames = get_int(n, "window_frames", cfg.window_frames);
+        cfg.candidates = get_int(n, "candidates", cfg.candidates);
+        cfg.max_embeddings = get_int(n, "max_embeddings", cfg.max_embeddings);
+        return cfg;
+    }
+
     static RecognizerModuleConfig parse_recognizer_module_config(const YAML::Node& n) {
         RecognizerModuleConfig cfg;
         if (!n) return cfg;
@@ -353,11 +514,19 @@ namespace veilsight {
         cfg.type = get_str(n, "type", cfg.type);
         cfg.workers = get_positive_int_alias(n, "model_instances", "workers", cfg.workers);
         cfg.gallery_path = get_str(n, "gallery_path", cfg.gallery_path);
+        cfg.gallery_precision = get_str(n, "gallery_precision", cfg.gallery_precision);
+        cfg.gallery_index = parse_gallery_index_config(n["gallery_index"]);
+        cfg.gallery_snapshot = get_bool(n, "gallery_snapshot", cfg.gallery_snapshot);
+        cfg.batch = parse_recognizer_batch_config(n["batch"]);
+        cfg.best_shot = parse_recognizer_best_shot_config(n["best_shot"]);
         cfg.unknown_threshold = n["unknown_threshold"]
                                     ? n["unknown_threshold"].as<float>()
                                     : (cfg.type == "mobilefacenet" ? 0.45f : cfg.unknown_threshold);
         cfg.param_path = get_str(n, "param_path", cfg.param_path);
         cfg.bin_path = get_str(n, "bin_path", cfg.bin_path);
+        cfg.precision = get_str(n, "precision", cfg.precision);
+        cfg.int8_param_path = get_str(n, "int8_param_path", cfg.int8_param_path);
+        cfg.int8_bin_path = get_str(n, "int8_bin_path", cfg.int8_bin_path);
         cfg.input_blob = get_str(n, "input_blob", cfg.input_blob);
         cfg.output_blob = get_str(n, "output_blob", cfg.output_blob);
         cfg.input_w = get_int(n, "input_w", cfg.input_w);
@@ -384,6 +553,17 @@ namespace veilsight {
         return cfg;
     }
 
+    static NcnnAutotuneConfig parse_ncnn_autotune_config(const YAML::Node& n) {
+        NcnnAutotuneConfig cfg;
+        if (!n) return cfg;
+
+        cfg.mode = get_str(n, "mode", cfg.mode);
+        cfg.cache_path = get_str(n, "cache_path", cfg.cache_path);
+        cfg.iterations = get_int(n, "iterations", cfg.iterations);
+        cfg.tolerance = get_float(n, "tolerance", cfg.tolerance);
+        return cfg;
+    }
+
     static ModulesConfig parse_modules_config(const YAML::Node& n) {
         ModulesConfig cfg;
         if (!n) return cfg;
@@ -405,6 +585,15 @@ namespace veilsight {
         }
         cfg.recognizer = parse_recognizer_module_config(n["recognizer"]);
         cfg.identity = parse_identity_module_config(n["identity"]);
+
+        cfg.ncnn_autotune = parse_ncnn_autotune_config(n["ncnn_autotune"]);
+        cfg.person_detector.yunet.ncnn_autotune = cfg.ncnn_autotune;
+        cfg.person_detector.scrfd.ncnn_autotune = cfg.ncnn_autotune;
+        cfg.person_detector.yolox.ncnn_autotune = cfg.ncnn_autotune;
+        cfg.person_detector.uhd.ncnn_autotune = cfg.ncnn_autotune;
+        cfg.face_detector.yunet.ncnn_autotune = cfg.ncnn_autotune;
+        cfg.face_detector.scrfd.ncnn_autotune = cfg.ncnn_autotune;
+        cfg.recognizer.ncnn_autotune = cfg.ncnn_autotune;
         return cfg;
     }
 
@@ -559,6 +748,7 @@ namespace veilsight {
             }
             ic.output = parse_output_config(s["output"], OutputConfig{});
             ic.outputs = parse_outputs_config(s["outputs"]);
+            ic.detection_regions = parse_detection_regions_config(s["detection_regions"], ic.id);
             if (ic.outputs.profiles.size() > 0 && ic.outputs.fps <= 0) {
                 throw std::runtime_error("[Config] outputs.fps must be > 0 when outputs.profiles is configured");
             }
@@ -584,6 +774,16 @@ namespace veilsight {
         return cfg;
     }
 
+    std::string int8_model_path(const std::string& fp32_path) {
+        for (const char* suffix : {".ncnn.param", ".ncnn.bin", ".param", ".bin"}) {
+            const std::string ext(suffix);
+            if (fp32_path.size() > ext.size() && fp32_path.ends_with(ext)) {
+                return fp32_path.substr(0, fp32_path.size() - ext.size()) + "_int8" + ext;
+            }
+        }
+        return fp32_path + "_int8";
+    }
+
     AppConfig load_config_yaml(const std::string& path) {
         return parse_config_yaml_node(YAML::LoadFile(path));
     }
@@ -673,6 +873,12 @@ namespace veilsight {
         require_int_min(runtime.anonymizer.blur_kernel, 3, "runtime.anonymizer.blur_kernel");
 
         const auto& modules = config.modules;
+        if (modules.ncnn_autotune.mode != "off" && modules.ncnn_autotune.mode != "cached" &&
+            modules.ncnn_autotune.mode != "auto") {
+            throw std::runtime_error("[Config] modules.ncnn_autotune.mode must be 'off', 'cached' or 'auto'");
+        }
+        require_int_min(modules.ncnn_autotune.iterations, 1, "modules.ncnn_autotune.iterations");
+        require_float_min(modules.ncnn_autotune.tolerance, 0.0f, "modules.ncnn_autotune.tolerance");
         require_int_min(modules.person_detector.workers, 1, "modules.person_detector.model_instances");
         require_int_min(modules.person_detector.yunet.ncnn_threads, 1, "modules.person_detector.yunet.ncnn_threads");
         require_int_min(modules.person_detector.scrfd.ncnn_threads, 1, "modules.person_detector.scrfd.ncnn_threads");
@@ -680,17 +886,144 @@ namespace veilsight {
         require_int_min(modules.person_detector.uhd.input_w, 1, "modules.person_detector.uhd.input_w");
         require_int_min(modules.person_detector.uhd.input_h, 1, "modules.person_detector.uhd.input_h");
         require_int_min(modules.person_detector.uhd.ncnn_threads, 1, "modules.person_detector.uhd.ncnn_threads");
+        const auto require_nms_mode = [](const std::string& mode, float sigma, const std::string& prefix) {
+            if (mode != "hard" && mode != "soft") {
+                throw std::runtime_error("[Config] " + prefix + ".nms_mode must be 'hard' or 'soft'");
+            }
+            if (!(sigma > 0.0f)) {
+                throw std::runtime_error("[Config] " + prefix + ".soft_nms_sigma must be > 0");
+            }
+        };
+        const auto require_precision = [](const std::string& precision, const std::string& prefix) {
+            if (precision != "fp32" && precision != "int8") {
+                throw std::runtime_error("[Config] " + prefix + ".precision must be 'fp32' or 'int8'");
+            }
+        };
+        require_precision(modules.person_detector.yunet.precision, "modules.person_detector.yunet");
+        require_precision(modules.person_detector.scrfd.precision, "modules.person_detector.scrfd");
+        require_precision(modules.person_detector.yolox.precision, "modules.person_detector.yolox");
+        require_precision(modules.face_detector.yunet.precision, "modules.face_detector.yunet");
+        require_precision(modules.face_detector.scrfd.precision, "modules.face_detector.scrfd");
+        require_precision(modules.recognizer.precision, "modules.recognizer");
+        if (modules.recognizer.gallery_precision != "fp32" && modules.recognizer.gallery_precision != "int8") {
+            throw std::runtime_error("[Config] modules.recognizer.gallery_precision must be 'fp32' or 'int8'");
+        }
+        const auto& gallery_index = modules.recognizer.gallery_index;
+        if (gallery_index.type != "flat" && gallery_index.type != "ivfpq") {
+            throw std::runtime_error("[Config] modules.recognizer.gallery_index.type must be 'flat' or 'ivfpq'");
+        }
+        require_int_min(gallery_index.min_rows, 0, "modules.recognizer.gallery_index.min_rows");
+        require_int_min(gallery_index.lists, 0, "modules.recognizer.gallery_index.lists");
+        require_int_min(gallery_index.probes, 1, "modules.recognizer.gallery_index.probes");
+        require_int_min(gallery_index.pq_subspaces, 1, "modules.recognizer.gallery_index.pq_subspaces");
+        require_int_min(gallery_index.rerank, 1, "modules.recognizer.gallery_index.rerank");
+        if (gallery_index.type == "ivfpq" && modules.recognizer.embedding_dim % gallery_index.pq_subspaces != 0) {
+            throw std::runtime_error("[Config] modules.recognizer.gallery_index.pq_subspaces must divide embedding_dim");
+        }
+        require_nms_mode(modules.person_detector.yolox.nms_mode,
+                         modules.person_detector.yolox.soft_nms_sigma,
+                         "modules.person_detector.yolox");
+        require_nms_mode(modules.person_detector.uhd.nms_mode,
+                         modules.person_detector.uhd.soft_nms_sigma,
+                         "modules.person_detector.uhd");
+        require_nms_mode(modules.person_detector.yunet.nms_mode,
+                         modules.person_detector.yunet.soft_nms_sigma,
+                         "modules.person_detector.yunet");
+        require_nms_mode(modules.person_detector.scrfd.nms_mode,
+                         modules.person_detector.scrfd.soft_nms_sigma,
+                         "modules.person_detector.scrfd");
+        require_nms_mode(modules.face_detector.yunet.nms_mode,
+                         modules.face_detector.yunet.soft_nms_sigma,
+                         "modules.face_detector.yunet");
+        require_nms_mode(modules.face_detector.scrfd.nms_mode,
+                         modules.face_detector.scrfd.soft_nms_sigma,
+                         "modules.face_detector.scrfd");
+        if (modules.person_detector.type == "cascade") {
+            const auto& cascade = modules.person_detector.cascade;
+            require_int_min(cascade.refresh_interval, 1, "modules.person_detector.cascade.refresh_interval");
+            require_float_min(cascade.crop_margin, 0.0f, "modules.person_detector.cascade.crop_margin");
+            if (cascade.max_crop_area_ratio < 0.0f || cascade.max_crop_area_ratio > 1.0f) {
+                throw std::runtime_error(
+                    "[Config] modules.person_detector.cascade.max_crop_area_ratio must be between 0 and 1");
+            }
+        }
+        const auto& motion_gate = modules.person_detector.motion_gate;
+        if (motion_gate.enabled) {
+            require_int_min(motion_gate.downscale_width, 16, "modules.person_detector.motion_gate.downscale_width");
+            require_int_min(motion_gate.grid_rows, 1, "modules.person_detector.motion_gate.grid_rows");
+            require_int_min(motion_gate.grid_cols, 1, "modules.person_detector.motion_gate.grid_cols");
+            if (motion_gate.pixel_threshold < 1 || motion_gate.pixel_threshold > 255) {
+                throw std::runtime_error(
+                    "[Config] modules.person_detector.motion_gate.pixel_threshold must be between 1 and 255");
+            }
+            if (motion_gate.cell_change_ratio < 0.0f || motion_gate.cell_change_ratio > 1.0f) {
+                throw std::runtime_error(
+                    "[Config] modules.person_detector.motion_gate.cell_change_ratio must be between 0 and 1");
+            }
+            require_int_min(motion_gate.min_active_cells, 1, "modules.person_detector.motion_gate.min_active_cells");
+            require_int_min(motion_gate.keyframe_interval, 1, "modules.person_detector.motion_gate.keyframe_interval");
+        }
+        const auto require_adaptive_resolution = [&](const AdaptiveResolutionConfig& adaptive,
+                                                     const std::string& prefix) {
+            if (!adaptive.enabled) return;
+            if (adaptive.levels.empty()) {
+                throw std::runtime_error("[Config] " + prefix + ".levels must not be empty");
+            }
+            for (const int level : adaptive.levels) {
+                require_int_min(level, 32, (prefix + ".levels").c_str());
+            }
+            if (adaptive.low_pressure < 0.0f || adaptive.high_pressure > 1.0f ||
+                adaptive.low_pressure >= adaptive.high_pressure) {
+                throw std::runtime_error("[Config] " + prefix +
+                                         ".low_pressure/high_pressure must satisfy 0 <= low < high <= 1");
+            }
+            require_float_min(adaptive.min_track_height_px, 0.0f, (prefix + ".min_track_height_px").c_str());
+            require_int_min(adaptive.cooldown_frames, 0, (prefix + ".cooldown_frames").c_str());
+        };
+        require_adaptive_resolution(modules.person_detector.adaptive_resolution,
+                                    "modules.person_detector.adaptive_resolution");
+        require_adaptive_resolution(modules.face_detector.adaptive_resolution,
+                                    "modules.face_detector.adaptive_resolution");
         if (modules.face_detector.type != "none") {
             if (modules.face_detector.association_mode != "person_bbox" &&
                 modules.face_detector.association_mode != "independent") {
                 throw std::runtime_error(
                     "[Config] modules.face_detector.association_mode must be person_bbox or independent");
             }
+            if (modules.face_detector.assignment != "greedy" && modules.face_detector.assignment != "hungarian") {
+                throw std::runtime_error("[Config] modules.face_detector.assignment must be greedy or hungarian");
+            }
             require_int_min(modules.face_detector.workers, 1, "modules.face_detector.model_instances");
             require_int_min(modules.face_detector.yunet.ncnn_threads, 1,
                             "modules.face_detector.yunet.ncnn_threads");
             require_int_min(modules.face_detector.scrfd.ncnn_threads, 1,
                             "modules.face_detector.scrfd.ncnn_threads");
+            const auto& probes = modules.face_detector.probes;
+            if (probes.mode != "full_frame" && probes.mode != "head_crop") {
+                throw std::runtime_error("[Config] modules.face_detector.probes.mode must be full_frame or head_crop");
+            }
+            require_int_min(probes.crop_input, 32, "modules.face_detector.probes.crop_input");
+            if (probes.head_fraction <= 0.0f || probes.head_fraction > 1.0f) {
+                throw std::runtime_error("[Config] modules.face_detector.probes.head_fraction must be in (0, 1]");
+            }
+            require_float_min(probes.crop_padding, 0.0f, "modules.face_detector.probes.crop_padding");
+            require_float_min(probes.min_track_height_px, 0.0f, "modules.face_detector.probes.min_track_height_px");
+            require_int_min(probes.full_frame_interval, 1, "modules.face_detector.probes.full_frame_interval");
+            require_int_min(probes.reuse_interval, 0, "modules.face_detector.probes.reuse_interval");
+            require_float_min(probes.reuse_max_shape_change, 0.0f,
+                              "modules.face_detector.probes.reuse_max_shape_change");
+            const auto& mosaic = modules.face_detector.mosaic;
+            require_int_min(mosaic.max_tasks, 1, "modules.face_detector.mosaic.max_tasks");
+            require_int_min(mosaic.gap_px, 0, "modules.face_detector.mosaic.gap_px");
+            if (mosaic.enabled) {
+                const bool yunet = modules.face_detector.type == "yunet";
+                const int input_w = yunet ? modules.face_detector.yunet.input_w : modules.face_detector.scrfd.input_w;
+                const int input_h = yunet ? modules.face_detector.yunet.input_h : modules.face_detector.scrfd.input_h;
+                if (probes.crop_input > input_w || probes.crop_input > input_h) {
+                    throw std::runtime_error(
+                        "[Config] modules.face_detector.mosaic needs probes.crop_input to fit the detector input size");
+                }
+            }
         }
         require_int_min(modules.recognizer.workers, 1, "modules.recognizer.model_instances");
         require_int_min(modules.recognizer.input_w, 1, "modules.recognizer.input_w");
@@ -698,6 +1031,12 @@ namespace veilsight {
         require_int_min(modules.recognizer.embedding_dim, 1, "modules.recognizer.embedding_dim");
         require_int_min(modules.recognizer.ncnn_threads, 1, "modules.recognizer.ncnn_threads");
         require_int_min(modules.recognizer.cache_ttl_frames, 1, "modules.recognizer.cache_ttl_frames");
+        require_int_min(modules.recognizer.batch.max_tasks, 1, "modules.recognizer.batch.max_tasks");
+        require_int_min(modules.recognizer.batch.max_faces, 1, "modules.recognizer.batch.max_faces");
+        const auto& best_shot = modules.recognizer.best_shot;
+        require_int_min(best_shot.window_frames, 1, "modules.recognizer.best_shot.window_frames");
+        require_int_min(best_shot.candidates, 1, "modules.recognizer.best_shot.candidates");
+        require_int_min(best_shot.max_embeddings, best_shot.candidates, "modules.recognizer.best_shot.max_embeddings");
         require_float_min(modules.recognizer.min_face_score, 0.0f, "modules.recognizer.min_face_score");
         require_float_min(modules.recognizer.min_face_size_px, 0.0f, "modules.recognizer.min_face_size_px");
         require_float_min(modules.recognizer.min_inter_eye_px, 0.0f, "modules.recognizer.min_inter_eye_px");
@@ -713,5 +1052,37 @@ namespace veilsight {
             }
         }
         require_int_min(modules.identity.workers, 1, "modules.identity.model_instances");
+
+        for (const auto& stream : config.streams) {
+            const auto& regions = stream.detection_regions;
+            const std::string prefix = "[Config] stream " + stream.id + " detection_regions.";
+            for (const auto& polygon : regions.polygons) {
+                double twice_area = 0.0;
+                for (size_t i = 0; i < polygon.size(); ++i) {
+                    const auto& point = polygon[i];
+                    if (point.x < 0.0f || point.x > 1.0f || point.y < 0.0f || point.y > 1.0f) {
+                        throw std::runtime_error(prefix + "polygons must use normalized coordinates in [0, 1]");
+                    }
+                    const auto& next = polygon[(i + 1) % polygon.size()];
+                    twice_area += static_cast<double>(point.x) * next.y - static_cast<double>(next.x) * point.y;
+                }
+                // A zero-area polygon (repeated or collinear points) would crop nothing and drop every detection.
+                if (std::fabs(twice_area) < 2e-6) {
+                    throw std::runtime_error(prefix + "polygons must enclose a non-zero area");
+                }
+            }
+            if (regions.tiling != "off" && regions.tiling != "auto") {
+                throw std::runtime_error(prefix + "tiling must be 'off' or 'auto'");
+            }
+            if (regions.tile_w < 0 || regions.tile_h < 0) {
+                throw std::runtime_error(prefix + "tile_w/tile_h must be >= 0");
+            }
+            if (regions.tile_overlap < 0.0f || regions.tile_overlap >= 0.9f) {
+                throw std::runtime_error(prefix + "tile_overlap must be in [0, 0.9)");
+            }
+            if (regions.merge_iou_threshold <= 0.0f || regions.merge_iou_threshold > 1.0f) {
+                throw std::runtime_error(prefix + "merge_iou_threshold must be in (0, 1]");
+            }
+        }
     }
 }
@@ -0,0 +1,331 @@
+#include <common/ncnn_autotune.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <utility>
+
+#include <ncnn/net.h>
+
+namespace veilsight {
+    namespace {
+        NcnnTuning make_tuning(bool fp16_packed,
+                               bool fp16_storage,
+                               bool fp16_arithmetic,
+                               bool packing,
+                               bool winograd,
+                               bool sgemm,
+                               bool light) {
+            NcnnTuning t;
+            t.use_fp16_packed = fp16_packed;
+            t.use_fp16_storage = fp16_storage;
+            t.use_fp16_arithmetic = fp16_arithmetic;
+            t.use_packing_layout = packing;
+            t.use_winograd_convolution = winograd;
+            t.use_sgemm_convolution = sgemm;
+            t.light_mode = light;
+            return t;
+        }
+
+        uint64_t fnv1a_file(const std::string& path, uint64_t hash) {
+            std::ifstream in(path, std::ios::binary);
+            if (!in.is_open()) {
+                throw std::runtime_error("[NcnnAutotune] Failed to open model file: " + path);
+            }
+            char buffer[1 << 16];
+            while (in) {
+                in.read(buffer, sizeof(buffer));
+                const std::streamsize n = in.gcount();
+                for (std::streamsize i = 0; i < n; ++i) {
+                    hash ^= static_cast<unsigned char>(buffer[i]);
+                    hash *= 1099511628211ull;
+                }
+            }
+            return hash;
+        }
+
+        std::string sanitize_key_part(std::string s) {
+            for (char& c : s) {
+                if (c == ' ' || c == '\t' || c == '\n' || c == '\r') c = '_';
+            }
+            return s;
+        }
+
+        std::string tuning_label(const NcnnTuning& t) {
+            std::ostringstream oss;
+            oss << "fp16_packed=" << t.use_fp16_packed
+                << " fp16_storage=" << t.use_fp16_storage
+                << " fp16_arithmetic=" << t.use_fp16_arithmetic
+                << " packing=" << t.use_packing_layout
+                << " winograd=" << t.use_winograd_convolution
+                << " sgemm=" << t.use_sgemm_convolution
+                << " light=" << t.light_mode;
+            return oss.str();
+        }
+
+        std::vector<ncnn::Mat> run_once(const ncnn::Net& net, const ncnn::Mat& input, bool light_mode) {
+            ncnn::Extractor ex = net.create_extractor();
+            ex.set_light_mode(light_mode);
+            if (net.input_names().empty() || ex.input(net.input_names()[0], input) != 0) {
+                throw std::runtime_error("[NcnnAutotune] Failed to feed model input");
+            }
+            std::vector<ncnn::Mat> outputs(net.output_names().size());
+            for (size_t i = 0; i < outputs.size(); ++i) {
+                if (ex.extract(net.output_names()[i], outputs[i]) != 0) {
+                    throw std::runtime_error("[NcnnAutotune] Failed to extract model output");
+                }
+            }
+            return outputs;
+        }
+
+        float output_deviation(const std::vector<ncnn::Mat>& reference, const std::vector<ncnn::Mat>& candidate) {
+            if (reference.size() != candidate.size()) return INFINITY;
+            float max_ref = 0.0f;
+            float max_diff = 0.0f;
+            for (size_t o = 0; o < reference.size(); ++o) {
+                const ncnn::Mat& a = reference[o];
+                const ncnn::Mat& b = candidate[o];
+                if (a.w != b.w || a.h != b.h || a.d != b.d || a.c != b.c) return INFINITY;
+                const size_t plane = static_cast<size_t>(a.w) * static_cast<size_t>(a.h) * static_cast<size_t>(a.d);
+                for (int q = 0; q < a.c; ++q) {
+                    const float* pa = a.channel(q);
+                    const float* pb = b.channel(q);
+                    for (size_t i = 0; i < plane; ++i) {
+                        max_ref = std::max(max_ref, std::fabs(pa[i]));
+                        max_diff = std::max(max_diff, std::fabs(pa[i] - pb[i]));
+                    }
+                }
+            }
+            return max_diff / std::max(max_ref, 1e-6f);
+        }
+
+        std::mutex& tuning_mutex() {
+            static std::mutex mutex;
+            return mutex;
+        }
+
+        std::map<std::string, std::optional<NcnnTuning>>& resolved_tunings() {
+            static std::map<std::string, std::optional<NcnnTuning>> resolved;
+            return resolved;
+        }
+    }
+
+    bool NcnnTuning::operator==(const NcnnTuning& other) const {
+        return use_fp16_packed == other.use_fp16_packed &&
+               use_fp16_storage == other.use_fp16_storage &&
+               use_fp16_arithmetic == other.use_fp16_arithmetic &&
+               use_packing_layout == other.use_packing_layout &&
+               use_winograd_convolution == other.use_winograd_convolution &&
+               use_sgemm_convolution == other.use_sgemm_convolution &&
+               light_mode == other.light_mode;
+    }
+
+    const std::vector<NcnnTuning>& ncnn_tuning_candidates() {
+        // The first entry is the fp32 accuracy reference.
+        static const std::vector<NcnnTuning> kCandidates = {
+            make_tuning(false, false, false, true, true, true, true),
+            make_tuning(true, true, true, true, true, true, true),
+            make_tuning(true, true, false, true, true, true, true),
+            make_tuning(false, false, false, false, true, true, true),
+            make_tuning(false, false, false, true, false, true, true),
+            make_tuning(false, false, false, true, true, false, true),
+            make_tuning(true, true, true, true, false, true, true),
+            make_tuning(false, false, false, true, true, true, false),
+        };
+        return kCandidates;
+    }
+
+    void apply_ncnn_tuning(ncnn::Option& opt, const NcnnTuning& tuning) {
+        opt.use_fp16_packed = tuning.use_fp16_packed;
+        opt.use_fp16_storage = tuning.use_fp16_storage;
+        opt.use_fp16_arithmetic = tuning.use_fp16_arithmetic;
+        opt.use_packing_layout = tuning.use_packing_layout;
+        opt.use_winograd_convolution = tuning.use_winograd_convolution;
+        opt.use_sgemm_convolution = tuning.use_sgemm_convolution;
+        opt.lightmode = tuning.light_mode;
+    }
+
+    std::string host_cpu_model() {
+        std::ifstream in("/proc/cpuinfo");
+        std::string line;
+        std::string fallback;
+        while (std::getline(in, line)) {
+            const auto colon = line.find(':');
+            if (colon == std::string::npos) continue;
+            std::string key = line.substr(0, colon);
+            key.erase(key.find_last_not_of(" \t") + 1);
+            std::string value = line.substr(colon + 1);
+            value.erase(0, value.find_first_not_of(" \t"));
+            if (key == "model name" && !value.empty()) return value;
+            if (fallback.empty() && (key == "Hardware" || key == "CPU part") && !value.empty()) {
+                fallback = key + " " + value;
+            }
+        }
+        return fallback.empty() ? "unknown-cpu" : fallback;
+    }
+
+    std::string ncnn_tuning_cache_key(const NcnnModelProbe& probe) {
+        uint64_t hash = 14695981039346656037ull;
+        hash = fnv1a_file(probe.param_path, hash);
+        hash = fnv1a_file(probe.bin_path, hash);
+
+        std::ostringstream oss;
+        oss << std::hex << hash << std::dec
+            << "|" << sanitize_key_part(host_cpu_model())
+            << "|t" << std::max(1, probe.threads)
+            << "|" << probe.input_w << "x" << probe.input_h << "x" << probe.input_c;
+        return oss.str();
+    }
+
+    std::optional<NcnnTuning> load_cached_ncnn_tuning(const std::string& cache_path, const std::string& key) {
+        std::ifstream in(cache_path);
+        if (!in.is_open()) return std::nullopt;
+
+        std::string line;
+        while (std::getline(in, line)) {
+            std::istringstream row(line);
+            std::string row_key;
+            if (!std::getline(row, row_key, '\t') || row_key != key) continue;
+            int f[7] = {};
+            NcnnTuning tuning;
+            for (int& v : f) {
+                if (!(row >> v)) return std::nullopt;
+            }
+            tuning = make_tuning(f[0] != 0, f[1] != 0, f[2] != 0, f[3] != 0, f[4] != 0, f[5] != 0, f[6] != 0);
+            row >> tuning.avg_ms;
+            return tuning;
+        }
+        return std::nullopt;
+    }
+
+    void store_cached_ncnn_tuning(const std::string& cache_path, const std::string& key, const NcnnTuning& tuning) {
+        namespace fs = std::filesystem;
+        std::vector<std::string> lines;
+        {
+            std::ifstream in(cache_path);
+            std::string line;
+            while (std::getline(in, line)) {
+                if (line.empty() || line.rfind(key + "\t", 0) == 0) continue;
+                lines.push_back(line);
+            }
+        }
+
+        std::ostringstream row;
+        row << key << '\t'
+            << tuning.use_fp16_packed << ' '
+            << tuning.use_fp16_storage << ' '
+            << tuning.use_fp16_arithmetic << ' '
+            << tuning.use_packing_layout << ' '
+            << tuning.use_winograd_convolution << ' '
+            << tuning.use_sgemm_convolution << ' '
+            << tuning.light_mode << ' '
+            << tuning.avg_ms;
+        lines.push_back(row.str());
+
+        const fs::path path(cache_path);
+        if (path.has_parent_path()) {
+            fs::create_directories(path.parent_path());
+        }
+        const fs::path tmp = path.string() + ".tmp";
+        {
+            std::ofstream out(tmp, std::ios::trunc);
+            if (!out.is_open()) {
+                throw std::runtime_error("[NcnnAutotune] Failed to write cache: " + tmp.string());
+            }
+            for (const auto& line : lines) out << line << '\n';
+        }
+        fs::rename(tmp, path);
+    }
+
+    std::vector<NcnnAutotuneReport> benchmark_ncnn_tunings(const NcnnModelProbe& probe,
+                                                           int iterations,
+                                                           float tolerance) {
+        if (!probe.load || probe.input_w <= 0 || probe.input_h <= 0 || probe.input_c <= 0) {
+            throw std::invalid_argument("[NcnnAutotune] probe needs a loader and a positive input shape");
+        }
+
+        ncnn::Mat input(probe.input_w, probe.input_h, probe.input_c);
+        std::mt19937 rng(20240229u);
+        std::uniform_real_distribution<float> dist(0.0f, 1.0f);
+        const size_t plane = static_cast<size_t>(probe.input_w) * static_cast<size_t>(probe.input_h);
+        for (int q = 0; q < probe.input_c; ++q) {
+            float* p = input.channel(q);
+            for (size_t i = 0; i < plane; ++i) p[i] = dist(rng);
+        }
+
+        std::vector<NcnnAutotuneReport> reports;
+        std::vector<ncnn::Mat> reference;
+        for (const auto& candidate : ncnn_tuning_candidates()) {
+            ncnn::Net net;
+            net.opt.use_vulkan_compute = false;
+            net.opt.num_threads = std::max(1, probe.threads);
+            apply_ncnn_tuning(net.opt, candidate);
+            probe.load(net);
+
+            NcnnAutotuneReport report;
+            report.tuning = candidate;
+            auto outputs = run_once(net, input, candidate.light_mode);
+            if (reference.empty()) {
+                reference = std::move(outputs);
+            } else {
+                report.max_deviation = output_deviation(reference, outputs);
+                report.within_tolerance = report.max_deviation <= tolerance;
+            }
+
+            const auto t0 = std::chrono::steady_clock::now();
+            for (int i = 0; i < std::max(1, iterations); ++i) {
+                (void)run_once(net, input, candidate.light_mode);
+            }
+            const auto t1 = std::chrono::steady_clock::now();
+            report.tuning.avg_ms =
+                std::chrono::duration<double, std::milli>(t1 - t0).count() / static_cast<double>(std::max(1, iterations));
+            reports.push_back(report);
+        }
+        return reports;
+    }
+
+    NcnnTuning pick_ncnn_tuning(const std::vector<NcnnAutotuneReport>& reports) {
+        const NcnnAutotuneReport* best = nullptr;
+        for (const auto& report : reports) {
+            if (!report.within_tolerance) continue;
+            if (!best || report.tuning.avg_ms < best->tuning.avg_ms) best = &report;
+        }
+        return best ? best->tuning : NcnnTuning{};
+    }
+
+    std::optional<NcnnTuning> resolve_ncnn_tuning(const NcnnAutotuneConfig& cfg, const NcnnModelProbe& probe) {
+        if (cfg.mode == "off") return std::nullopt;
+
+        const std::string key = ncnn_tuning_cache_key(probe);
+        std::lock_guard lk(tuning_mutex());
+        auto& resolved = resolved_tunings();
+        auto it = resolved.find(key);
+        if (it != resolved.end()) return it->second;
+
+        std::optional<NcnnTuning> tuning = load_cached_ncnn_tuning(cfg.cache_path, key);
+        if (!tuning && cfg.mode == "auto") {
+            std::cerr << "[NcnnAutotune] benchmarking " << probe.name << " on " << host_cpu_model() << "\n";
+            tuning = pick_ncnn_tuning(benchmark_ncnn_tunings(probe, cfg.iterations, cfg.tolerance));
+            try {
+                store_cached_ncnn_tuning(cfg.cache_path, key, *tuning);
+            } catch (const std::exception& e) {
+                std::cerr << "[NcnnAutotune] " << e.what() << "\n";
+            }
+        }
+        if (tuning) {
+            std::cerr << "[NcnnAutotune] " << probe.name << ": " << tuning_label(*tuning)
+                      << " avg_ms=" << tuning->avg_ms << "\n";
+        }
+        resolved[key] = tuning;
+        return tuning;
+    }
+}
@@ -0,0 +1,252 @@
+#include <common/nms.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <stdexcept>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace veilsight {
+    namespace {
+        struct BoxSoA {
+            std::vector<float> x1;
+            std::vector<float> y1;
+            std::vector<float> x2;
+            std::vector<float> y2;
+            std::vector<float> area;
+
+            void reserve(size_t n) {
+                x1.reserve(n);
+                y1.reserve(n);
+                x2.reserve(n);
+                y2.reserve(n);
+                area.reserve(n);
+            }
+
+            void push(float l, float t, float r, float b) {
+                x1.push_back(l);
+                y1.push_back(t);
+                x2.push_back(r);
+                y2.push_back(b);
+                area.push_back(std::max(0.0f, r - l) * std::max(0.0f, b - t));
+            }
+
+            void swap_remove(size_t i) {
+                const size_t last = area.size() - 1;
+                x1[i] = x1[last];
+                y1[i] = y1[last];
+                x2[i] = x2[last];
+                y2[i] = y2[last];
+                area[i] = area[last];
+                x1.pop_back();
+                y1.pop_back();
+                x2.pop_back();
+                y2.pop_back();
+                area.pop_back();
+            }
+
+            size_t size() const { return area.size(); }
+        };
+
+        float iou_scalar(const BoxSoA& set, size_t i, float l, float t, float r, float b, float area) {
+            const float iw = std::max(0.0f, std::min(set.x2[i], r) - std::max(set.x1[i], l));
+            const float ih = std::max(0.0f, std::min(set.y2[i], b) - std::max(set.y1[i], t));
+            const float inter = iw * ih;
+            if (inter <= 0.0f) return 0.0f;
+            const float uni = set.area[i] + area - inter;
+            if (uni <= 0.0f) return 0.0f;
+            return inter / uni;
+        }
+
+        // True when the box overlaps any member of `set` with IoU above `threshold`.
+        bool overlaps_any(const BoxSoA& set, float l, float t, float r, float b, float threshold) {
+            const size_t n = set.size();
+            if (n == 0) return false;
+            if (threshold < 0.0f) return true;
+            const float area = std::max(0.0f, r - l) * std::max(0.0f, b - t);
+            size_t i = 0;
+#if defined(__AVX2__)
+            const __m256 vl = _mm256_set1_ps(l);
+            const __m256 vt = _mm256_set1_ps(t);
+            const __m256 vr = _mm256_set1_ps(r);
+            const __m256 vb = _mm256_set1_ps(b);
+            const __m256 va = _mm256_set1_ps(area);
+            const __m256 vth = _mm256_set1_ps(threshold);
+            const __m256 zero = _mm256_setzero_ps();
+            for (; i + 8 <= n; i += 8) {
+                const __m256 iw = _mm256_max_ps(zero,
+                                                _mm256_sub_ps(_mm256_min_ps(_mm256_loadu_ps(&set.x2[i]), vr),
+                                                              _mm256_max_ps(_mm256_loadu_ps(&set.x1[i]), vl)));
+                const __m256 ih = _mm256_max_ps(zero,
+                                                _mm256_sub_ps(_mm256_min_ps(_mm256_loadu_ps(&set.y2[i]), vb),
+                                                              _mm256_max_ps(_mm256_loadu_ps(&set.y1[i]), vt)));
+                const __m256 inter = _mm256_mul_ps(iw, ih);
+                const __m256 uni = _mm256_sub_ps(_mm256_add_ps(_mm256_loadu_ps(&set.area[i]), va), inter);
+                const __m256 hit = _mm256_and_ps(_mm256_cmp_ps(inter, zero, _CMP_GT_OQ),
+                                                 _mm256_cmp_ps(inter, _mm256_mul_ps(vth, uni), _CMP_GT_OQ));
+                if (_mm256_movemask_ps(hit) != 0) return true;
+            }
+#elif defined(__ARM_NEON)
+            const float32x4_t vl = vdupq_n_f32(l);
+            const float32x4_t vt = vdupq_n_f32(t);
+            const float32x4_t vr = vdupq_n_f32(r);
+            const float32x4_t vb = vdupq_n_f32(b);
+            const float32x4_t va = vdupq_n_f32(area);
+            const float32x4_t vth = vdupq_n_f32(threshold);
+            const float32x4_t zero = vdupq_n_f32(0.0f);
+            for (; i + 4 <= n; i += 4) {
+                const float32x4_t iw = vmaxq_f32(zero,
+                                                 vsubq_f32(vminq_f32(vld1q_f32(&set.x2[i]), vr),
+                                                           vmaxq_f32(vld1q_f32(&set.x1[i]), vl)));
+                const float32x4_t ih = vmaxq_f32(zero,
+                                                 vsubq_f32(vminq_f32(vld1q_f32(&set.y2[i]), vb),
+                                                           vmaxq_f32(vld1q_f32(&set.y1[i]), vt)));
+                const float32x4_t inter = vmulq_f32(iw, ih);
+                const float32x4_t uni = vsubq_f32(vaddq_f32(vld1q_f32(&set.area[i]), va), inter);
+                const uint32x4_t hit = vandq_u32(vcgtq_f32(inter, zero), vcgtq_f32(inter, vmulq_f32(vth, uni)));
+                if (vmaxvq_u32(hit) != 0) return true;
+            }
+#endif
+            for (; i < n; ++i) {
+                if (iou_scalar(set, i, l, t, r, b, area) > threshold) return true;
+            }
+            return false;
+        }
+
+        std::vector<int> hard_nms(const NmsCandidates& c, const std::vector<int>& order, float threshold) {
+            BoxSoA kept_boxes;
+            kept_boxes.reserve(order.size());
+            std::vector<int> kept;
+            kept.reserve(order.size());
+            for (const int idx : order) {
+                const size_t i = static_cast<size_t>(idx);
+                const float l = c.x1[i];
+                const float t = c.y1[i];
+                const float r = c.x2[i];
+                const float b = c.y2[i];
+                if (overlaps_any(kept_boxes, l, t, r, b, threshold)) continue;
+                kept_boxes.push(l, t, r, b);
+                kept.push_back(idx);
+            }
+            return kept;
+        }
+
+        // Gaussian soft-NMS: each kept box decays the scores of the remaining boxes by exp(-iou^2 / sigma).
+        std::vector<int> soft_nms(NmsCandidates& c,
+                                  const std::vector<int>& order,
+                                  float sigma,
+                                  float min_score) {
+            BoxSoA remaining;
+            remaining.reserve(order.size());
+            std::vector<float> scores;
+            std::vector<int> indices;
+            scores.reserve(order.size());
+            indices.reserve(order.size());
+            for (const int idx : order) {
+                const size_t i = static_cast<size_t>(idx);
+                remaining.push(c.x1[i], c.y1[i], c.x2[i], c.y2[i]);
+                scores.push_back(c.score[i]);
+                indices.push_back(idx);
+            }
+
+            const float inv_sigma = 1.0f / std::max(sigma, 1e-6f);
+            std::vector<int> kept;
+            kept.reserve(order.size());
+            while (!scores.empty()) {
+                const size_t best = static_cast<size_t>(
+                    std::max_element(scores.begin(), scores.end()) - scores.begin());
+                if (scores[best] < min_score) break;
+
+                const float l = remaining.x1[best];
+                const float t = remaining.y1[best];
+                const float r = remaining.x2[best];
+                const float b = remaining.y2[best];
+                const float area = remaining.area[best];
+                c.score[static_cast<size_t>(indices[best])] = scores[best];
+                kept.push_back(indices[best]);
+
+                remaining.swap_remove(best);
+                scores[best] = scores.back();
+                scores.pop_back();
+                indices[best] = indices.back();
+                indices.pop_back();
+
+                for (size_t i = 0; i < scores.size();) {
+                    const float iou = iou_scalar(remaining, i, l, t, r, b, area);
+                    scores[i] *= std::exp(-(iou * iou) * inv_sigma);
+                    if (scores[i] < min_score) {
+                        remaining.swap_remove(i);
+                        scores[i] = scores.back();
+                        scores.pop_back();
+                        indices[i] = indices.back();
+                        indices.pop_back();
+                        continue;
+                    }
+                    ++i;
+                }
+            }
+            return kept;
+        }
+    }
+
+    NmsMode nms_mode_from_str(const std::string& mode) {
+        if (mode == "hard") return NmsMode::Hard;
+        if (mode == "soft") return NmsMode::Soft;
+        throw std::invalid_argument("[NMS] Unsupported nms mode: " + mode);
+    }
+
+    void NmsCandidates::clear() {
+        x1.clear();
+        y1.clear();
+        x2.clear();
+        y2.clear();
+        score.clear();
+    }
+
+    void NmsCandidates::reserve(size_t n) {
+        x1.reserve(n);
+        y1.reserve(n);
+        x2.reserve(n);
+        y2.reserve(n);
+        score.reserve(n);
+    }
+
+    void NmsCandidates::push(float left, float top, float right, float bottom, float s) {
+        x1.push_back(left);
+        y1.push_back(top);
+        x2.push_back(right);
+        y2.push_back(bottom);
+        score.push_back(s);
+    }
+
+    std::vector<int> top_k_indices(const std::vector<float>& scores, int k) {
+        std::vector<int> order(scores.size());
+        std::iota(order.begin(), order.end(), 0);
+        const auto better = [&scores](int a, int b) {
+            const float sa = scores[static_cast<size_t>(a)];
+            const float sb = scores[static_cast<size_t>(b)];
+            return sa > sb || (sa == sb && a < b);
+        };
+        if (k > 0 && static_cast<size_t>(k) < order.size()) {
+            std::nth_element(order.begin(), order.begin() + k, order.end(), better);
+            order.resize(static_cast<size_t>(k));
+        }
+        std::sort(order.begin(), order.end(), better);
+        return order;
+    }
+
+    std::vector<int> non_max_suppression(NmsCandidates& candidates, const NmsOptions& options) {
+        if (candidates.empty()) return {};
+
+        const std::vector<int> order = top_k_indices(candidates.score, options.top_k);
+        if (options.mode == NmsMode::Soft) {
+            return soft_nms(candidates, order, options.soft_sigma, options.soft_min_score);
+        }
+        return hard_nms(candidates, order, options.iou_threshold);
+    }
+}
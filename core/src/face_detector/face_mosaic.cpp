@@ -0,0 +1,143 @@
+#include <face_detector/face_mosaic.hpp>
+
+#include <face_detector/face_policy.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+#include <opencv2/imgproc.hpp>
+
+namespace veilsight {
+    namespace {
+        int grid_cols(const FaceMosaicLayout& layout) {
+            if (layout.tile <= 0) return 0;
+            return (layout.canvas.width + layout.gap) / (layout.tile + layout.gap);
+        }
+
+        int grid_rows(const FaceMosaicLayout& layout) {
+            if (layout.tile <= 0) return 0;
+            return (layout.canvas.height + layout.gap) / (layout.tile + layout.gap);
+        }
+
+        // Maps tile coordinates back into the crop that was resized onto the tile.
+        SpatialTransform tile_to_crop(const cv::Rect& cell, cv::Size crop_size) {
+            const float sx = static_cast<float>(crop_size.width) / static_cast<float>(cell.width);
+            const float sy = static_cast<float>(crop_size.height) / static_cast<float>(cell.height);
+            SpatialTransform transform;
+            transform.source_size = cell.size();
+            transform.target_size = crop_size;
+            transform.source_to_target = cv::Matx23f(sx, 0.0f, -static_cast<float>(cell.x) * sx,
+                                                      0.0f, sy, -static_cast<float>(cell.y) * sy);
+            transform.target_to_source = cv::Matx23f(1.0f / sx, 0.0f, static_cast<float>(cell.x),
+                                                      0.0f, 1.0f / sy, static_cast<float>(cell.y));
+            return transform;
+        }
+
+        RectF clip_to_cell(const RectF& rect, const cv::Rect& cell) {
+            const float x1 = std::max(rect.x, static_cast<float>(cell.x));
+            const float y1 = std::max(rect.y, static_cast<float>(cell.y));
+            const float x2 = std::min(rect.x + rect.w, static_cast<float>(cell.x + cell.width));
+            const float y2 = std::min(rect.y + rect.h, static_cast<float>(cell.y + cell.height));
+            return RectF{x1, y1, std::max(0.0f, x2 - x1), std::max(0.0f, y2 - y1)};
+        }
+
+        FaceDetectionResult empty_result(const FaceDetectionTask& task) {
+            FaceDetectionResult result;
+            result.stream_id = task.stream_id;
+            result.frame_id = task.frame_id;
+            result.probe_id = task.probe_id;
+            result.kind = task.kind;
+            return result;
+        }
+    }
+
+    size_t face_mosaic_capacity(const FaceMosaicLayout& layout) {
+        return static_cast<size_t>(std::max(0, grid_cols(layout))) * static_cast<size_t>(std::max(0, grid_rows(layout)));
+    }
+
+    std::vector<FaceMosaic> pack_face_mosaics(const std::vector<FaceDetectionTask>& tasks,
+                                              const FaceMosaicLayout& layout) {
+        std::vector<FaceMosaic> mosaics;
+        const size_t capacity = face_mosaic_capacity(layout);
+        if (capacity == 0) return mosaics;
+
+        const int cols = grid_cols(layout);
+        const int stride = layout.tile + layout.gap;
+        for (size_t t = 0; t < tasks.size(); ++t) {
+            if (tasks[t].kind != FaceProbeKind::HeadCrops) continue;
+            for (size_t c = 0; c < tasks[t].crops.size(); ++c) {
+                const cv::Mat& crop = tasks[t].crops[c].input.image;
+                if (crop.empty()) continue;
+                if (mosaics.empty() || mosaics.back().tiles.size() >= capacity) {
+                    mosaics.push_back(FaceMosaic{cv::Mat(layout.canvas, crop.type(), cv::Scalar::all(0)), {}});
+                }
+
+                FaceMosaic& mosaic = mosaics.back();
+                const int k = static_cast<int>(mosaic.tiles.size());
+                const cv::Rect cell((k % cols) * stride, (k / cols) * stride, layout.tile, layout.tile);
+                cv::Mat dst = mosaic.canvas(cell);
+                cv::resize(crop, dst, cell.size(), 0, 0, cv::INTER_LINEAR);
+                mosaic.tiles.push_back(FaceMosaicTile{t, c, cell});
+            }
+        }
+        return mosaics;
+    }
+
+    std::vector<FaceDetectionResult> run_face_mosaic_tasks(IFaceDetector& detector,
+                                                           const std::vector<FaceDetectionTask>& tasks,
+                                                           const FaceMosaicLayout& layout) {
+        std::vector<FaceDetectionResult> results;
+        results.reserve(tasks.size());
+        const bool packable = face_mosaic_capacity(layout) > 0;
+        for (const auto& task : tasks) {
+            if (task.kind == FaceProbeKind::HeadCrops && packable) {
+                results.push_back(empty_result(task));
+            } else {
+                results.push_back(run_face_detection_task(detector, task));
+            }
+        }
+        if (!packable) return results;
+
+        const int cols = grid_cols(layout);
+        const int rows = grid_rows(layout);
+        const int stride = layout.tile + layout.gap;
+        for (const auto& mosaic : pack_face_mosaics(tasks, layout)) {
+            const FaceDetectionTask& first = tasks[mosaic.tiles.front().task];
+            FaceDetectorRunConfig run = first.run;
+            run.input_w = layout.canvas.width;
+            run.input_h = layout.canvas.height;
+            run.preprocess.reset();
+
+            // Detections stay grouped per tile so each task sees its crops' faces in crop order.
+            std::vector<std::vector<FaceObservation>> by_tile(mosaic.tiles.size());
+            for (const auto& face : detector.detect_faces(mosaic.canvas, run)) {
+                const float cx = face.bbox.x + face.bbox.w * 0.5f;
+                const float cy = face.bbox.y + face.bbox.h * 0.5f;
+                const int col = static_cast<int>(std::floor(cx / static_cast<float>(stride)));
+                const int row = static_cast<int>(std::floor(cy / static_cast<float>(stride)));
+                if (col < 0 || row < 0 || col >= cols || row >= rows) continue;
+                const size_t k = static_cast<size_t>(row * cols + col);
+                if (k >= mosaic.tiles.size()) continue;
+                const cv::Rect& cell = mosaic.tiles[k].cell;
+                if (cx >= static_cast<float>(cell.x + cell.width) || cy >= static_cast<float>(cell.y + cell.height)) {
+                    continue; // center in the gap
+                }
+                FaceObservation clipped = face;
+                clipped.bbox = clip_to_cell(face.bbox, cell);
+                by_tile[k].push_back(clipped);
+            }
+
+            for (size_t k = 0; k < mosaic.tiles.size(); ++k) {
+                const FaceMosaicTile& tile = mosaic.tiles[k];
+                const FaceProbeCrop& crop = tasks[tile.task].crops[tile.crop];
+                const SpatialTransform to_crop = tile_to_crop(tile.cell, crop.input.image.size());
+                FaceDetectionResult& result = results[tile.task];
+                for (const auto& face : by_tile[k]) {
+                    result.faces.push_back(map_face(crop.input.image_to_frame, map_face(to_crop, face)));
+                    result.track_ids.push_back(crop.track_id);
+                }
+            }
+        }
+        return results;
+    }
+}
@@ -1,6 +1,10 @@
 #include <face_detector/face_policy.hpp>
 
+#include <face_detector/face_mosaic.hpp>
+#include <tracking/association.hpp>
+
 #include <algorithm>
+#include <cmath>
 #include <limits>
 #include <utility>
 
@@ -78,60 +82,253 @@ namespace veilsight {
             return box;
         }
 
-        void assign_full_frame_faces(std::vector<Box>& tracks,
-                                     std::vector<FaceObservation> faces,
-                                     int64_t frame_id,
-                                     const FaceDetectorModuleConfig& cfg) {
+        // Uniform grid over rectangles. Each entry is listed in every cell it overlaps and coordinates outside
+        // the grid clamp to its border cells, so every entry intersecting a query shares one of its cells.
+        class RectGrid {
+        public:
+            explicit RectGrid(const std::vector<Box>& tracks) {
+                float x1 = std::numeric_limits<float>::infinity();
+                float y1 = std::numeric_limits<float>::infinity();
+                float x2 = -std::numeric_limits<float>::infinity();
+                float y2 = -std::numeric_limits<float>::infinity();
+                float height_sum = 0.0f;
+                for (const auto& track : tracks) {
+                    x1 = std::min(x1, track.x);
+                    y1 = std::min(y1, track.y);
+                    x2 = std::max(x2, track.x + track.w);
+                    y2 = std::max(y2, track.y + track.h);
+                    height_sum += std::max(0.0f, track.h);
+                }
+                if (tracks.empty()) return;
+
+                // Half a person height keeps a face-center query to one cell with a handful of tracks in it.
+                constexpr int kMaxCells = 64;
+                const float mean_h = height_sum / static_cast<float>(tracks.size());
+                cell_ = std::max({8.0f, mean_h * 0.5f, (x2 - x1) / kMaxCells, (y2 - y1) / kMaxCells});
+                x0_ = x1;
+                y0_ = y1;
+                cols_ = std::max(1, static_cast<int>(std::ceil((x2 - x1) / cell_)));
+                rows_ = std::max(1, static_cast<int>(std::ceil((y2 - y1) / cell_)));
+                cells_.resize(static_cast<size_t>(cols_ * rows_));
+            }
+
+            void insert(const RectF& rect, size_t index) {
+                for_cells(rect, [&](std::vector<size_t>& cell) { cell.push_back(index); });
+            }
+
+            // Calls fn once per entry listed in the cells `rect` covers; an entry spanning several of those
+            // cells is visited more than once.
+            template <typename Fn>
+            void visit(const RectF& rect, Fn&& fn) {
+                for_cells(rect, [&](std::vector<size_t>& cell) {
+                    for (const size_t index : cell) fn(index);
+                });
+            }
+
+        private:
+            int clamp_cell(float v, float origin, int count) const {
+                const float c = std::floor((v - origin) / cell_);
+                return static_cast<int>(std::clamp(c, 0.0f, static_cast<float>(count - 1)));
+            }
+
+            template <typename Fn>
+            void for_cells(const RectF& rect, Fn&& fn) {
+                if (cells_.empty()) return;
+                const int c1 = clamp_cell(rect.x, x0_, cols_);
+                const int c2 = clamp_cell(rect.x + std::max(0.0f, rect.w), x0_, cols_);
+                const int r1 = clamp_cell(rect.y, y0_, rows_);
+                const int r2 = clamp_cell(rect.y + std::max(0.0f, rect.h), y0_, rows_);
+                for (int r = r1; r <= r2; ++r) {
+                    for (int c = c1; c <= c2; ++c) fn(cells_[static_cast<size_t>(r * cols_ + c)]);
+                }
+            }
+
+            float x0_ = 0.0f;
+            float y0_ = 0.0f;
+            float cell_ = 1.0f;
+            int cols_ = 0;
+            int rows_ = 0;
+            std::vector<std::vector<size_t>> cells_;
+        };
+
+        float min_face_score_for(const FaceDetectorModuleConfig& cfg) {
+            return cfg.type == "yunet" ? cfg.yunet.score_threshold : cfg.scrfd.score_threshold;
+        }
+
+        void assign_faces(std::vector<Box>& tracks,
+                          std::vector<FaceObservation> faces,
+                          int64_t frame_id,
+                          FaceSource source,
+                          const FaceDetectorModuleConfig& cfg) {
             std::sort(faces.begin(), faces.end(), [](const FaceObservation& a, const FaceObservation& b) {
                 return a.score > b.score;
             });
 
-            std::vector<int> assigned_per_track(tracks.size(), 0);
             const size_t person_track_count = tracks.size();
             int face_only_id = -1;
-            const int max_per_track = 1;
-            const float min_face_score = cfg.type == "yunet" ? cfg.yunet.score_threshold : cfg.scrfd.score_threshold;
+            for (const auto& track : tracks) {
+                if (track.id <= face_only_id) face_only_id = track.id - 1;
+            }
+            const float min_face_score = min_face_score_for(cfg);
+
+            // Person boxes and already attached fresh faces are indexed once, so each face only looks at the
+            // tracks under its center and the faces it overlaps.
+            RectGrid track_grid(tracks);
+            RectGrid face_grid(tracks);
+            std::vector<char> taken(person_track_count, 0);
+            for (size_t i = 0; i < person_track_count; ++i) {
+                track_grid.insert(RectF{tracks[i].x, tracks[i].y, tracks[i].w, tracks[i].h}, i);
+                if (tracks[i].face && tracks[i].face->fresh) {
+                    taken[i] = 1;
+                    face_grid.insert(tracks[i].face->bbox, i);
+                }
+            }
+
+            const auto duplicates_assigned_face = [&](const FaceObservation& face) {
+                bool duplicate = false;
+                face_grid.visit(face.bbox, [&](size_t i) {
+                    if (!duplicate && iou_of(face.bbox, tracks[i].face->bbox) > 0.5f) duplicate = true;
+                });
+                return duplicate;
+            };
+            const auto for_each_candidate = [&](const FaceObservation& face, auto&& fn) {
+                const RectF center{face.bbox.x + face.bbox.w * 0.5f, face.bbox.y + face.bbox.h * 0.5f, 0.0f, 0.0f};
+                track_grid.visit(center, [&](size_t i) {
+                    if (taken[i] || !plausible_face_for_track(face, tracks[i], min_face_score)) return;
+                    fn(i, face_track_score(face, tracks[i]));
+                });
+            };
+            const auto attach = [&](size_t i, const FaceObservation& face) {
+                tracks[i].face = face;
+                taken[i] = 1;
+                face_grid.insert(face.bbox, i);
+            };
+            const auto add_face_only = [&](const FaceObservation& face) {
+                if (cfg.association_mode != "independent") return;
+                tracks.push_back(face_only_box(face, face_only_id--));
+                face_grid.insert(face.bbox, tracks.size() - 1);
+            };
 
-            for (auto face : faces) {
+            for (auto& face : faces) {
                 face.frame_id = frame_id;
-                face.source = FaceSource::FullFrame;
+                face.source = source;
                 face.fresh = true;
+            }
+
+            if (cfg.assignment == "hungarian") {
+                // Maximizes the summed face/track score over all plausible pairs instead of letting the
+                // strongest face take its favourite track first.
+                std::vector<FaceObservation> pending;
+                for (const auto& face : faces) {
+                    if (!duplicates_assigned_face(face)) pending.push_back(face);
+                }
+                std::vector<int> column_of(person_track_count, -1);
+                std::vector<size_t> columns;
+                std::vector<std::vector<std::pair<size_t, float>>> pairs(pending.size());
+                for (size_t f = 0; f < pending.size(); ++f) {
+                    for_each_candidate(pending[f], [&](size_t i, float score) {
+                        if (column_of[i] < 0) {
+                            column_of[i] = static_cast<int>(columns.size());
+                            columns.push_back(i);
+                        }
+                        pairs[f].emplace_back(i, score);
+                    });
+                }
+
+                std::vector<int> matched(pending.size(), -1);
+                if (!columns.empty()) {
+                    constexpr float kInfeasible = 1e6f;
+                    CostMatrix cost;
+                    cost.reset(static_cast<int>(pending.size()), static_cast<int>(columns.size()), kInfeasible);
+                    for (size_t f = 0; f < pending.size(); ++f) {
+                        for (const auto& [i, score] : pairs[f]) {
+                            cost.at(static_cast<int>(f), column_of[i]) = -score;
+                        }
+                    }
+                    const std::vector<int> assignment = solve_assignment(cost);
+                    for (size_t f = 0; f < assignment.size() && f < pending.size(); ++f) {
+                        const int c = assignment[f];
+                        if (c < 0 || cost.at(static_cast<int>(f), c) >= kInfeasible) continue;
+                        matched[f] = c;
+                        attach(columns[static_cast<size_t>(c)], pending[f]);
+                    }
+                }
+                for (size_t f = 0; f < pending.size(); ++f) {
+                    if (matched[f] < 0 && !duplicates_assigned_face(pending[f])) add_face_only(pending[f]);
+                }
+                return;
+            }
+
+            for (const auto& face : faces) {
+                if (duplicates_assigned_face(face)) continue;
 
                 float best_score = -std::numeric_limits<float>::infinity();
                 size_t best_track = person_track_count;
-                for (size_t i = 0; i < person_track_count; ++i) {
-                    if (assigned_per_track[i] >= max_per_track) continue;
-                    if (!plausible_face_for_track(face, tracks[i], min_face_score)) continue;
-
-                    const float score = face_track_score(face, tracks[i]);
-                    if (score > best_score) {
+                for_each_candidate(face, [&](size_t i, float score) {
+                    if (score > best_score || (score == best_score && i < best_track)) {
                         best_score = score;
                         best_track = i;
                     }
-                }
+                });
 
                 if (best_track >= person_track_count) {
-                    if (cfg.association_mode != "independent") continue;
-                    tracks.push_back(face_only_box(face, face_only_id--));
+                    add_face_only(face);
                     continue;
                 }
-                tracks[best_track].face = face;
-                ++assigned_per_track[best_track];
+                attach(best_track, face);
             }
         }
 
-        FaceDetectorRunConfig run_config_for_detector(const FaceDetectorModuleConfig& cfg) {
-            if (cfg.type == "yunet") {
-                return FaceDetectorRunConfig{std::max(1, cfg.yunet.input_w), std::max(1, cfg.yunet.input_h)};
+        // A face found in a track's own head crop goes to that track first; the rest compete like
+        // full-frame faces.
+        void assign_head_crop_faces(std::vector<Box>& tracks,
+                                    const FaceDetectionResult& result,
+                                    int64_t frame_id,
+                                    const FaceDetectorModuleConfig& cfg) {
+            const float min_face_score = min_face_score_for(cfg);
+            std::unordered_map<int, size_t> index_of;
+            index_of.reserve(tracks.size());
+            for (size_t i = 0; i < tracks.size(); ++i) index_of.emplace(tracks[i].id, i);
+
+            std::vector<FaceObservation> unassigned;
+            for (size_t i = 0; i < result.faces.size(); ++i) {
+                FaceObservation face = result.faces[i];
+                face.frame_id = frame_id;
+                face.source = FaceSource::HeadCrop;
+                face.fresh = true;
+
+                const int track_id = i < result.track_ids.size() ? result.track_ids[i] : -1;
+                const auto found = index_of.find(track_id);
+                Box* owner = found != index_of.end() ? &tracks[found->second] : nullptr;
+                const bool owner_has_fresh_face = owner && owner->face && owner->face->fresh;
+                if (!owner || !plausible_face_for_track(face, *owner, min_face_score) ||
+                    (owner_has_fresh_face && owner->face->score >= face.score)) {
+                    unassigned.push_back(face);
+                    continue;
+                }
+                if (owner_has_fresh_face) unassigned.push_back(*owner->face);
+                owner->face = face;
             }
-            return FaceDetectorRunConfig{std::max(1, cfg.scrfd.input_w), std::max(1, cfg.scrfd.input_h)};
+            assign_faces(tracks, std::move(unassigned), frame_id, FaceSource::HeadCrop, cfg);
         }
 
         std::string full_frame_probe_id(int64_t frame_id) {
             return std::to_string(frame_id) + ":full";
         }
+
+        std::string head_crops_probe_id(int64_t frame_id) {
+            return std::to_string(frame_id) + ":heads";
+        }
     } // namespace
 
+    FaceDetectorRunConfig run_config_for_detector(const FaceDetectorModuleConfig& cfg) {
+        const bool yunet = cfg.type == "yunet";
+        FaceDetectorRunConfig run;
+        run.input_w = std::max(1, yunet ? cfg.yunet.input_w : cfg.scrfd.input_w);
+        run.input_h = std::max(1, yunet ? cfg.yunet.input_h : cfg.scrfd.input_h);
+        return run;
+    }
+
     FaceProbePlanner::FaceProbePlanner(FaceDetectorModuleConfig cfg,
                                        std::shared_ptr<FaceStateStore> state)
         : cfg_(std::move(cfg)),
@@ -139,17 +336,75 @@ namespace veilsight {
         if (!state_) state_ = std::make_shared<FaceStateStore>();
     }
 
-    std::vector<FaceDetectionTask> FaceProbePlanner::plan(FrameCtx& frame, std::vector<Box>& tracks) {
-        std::lock_guard<std::mutex> lock(state_->mutex);
-        std::vector<FaceDetectionTask> tasks;
+    cv::Rect head_crop_rect(const Box& person, cv::Size frame_size, const FaceProbeConfig& cfg) {
+        const float head_h = person.h * cfg.head_fraction;
+        const float side = std::max(person.w, head_h) * (1.0f + 2.0f * cfg.crop_padding);
+        const float cx = person.x + person.w * 0.5f;
+        const float cy = person.y + head_h * 0.5f;
+        const int x0 = std::max(0, static_cast<int>(std::floor(cx - side * 0.5f)));
+        const int y0 = std::max(0, static_cast<int>(std::floor(cy - side * 0.5f)));
+        const int x1 = std::min(frame_size.width, static_cast<int>(std::ceil(cx + side * 0.5f)));
+        const int y1 = std::min(frame_size.height, static_cast<int>(std::ceil(cy + side * 0.5f)));
+        if (x1 - x0 < 2 || y1 - y0 < 2) return {};
+        return cv::Rect(x0, y0, x1 - x0, y1 - y0);
+    }
 
-        for (auto& track : tracks) {
-            track.privacy_action = "anonymize";
-            track.face.reset();
+    std::optional<FaceObservation> propagate_track_face(const TrackFaceState& state,
+                                                        const Box& track,
+                                                        int64_t frame_id,
+                                                        const FaceProbeConfig& cfg) {
+        if (cfg.reuse_interval <= 0) return std::nullopt;
+        const int64_t age = frame_id - state.face.frame_id;
+        if (age < 0 || age >= cfg.reuse_interval) return std::nullopt;
+        if (state.person.w <= 1.0f || state.person.h <= 1.0f || track.w <= 1.0f || track.h <= 1.0f) {
+            return std::nullopt;
         }
 
-        if (frame.inf.empty()) return tasks;
+        const float sx = track.w / state.person.w;
+        const float sy = track.h / state.person.h;
+        if (std::fabs(sx - 1.0f) > cfg.reuse_max_shape_change || std::fabs(sy - 1.0f) > cfg.reuse_max_shape_change) {
+            return std::nullopt;
+        }
 
+        FaceObservation face = state.face;
+        face.bbox.x = track.x + (state.face.bbox.x - state.person.x) * sx;
+        face.bbox.y = track.y + (state.face.bbox.y - state.person.y) * sy;
+        face.bbox.w = state.face.bbox.w * sx;
+        face.bbox.h = state.face.bbox.h * sy;
+        for (int i = 0; i < face.landmark_count && i < 5; ++i) {
+            auto& point = face.landmarks[static_cast<size_t>(i)];
+            point.x = track.x + (point.x - state.person.x) * sx;
+            point.y = track.y + (point.y - state.person.y) * sy;
+        }
+        face.fresh = false;
+        return face;
+    }
+
+    FaceDetectionResult run_face_detection_task(IFaceDetector& detector, const FaceDetectionTask& task) {
+        FaceDetectionResult result;
+        result.stream_id = task.stream_id;
+        result.frame_id = task.frame_id;
+        result.probe_id = task.probe_id;
+        result.kind = task.kind;
+        if (task.kind == FaceProbeKind::HeadCrops) {
+            for (const auto& crop : task.crops) {
+                const auto faces = detector.detect_faces(crop.input.image, task.run);
+                for (const auto& face : faces) {
+                    result.faces.push_back(map_face(crop.input.image_to_frame, face));
+                    result.track_ids.push_back(crop.track_id);
+                }
+            }
+            return result;
+        }
+        const auto faces = detector.detect_faces(task.input.image, task.run);
+        result.faces.reserve(faces.size());
+        for (const auto& face : faces) {
+            result.faces.push_back(map_face(task.input.image_to_frame, face));
+        }
+        return result;
+    }
+
+    FaceDetectionTask FaceProbePlanner::full_frame_task_(const FrameCtx& frame) const {
         FaceDetectionTask task;
         task.stream_id = frame.stream_id;
         task.frame_id = frame.frame_id;
@@ -158,8 +413,83 @@ namespace veilsight {
         task.input.image = frame.inf;
         task.input.image_to_frame = identity_transform(frame.inf.size());
         task.run = run_config_for_detector(cfg_);
-        tasks.push_back(std::move(task));
+        task.run.preprocess = frame.preprocess;
+        return task;
+    }
+
+    std::vector<FaceDetectionTask> FaceProbePlanner::plan(FrameCtx& frame, std::vector<Box>& tracks) {
+        std::lock_guard<std::mutex> lock(state_->mutex);
+        std::vector<FaceDetectionTask> tasks;
+
+        for (auto& track : tracks) {
+            track.privacy_action = "anonymize";
+            track.face.reset();
+        }
 
+        if (frame.inf.empty()) return tasks;
+
+        const FaceProbeConfig& probes = cfg_.probes;
+        std::vector<bool> reused(tracks.size(), false);
+        size_t reused_count = 0;
+        if (probes.reuse_interval > 0) {
+            for (size_t i = 0; i < tracks.size(); ++i) {
+                const auto it = state_->tracks.find(tracks[i].id);
+                if (it == state_->tracks.end()) continue;
+                if (auto face = propagate_track_face(it->second, tracks[i], frame.frame_id, probes)) {
+                    tracks[i].face = std::move(face);
+                    reused[i] = true;
+                    ++reused_count;
+                }
+            }
+        }
+
+        if (probes.mode != "head_crop") {
+            // One full-frame probe covers every track, so it is skipped only while all of them reuse a
+            // face; it still runs every full_frame_interval frames for faces that have no track.
+            const bool all_reused = !tracks.empty() && reused_count == tracks.size();
+            const bool fallback_due = last_full_frame_id_ < 0 || frame.frame_id < last_full_frame_id_ ||
+                                      frame.frame_id - last_full_frame_id_ >= probes.full_frame_interval;
+            if (all_reused && !fallback_due) {
+                ++frame.face_probes_avoided;
+                return tasks;
+            }
+            last_full_frame_id_ = frame.frame_id;
+            ++frame.face_probes_issued;
+            tasks.push_back(full_frame_task_(frame));
+            return tasks;
+        }
+
+        FaceDetectionTask heads;
+        heads.stream_id = frame.stream_id;
+        heads.frame_id = frame.frame_id;
+        heads.probe_id = head_crops_probe_id(frame.frame_id);
+        heads.kind = FaceProbeKind::HeadCrops;
+        heads.run.input_w = probes.crop_input;
+        heads.run.input_h = probes.crop_input;
+        for (size_t i = 0; i < tracks.size(); ++i) {
+            const Box& track = tracks[i];
+            if (reused[i]) {
+                ++frame.face_probes_avoided;
+                continue;
+            }
+            if (track.h < probes.min_track_height_px) continue;
+            const cv::Rect rect = head_crop_rect(track, frame.inf.size(), probes);
+            if (rect.empty()) continue;
+            FaceProbeCrop crop;
+            crop.input.image = frame.inf(rect);
+            crop.input.image_to_frame = crop_transform(rect, frame.inf.size());
+            crop.track_id = track.id;
+            heads.crops.push_back(std::move(crop));
+        }
+        frame.face_probes_issued += heads.crops.size();
+        if (!heads.crops.empty()) tasks.push_back(std::move(heads));
+
+        if (last_full_frame_id_ < 0 || frame.frame_id < last_full_frame_id_ ||
+            frame.frame_id - last_full_frame_id_ >= probes.full_frame_interval) {
+            last_full_frame_id_ = frame.frame_id;
+            ++frame.face_probes_issued;
+            tasks.push_back(full_frame_task_(frame));
+        }
         return tasks;
     }
 
@@ -174,38 +504,56 @@ namespace veilsight {
                                   std::vector<Box>& tracks,
                                   const std::vector<FaceDetectionResult>& results) {
         std::lock_guard<std::mutex> lock(state_->mutex);
+        for (const auto& result : results) {
+            if (result.kind != FaceProbeKind::HeadCrops) continue;
+            assign_head_crop_faces(tracks, result, frame.frame_id, cfg_);
+        }
         for (const auto& result : results) {
             if (result.kind != FaceProbeKind::FullFrame) continue;
-            assign_full_frame_faces(tracks, result.faces, frame.frame_id, cfg_);
+            assign_faces(tracks, result.faces, frame.frame_id, FaceSource::FullFrame, cfg_);
+        }
+
+        if (cfg_.probes.reuse_interval <= 0) return;
+        for (const auto& track : tracks) {
+            if (track.id < 0) continue;
+            if (!track.face) {
+                state_->tracks.erase(track.id);
+            } else if (track.face->fresh) {
+                state_->tracks[track.id] = TrackFaceState{*track.face, RectF{track.x, track.y, track.w, track.h}};
+            }
+        }
+        for (auto it = state_->tracks.begin(); it != state_->tracks.end();) {
+            if (frame.frame_id - it->second.face.frame_id >= cfg_.probes.reuse_interval) {
+                it = state_->tracks.erase(it);
+            } else {
+                ++it;
+            }
         }
     }
 
     HybridFacePolicy::HybridFacePolicy(FaceDetectorModuleConfig cfg,
                                        std::shared_ptr<FaceStateStore> state)
         : cfg_(std::move(cfg)),
-          state_(std::move(state)) {
-        if (!state_) state_ = std::make_shared<FaceStateStore>();
-    }
+          state_(state ? std::move(state) : std::make_shared<FaceStateStore>()),
+          planner_(cfg_, state_),
+          applier_(cfg_, state_) {}
 
     void HybridFacePolicy::annotate(FrameCtx& frame,
                                     std::vector<Box>& tracks,
                                     IFaceDetector& detector) {
-        FaceProbePlanner planner(cfg_, state_);
-        FaceResultApplier applier(cfg_, state_);
+        const auto tasks = planner_.plan(frame, tracks);
         std::vector<FaceDetectionResult> results;
-        for (const auto& task : planner.plan(frame, tracks)) {
-            FaceDetectionResult result;
-            result.stream_id = task.stream_id;
-            result.frame_id = task.frame_id;
-            result.probe_id = task.probe_id;
-            result.kind = task.kind;
-            const auto faces = detector.detect_faces(task.input.image, task.run);
-            result.faces.reserve(faces.size());
-            for (const auto& face : faces) {
-                result.faces.push_back(map_face(task.input.image_to_frame, face));
+        if (cfg_.mosaic.enabled) {
+            const FaceDetectorRunConfig canvas = run_config_for_detector(cfg_);
+            const FaceMosaicLayout layout{cv::Size(canvas.input_w, canvas.input_h),
+                                          cfg_.probes.crop_input,
+                                          cfg_.mosaic.gap_px};
+            results = run_face_mosaic_tasks(detector, tasks, layout);
+        } else {
+            for (const auto& task : tasks) {
+                results.push_back(run_face_detection_task(detector, task));
             }
-            results.push_back(std::move(result));
         }
-        applier.apply(frame, tracks, results);
+        applier_.apply(frame, tracks, results);
     }
 }
@@ -1,5 +1,7 @@
 #include <face_detector/scrfd_detector.hpp>
 
+#include <common/nms.hpp>
+
 #include <algorithm>
 #include <array>
 #include <cmath>
@@ -24,31 +26,6 @@ namespace veilsight {
             return variant;
         }
 
-        float area_of(const RectF& b) {
-            return std::max(0.0f, b.w) * std::max(0.0f, b.h);
-        }
-
-        float iou_of(const RectF& a, const RectF& b) {
-            const float ax2 = a.x + a.w;
-            const float ay2 = a.y + a.h;
-            const float bx2 = b.x + b.w;
-            const float by2 = b.y + b.h;
-
-            const float xx1 = std::max(a.x, b.x);
-            const float yy1 = std::max(a.y, b.y);
-            const float xx2 = std::min(ax2, bx2);
-            const float yy2 = std::min(ay2, by2);
-
-            const float iw = std::max(0.0f, xx2 - xx1);
-            const float ih = std::max(0.0f, yy2 - yy1);
-            const float inter = iw * ih;
-            if (inter <= 0.0f) return 0.0f;
-
-            const float uni = area_of(a) + area_of(b) - inter;
-            if (uni <= 0.0f) return 0.0f;
-            return inter / uni;
-        }
-
         std::string resolve_path_or_throw(const std::string& p) {
             namespace fs = std::filesystem;
             if (fs::exists(fs::path(p))) return p;
@@ -169,6 +146,15 @@ namespace veilsight {
         }
     } // namespace
 
+    PreprocessKey scrfd_preprocess_key(const SCRFDModuleConfig& cfg) {
+        PreprocessKey key;
+        key.width = cfg.input_w;
+        key.height = cfg.input_h;
+        key.mean = {127.5f, 127.5f, 127.5f};
+        key.norm = {1.0f / 128.0f, 1.0f / 128.0f, 1.0f / 128.0f};
+        return key;
+    }
+
     class SCRFDDetector::Impl {
     public:
         explicit Impl(const SCRFDModuleConfig& cfg) {
@@ -187,34 +173,36 @@ namespace veilsight {
             net_.opt.num_threads = std::max(1, cfg.ncnn_threads);
             workspace_pool_allocator_.set_size_compare_ratio(0.0f);
 
-            const std::string param = resolve_path_or_throw(cfg.param_path);
-            const std::string bin = resolve_path_or_throw(cfg.bin_path);
-
-            if (net_.load_param(param.c_str()) != 0) {
-                throw std::runtime_error("Failed to load SCRFD param: " + param);
-            }
-            if (net_.load_model(bin.c_str()) != 0) {
-                throw std::runtime_error("Failed to load SCRFD weights: " + bin);
+            const NcnnModelProbe probe = scrfd_model_probe(cfg);
+            if (const auto tuning = resolve_ncnn_tuning(cfg.ncnn_autotune, probe)) {
+                apply_ncnn_tuning(net_.opt, *tuning);
             }
+            probe.load(net_);
         }
 
-        std::vector<FaceObservation> detect_faces(const cv::Mat& bgr, const SCRFDModuleConfig& cfg) {
+        std::vector<FaceObservation> detect_faces(const cv::Mat& bgr, const SCRFDModuleConfig& cfg,
+                                                  PreprocessCache* cache) {
             if (bgr.empty()) return {};
 
-            ncnn::Mat in = ncnn::Mat::from_pixels_resize(
-                bgr.data,
-                ncnn::Mat::PIXEL_BGR,
-                bgr.cols,
-                bgr.rows,
-                cfg.input_w,
-                cfg.input_h);
-
-            static const float mean_vals[3] = {127.5f, 127.5f, 127.5f};
-            static const float norm_vals[3] = {1.0f / 128.0f, 1.0f / 128.0f, 1.0f / 128.0f};
-            in.substract_mean_normalize(mean_vals, norm_vals);
+            const auto build = [&]() {
+                ncnn::Mat tensor = ncnn::Mat::from_pixels_resize(
+                    bgr.data,
+                    ncnn::Mat::PIXEL_BGR,
+                    bgr.cols,
+                    bgr.rows,
+                    static_cast<int>(bgr.step[0]),
+                    cfg.input_w,
+                    cfg.input_h);
+                static const float mean_vals[3] = {127.5f, 127.5f, 127.5f};
+                static const float norm_vals[3] = {1.0f / 128.0f, 1.0f / 128.0f, 1.0f / 128.0f};
+                tensor.substract_mean_normalize(mean_vals, norm_vals);
+                return tensor;
+            };
+            const ncnn::Mat in = cache ? cache->get(bgr, scrfd_preprocess_key(cfg), build) : build();
+            if (in.empty()) return {};
 
             ncnn::Extractor ex = net_.create_extractor();
-            ex.set_light_mode(true);
+            ex.set_light_mode(net_.opt.lightmode);
 
             thread_local ncnn::UnlockedPoolAllocator blob_pool_allocator;
             thread_local bool blob_pool_initialized = false;
@@ -317,40 +305,28 @@ namespace veilsight {
                 }
             }
 
-            std::vector<int> order(candidates.size());
-            for (size_t i = 0; i < candidates.size(); ++i) {
-                order[i] = static_cast<int>(i);
-            }
-
-            std::sort(order.begin(),
-                      order.end(),
-                      [&candidates](int a, int b) {
-                          return candidates[static_cast<size_t>(a)].score >
-                                 candidates[static_cast<size_t>(b)].score;
-                      });
-
-            if (cfg.top_k > 0 && static_cast<int>(order.size()) > cfg.top_k) {
-                order.resize(static_cast<size_t>(cfg.top_k));
-            }
-
-            std::vector<int> keep_indices;
-            keep_indices.reserve(order.size());
-            for (const int idx : order) {
-                const FaceObservation& candidate = candidates[static_cast<size_t>(idx)];
-                bool keep = true;
-                for (const int kept : keep_indices) {
-                    if (iou_of(candidate.bbox, candidates[static_cast<size_t>(kept)].bbox) > cfg.nms_threshold) {
-                        keep = false;
-                        break;
-                    }
-                }
-                if (keep) keep_indices.push_back(idx);
+            NmsCandidates boxes;
+            boxes.reserve(candidates.size());
+            for (const auto& candidate : candidates) {
+                boxes.push(candidate.bbox.x,
+                           candidate.bbox.y,
+                           candidate.bbox.x + candidate.bbox.w,
+                           candidate.bbox.y + candidate.bbox.h,
+                           candidate.score);
             }
+            NmsOptions nms;
+            nms.iou_threshold = cfg.nms_threshold;
+            nms.top_k = cfg.top_k;
+            nms.mode = nms_mode_from_str(cfg.nms_mode);
+            nms.soft_sigma = cfg.soft_nms_sigma;
+            nms.soft_min_score = cfg.score_threshold;
+            const std::vector<int> keep = non_max_suppression(boxes, nms);
 
             std::vector<FaceObservation> out_faces;
-            out_faces.reserve(keep_indices.size());
-            for (const int idx : keep_indices) {
-                out_faces.push_back(candidates[static_cast<size_t>(idx)]);
+            out_faces.reserve(keep.size());
+            for (const int idx : keep) {
+                out_faces.push_back(std::move(candidates[static_cast<size_t>(idx)]));
+                out_faces.back().score = boxes.score[static_cast<size_t>(idx)]; // decayed in soft mode
             }
             return out_faces;
         }
@@ -360,6 +336,26 @@ namespace veilsight {
         mutable ncnn::PoolAllocator workspace_pool_allocator_;
     };
 
+    NcnnModelProbe scrfd_model_probe(const SCRFDModuleConfig& cfg) {
+        NcnnModelProbe probe;
+        const auto [param_file, bin_file] = ncnn_model_files(cfg);
+        probe.name = cfg.precision == "int8" ? "scrfd_int8" : "scrfd";
+        probe.param_path = resolve_path_or_throw(param_file);
+        probe.bin_path = resolve_path_or_throw(bin_file);
+        probe.input_w = cfg.input_w;
+        probe.input_h = cfg.input_h;
+        probe.threads = std::max(1, cfg.ncnn_threads);
+        probe.load = [param = probe.param_path, bin = probe.bin_path](ncnn::Net& net) {
+            if (net.load_param(param.c_str()) != 0) {
+                throw std::runtime_error("Failed to load SCRFD param: " + param);
+            }
+            if (net.load_model(bin.c_str()) != 0) {
+                throw std::runtime_error("Failed to load SCRFD weights: " + bin);
+            }
+        };
+        return probe;
+    }
+
     SCRFDDetector::SCRFDDetector(SCRFDModuleConfig cfg)
         : cfg_(std::move(cfg)),
           impl_(std::make_unique<Impl>(cfg_)) {}
@@ -369,7 +365,7 @@ namespace veilsight {
     SCRFDDetector& SCRFDDetector::operator=(SCRFDDetector&&) noexcept = default;
 
     std::vector<Box> SCRFDDetector::detect(const cv::Mat& bgr) {
-        const auto faces = impl_->detect_faces(bgr, cfg_);
+        const auto faces = impl_->detect_faces(bgr, cfg_, nullptr);
         std::vector<Box> boxes;
         boxes.reserve(faces.size());
         for (const auto& face : faces) {
@@ -383,6 +379,6 @@ namespace veilsight {
         SCRFDModuleConfig run_cfg = cfg_;
         run_cfg.input_w = std::max(1, run.input_w);
         run_cfg.input_h = std::max(1, run.input_h);
-        return impl_->detect_faces(bgr, run_cfg);
+        return impl_->detect_faces(bgr, run_cfg, run.preprocess.get());
     }
 }
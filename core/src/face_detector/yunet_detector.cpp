@@ -1,5 +1,7 @@
 #include <face_detector/yunet_detector.hpp>
 
+#include <common/nms.hpp>
+
 #include <algorithm>
 #include <array>
 #include <cmath>
@@ -14,31 +16,6 @@
 
 namespace veilsight {
     namespace {
-        float area_of(const RectF& b) {
-            return std::max(0.0f, b.w) * std::max(0.0f, b.h);
-        }
-
-        float iou_of(const RectF& a, const RectF& b) {
-            const float ax2 = a.x + a.w;
-            const float ay2 = a.y + a.h;
-            const float bx2 = b.x + b.w;
-            const float by2 = b.y + b.h;
-
-            const float xx1 = std::max(a.x, b.x);
-            const float yy1 = std::max(a.y, b.y);
-            const float xx2 = std::min(ax2, bx2);
-            const float yy2 = std::min(ay2, by2);
-
-            const float iw = std::max(0.0f, xx2 - xx1);
-            const float ih = std::max(0.0f, yy2 - yy1);
-            const float inter = iw * ih;
-            if (inter <= 0.0f) return 0.0f;
-
-            const float uni = area_of(a) + area_of(b) - inter;
-            if (uni <= 0.0f) return 0.0f;
-            return inter / uni;
-        }
-
         std::string resolve_path_or_throw(const std::string& p) {
             namespace fs = std::filesystem;
             if (fs::exists(fs::path(p))) return p;
@@ -107,6 +84,13 @@ namespace veilsight {
         }
     } // namespace
 
+    PreprocessKey yunet_preprocess_key(const YuNetModuleConfig& cfg) {
+        PreprocessKey key;
+        key.width = cfg.input_w;
+        key.height = cfg.input_h;
+        return key;
+    }
+
     class YuNetDetector::Impl {
     public:
         explicit Impl(const YuNetModuleConfig& cfg) {
@@ -114,30 +98,32 @@ namespace veilsight {
             net_.opt.num_threads = std::max(1, cfg.ncnn_threads);
             workspace_pool_allocator_.set_size_compare_ratio(0.0f);
 
-            const std::string param = resolve_path_or_throw(cfg.param_path);
-            const std::string bin = resolve_path_or_throw(cfg.bin_path);
-
-            if (net_.load_param(param.c_str()) != 0) {
-                throw std::runtime_error("Failed to load YuNet param: " + param);
-            }
-            if (net_.load_model(bin.c_str()) != 0) {
-                throw std::runtime_error("Failed to load YuNet weights: " + bin);
+            const NcnnModelProbe probe = yunet_model_probe(cfg);
+            if (const auto tuning = resolve_ncnn_tuning(cfg.ncnn_autotune, probe)) {
+                apply_ncnn_tuning(net_.opt, *tuning);
             }
+            probe.load(net_);
         }
 
-        std::vector<FaceObservation> detect_faces(const cv::Mat& bgr, const YuNetModuleConfig& cfg) {
+        std::vector<FaceObservation> detect_faces(const cv::Mat& bgr, const YuNetModuleConfig& cfg,
+                                                  PreprocessCache* cache) {
             if (bgr.empty()) return {};
 
-            ncnn::Mat in = ncnn::Mat::from_pixels_resize(
-                bgr.data,
-                ncnn::Mat::PIXEL_BGR,
-                bgr.cols,
-                bgr.rows,
-                cfg.input_w,
-                cfg.input_h);
+            const auto build = [&]() {
+                return ncnn::Mat::from_pixels_resize(
+                    bgr.data,
+                    ncnn::Mat::PIXEL_BGR,
+                    bgr.cols,
+                    bgr.rows,
+                    static_cast<int>(bgr.step[0]),
+                    cfg.input_w,
+                    cfg.input_h);
+            };
+            const ncnn::Mat in = cache ? cache->get(bgr, yunet_preprocess_key(cfg), build) : build();
+            if (in.empty()) return {};
 
             ncnn::Extractor ex = net_.create_extractor();
-            ex.set_light_mode(true);
+            ex.set_light_mode(net_.opt.lightmode);
             thread_local ncnn::UnlockedPoolAllocator blob_pool_allocator;
             thread_local bool blob_pool_initialized = false;
             if (!blob_pool_initialized) {
@@ -230,40 +216,28 @@ namespace veilsight {
                 }
             }
 
-            std::vector<int> order(candidates.size());
-            for (size_t i = 0; i < candidates.size(); ++i) order[i] = static_cast<int>(i);
-
-            std::sort(order.begin(),
-                      order.end(),
-                      [&candidates](int a, int b) {
-                          return candidates[static_cast<size_t>(a)].score >
-                                 candidates[static_cast<size_t>(b)].score;
-                      });
-
-            if (cfg.top_k > 0 && static_cast<int>(order.size()) > cfg.top_k) {
-                order.resize(static_cast<size_t>(cfg.top_k));
+            NmsCandidates boxes;
+            boxes.reserve(candidates.size());
+            for (const auto& candidate : candidates) {
+                boxes.push(candidate.bbox.x,
+                           candidate.bbox.y,
+                           candidate.bbox.x + candidate.bbox.w,
+                           candidate.bbox.y + candidate.bbox.h,
+                           candidate.score);
             }
+            NmsOptions nms;
+            nms.iou_threshold = cfg.nms_threshold;
+            nms.top_k = cfg.top_k;
+            nms.mode = nms_mode_from_str(cfg.nms_mode);
+            nms.soft_sigma = cfg.soft_nms_sigma;
+            nms.soft_min_score = cfg.score_threshold;
+            const std::vector<int> keep = non_max_suppression(boxes, nms);
 
             std::vector<FaceObservation> out_boxes;
-            out_boxes.reserve(order.size());
-            std::vector<int> keep_indices;
-            keep_indices.reserve(order.size());
-
-            for (int idx : order) {
-                const FaceObservation& cand = candidates[static_cast<size_t>(idx)];
-                bool keep = true;
-                for (int kept : keep_indices) {
-                    if (iou_of(cand.bbox, candidates[static_cast<size_t>(kept)].bbox) > cfg.nms_threshold) {
-                        keep = false;
-                        break;
-                    }
-                }
-                if (keep) keep_indices.push_back(idx);
-            }
-
-            out_boxes.reserve(keep_indices.size());
-            for (int idx : keep_indices) {
-                out_boxes.push_back(candidates[static_cast<size_t>(idx)]);
+            out_boxes.reserve(keep.size());
+            for (const int idx : keep) {
+                out_boxes.push_back(std::move(candidates[static_cast<size_t>(idx)]));
+                out_boxes.back().score = boxes.score[static_cast<size_t>(idx)]; // decayed in soft mode
             }
             return out_boxes;
         }
@@ -273,6 +247,26 @@ namespace veilsight {
         mutable ncnn::PoolAllocator workspace_pool_allocator_;
     };
 
+    NcnnModelProbe yunet_model_probe(const YuNetModuleConfig& cfg) {
+        NcnnModelProbe probe;
+        const auto [param_file, bin_file] = ncnn_model_files(cfg);
+        probe.name = cfg.precision == "int8" ? "yunet_int8" : "yunet";
+        probe.param_path = resolve_path_or_throw(param_file);
+        probe.bin_path = resolve_path_or_throw(bin_file);
+        probe.input_w = cfg.input_w;
+        probe.input_h = cfg.input_h;
+        probe.threads = std::max(1, cfg.ncnn_threads);
+        probe.load = [param = probe.param_path, bin = probe.bin_path](ncnn::Net& net) {
+            if (net.load_param(param.c_str()) != 0) {
+                throw std::runtime_error("Failed to load YuNet param: " + param);
+            }
+            if (net.load_model(bin.c_str()) != 0) {
+                throw std::runtime_error("Failed to load YuNet weights: " + bin);
+            }
+        };
+        return probe;
+    }
+
     YuNetDetector::YuNetDetector(YuNetModuleConfig cfg)
         : cfg_(std::move(cfg)),
           impl_(std::make_unique<Impl>(cfg_)) {}
@@ -282,7 +276,7 @@ namespace veilsight {
     YuNetDetector& YuNetDetector::operator=(YuNetDetector&&) noexcept = default;
 
     std::vector<Box> YuNetDetector::detect(const cv::Mat& bgr) {
-        const auto faces = impl_->detect_faces(bgr, cfg_);
+        const auto faces = impl_->detect_faces(bgr, cfg_, nullptr);
         std::vector<Box> boxes;
         boxes.reserve(faces.size());
         for (const auto& face : faces) {
@@ -296,6 +290,6 @@ namespace veilsight {
         YuNetModuleConfig run_cfg = cfg_;
         run_cfg.input_w = std::max(1, run.input_w);
         run_cfg.input_h = std::max(1, run.input_h);
-        return impl_->detect_faces(bgr, run_cfg);
+        return impl_->detect_faces(bgr, run_cfg, run.preprocess.get());
     }
 }
@@ -0,0 +1,83 @@
+#include <person_detector/cascade_detector.hpp>
+
+#include <person_detector/uhd_detector.hpp>
+#include <person_detector/yolox_detector.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <utility>
+
+namespace veilsight {
+    namespace {
+        cv::Rect gate_crop(const std::vector<Box>& hits, cv::Size frame_size, float margin) {
+            float left = hits.front().x;
+            float top = hits.front().y;
+            float right = hits.front().x + hits.front().w;
+            float bottom = hits.front().y + hits.front().h;
+            for (const auto& hit : hits) {
+                left = std::min(left, hit.x);
+                top = std::min(top, hit.y);
+                right = std::max(right, hit.x + hit.w);
+                bottom = std::max(bottom, hit.y + hit.h);
+            }
+            const float pad_x = margin * (right - left);
+            const float pad_y = margin * (bottom - top);
+            const int x0 = static_cast<int>(std::floor(left - pad_x));
+            const int y0 = static_cast<int>(std::floor(top - pad_y));
+            const int x1 = static_cast<int>(std::ceil(right + pad_x));
+            const int y1 = static_cast<int>(std::ceil(bottom + pad_y));
+            return cv::Rect(x0, y0, x1 - x0, y1 - y0) & cv::Rect(0, 0, frame_size.width, frame_size.height);
+        }
+    }
+
+    CascadeDetector::CascadeDetector(PersonDetectorModuleConfig cfg)
+        : CascadeDetector(cfg.cascade,
+                          std::make_unique<UhdDetector>(cfg.uhd),
+                          std::make_unique<YoloXDetector>(cfg.yolox)) {}
+
+    CascadeDetector::CascadeDetector(CascadeModuleConfig cfg,
+                                     std::unique_ptr<IPersonDetector> gate,
+                                     std::unique_ptr<IPersonDetector> full)
+        : cfg_(std::move(cfg)),
+          gate_(std::move(gate)),
+          full_(std::move(full)) {
+        if (!gate_ || !full_) {
+            throw std::invalid_argument("[Cascade] gate and full detectors are required");
+        }
+    }
+
+    CascadeDetector::~CascadeDetector() = default;
+    CascadeDetector::CascadeDetector(CascadeDetector&&) noexcept = default;
+    CascadeDetector& CascadeDetector::operator=(CascadeDetector&&) noexcept = default;
+
+    std::vector<Box> CascadeDetector::detect(const cv::Mat& bgr) {
+        return detect(bgr, PersonDetectionHints{});
+    }
+
+    std::vector<Box> CascadeDetector::detect(const cv::Mat& bgr, const PersonDetectionHints& hints) {
+        if (bgr.empty()) return {};
+        if (hints.tracks_live || hints.refresh) {
+            return full_->detect(bgr, hints);
+        }
+
+        const auto hits = gate_->detect(bgr);
+        if (hits.empty()) return {};
+
+        const cv::Rect crop = gate_crop(hits, bgr.size(), cfg_.crop_margin);
+        const double frame_area = static_cast<double>(bgr.cols) * static_cast<double>(bgr.rows);
+        if (crop.area() < 4 || static_cast<double>(crop.area()) > cfg_.max_crop_area_ratio * frame_area) {
+            return full_->detect(bgr, hints);
+        }
+
+        // The adaptive input size is chosen for the whole frame; the ROI keeps the configured size.
+        PersonDetectionHints crop_hints = hints;
+        crop_hints.input_size = cv::Size();
+        auto boxes = full_->detect(bgr(crop), crop_hints);
+        for (auto& box : boxes) {
+            box.x += static_cast<float>(crop.x);
+            box.y += static_cast<float>(crop.y);
+        }
+        return boxes;
+    }
+}
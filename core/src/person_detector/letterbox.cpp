@@ -0,0 +1,226 @@
+#include <person_detector/letterbox.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace veilsight {
+    namespace {
+        void build_taps(int src, int dst, std::vector<int>& i0, std::vector<int>& i1, std::vector<float>& a,
+                        int step) {
+            i0.resize(static_cast<size_t>(dst));
+            i1.resize(static_cast<size_t>(dst));
+            a.resize(static_cast<size_t>(dst));
+            const double ratio = static_cast<double>(src) / static_cast<double>(dst);
+            for (int d = 0; d < dst; ++d) {
+                const double f = (static_cast<double>(d) + 0.5) * ratio - 0.5;
+                int s0 = static_cast<int>(std::floor(f));
+                float w = static_cast<float>(f - static_cast<double>(s0));
+                if (s0 < 0) {
+                    s0 = 0;
+                    w = 0.0f;
+                }
+                int s1 = s0 + 1;
+                if (s1 >= src) {
+                    s0 = std::min(s0, src - 1);
+                    s1 = s0;
+                    w = 0.0f;
+                }
+                i0[static_cast<size_t>(d)] = s0 * step;
+                i1[static_cast<size_t>(d)] = s1 * step;
+                a[static_cast<size_t>(d)] = w;
+            }
+        }
+
+        void horizontal_row(const unsigned char* row, const LetterboxLayout& layout, float* out) {
+            const int n = layout.resized_w;
+            float* r = out;
+            float* g = out + n;
+            float* b = out + 2 * n;
+            int dx = 0;
+#if defined(__AVX2__)
+            // Gathers one 32-bit word (B, G, R and the next pixel's B) per tap, so only columns whose right
+            // tap leaves a byte of the row after it are vectorized; the rest fall through to the scalar loop.
+            const int row_bytes = layout.src_w * 3;
+            int vector_end = n;
+            while (vector_end > 0 && layout.x1[static_cast<size_t>(vector_end - 1)] + 4 > row_bytes) --vector_end;
+            const int* base = reinterpret_cast<const int*>(row);
+            const __m256i low_byte = _mm256_set1_epi32(0xff);
+            for (; dx + 8 <= vector_end; dx += 8) {
+                const __m256i i0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(layout.x0.data() + dx));
+                const __m256i i1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(layout.x1.data() + dx));
+                const __m256i p0 = _mm256_i32gather_epi32(base, i0, 1);
+                const __m256i p1 = _mm256_i32gather_epi32(base, i1, 1);
+                const __m256 a = _mm256_loadu_ps(layout.ax.data() + dx);
+                const auto lerp = [&](int shift) {
+                    const __m256 v0 = _mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srli_epi32(p0, shift), low_byte));
+                    const __m256 v1 = _mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srli_epi32(p1, shift), low_byte));
+                    return _mm256_add_ps(v0, _mm256_mul_ps(a, _mm256_sub_ps(v1, v0)));
+                };
+                _mm256_storeu_ps(b + dx, lerp(0));
+                _mm256_storeu_ps(g + dx, lerp(8));
+                _mm256_storeu_ps(r + dx, lerp(16));
+            }
+#endif
+            for (; dx < n; ++dx) {
+                const unsigned char* p0 = row + layout.x0[static_cast<size_t>(dx)];
+                const unsigned char* p1 = row + layout.x1[static_cast<size_t>(dx)];
+                const float a = layout.ax[static_cast<size_t>(dx)];
+                const float b0 = static_cast<float>(p0[0]);
+                const float g0 = static_cast<float>(p0[1]);
+                const float r0 = static_cast<float>(p0[2]);
+                b[dx] = b0 + a * (static_cast<float>(p1[0]) - b0);
+                g[dx] = g0 + a * (static_cast<float>(p1[1]) - g0);
+                r[dx] = r0 + a * (static_cast<float>(p1[2]) - r0);
+            }
+        }
+
+        void vertical_blend(const float* top, const float* bottom, float w, float norm, float* out, int n) {
+            int i = 0;
+#if defined(__AVX2__)
+            const __m256 vw = _mm256_set1_ps(w);
+            const __m256 vn = _mm256_set1_ps(norm);
+            for (; i + 8 <= n; i += 8) {
+                const __m256 t = _mm256_loadu_ps(top + i);
+                const __m256 d = _mm256_sub_ps(_mm256_loadu_ps(bottom + i), t);
+                _mm256_storeu_ps(out + i, _mm256_mul_ps(_mm256_add_ps(t, _mm256_mul_ps(d, vw)), vn));
+            }
+#elif defined(__ARM_NEON)
+            const float32x4_t vw = vdupq_n_f32(w);
+            const float32x4_t vn = vdupq_n_f32(norm);
+            for (; i + 4 <= n; i += 4) {
+                const float32x4_t t = vld1q_f32(top + i);
+                const float32x4_t d = vsubq_f32(vld1q_f32(bottom + i), t);
+                vst1q_f32(out + i, vmulq_f32(vmlaq_f32(t, d, vw), vn));
+            }
+#endif
+            for (; i < n; ++i) {
+                out[i] = (top[i] + w * (bottom[i] - top[i])) * norm;
+            }
+        }
+    }
+
+    LetterboxLayout make_letterbox_layout(int src_w, int src_h, int dst_w, int dst_h, bool keep_aspect) {
+        if (src_w <= 0 || src_h <= 0 || dst_w <= 0 || dst_h <= 0) {
+            throw std::invalid_argument("[Letterbox] source and input sizes must be positive");
+        }
+
+        LetterboxLayout layout;
+        layout.src_w = src_w;
+        layout.src_h = src_h;
+        layout.dst_w = dst_w;
+        layout.dst_h = dst_h;
+        layout.keep_aspect = keep_aspect;
+
+        if (keep_aspect) {
+            const float sx = static_cast<float>(dst_w) / static_cast<float>(src_w);
+            const float sy = static_cast<float>(dst_h) / static_cast<float>(src_h);
+            const float scale = std::min(sx, sy);
+            layout.scale_x = scale;
+            layout.scale_y = scale;
+            layout.resized_w = std::clamp(static_cast<int>(std::round(static_cast<float>(src_w) * scale)), 1, dst_w);
+            layout.resized_h = std::clamp(static_cast<int>(std::round(static_cast<float>(src_h) * scale)), 1, dst_h);
+            layout.pad_x = std::max(0, (dst_w - layout.resized_w) / 2);
+            layout.pad_y = std::max(0, (dst_h - layout.resized_h) / 2);
+        } else {
+            layout.scale_x = static_cast<float>(dst_w) / static_cast<float>(src_w);
+            layout.scale_y = static_cast<float>(dst_h) / static_cast<float>(src_h);
+            layout.resized_w = dst_w;
+            layout.resized_h = dst_h;
+        }
+
+        build_taps(src_w, layout.resized_w, layout.x0, layout.x1, layout.ax, 3);
+        build_taps(src_h, layout.resized_h, layout.y0, layout.y1, layout.ay, 1);
+        return layout;
+    }
+
+    const LetterboxLayout& LetterboxLayoutCache::get(int src_w, int src_h, int dst_w, int dst_h, bool keep_aspect) {
+        ++clock_;
+        size_t victim = 0;
+        for (size_t i = 0; i < kCapacity; ++i) {
+            if (last_used_[i] != 0 && layouts_[i].matches(src_w, src_h, dst_w, dst_h, keep_aspect)) {
+                last_used_[i] = clock_;
+                return layouts_[i];
+            }
+            if (last_used_[i] < last_used_[victim]) victim = i;
+        }
+        layouts_[victim] = make_letterbox_layout(src_w, src_h, dst_w, dst_h, keep_aspect);
+        last_used_[victim] = clock_;
+        ++builds_;
+        return layouts_[victim];
+    }
+
+    void letterbox_bgr_to_planar_rgb(const cv::Mat& bgr,
+                                     const LetterboxLayout& layout,
+                                     float pad_value,
+                                     float norm,
+                                     float* dst,
+                                     size_t plane_stride) {
+        if (bgr.type() != CV_8UC3) {
+            throw std::invalid_argument("[Letterbox] expected a BGR8 image");
+        }
+        if (bgr.cols != layout.src_w || bgr.rows != layout.src_h) {
+            throw std::invalid_argument("[Letterbox] layout was built for " + std::to_string(layout.src_w) + "x" +
+                                        std::to_string(layout.src_h) + ", got " + std::to_string(bgr.cols) + "x" +
+                                        std::to_string(bgr.rows));
+        }
+
+        const int dst_w = layout.dst_w;
+        const int rw = layout.resized_w;
+        const int rh = layout.resized_h;
+        const float pad = pad_value * norm;
+
+        for (int c = 0; c < 3; ++c) {
+            float* plane = dst + static_cast<size_t>(c) * plane_stride;
+            std::fill(plane, plane + static_cast<size_t>(layout.pad_y) * static_cast<size_t>(dst_w), pad);
+            std::fill(plane + static_cast<size_t>(layout.pad_y + rh) * static_cast<size_t>(dst_w),
+                      plane + static_cast<size_t>(layout.dst_h) * static_cast<size_t>(dst_w),
+                      pad);
+            for (int y = layout.pad_y; y < layout.pad_y + rh; ++y) {
+                float* row = plane + static_cast<size_t>(y) * static_cast<size_t>(dst_w);
+                std::fill(row, row + layout.pad_x, pad);
+                std::fill(row + layout.pad_x + rw, row + dst_w, pad);
+            }
+        }
+
+        thread_local std::vector<float> buffers;
+        buffers.resize(static_cast<size_t>(rw) * 6);
+        float* slots[2] = {buffers.data(), buffers.data() + static_cast<size_t>(rw) * 3};
+        int cached[2] = {-1, -1};
+
+        const auto fetch = [&](int sy, int keep) -> const float* {
+            for (int s = 0; s < 2; ++s) {
+                if (cached[s] == sy) return slots[s];
+            }
+            const int slot = cached[0] == keep ? 1 : 0;
+            horizontal_row(bgr.ptr<unsigned char>(sy), layout, slots[slot]);
+            cached[slot] = sy;
+            return slots[slot];
+        };
+
+        for (int dy = 0; dy < rh; ++dy) {
+            const int sy0 = layout.y0[static_cast<size_t>(dy)];
+            const int sy1 = layout.y1[static_cast<size_t>(dy)];
+            const float* top = fetch(sy0, sy1);
+            const float* bottom = fetch(sy1, sy0);
+            const float w = layout.ay[static_cast<size_t>(dy)];
+            const size_t out_offset = static_cast<size_t>(layout.pad_y + dy) * static_cast<size_t>(dst_w) +
+                                      static_cast<size_t>(layout.pad_x);
+            for (int c = 0; c < 3; ++c) {
+                vertical_blend(top + static_cast<size_t>(c) * static_cast<size_t>(rw),
+                               bottom + static_cast<size_t>(c) * static_cast<size_t>(rw),
+                               w,
+                               norm,
+                               dst + static_cast<size_t>(c) * plane_stride + out_offset,
+                               rw);
+            }
+        }
+    }
+}
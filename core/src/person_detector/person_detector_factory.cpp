@@ -2,6 +2,7 @@
 
 #include <face_detector/scrfd_detector.hpp>
 #include <face_detector/yunet_detector.hpp>
+#include <person_detector/cascade_detector.hpp>
 #include <person_detector/uhd_detector.hpp>
 #include <person_detector/yolox_detector.hpp>
 
@@ -78,6 +79,23 @@ namespace veilsight {
         private:
             UhdModuleConfig cfg_;
         };
+
+        class CascadeDetectorFactory final : public IPersonDetectorFactory {
+        public:
+            explicit CascadeDetectorFactory(PersonDetectorModuleConfig cfg)
+                : cfg_(std::move(cfg)) {}
+
+            std::unique_ptr<IPersonDetector> create() const override {
+                return std::make_unique<CascadeDetector>(cfg_);
+            }
+
+            int backend_threads() const override {
+                return std::max({1, cfg_.uhd.ncnn_threads, cfg_.yolox.ncnn_threads});
+            }
+
+        private:
+            PersonDetectorModuleConfig cfg_;
+        };
     }
 
     std::unique_ptr<IPersonDetectorFactory> create_person_detector_factory(const PersonDetectorModuleConfig& cfg) {
@@ -93,10 +111,29 @@ namespace veilsight {
         if (cfg.type == "uhd") {
             return std::make_unique<UhdDetectorFactory>(cfg.uhd);
         }
+        if (cfg.type == "cascade") {
+            return std::make_unique<CascadeDetectorFactory>(cfg);
+        }
         throw std::invalid_argument("[Detector] Unsupported detector type: " + cfg.type);
     }
 
     std::unique_ptr<IPersonDetector> create_person_detector(const PersonDetectorModuleConfig& cfg) {
         return create_person_detector_factory(cfg)->create();
     }
+
+    cv::Size person_detector_input_size(const PersonDetectorModuleConfig& cfg) {
+        if (cfg.type.empty() || cfg.type == "yolox" || cfg.type == "cascade") {
+            return cv::Size(cfg.yolox.input_w, cfg.yolox.input_h);
+        }
+        if (cfg.type == "yunet") {
+            return cv::Size(cfg.yunet.input_w, cfg.yunet.input_h);
+        }
+        if (cfg.type == "scrfd") {
+            return cv::Size(cfg.scrfd.input_w, cfg.scrfd.input_h);
+        }
+        if (cfg.type == "uhd") {
+            return cv::Size(cfg.uhd.input_w, cfg.uhd.input_h);
+        }
+        throw std::invalid_argument("[Detector] Unsupported detector type: " + cfg.type);
+    }
 }
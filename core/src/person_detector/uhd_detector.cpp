@@ -1,9 +1,13 @@
 #include <person_detector/uhd_detector.hpp>
 
+#include <common/fast_math.hpp>
+#include <common/nms.hpp>
+
 #include <algorithm>
 #include <array>
 #include <cmath>
 #include <chrono>
+#include <cstdint>
 #include <fstream>
 #include <filesystem>
 #include <stdexcept>
@@ -51,44 +55,6 @@ namespace veilsight {
             {9.637338638305664f, 10.5896577835083f},
         }};
 
-        float area_of(const Box& b) {
-            return std::max(0.0f, b.w) * std::max(0.0f, b.h);
-        }
-
-        float iou_of(const Box& a, const Box& b) {
-            const float ax2 = a.x + a.w;
-            const float ay2 = a.y + a.h;
-            const float bx2 = b.x + b.w;
-            const float by2 = b.y + b.h;
-
-            const float xx1 = std::max(a.x, b.x);
-            const float yy1 = std::max(a.y, b.y);
-            const float xx2 = std::min(ax2, bx2);
-            const float yy2 = std::min(ay2, by2);
-
-            const float iw = std::max(0.0f, xx2 - xx1);
-            const float ih = std::max(0.0f, yy2 - yy1);
-            const float inter = iw * ih;
-            if (inter <= 0.0f) return 0.0f;
-
-            const float uni = area_of(a) + area_of(b) - inter;
-            if (uni <= 0.0f) return 0.0f;
-            return inter / uni;
-        }
-
-        float sigmoid(float x) {
-            if (x >= 0.0f) {
-                const float z = std::exp(-x);
-                return 1.0f / (1.0f + z);
-            }
-            const float z = std::exp(x);
-            return z / (1.0f + z);
-        }
-
-        float softplus(float x) {
-            return std::log1p(std::exp(-std::fabs(x))) + std::max(x, 0.0f);
-        }
-
         std::string resolve_path_or_throw(const std::string& p, const char* label) {
             namespace fs = std::filesystem;
             if (fs::exists(fs::path(p))) return p;
@@ -122,46 +88,12 @@ namespace veilsight {
             return out.dims == 3 && out.w == 8 && out.h == 8 && out.c == 56;
         }
 
-        float at_chw(const ncnn::Mat& out, int channel, int y, int x) {
-            const float* row = out.channel(channel).row(y);
-            return row[x];
-        }
-
-        float uhd_value(const ncnn::Mat& out, OutputLayout layout, int anchor, int field, int y, int x) {
-            int channel = anchor * 7 + field;
+        int uhd_channel(OutputLayout layout, int anchor, int field) {
             if (layout == OutputLayout::CatHeads) {
-                if (field < 4) {
-                    channel = anchor * 4 + field;
-                } else {
-                    channel = 32 + (field - 4) * 8 + anchor;
-                }
-            }
-            return at_chw(out, channel, y, x);
-        }
-
-        std::vector<Box> nms_sorted(std::vector<Box>& candidates, int top_k, float nms_threshold) {
-            std::sort(candidates.begin(),
-                      candidates.end(),
-                      [](const Box& a, const Box& b) {
-                          return a.score > b.score;
-                      });
-            if (top_k > 0 && static_cast<int>(candidates.size()) > top_k) {
-                candidates.resize(static_cast<size_t>(top_k));
-            }
-
-            std::vector<Box> boxes;
-            boxes.reserve(candidates.size());
-            for (const auto& candidate : candidates) {
-                bool keep = true;
-                for (const auto& kept : boxes) {
-                    if (iou_of(candidate, kept) > nms_threshold) {
-                        keep = false;
-                        break;
-                    }
-                }
-                if (keep) boxes.push_back(candidate);
+                if (field < 4) return anchor * 4 + field;
+                return 32 + (field - 4) * 8 + anchor;
             }
-            return boxes;
+            return anchor * 7 + field;
         }
 
         void validate_variant(const UhdModuleConfig& cfg) {
@@ -258,22 +190,10 @@ namespace veilsight {
 
             return ParamLoadPlan{patch_cat_output_param(param_path), OutputLayout::CatHeads, true};
         }
-    }
-
-    class UhdDetector::Impl {
-    public:
-        explicit Impl(const UhdModuleConfig& cfg) {
-            validate_variant(cfg);
 
-            net_.opt.use_vulkan_compute = false;
-            net_.opt.num_threads = std::max(1, cfg.ncnn_threads);
-            workspace_pool_allocator_.set_size_compare_ratio(0.0f);
-
-            const std::string param = resolve_path_or_throw(cfg.param_path, "param");
-            const std::string bin = resolve_path_or_throw(cfg.bin_path, "weights");
+        OutputLayout load_uhd_net(ncnn::Net& net, const std::string& param, const std::string& bin) {
             const ParamLoadPlan param_plan = make_param_load_plan(param);
-            output_layout_ = param_plan.layout;
-            if (net_.load_param(param_plan.path.c_str()) != 0) {
+            if (net.load_param(param_plan.path.c_str()) != 0) {
                 if (param_plan.remove_after_load) {
                     std::filesystem::remove(param_plan.path);
                 }
@@ -282,9 +202,27 @@ namespace veilsight {
             if (param_plan.remove_after_load) {
                 std::filesystem::remove(param_plan.path);
             }
-            if (net_.load_model(bin.c_str()) != 0) {
+            if (net.load_model(bin.c_str()) != 0) {
                 throw std::runtime_error("[UHD] Failed to load NCNN weights: " + bin);
             }
+            return param_plan.layout;
+        }
+    }
+
+    class UhdDetector::Impl {
+    public:
+        explicit Impl(const UhdModuleConfig& cfg) {
+            validate_variant(cfg);
+
+            net_.opt.use_vulkan_compute = false;
+            net_.opt.num_threads = std::max(1, cfg.ncnn_threads);
+            workspace_pool_allocator_.set_size_compare_ratio(0.0f);
+
+            const NcnnModelProbe probe = uhd_model_probe(cfg);
+            if (const auto tuning = resolve_ncnn_tuning(cfg.ncnn_autotune, probe)) {
+                apply_ncnn_tuning(net_.opt, *tuning);
+            }
+            output_layout_ = load_uhd_net(net_, probe.param_path, probe.bin_path);
         }
 
         std::vector<Box> detect(const cv::Mat& bgr, const UhdModuleConfig& cfg) {
@@ -301,7 +239,7 @@ namespace veilsight {
             in.substract_mean_normalize(nullptr, norm_vals);
 
             ncnn::Extractor ex = net_.create_extractor();
-            ex.set_light_mode(true);
+            ex.set_light_mode(net_.opt.lightmode);
             thread_local ncnn::UnlockedPoolAllocator blob_pool_allocator;
             thread_local bool blob_pool_initialized = false;
             if (!blob_pool_initialized) {
@@ -317,52 +255,81 @@ namespace veilsight {
             if (ex.extract("out0", out) != 0) return {};
             if (!has_supported_shape(out)) return {};
 
-            std::vector<Box> candidates;
+            NmsCandidates candidates;
             candidates.reserve(8 * 8 * 8);
 
+            // A product of three sigmoids can only reach the threshold if every factor does, so cells are
+            // rejected on raw logits before any transcendental is evaluated.
+            const float min_logit = logit_threshold(cfg.score_threshold);
+            static constexpr int kCells = 8 * 8;
             for (int a = 0; a < 8; ++a) {
-                for (int gy = 0; gy < 8; ++gy) {
-                    for (int gx = 0; gx < 8; ++gx) {
-                        const float tx = uhd_value(out, output_layout_, a, 0, gy, gx);
-                        const float ty = uhd_value(out, output_layout_, a, 1, gy, gx);
-                        const float tw = uhd_value(out, output_layout_, a, 2, gy, gx);
-                        const float th = uhd_value(out, output_layout_, a, 3, gy, gx);
-                        const float obj = uhd_value(out, output_layout_, a, 4, gy, gx);
-                        const float quality = uhd_value(out, output_layout_, a, 5, gy, gx);
-                        const float cls = uhd_value(out, output_layout_, a, 6, gy, gx);
-
-                        const float score = sigmoid(obj) * sigmoid(quality) * sigmoid(cls);
-                        if (score < cfg.score_threshold) continue;
-
-                        const float cx_norm = (sigmoid(tx) + static_cast<float>(gx)) / 8.0f;
-                        const float cy_norm = (sigmoid(ty) + static_cast<float>(gy)) / 8.0f;
-                        const float w_norm = kAnchors[static_cast<size_t>(a)][0] *
-                                             softplus(tw) *
-                                             kWhScale[static_cast<size_t>(a)][0];
-                        const float h_norm = kAnchors[static_cast<size_t>(a)][1] *
-                                             softplus(th) *
-                                             kWhScale[static_cast<size_t>(a)][1];
-
-                        const float cx = cx_norm * static_cast<float>(bgr.cols);
-                        const float cy = cy_norm * static_cast<float>(bgr.rows);
-                        const float w = w_norm * static_cast<float>(bgr.cols);
-                        const float h = h_norm * static_cast<float>(bgr.rows);
-
-                        Box box = clip_box(
-                            cx - 0.5f * w,
-                            cy - 0.5f * h,
-                            cx + 0.5f * w,
-                            cy + 0.5f * h,
-                            bgr.cols,
-                            bgr.rows);
-                        if (box.w <= 0.0f || box.h <= 0.0f) continue;
-                        box.score = score;
-                        candidates.push_back(box);
-                    }
+                const float* field[7];
+                for (int f = 0; f < 7; ++f) {
+                    field[f] = out.channel(uhd_channel(output_layout_, a, f));
+                }
+
+                uint8_t pass[kCells];
+                for (int i = 0; i < kCells; ++i) {
+                    pass[i] = static_cast<uint8_t>((field[4][i] >= min_logit) &
+                                                   (field[5][i] >= min_logit) &
+                                                   (field[6][i] >= min_logit));
+                }
+
+                for (int i = 0; i < kCells; ++i) {
+                    if (!pass[i]) continue;
+                    const float score = fast_sigmoid(field[4][i]) * fast_sigmoid(field[5][i]) *
+                                        fast_sigmoid(field[6][i]);
+                    if (score < cfg.score_threshold) continue;
+
+                    const int gy = i / 8;
+                    const int gx = i - gy * 8;
+                    const float cx_norm = (fast_sigmoid(field[0][i]) + static_cast<float>(gx)) / 8.0f;
+                    const float cy_norm = (fast_sigmoid(field[1][i]) + static_cast<float>(gy)) / 8.0f;
+                    const float w_norm = kAnchors[static_cast<size_t>(a)][0] *
+                                         fast_softplus(field[2][i]) *
+                                         kWhScale[static_cast<size_t>(a)][0];
+                    const float h_norm = kAnchors[static_cast<size_t>(a)][1] *
+                                         fast_softplus(field[3][i]) *
+                                         kWhScale[static_cast<size_t>(a)][1];
+
+                    const float cx = cx_norm * static_cast<float>(bgr.cols);
+                    const float cy = cy_norm * static_cast<float>(bgr.rows);
+                    const float w = w_norm * static_cast<float>(bgr.cols);
+                    const float h = h_norm * static_cast<float>(bgr.rows);
+
+                    const Box box = clip_box(
+                        cx - 0.5f * w,
+                        cy - 0.5f * h,
+                        cx + 0.5f * w,
+                        cy + 0.5f * h,
+                        bgr.cols,
+                        bgr.rows);
+                    if (box.w <= 0.0f || box.h <= 0.0f) continue;
+                    candidates.push(box.x, box.y, box.x + box.w, box.y + box.h, score);
                 }
             }
 
-            return nms_sorted(candidates, cfg.top_k, cfg.nms_threshold);
+            NmsOptions nms;
+            nms.iou_threshold = cfg.nms_threshold;
+            nms.top_k = cfg.top_k;
+            nms.mode = nms_mode_from_str(cfg.nms_mode);
+            nms.soft_sigma = cfg.soft_nms_sigma;
+            nms.soft_min_score = cfg.score_threshold;
+            const std::vector<int> keep = non_max_suppression(candidates, nms);
+
+            std::vector<Box> boxes;
+            boxes.reserve(keep.size());
+            for (const int idx : keep) {
+                const size_t i = static_cast<size_t>(idx);
+                Box box;
+                box.x = candidates.x1[i];
+                box.y = candidates.y1[i];
+                box.w = candidates.x2[i] - candidates.x1[i];
+                box.h = candidates.y2[i] - candidates.y1[i];
+                box.score = candidates.score[i];
+                boxes.push_back(box);
+            }
+            return boxes;
         }
 
     private:
@@ -371,6 +338,20 @@ namespace veilsight {
         mutable ncnn::PoolAllocator workspace_pool_allocator_;
     };
 
+    NcnnModelProbe uhd_model_probe(const UhdModuleConfig& cfg) {
+        NcnnModelProbe probe;
+        probe.name = "uhd";
+        probe.param_path = resolve_path_or_throw(cfg.param_path, "param");
+        probe.bin_path = resolve_path_or_throw(cfg.bin_path, "weights");
+        probe.input_w = cfg.input_w;
+        probe.input_h = cfg.input_h;
+        probe.threads = std::max(1, cfg.ncnn_threads);
+        probe.load = [param = probe.param_path, bin = probe.bin_path](ncnn::Net& net) {
+            (void)load_uhd_net(net, param, bin);
+        };
+        return probe;
+    }
+
     UhdDetector::UhdDetector(UhdModuleConfig cfg)
         : cfg_(std::move(cfg)),
           impl_(std::make_unique<Impl>(cfg_)) {}
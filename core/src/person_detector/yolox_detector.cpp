@@ -1,7 +1,12 @@
 #include <person_detector/yolox_detector.hpp>
 
+#include <common/fast_math.hpp>
+#include <common/nms.hpp>
+#include <person_detector/letterbox.hpp>
+
 #include <algorithm>
 #include <cmath>
+#include <cstdint>
 #include <filesystem>
 #include <stdexcept>
 #include <string>
@@ -11,7 +16,10 @@
 #include <ncnn/allocator.h>
 #include <ncnn/layer.h>
 #include <ncnn/net.h>
-#include <opencv2/imgproc.hpp>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
 
 namespace veilsight {
     namespace {
@@ -57,42 +65,6 @@ namespace veilsight {
 
         DEFINE_LAYER_CREATOR(YoloV5Focus)
 
-        struct LetterboxInfo {
-            float scale_x = 1.0f;
-            float scale_y = 1.0f;
-            float pad_x = 0.0f;
-            float pad_y = 0.0f;
-        };
-
-        struct DetectionRow {
-            float values[6]{};
-        };
-
-        float area_of(const Box& b) {
-            return std::max(0.0f, b.w) * std::max(0.0f, b.h);
-        }
-
-        float iou_of(const Box& a, const Box& b) {
-            const float ax2 = a.x + a.w;
-            const float ay2 = a.y + a.h;
-            const float bx2 = b.x + b.w;
-            const float by2 = b.y + b.h;
-
-            const float xx1 = std::max(a.x, b.x);
-            const float yy1 = std::max(a.y, b.y);
-            const float xx2 = std::min(ax2, bx2);
-            const float yy2 = std::min(ay2, by2);
-
-            const float iw = std::max(0.0f, xx2 - xx1);
-            const float ih = std::max(0.0f, yy2 - yy1);
-            const float inter = iw * ih;
-            if (inter <= 0.0f) return 0.0f;
-
-            const float uni = area_of(a) + area_of(b) - inter;
-            if (uni <= 0.0f) return 0.0f;
-            return inter / uni;
-        }
-
         std::string resolve_path_or_throw(const std::string& p) {
             namespace fs = std::filesystem;
             if (fs::exists(fs::path(p))) return p;
@@ -107,37 +79,6 @@ namespace veilsight {
             throw std::runtime_error("Model path not found: " + p);
         }
 
-        cv::Mat make_input(const cv::Mat& bgr, const YoloXModuleConfig& cfg, LetterboxInfo& info) {
-            if (!cfg.letterbox) {
-                info.scale_x = static_cast<float>(cfg.input_w) / static_cast<float>(std::max(1, bgr.cols));
-                info.scale_y = static_cast<float>(cfg.input_h) / static_cast<float>(std::max(1, bgr.rows));
-                info.pad_x = 0.0f;
-                info.pad_y = 0.0f;
-                cv::Mat resized;
-                cv::resize(bgr, resized, cv::Size(cfg.input_w, cfg.input_h));
-                return resized;
-            }
-
-            const float sx = static_cast<float>(cfg.input_w) / static_cast<float>(std::max(1, bgr.cols));
-            const float sy = static_cast<float>(cfg.input_h) / static_cast<float>(std::max(1, bgr.rows));
-            const float scale = std::min(sx, sy);
-            info.scale_x = scale;
-            info.scale_y = scale;
-
-            const int resized_w = std::max(1, static_cast<int>(std::round(static_cast<float>(bgr.cols) * scale)));
-            const int resized_h = std::max(1, static_cast<int>(std::round(static_cast<float>(bgr.rows) * scale)));
-            const int pad_x = std::max(0, (cfg.input_w - resized_w) / 2);
-            const int pad_y = std::max(0, (cfg.input_h - resized_h) / 2);
-            info.pad_x = static_cast<float>(pad_x);
-            info.pad_y = static_cast<float>(pad_y);
-
-            cv::Mat resized;
-            cv::resize(bgr, resized, cv::Size(resized_w, resized_h));
-            cv::Mat canvas(cfg.input_h, cfg.input_w, bgr.type(), cv::Scalar(114, 114, 114));
-            resized.copyTo(canvas(cv::Rect(pad_x, pad_y, resized_w, resized_h)));
-            return canvas;
-        }
-
         Box clip_box(float x1, float y1, float x2, float y2, int width, int height) {
             x1 = std::clamp(x1, 0.0f, static_cast<float>(width));
             y1 = std::clamp(y1, 0.0f, static_cast<float>(height));
@@ -153,93 +94,117 @@ namespace veilsight {
             return out;
         }
 
-        std::vector<DetectionRow> rows_from_output(const ncnn::Mat& out) {
-            std::vector<DetectionRow> rows;
+        // A run of detection rows inside the raw output tensor. Row i, field k lives at
+        // data[i * row_stride + k * field_stride].
+        struct OutputView {
+            const float* data = nullptr;
+            size_t rows = 0;
+            size_t row_stride = 0;
+            size_t field_stride = 0;
+        };
+
+        std::vector<OutputView> output_views(const ncnn::Mat& out) {
             const float* data = static_cast<const float*>(out.data);
-            if (!data || out.total() < 6) return rows;
+            if (!data || out.total() < 6) return {};
 
             if (out.dims == 2 && out.w == 6) {
-                rows.reserve(static_cast<size_t>(out.h));
-                for (int y = 0; y < out.h; ++y) {
-                    DetectionRow row;
-                    for (int k = 0; k < 6; ++k) row.values[k] = data[static_cast<size_t>(y * out.w + k)];
-                    rows.push_back(row);
-                }
-                return rows;
+                return {OutputView{data, static_cast<size_t>(out.h), 6, 1}};
             }
-
             if (out.dims == 2 && out.h == 6) {
-                rows.reserve(static_cast<size_t>(out.w));
-                for (int x = 0; x < out.w; ++x) {
-                    DetectionRow row;
-                    for (int k = 0; k < 6; ++k) row.values[k] = data[static_cast<size_t>(k * out.w + x)];
-                    rows.push_back(row);
-                }
-                return rows;
+                return {OutputView{data, static_cast<size_t>(out.w), 1, static_cast<size_t>(out.w)}};
             }
-
             if (out.dims == 3 && out.w == 6) {
-                rows.reserve(static_cast<size_t>(out.c * out.h));
+                std::vector<OutputView> views;
+                views.reserve(static_cast<size_t>(out.c));
                 for (int q = 0; q < out.c; ++q) {
-                    const float* channel = out.channel(q);
-                    for (int y = 0; y < out.h; ++y) {
-                        DetectionRow row;
-                        for (int k = 0; k < 6; ++k) row.values[k] = channel[static_cast<size_t>(y * out.w + k)];
-                        rows.push_back(row);
-                    }
+                    views.push_back(OutputView{out.channel(q), static_cast<size_t>(out.h), 6, 1});
                 }
-                return rows;
+                return views;
             }
+            return {OutputView{data, out.total() / 6, 6, 1}};
+        }
 
-            const size_t count = out.total() / 6;
-            rows.reserve(count);
-            for (size_t i = 0; i < count; ++i) {
-                DetectionRow row;
-                for (int k = 0; k < 6; ++k) row.values[k] = data[i * 6 + static_cast<size_t>(k)];
-                rows.push_back(row);
+        // Appends rows whose clamp(obj) * clamp(cls) reaches the threshold. Row indices are offset by `base`.
+        void collect_scored_rows(const OutputView& view,
+                                 float threshold,
+                                 uint32_t base,
+                                 std::vector<uint32_t>& indices,
+                                 std::vector<float>& scores) {
+            const float* obj = view.data + 4 * view.field_stride;
+            const float* cls = view.data + 5 * view.field_stride;
+            size_t i = 0;
+#if defined(__AVX2__)
+            if (view.row_stride == 1) {
+                const __m256 zero = _mm256_setzero_ps();
+                const __m256 one = _mm256_set1_ps(1.0f);
+                const __m256 thr = _mm256_set1_ps(threshold);
+                alignas(32) float lane_scores[8];
+                for (; i + 8 <= view.rows; i += 8) {
+                    const __m256 o = _mm256_min_ps(_mm256_max_ps(_mm256_loadu_ps(obj + i), zero), one);
+                    const __m256 c = _mm256_min_ps(_mm256_max_ps(_mm256_loadu_ps(cls + i), zero), one);
+                    const __m256 score = _mm256_mul_ps(o, c);
+                    int mask = _mm256_movemask_ps(_mm256_cmp_ps(score, thr, _CMP_GE_OQ));
+                    if (mask == 0) continue;
+                    _mm256_store_ps(lane_scores, score);
+                    while (mask != 0) {
+                        const int lane = __builtin_ctz(static_cast<unsigned>(mask));
+                        indices.push_back(base + static_cast<uint32_t>(i + static_cast<size_t>(lane)));
+                        scores.push_back(lane_scores[lane]);
+                        mask &= mask - 1;
+                    }
+                }
+            }
+#endif
+            for (; i < view.rows; ++i) {
+                const size_t off = i * view.row_stride;
+                const float o = std::clamp(obj[off], 0.0f, 1.0f);
+                if (o < threshold) continue;
+                const float score = o * std::clamp(cls[off], 0.0f, 1.0f);
+                if (score < threshold) continue;
+                indices.push_back(base + static_cast<uint32_t>(i));
+                scores.push_back(score);
             }
-            return rows;
         }
 
-        void decode_raw_yolox(float raw_x,
-                              float raw_y,
-                              float raw_w,
-                              float raw_h,
-                              size_t index,
-                              int input_w,
-                              int input_h,
-                              int& x1,
-                              int& y1,
-                              float& cx,
-                              float& cy,
-                              float& w,
-                              float& h) {
-            static constexpr int kStrides[3] = {8, 16, 32};
-            size_t offset = 0;
-            for (int stride : kStrides) {
-                const int grid_w = std::max(1, input_w / stride);
-                const int grid_h = std::max(1, input_h / stride);
-                const size_t level_count = static_cast<size_t>(grid_w) * static_cast<size_t>(grid_h);
-                if (index < offset + level_count) {
-                    const size_t local = index - offset;
-                    x1 = static_cast<int>(local % static_cast<size_t>(grid_w));
-                    y1 = static_cast<int>(local / static_cast<size_t>(grid_w));
-                    cx = (raw_x + static_cast<float>(x1)) * static_cast<float>(stride);
-                    cy = (raw_y + static_cast<float>(y1)) * static_cast<float>(stride);
-                    w = std::exp(raw_w) * static_cast<float>(stride);
-                    h = std::exp(raw_h) * static_cast<float>(stride);
-                    return;
+        // Grid cell and stride for every anchor point of the raw (undecoded) YOLOX head.
+        struct GridTable {
+            int input_w = 0;
+            int input_h = 0;
+            std::vector<float> grid_x;
+            std::vector<float> grid_y;
+            std::vector<float> stride;
+
+            void build(int w, int h) {
+                input_w = w;
+                input_h = h;
+                grid_x.clear();
+                grid_y.clear();
+                stride.clear();
+                static constexpr int kStrides[3] = {8, 16, 32};
+                for (const int s : kStrides) {
+                    const int grid_w = std::max(1, w / s);
+                    const int grid_h = std::max(1, h / s);
+                    for (int y = 0; y < grid_h; ++y) {
+                        for (int x = 0; x < grid_w; ++x) {
+                            grid_x.push_back(static_cast<float>(x));
+                            grid_y.push_back(static_cast<float>(y));
+                            stride.push_back(static_cast<float>(s));
+                        }
+                    }
                 }
-                offset += level_count;
             }
+        };
+    }
 
-            x1 = 0;
-            y1 = 0;
-            cx = raw_x;
-            cy = raw_y;
-            w = raw_w;
-            h = raw_h;
-        }
+    PreprocessKey yolox_preprocess_key(const YoloXModuleConfig& cfg) {
+        PreprocessKey key;
+        key.width = cfg.input_w;
+        key.height = cfg.input_h;
+        key.resize = cfg.letterbox ? PreprocessResize::Letterbox : PreprocessResize::Stretch;
+        key.pad_value = 114.0f;
+        key.rgb = true;
+        key.norm = {1.0f / 255.0f, 1.0f / 255.0f, 1.0f / 255.0f};
+        return key;
     }
 
     class YoloXDetector::Impl {
@@ -249,33 +214,42 @@ namespace veilsight {
             net_.opt.num_threads = std::max(1, cfg.ncnn_threads);
             workspace_pool_allocator_.set_size_compare_ratio(0.0f);
 
-            const std::string param = resolve_path_or_throw(cfg.param_path);
-            const std::string bin = resolve_path_or_throw(cfg.bin_path);
-
-            net_.register_custom_layer("YoloV5Focus", YoloV5Focus_layer_creator);
-            if (net_.load_param(param.c_str()) != 0) {
-                throw std::runtime_error("Failed to load YOLOX NCNN param: " + param);
-            }
-            if (net_.load_model(bin.c_str()) != 0) {
-                throw std::runtime_error("Failed to load YOLOX NCNN weights: " + bin);
+            const NcnnModelProbe probe = yolox_model_probe(cfg);
+            if (const auto tuning = resolve_ncnn_tuning(cfg.ncnn_autotune, probe)) {
+                apply_ncnn_tuning(net_.opt, *tuning);
             }
+            probe.load(net_);
         }
 
-        std::vector<Box> detect(const cv::Mat& bgr, const YoloXModuleConfig& cfg) {
+        std::vector<Box> detect(const cv::Mat& bgr, const YoloXModuleConfig& cfg, PreprocessCache* cache) {
             if (bgr.empty()) return {};
 
-            LetterboxInfo letterbox;
-            const cv::Mat input = make_input(bgr, cfg, letterbox);
-            ncnn::Mat in = ncnn::Mat::from_pixels(
-                input.data,
-                ncnn::Mat::PIXEL_BGR2RGB,
-                input.cols,
-                input.rows);
-            static const float norm_vals[3] = {1.0f / 255.0f, 1.0f / 255.0f, 1.0f / 255.0f};
-            in.substract_mean_normalize(nullptr, norm_vals);
+            const LetterboxLayout& layout =
+                layouts_.get(bgr.cols, bgr.rows, cfg.input_w, cfg.input_h, cfg.letterbox);
+            ncnn::Mat shared_input;
+            if (cache) {
+                shared_input = cache->get(bgr, yolox_preprocess_key(cfg), [&]() {
+                    ncnn::Mat tensor(cfg.input_w, cfg.input_h, 3);
+                    if (!tensor.empty()) {
+                        letterbox_bgr_to_planar_rgb(
+                            bgr, layout, 114.0f, 1.0f / 255.0f, static_cast<float*>(tensor.data), tensor.cstep);
+                    }
+                    return tensor;
+                });
+                if (shared_input.empty()) return {};
+            } else {
+                input_.create(cfg.input_w, cfg.input_h, 3);
+                if (input_.empty()) return {};
+                letterbox_bgr_to_planar_rgb(bgr,
+                                            layout,
+                                            114.0f,
+                                            1.0f / 255.0f,
+                                            static_cast<float*>(input_.data),
+                                            input_.cstep);
+            }
 
             ncnn::Extractor ex = net_.create_extractor();
-            ex.set_light_mode(true);
+            ex.set_light_mode(net_.opt.lightmode);
             thread_local ncnn::UnlockedPoolAllocator blob_pool_allocator;
             thread_local bool blob_pool_initialized = false;
             if (!blob_pool_initialized) {
@@ -285,47 +259,47 @@ namespace veilsight {
             ex.set_blob_allocator(&blob_pool_allocator);
             ex.set_workspace_allocator(&workspace_pool_allocator_);
 
-            if (ex.input("in0", in) != 0) return {};
+            if (ex.input("in0", cache ? shared_input : input_) != 0) return {};
 
             ncnn::Mat out;
             if (ex.extract("out0", out) != 0) return {};
 
-            const std::vector<DetectionRow> rows = rows_from_output(out);
-            std::vector<Box> candidates;
-            candidates.reserve(rows.size());
-
-            for (size_t i = 0; i < rows.size(); ++i) {
-                const float* r = rows[i].values;
-                const float objectness = std::clamp(r[4], 0.0f, 1.0f);
-                const float class_score = std::clamp(r[5], 0.0f, 1.0f);
-                const float score = objectness * class_score;
-                if (score < cfg.score_threshold) continue;
-
-                float cx = 0.0f;
-                float cy = 0.0f;
-                float w = 0.0f;
-                float h = 0.0f;
-                if (cfg.decoded_output) {
-                    cx = r[0];
-                    cy = r[1];
-                    w = r[2];
-                    h = r[3];
-                } else {
-                    int grid_x = 0;
-                    int grid_y = 0;
-                    decode_raw_yolox(r[0],
-                                     r[1],
-                                     r[2],
-                                     r[3],
-                                     i,
-                                     cfg.input_w,
-                                     cfg.input_h,
-                                     grid_x,
-                                     grid_y,
-                                     cx,
-                                     cy,
-                                     w,
-                                     h);
+            const float pad_x = static_cast<float>(layout.pad_x);
+            const float pad_y = static_cast<float>(layout.pad_y);
+            const std::vector<OutputView> views = output_views(out);
+            score_indices_.clear();
+            score_values_.clear();
+            uint32_t base = 0;
+            for (const auto& view : views) {
+                collect_scored_rows(view, cfg.score_threshold, base, score_indices_, score_values_);
+                base += static_cast<uint32_t>(view.rows);
+            }
+            const GridTable* grid = cfg.decoded_output ? nullptr : &grid_for_(cfg.input_w, cfg.input_h);
+
+            NmsCandidates candidates;
+            candidates.reserve(score_indices_.size());
+            size_t view_index = 0;
+            size_t view_base = 0;
+            for (size_t k = 0; k < score_indices_.size(); ++k) {
+                const size_t i = score_indices_[k];
+                while (i >= view_base + views[view_index].rows) {
+                    view_base += views[view_index].rows;
+                    ++view_index;
+                }
+                const OutputView& view = views[view_index];
+                const float* r = view.data + (i - view_base) * view.row_stride;
+                const size_t fs = view.field_stride;
+
+                float cx = r[0];
+                float cy = r[fs];
+                float w = r[2 * fs];
+                float h = r[3 * fs];
+                if (grid && i < grid->stride.size()) {
+                    const float stride = grid->stride[i];
+                    cx = (cx + grid->grid_x[i]) * stride;
+                    cy = (cy + grid->grid_y[i]) * stride;
+                    w = fast_exp(w) * stride;
+                    h = fast_exp(h) * stride;
                 }
 
                 float x1 = cx - w * 0.5f;
@@ -333,56 +307,79 @@ namespace veilsight {
                 float x2 = cx + w * 0.5f;
                 float y2 = cy + h * 0.5f;
 
-                x1 = (x1 - letterbox.pad_x) / letterbox.scale_x;
-                x2 = (x2 - letterbox.pad_x) / letterbox.scale_x;
-                y1 = (y1 - letterbox.pad_y) / letterbox.scale_y;
-                y2 = (y2 - letterbox.pad_y) / letterbox.scale_y;
+                x1 = (x1 - pad_x) / layout.scale_x;
+                x2 = (x2 - pad_x) / layout.scale_x;
+                y1 = (y1 - pad_y) / layout.scale_y;
+                y2 = (y2 - pad_y) / layout.scale_y;
 
-                Box box = clip_box(x1, y1, x2, y2, bgr.cols, bgr.rows);
+                const Box box = clip_box(x1, y1, x2, y2, bgr.cols, bgr.rows);
                 if (box.w <= 0.0f || box.h <= 0.0f) continue;
-                box.score = score;
-                candidates.push_back(std::move(box));
+                candidates.push(box.x, box.y, box.x + box.w, box.y + box.h, score_values_[k]);
             }
 
-            std::vector<int> order(candidates.size());
-            for (size_t i = 0; i < candidates.size(); ++i) order[i] = static_cast<int>(i);
-            std::sort(order.begin(),
-                      order.end(),
-                      [&candidates](int a, int b) {
-                          return candidates[static_cast<size_t>(a)].score >
-                                 candidates[static_cast<size_t>(b)].score;
-                      });
-            if (cfg.top_k > 0 && static_cast<int>(order.size()) > cfg.top_k) {
-                order.resize(static_cast<size_t>(cfg.top_k));
-            }
-
-            std::vector<int> keep_indices;
-            keep_indices.reserve(order.size());
-            for (const int idx : order) {
-                const Box& candidate = candidates[static_cast<size_t>(idx)];
-                bool keep = true;
-                for (const int kept : keep_indices) {
-                    if (iou_of(candidate, candidates[static_cast<size_t>(kept)]) > cfg.nms_threshold) {
-                        keep = false;
-                        break;
-                    }
-                }
-                if (keep) keep_indices.push_back(idx);
-            }
+            NmsOptions nms;
+            nms.iou_threshold = cfg.nms_threshold;
+            nms.top_k = cfg.top_k;
+            nms.mode = nms_mode_from_str(cfg.nms_mode);
+            nms.soft_sigma = cfg.soft_nms_sigma;
+            nms.soft_min_score = cfg.score_threshold;
+            const std::vector<int> keep = non_max_suppression(candidates, nms);
 
             std::vector<Box> boxes;
-            boxes.reserve(keep_indices.size());
-            for (const int idx : keep_indices) {
-                boxes.push_back(candidates[static_cast<size_t>(idx)]);
+            boxes.reserve(keep.size());
+            for (const int idx : keep) {
+                const size_t i = static_cast<size_t>(idx);
+                Box box;
+                box.x = candidates.x1[i];
+                box.y = candidates.y1[i];
+                box.w = candidates.x2[i] - candidates.x1[i];
+                box.h = candidates.y2[i] - candidates.y1[i];
+                box.score = candidates.score[i];
+                boxes.push_back(box);
             }
             return boxes;
         }
 
     private:
+        // One table per input size, so adaptive resolution switching between its levels never rebuilds them.
+        const GridTable& grid_for_(int w, int h) {
+            for (const auto& grid : grids_) {
+                if (grid.input_w == w && grid.input_h == h) return grid;
+            }
+            grids_.emplace_back().build(w, h);
+            return grids_.back();
+        }
+
         ncnn::Net net_;
         mutable ncnn::PoolAllocator workspace_pool_allocator_;
+        LetterboxLayoutCache layouts_;
+        ncnn::Mat input_;
+        std::vector<GridTable> grids_;
+        std::vector<uint32_t> score_indices_;
+        std::vector<float> score_values_;
     };
 
+    NcnnModelProbe yolox_model_probe(const YoloXModuleConfig& cfg) {
+        NcnnModelProbe probe;
+        const auto [param_file, bin_file] = ncnn_model_files(cfg);
+        probe.name = cfg.precision == "int8" ? "yolox_int8" : "yolox";
+        probe.param_path = resolve_path_or_throw(param_file);
+        probe.bin_path = resolve_path_or_throw(bin_file);
+        probe.input_w = cfg.input_w;
+        probe.input_h = cfg.input_h;
+        probe.threads = std::max(1, cfg.ncnn_threads);
+        probe.load = [param = probe.param_path, bin = probe.bin_path](ncnn::Net& net) {
+            net.register_custom_layer("YoloV5Focus", YoloV5Focus_layer_creator);
+            if (net.load_param(param.c_str()) != 0) {
+                throw std::runtime_error("Failed to load YOLOX NCNN param: " + param);
+            }
+            if (net.load_model(bin.c_str()) != 0) {
+                throw std::runtime_error("Failed to load YOLOX NCNN weights: " + bin);
+            }
+        };
+        return probe;
+    }
+
     YoloXDetector::YoloXDetector(YoloXModuleConfig cfg)
         : cfg_(std::move(cfg)),
           impl_(std::make_unique<Impl>(cfg_)) {}
@@ -392,6 +389,17 @@ namespace veilsight {
     YoloXDetector& YoloXDetector::operator=(YoloXDetector&&) noexcept = default;
 
     std::vector<Box> YoloXDetector::detect(const cv::Mat& bgr) {
-        return impl_->detect(bgr, cfg_);
+        return impl_->detect(bgr, cfg_, nullptr);
+    }
+
+    std::vector<Box> YoloXDetector::detect(const cv::Mat& bgr, const PersonDetectionHints& hints) {
+        if (hints.input_size.empty() ||
+            (hints.input_size.width == cfg_.input_w && hints.input_size.height == cfg_.input_h)) {
+            return impl_->detect(bgr, cfg_, hints.preprocess.get());
+        }
+        YoloXModuleConfig cfg = cfg_;
+        cfg.input_w = hints.input_size.width;
+        cfg.input_h = hints.input_size.height;
+        return impl_->detect(bgr, cfg, hints.preprocess.get());
     }
 }
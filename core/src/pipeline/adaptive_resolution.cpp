@@ -0,0 +1,95 @@
+#include <pipeline/adaptive_resolution.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+namespace veilsight {
+    namespace {
+        int round_to_stride(float value) {
+            constexpr int kStride = 32;
+            return std::max(kStride, static_cast<int>(std::lround(value / kStride)) * kStride);
+        }
+
+        float tenth_percentile(std::vector<float>& values) {
+            if (values.empty()) return 0.0f;
+            const size_t k = values.size() / 10;
+            std::nth_element(values.begin(), values.begin() + static_cast<std::ptrdiff_t>(k), values.end());
+            return values[k];
+        }
+    }
+
+    AdaptiveResolution::AdaptiveResolution(AdaptiveResolutionConfig cfg, cv::Size configured_input)
+        : cfg_(std::move(cfg)) {
+        const int long_side = std::max(configured_input.width, configured_input.height);
+        std::vector<int> levels = cfg_.levels;
+        std::sort(levels.begin(), levels.end());
+        levels.erase(std::unique(levels.begin(), levels.end()), levels.end());
+        if (long_side > 0) {
+            for (const int level : levels) {
+                if (level >= long_side) break;
+                const float scale = static_cast<float>(level) / static_cast<float>(long_side);
+                const cv::Size size(round_to_stride(static_cast<float>(configured_input.width) * scale),
+                                    round_to_stride(static_cast<float>(configured_input.height) * scale));
+                if (sizes_.empty() || sizes_.back() != size) sizes_.push_back(size);
+            }
+        }
+        sizes_.push_back(configured_input);
+        level_ = sizes_.size() - 1;
+        frames_since_change_ = cfg_.cooldown_frames;
+    }
+
+    float AdaptiveResolution::input_height_of_(float frame_height_px, size_t level, cv::Size frame_size) const {
+        const cv::Size input = sizes_[level];
+        const float scale = std::min(static_cast<float>(input.width) / static_cast<float>(frame_size.width),
+                                     static_cast<float>(input.height) / static_cast<float>(frame_size.height));
+        return frame_height_px * scale;
+    }
+
+    cv::Size AdaptiveResolution::update(float queue_pressure, float small_track_height, cv::Size frame_size) {
+        if (!cfg_.enabled || sizes_.size() < 2) return current();
+        if (frames_since_change_ < cfg_.cooldown_frames) {
+            ++frames_since_change_;
+            return current();
+        }
+
+        const bool small_known = small_track_height > 0.0f && frame_size.width > 0 && frame_size.height > 0;
+        size_t next = level_;
+        if (queue_pressure >= cfg_.high_pressure) {
+            if (level_ > 0 &&
+                (!small_known ||
+                 input_height_of_(small_track_height, level_ - 1, frame_size) >= cfg_.min_track_height_px)) {
+                next = level_ - 1;
+            }
+        } else if (level_ + 1 < sizes_.size()) {
+            const bool drained = queue_pressure <= cfg_.low_pressure;
+            const bool too_small =
+                small_known && input_height_of_(small_track_height, level_, frame_size) < cfg_.min_track_height_px;
+            if (drained || too_small) next = level_ + 1;
+        }
+
+        if (next != level_) {
+            level_ = next;
+            frames_since_change_ = 0;
+        }
+        return current();
+    }
+
+    float small_track_height(const std::vector<Box>& boxes) {
+        std::vector<float> heights;
+        heights.reserve(boxes.size());
+        for (const auto& box : boxes) {
+            if (box.h > 0.0f) heights.push_back(box.h);
+        }
+        return tenth_percentile(heights);
+    }
+
+    float small_face_height(const std::vector<Box>& boxes) {
+        std::vector<float> heights;
+        heights.reserve(boxes.size());
+        for (const auto& box : boxes) {
+            if (box.face && box.face->bbox.h > 0.0f) heights.push_back(box.face->bbox.h);
+        }
+        return tenth_percentile(heights);
+    }
+}
@@ -0,0 +1,210 @@
+#include <pipeline/detection_regions.hpp>
+
+#include <common/nms.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <utility>
+
+#include <opencv2/imgproc.hpp>
+
+namespace veilsight {
+    namespace {
+        constexpr float kContainmentThreshold = 0.8f;
+        // Boxes within this many pixels of an interior crop edge were likely cut off by that crop.
+        constexpr float kSeamMargin = 2.0f;
+
+        std::vector<int> tile_offsets(int start, int length, int tile, float overlap) {
+            if (length <= tile) return {start};
+            const float step = std::max(1.0f, static_cast<float>(tile) * (1.0f - overlap));
+            const int count = static_cast<int>(std::ceil(static_cast<float>(length - tile) / step)) + 1;
+            std::vector<int> offsets;
+            offsets.reserve(static_cast<size_t>(count));
+            for (int i = 0; i < count; ++i) {
+                offsets.push_back(start + static_cast<int>(std::lround(
+                                              static_cast<double>(i) * (length - tile) / (count - 1))));
+            }
+            return offsets;
+        }
+
+        float area_of(const Box& b) {
+            return std::max(0.0f, b.w) * std::max(0.0f, b.h);
+        }
+
+        float intersection_of(const Box& a, const Box& b) {
+            const float iw = std::min(a.x + a.w, b.x + b.w) - std::max(a.x, b.x);
+            const float ih = std::min(a.y + a.h, b.y + b.h) - std::max(a.y, b.y);
+            return (iw > 0.0f && ih > 0.0f) ? iw * ih : 0.0f;
+        }
+
+        // True when the box reaches an edge of its crop that lies inside the frame, i.e. the crop may have
+        // truncated it. Crop edges on the frame border are not seams.
+        bool touches_seam(const Box& box, const cv::Rect& crop, cv::Size frame_size) {
+            const float left = static_cast<float>(crop.x);
+            const float top = static_cast<float>(crop.y);
+            const float right = static_cast<float>(crop.x + crop.width);
+            const float bottom = static_cast<float>(crop.y + crop.height);
+            return (crop.x > 0 && box.x <= left + kSeamMargin) ||
+                   (crop.y > 0 && box.y <= top + kSeamMargin) ||
+                   (crop.x + crop.width < frame_size.width && box.x + box.w >= right - kSeamMargin) ||
+                   (crop.y + crop.height < frame_size.height && box.y + box.h >= bottom - kSeamMargin);
+        }
+
+        bool centred_inside(const std::vector<std::vector<cv::Point2f>>& polygons, const Box& box) {
+            if (polygons.empty()) return true;
+            const cv::Point2f centre(box.x + 0.5f * box.w, box.y + 0.5f * box.h);
+            return std::any_of(polygons.begin(), polygons.end(), [&centre](const auto& polygon) {
+                return cv::pointPolygonTest(polygon, centre, false) >= 0.0;
+            });
+        }
+    }
+
+    DetectionRegionPlanner::DetectionRegionPlanner(DetectionRegionsConfig cfg, cv::Size detector_input_size)
+        : cfg_(std::move(cfg)),
+          tile_size_(cfg_.tile_w > 0 ? cfg_.tile_w : detector_input_size.width,
+                     cfg_.tile_h > 0 ? cfg_.tile_h : detector_input_size.height) {
+        tile_size_.width = std::max(1, tile_size_.width);
+        tile_size_.height = std::max(1, tile_size_.height);
+        cfg_.tile_overlap = std::clamp(cfg_.tile_overlap, 0.0f, 0.9f);
+    }
+
+    bool DetectionRegionPlanner::active() const {
+        return !cfg_.polygons.empty() || cfg_.tiling == "auto";
+    }
+
+    std::shared_ptr<const DetectionRegionLayout> DetectionRegionPlanner::layout(cv::Size frame_size) {
+        if (layout_ && layout_->frame_size == frame_size) return layout_;
+
+        auto layout = std::make_shared<DetectionRegionLayout>();
+        layout->frame_size = frame_size;
+        layout->merge_iou_threshold = cfg_.merge_iou_threshold;
+
+        const cv::Rect bounds(0, 0, frame_size.width, frame_size.height);
+        std::vector<cv::Rect> regions;
+        for (const auto& polygon : cfg_.polygons) {
+            std::vector<cv::Point2f> points;
+            points.reserve(polygon.size());
+            float min_x = static_cast<float>(frame_size.width);
+            float min_y = static_cast<float>(frame_size.height);
+            float max_x = 0.0f;
+            float max_y = 0.0f;
+            for (const auto& p : polygon) {
+                points.emplace_back(p.x * static_cast<float>(frame_size.width),
+                                    p.y * static_cast<float>(frame_size.height));
+                min_x = std::min(min_x, points.back().x);
+                min_y = std::min(min_y, points.back().y);
+                max_x = std::max(max_x, points.back().x);
+                max_y = std::max(max_y, points.back().y);
+            }
+            const int x0 = static_cast<int>(std::floor(min_x));
+            const int y0 = static_cast<int>(std::floor(min_y));
+            const cv::Rect region = cv::Rect(x0,
+                                             y0,
+                                             static_cast<int>(std::ceil(max_x)) - x0,
+                                             static_cast<int>(std::ceil(max_y)) - y0) &
+                                    bounds;
+            if (region.width < 2 || region.height < 2) continue;
+            layout->polygons.push_back(std::move(points));
+            regions.push_back(region);
+        }
+        if (regions.empty()) {
+            if (!cfg_.polygons.empty()) {
+                std::cerr << "[DetectionRegions](layout) no polygon spans 2px at " << frame_size.width << "x"
+                          << frame_size.height << "; detecting on the full frame\n";
+            }
+            regions.push_back(bounds);
+        }
+
+        for (const auto& region : regions) {
+            const bool fits = region.width <= tile_size_.width && region.height <= tile_size_.height;
+            if (cfg_.tiling != "auto" || fits || cfg_.full_region_pass) {
+                layout->crops.push_back(region);
+            }
+            if (cfg_.tiling == "auto" && !fits) {
+                add_tiles_(*layout, region);
+            }
+        }
+
+        layout_ = std::move(layout);
+        return layout_;
+    }
+
+    void DetectionRegionPlanner::add_tiles_(DetectionRegionLayout& layout, const cv::Rect& region) const {
+        const int tile_w = std::min(tile_size_.width, region.width);
+        const int tile_h = std::min(tile_size_.height, region.height);
+        const auto xs = tile_offsets(region.x, region.width, tile_w, cfg_.tile_overlap);
+        const auto ys = tile_offsets(region.y, region.height, tile_h, cfg_.tile_overlap);
+        for (const int y : ys) {
+            for (const int x : xs) {
+                layout.crops.emplace_back(x, y, tile_w, tile_h);
+            }
+        }
+    }
+
+    std::vector<StageImage> crop_detection_regions(const cv::Mat& frame, const DetectionRegionLayout& layout) {
+        std::vector<StageImage> out;
+        if (frame.empty() || frame.size() != layout.frame_size) return out;
+        out.reserve(layout.crops.size());
+        for (const auto& crop : layout.crops) {
+            out.push_back(StageImage{frame(crop), crop_transform(crop, layout.frame_size)});
+        }
+        return out;
+    }
+
+    std::vector<Box> merge_region_detections(const DetectionRegionLayout& layout,
+                                             const std::vector<std::vector<Box>>& crop_boxes) {
+        std::vector<Box> boxes;
+        std::vector<size_t> source_crop;
+        NmsCandidates candidates;
+        for (size_t crop = 0; crop < crop_boxes.size(); ++crop) {
+            for (const auto& box : crop_boxes[crop]) {
+                if (!centred_inside(layout.polygons, box)) continue;
+                boxes.push_back(box);
+                source_crop.push_back(crop);
+                candidates.push(box.x, box.y, box.x + box.w, box.y + box.h, box.score);
+            }
+        }
+        if (crop_boxes.size() <= 1) return boxes;
+
+        NmsOptions options;
+        options.iou_threshold = layout.merge_iou_threshold;
+        const auto kept = non_max_suppression(candidates, options);
+
+        std::vector<Box> merged;
+        std::vector<size_t> merged_crop;
+        merged.reserve(kept.size());
+        merged_crop.reserve(kept.size());
+        for (const int idx : kept) {
+            const Box& box = boxes[static_cast<size_t>(idx)];
+            const size_t crop = source_crop[static_cast<size_t>(idx)];
+            bool absorbed = false;
+            for (size_t m = 0; m < merged.size(); ++m) {
+                if (merged_crop[m] == crop) continue;
+                const bool box_larger = area_of(box) > area_of(merged[m]);
+                const float smaller = std::min(area_of(box), area_of(merged[m]));
+                if (smaller <= 0.0f || intersection_of(box, merged[m]) < kContainmentThreshold * smaller) continue;
+                // Only a box cut off by its crop is a partial view; a box fully inside its crop is a separate
+                // (e.g. nested) person and must survive.
+                const Box& partial = box_larger ? merged[m] : box;
+                const size_t partial_crop = box_larger ? merged_crop[m] : crop;
+                if (partial_crop >= layout.crops.size() ||
+                    !touches_seam(partial, layout.crops[partial_crop], layout.frame_size)) {
+                    continue;
+                }
+                if (box_larger) {
+                    const float score = std::max(merged[m].score, box.score);
+                    merged[m] = box;
+                    merged[m].score = score;
+                    merged_crop[m] = crop;
+                }
+                absorbed = true;
+                break;
+            }
+            if (absorbed) continue;
+            merged.push_back(box);
+            merged_crop.push_back(crop);
+        }
+        return merged;
+    }
+}
@@ -156,6 +156,7 @@ namespace veilsight {
         mutable std::mutex mutex;
         std::map<RuntimeStage, StageAccumulator> global;
         std::map<std::string, std::map<RuntimeStage, StageAccumulator>> streams;
+        std::map<std::string, std::map<std::string, uint64_t>> stream_counters;
     };
 
     RuntimeMetrics::RuntimeMetrics()
@@ -179,6 +180,11 @@ namespace veilsight {
         impl_->streams[stream_id][stage].observe(duration_ns, ok);
     }
 
+    void RuntimeMetrics::add_stream_counter(const std::string& stream_id, const std::string& name, uint64_t delta) {
+        std::lock_guard lk(impl_->mutex);
+        impl_->stream_counters[stream_id][name] += delta;
+    }
+
     RuntimeMetrics::Snapshot RuntimeMetrics::snapshot() const {
         const uint64_t now_ns = now_steady_ns();
         const double uptime_s = static_cast<double>(now_ns - impl_->started_ns) / 1e9;
@@ -198,6 +204,7 @@ namespace veilsight {
                 stream_out[stage] = acc.snapshot(uptime_s);
             }
         }
+        out.stream_counters = impl_->stream_counters;
         return out;
     }
 
@@ -242,6 +249,22 @@ namespace veilsight {
         }
         oss << "},";
 
+        oss << "\"counters\":{";
+        bool first_counter_stream = true;
+        for (const auto& [stream_id, counters] : snapshot.stream_counters) {
+            if (!first_counter_stream) oss << ",";
+            first_counter_stream = false;
+            oss << "\"" << json_escape(stream_id) << "\":{";
+            bool inner_first = true;
+            for (const auto& [name, value] : counters) {
+                if (!inner_first) oss << ",";
+                inner_first = false;
+                oss << "\"" << json_escape(name) << "\":" << value;
+            }
+            oss << "}";
+        }
+        oss << "},";
+
         oss << "\"queues\":{";
         bool first_queue = true;
         for (const auto& [name, q] : queues) {
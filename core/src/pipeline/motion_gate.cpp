@@ -0,0 +1,98 @@
+#include <pipeline/motion_gate.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <utility>
+
+#include <opencv2/imgproc.hpp>
+
+namespace veilsight {
+    MotionGate::MotionGate(MotionGateConfig cfg)
+        : cfg_(std::move(cfg)) {
+        cfg_.downscale_width = std::max(1, cfg_.downscale_width);
+        cfg_.grid_rows = std::max(1, cfg_.grid_rows);
+        cfg_.grid_cols = std::max(1, cfg_.grid_cols);
+        cfg_.min_active_cells = std::max(1, cfg_.min_active_cells);
+        cfg_.keyframe_interval = std::max(1, cfg_.keyframe_interval);
+    }
+
+    bool MotionGate::should_detect(const cv::Mat& bgr, bool tracks_live) {
+        if (!cfg_.enabled) return true;
+        if (bgr.empty() || bgr.type() != CV_8UC3) {
+            reference_.release();
+            frames_since_detect_ = 0;
+            return true;
+        }
+
+        prepare_(bgr);
+        const bool reference_valid = !reference_.empty() && reference_.size() == gray_.size();
+        last_active_cells_ = reference_valid ? count_active_cells_() : cfg_.grid_rows * cfg_.grid_cols;
+
+        const bool detect = tracks_live ||
+                            !reference_valid ||
+                            frames_since_detect_ + 1 >= cfg_.keyframe_interval ||
+                            last_active_cells_ >= cfg_.min_active_cells;
+        if (!detect) {
+            ++frames_since_detect_;
+            ++skipped_frames_;
+            return false;
+        }
+
+        std::swap(reference_, gray_);
+        frames_since_detect_ = 0;
+        return true;
+    }
+
+    void MotionGate::prepare_(const cv::Mat& bgr) {
+        const int width = std::min(bgr.cols, cfg_.downscale_width);
+        const int height = std::max(1, static_cast<int>(std::lround(
+                                           static_cast<double>(bgr.rows) * width / std::max(1, bgr.cols))));
+        cv::resize(bgr, small_, cv::Size(width, height), 0.0, 0.0, cv::INTER_AREA);
+        cv::cvtColor(small_, gray_, cv::COLOR_BGR2GRAY);
+
+        if (static_cast<int>(cell_of_col_.size()) == width && static_cast<int>(cell_of_row_.size()) == height) {
+            return;
+        }
+
+        const int rows = std::min(cfg_.grid_rows, height);
+        const int cols = std::min(cfg_.grid_cols, width);
+        cell_of_col_.resize(static_cast<size_t>(width));
+        cell_of_row_.resize(static_cast<size_t>(height));
+        for (int x = 0; x < width; ++x) {
+            cell_of_col_[static_cast<size_t>(x)] = x * cols / width;
+        }
+        for (int y = 0; y < height; ++y) {
+            cell_of_row_[static_cast<size_t>(y)] = (y * rows / height) * cols;
+        }
+        cell_area_.assign(static_cast<size_t>(rows * cols), 0);
+        for (int y = 0; y < height; ++y) {
+            for (int x = 0; x < width; ++x) {
+                ++cell_area_[static_cast<size_t>(cell_of_row_[static_cast<size_t>(y)] +
+                                                 cell_of_col_[static_cast<size_t>(x)])];
+            }
+        }
+        cell_changed_.assign(cell_area_.size(), 0);
+    }
+
+    int MotionGate::count_active_cells_() const {
+        std::fill(cell_changed_.begin(), cell_changed_.end(), 0);
+        const int threshold = cfg_.pixel_threshold;
+        for (int y = 0; y < gray_.rows; ++y) {
+            const uint8_t* cur = gray_.ptr<uint8_t>(y);
+            const uint8_t* ref = reference_.ptr<uint8_t>(y);
+            int* changed = cell_changed_.data() + cell_of_row_[static_cast<size_t>(y)];
+            for (int x = 0; x < gray_.cols; ++x) {
+                const int diff = std::abs(static_cast<int>(cur[x]) - static_cast<int>(ref[x]));
+                changed[cell_of_col_[static_cast<size_t>(x)]] += diff > threshold ? 1 : 0;
+            }
+        }
+
+        int active = 0;
+        for (size_t i = 0; i < cell_changed_.size(); ++i) {
+            const float ratio = static_cast<float>(cell_changed_[i]) / static_cast<float>(std::max(1, cell_area_[i]));
+            if (cell_changed_[i] > 0 && ratio >= cfg_.cell_change_ratio) ++active;
+        }
+        return active;
+    }
+}
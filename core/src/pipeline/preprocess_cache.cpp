@@ -0,0 +1,120 @@
+#include <pipeline/preprocess_cache.hpp>
+
+#include <face_detector/scrfd_detector.hpp>
+#include <face_detector/yunet_detector.hpp>
+#include <person_detector/yolox_detector.hpp>
+
+#include <cmath>
+
+namespace veilsight {
+    bool PreprocessKey::same_geometry(const PreprocessKey& other) const {
+        if (width != other.width || height != other.height || resize != other.resize) return false;
+        return resize == PreprocessResize::Stretch || pad_value == other.pad_value;
+    }
+
+    bool PreprocessKey::operator==(const PreprocessKey& other) const {
+        return same_geometry(other) && rgb == other.rgb && mean == other.mean && norm == other.norm;
+    }
+
+    PreprocessCache::PreprocessCache(const cv::Mat& source)
+        : data_(source.data),
+          cols_(source.cols),
+          rows_(source.rows),
+          step_(source.empty() ? 0 : source.step[0]) {}
+
+    bool PreprocessCache::covers_(const cv::Mat& image) const {
+        return data_ != nullptr && image.data == data_ && image.cols == cols_ && image.rows == rows_ &&
+               image.step[0] == step_;
+    }
+
+    ncnn::Mat PreprocessCache::get(const cv::Mat& image,
+                                   const PreprocessKey& key,
+                                   const std::function<ncnn::Mat()>& build) {
+        if (!covers_(image)) return build();
+
+        ncnn::Mat base;
+        PreprocessKey base_key;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            for (const auto& entry : entries_) {
+                if (entry.key == key) {
+                    ++hits_;
+                    return entry.tensor;
+                }
+                if (base.empty() && entry.key.same_geometry(key)) {
+                    base = entry.tensor;
+                    base_key = entry.key;
+                }
+            }
+        }
+
+        ncnn::Mat tensor;
+        bool was_derived = false;
+        if (!base.empty()) {
+            tensor = convert_preprocessed(base, base_key, key);
+            was_derived = !tensor.empty();
+        }
+        if (tensor.empty()) tensor = build();
+        if (tensor.empty()) return tensor;
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (const auto& entry : entries_) {
+            if (entry.key == key) {
+                ++hits_;
+                return entry.tensor;
+            }
+        }
+        ++(was_derived ? derived_ : misses_);
+        entries_.push_back(Entry{key, tensor});
+        return tensor;
+    }
+
+    size_t PreprocessCache::hits() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return hits_;
+    }
+
+    size_t PreprocessCache::derived() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return derived_;
+    }
+
+    size_t PreprocessCache::misses() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return misses_;
+    }
+
+    ncnn::Mat convert_preprocessed(const ncnn::Mat& tensor, const PreprocessKey& from, const PreprocessKey& to) {
+        if (!from.same_geometry(to) || tensor.empty() || tensor.c != 3) return {};
+        for (const float n : from.norm) {
+            if (n == 0.0f || !std::isfinite(n)) return {};
+        }
+
+        ncnn::Mat out(tensor.w, tensor.h, 3);
+        if (out.empty()) return out;
+        const size_t plane = static_cast<size_t>(tensor.w) * static_cast<size_t>(tensor.h);
+        for (int c = 0; c < 3; ++c) {
+            // Plane c of `to` holds the same colour as plane src of `from`; swapping order is 0 <-> 2.
+            const int src = from.rgb == to.rgb ? c : 2 - c;
+            const size_t sc = static_cast<size_t>(src);
+            const size_t dc = static_cast<size_t>(c);
+            // (v / norm_a + mean_a - mean_b) * norm_b, folded into one multiply-add.
+            const float scale = to.norm[dc] / from.norm[sc];
+            const float shift = (from.mean[sc] - to.mean[dc]) * to.norm[dc];
+            const float* in = static_cast<const float*>(tensor.channel(src));
+            float* dst = static_cast<float*>(out.channel(c));
+            for (size_t i = 0; i < plane; ++i) {
+                dst[i] = in[i] * scale + shift;
+            }
+        }
+        return out;
+    }
+
+    bool detectors_share_preprocess(const PersonDetectorModuleConfig& person, const FaceDetectorModuleConfig& face) {
+        const bool yolox_input = person.type.empty() || person.type == "yolox" || person.type == "cascade";
+        if (!yolox_input || face.type.empty() || face.type == "none") return false;
+        const PreprocessKey face_key =
+            face.type == "yunet" ? yunet_preprocess_key(face.yunet) : scrfd_preprocess_key(face.scrfd);
+        return yolox_preprocess_key(person.yolox).same_geometry(face_key);
+    }
+}
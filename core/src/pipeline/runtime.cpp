@@ -1,5 +1,7 @@
 #include <pipeline/runtime.hpp>
 
+#include <face_detector/face_mosaic.hpp>
+
 #include <algorithm>
 #include <chrono>
 #include <cmath>
@@ -28,6 +30,17 @@ namespace veilsight {
             return cfg.type != "none";
         }
 
+        bool person_detector_resizable(const PersonDetectorModuleConfig& cfg) {
+            return cfg.type.empty() || cfg.type == "yolox" || cfg.type == "cascade";
+        }
+
+        template <typename Queue>
+        float queue_pressure(const Queue& queue) {
+            const size_t cap = queue.capacity();
+            if (cap == 0) return 0.0f;
+            return static_cast<float>(queue.size()) / static_cast<float>(cap);
+        }
+
         int recognizer_worker_count(const RecognizerModuleConfig& cfg) {
             return std::max(1, cfg.workers);
         }
@@ -222,6 +235,7 @@ namespace veilsight {
         pipes_by_stream_id_.clear();
         pipes_.reserve(streams_.size());
         const bool face_enabled = face_pipeline_enabled(opt_.face_detector) && face_detector_factory != nullptr;
+        share_preprocess_ = face_enabled && detectors_share_preprocess(opt_.person_detector, opt_.face_detector);
         for (const auto& s : streams_) {
             auto pipe = std::make_unique<StreamPipe>(s.id,
                                                      opt_.frames_in_cap,
@@ -241,6 +255,28 @@ namespace veilsight {
                 std::cerr << "[Pipeline](start) stream coordinator init failed for " << s.id << ": " << e.what() << "\n";
                 continue;
             }
+            if (opt_.person_detector.motion_gate.enabled) {
+                pipe->motion_gate = std::make_unique<MotionGate>(opt_.person_detector.motion_gate);
+            }
+            auto regions = std::make_unique<DetectionRegionPlanner>(
+                s.detection_regions, person_detector_input_size(opt_.person_detector));
+            if (regions->active()) {
+                pipe->detection_regions = std::move(regions);
+            }
+            if (opt_.person_detector.adaptive_resolution.enabled) {
+                if (person_detector_resizable(opt_.person_detector)) {
+                    pipe->person_resolution = std::make_unique<AdaptiveResolution>(
+                        opt_.person_detector.adaptive_resolution, person_detector_input_size(opt_.person_detector));
+                } else {
+                    std::cerr << "[Pipeline](start) adaptive_resolution ignored for person detector type "
+                              << opt_.person_detector.type << "\n";
+                }
+            }
+            if (face_enabled && opt_.face_detector.adaptive_resolution.enabled) {
+                const auto run = run_config_for_detector(opt_.face_detector);
+                pipe->face_resolution = std::make_unique<AdaptiveResolution>(
+                    opt_.face_detector.adaptive_resolution, cv::Size(run.input_w, run.input_h));
+            }
             pipes_by_stream_id_[s.id] = pipe.get();
             pipes_.push_back(std::move(pipe));
         }
@@ -269,10 +305,34 @@ namespace veilsight {
                         const uint64_t t0_ns = steady_now_ns();
 
                         try {
-                            const auto boxes = detector->detect(task.input.image);
-                            result.boxes.reserve(boxes.size());
-                            for (const auto& box : boxes) {
-                                result.boxes.push_back(map_box(task.input.image_to_frame, box));
+                            if (task.regions) {
+                                const auto crops = crop_detection_regions(task.input.image, *task.regions);
+                                std::vector<std::vector<Box>> crop_boxes(crops.size());
+                                // The adaptive input size is chosen for the whole frame; tiles and polygon crops
+                                // keep the configured size so they are not downscaled a second time.
+                                PersonDetectionHints crop_hints = task.hints;
+                                crop_hints.input_size = cv::Size();
+                                const cv::Rect full_frame(0, 0, task.input.image.cols, task.input.image.rows);
+                                for (size_t c = 0; c < crops.size(); ++c) {
+                                    const bool is_full_frame = task.regions->crops[c] == full_frame;
+                                    const auto boxes =
+                                        detector->detect(crops[c].image, is_full_frame ? task.hints : crop_hints);
+                                    crop_boxes[c].reserve(boxes.size());
+                                    for (const auto& box : boxes) {
+                                        crop_boxes[c].push_back(map_box(crops[c].image_to_frame, box));
+                                    }
+                                }
+                                const auto merged = merge_region_detections(*task.regions, crop_boxes);
+                                result.boxes.reserve(merged.size());
+                                for (const auto& box : merged) {
+                                    result.boxes.push_back(map_box(task.input.image_to_frame, box));
+                                }
+                            } else {
+                                const auto boxes = detector->detect(task.input.image, task.hints);
+                                result.boxes.reserve(boxes.size());
+                                for (const auto& box : boxes) {
+                                    result.boxes.push_back(map_box(task.input.image_to_frame, box));
+                                }
                             }
                             person_detections_total_.fetch_add(result.boxes.size(), std::memory_order_relaxed);
                             if (task.frame_ctx) {
@@ -305,29 +365,45 @@ namespace veilsight {
             if (face_detector_stage_->factory) {
                 face_detector_stage_->workers.clear();
                 face_detector_stage_->workers.reserve(std::max(1, opt_.face_detector.workers));
+                const FaceMosaicConfig mosaic = opt_.face_detector.mosaic;
+                const FaceDetectorRunConfig canvas_run = run_config_for_detector(opt_.face_detector);
+                const FaceMosaicLayout layout{cv::Size(canvas_run.input_w, canvas_run.input_h),
+                                              opt_.face_detector.probes.crop_input,
+                                              mosaic.gap_px};
                 for (int i = 0; i < std::max(1, opt_.face_detector.workers); ++i) {
                     auto detector = face_detector_stage_->factory->create();
-                    face_detector_stage_->workers.emplace_back([this, detector = std::move(detector)]() mutable {
+                    face_detector_stage_->workers.emplace_back([this, mosaic, layout, detector = std::move(detector)]() mutable {
                         while (running_.load(std::memory_order_relaxed)) {
                             FaceDetectionTask task;
                             if (!face_detector_stage_->input.pop_for(task, std::chrono::milliseconds(200))) continue;
                             if (!detector) continue;
 
-                            FaceDetectionResult result;
-                            result.stream_id = task.stream_id;
-                            result.frame_id = task.frame_id;
-                            result.probe_id = task.probe_id;
-                            result.kind = task.kind;
+                            // Head-crop probes already queued, from any stream, share one mosaic forward.
+                            std::vector<FaceDetectionTask> batch;
+                            batch.push_back(std::move(task));
+                            if (mosaic.enabled && batch.front().kind == FaceProbeKind::HeadCrops) {
+                                FaceDetectionTask next;
+                                while (batch.size() < static_cast<size_t>(mosaic.max_tasks) &&
+                                       face_detector_stage_->input.try_pop(next)) {
+                                    const bool crops = next.kind == FaceProbeKind::HeadCrops;
+                                    batch.push_back(std::move(next));
+                                    if (!crops) break;
+                                }
+                            }
+
+                            std::vector<FaceDetectionResult> results;
                             bool ok = true;
                             const uint64_t t0_ns = steady_now_ns();
 
                             try {
-                                const auto faces = detector->detect_faces(task.input.image, task.run);
-                                result.faces.reserve(faces.size());
-                                for (const auto& face : faces) {
-                                    result.faces.push_back(map_face(task.input.image_to_frame, face));
+                                if (mosaic.enabled) {
+                                    results = run_face_mosaic_tasks(*detector, batch, layout);
+                                } else {
+                                    results.push_back(run_face_detection_task(*detector, batch.front()));
+                                }
+                                for (const auto& result : results) {
+                                    face_detections_total_.fetch_add(result.faces.size(), std::memory_order_relaxed);
                                 }
-                                face_detections_total_.fetch_add(result.faces.size(), std::memory_order_relaxed);
                             } catch (const std::exception& e) {
                                 ok = false;
                                 thread_local bool logged = false;
@@ -335,18 +411,30 @@ namespace veilsight {
                                     std::cerr << "[Pipeline](face_detector) detect failed: " << e.what() << "\n";
                                     logged = true;
                                 }
-                                result.faces.clear();
+                                results.clear();
+                                for (const auto& failed : batch) {
+                                    FaceDetectionResult result;
+                                    result.stream_id = failed.stream_id;
+                                    result.frame_id = failed.frame_id;
+                                    result.probe_id = failed.probe_id;
+                                    result.kind = failed.kind;
+                                    results.push_back(std::move(result));
+                                }
                             }
 
                             if (metrics_) {
-                                const uint64_t dt_ns = steady_now_ns() - t0_ns;
-                                metrics_->observe_global(RuntimeStage::FaceDetector, dt_ns, ok);
-                                metrics_->observe_stream(task.stream_id, RuntimeStage::FaceDetector, dt_ns, ok);
+                                const uint64_t dt_ns = (steady_now_ns() - t0_ns) / batch.size();
+                                for (const auto& done : batch) {
+                                    metrics_->observe_global(RuntimeStage::FaceDetector, dt_ns, ok);
+                                    metrics_->observe_stream(done.stream_id, RuntimeStage::FaceDetector, dt_ns, ok);
+                                }
                             }
 
-                            auto it = pipes_by_stream_id_.find(task.stream_id);
-                            if (it != pipes_by_stream_id_.end() && it->second) {
-                                it->second->faces_in.push_drop_oldest(std::move(result));
+                            for (auto& result : results) {
+                                auto it = pipes_by_stream_id_.find(result.stream_id);
+                                if (it != pipes_by_stream_id_.end() && it->second) {
+                                    it->second->faces_in.push_drop_oldest(std::move(result));
+                                }
                             }
                         }
                     });
@@ -356,19 +444,35 @@ namespace veilsight {
             recognizer_stage_->workers.clear();
             const int recognizer_workers = recognizer_worker_count(opt_.recognizer);
             recognizer_stage_->workers.reserve(recognizer_workers);
+            const RecognizerBatchConfig recognizer_batch = opt_.recognizer.batch;
             for (int i = 0; i < recognizer_workers; ++i) {
                 auto recognizer = recognizer_stage_->factory->create();
-                recognizer_stage_->workers.emplace_back([this, recognizer = std::move(recognizer)]() mutable {
+                recognizer_stage_->workers.emplace_back([this, recognizer_batch, recognizer = std::move(recognizer)]() mutable {
                     while (running_.load(std::memory_order_relaxed)) {
                         RecognitionTask task;
                         if (!recognizer_stage_->input.pop_for(task, std::chrono::milliseconds(200))) continue;
                         if (!recognizer) continue;
 
+                        // Tasks already queued, from any stream, are embedded and matched together.
+                        std::vector<RecognitionTask> batch;
+                        batch.push_back(std::move(task));
+                        if (recognizer_batch.enabled) {
+                            RecognitionTask next;
+                            while (batch.size() < static_cast<size_t>(recognizer_batch.max_tasks) &&
+                                   recognizer_stage_->input.try_pop(next)) {
+                                batch.push_back(std::move(next));
+                            }
+                        }
+
                         bool ok = true;
-                        RecognitionResult result;
+                        std::vector<RecognitionResult> results;
                         const uint64_t t0_ns = steady_now_ns();
                         try {
-                            result = recognizer->recognize(task);
+                            if (batch.size() == 1) {
+                                results.push_back(recognizer->recognize(batch.front()));
+                            } else {
+                                results = recognizer->recognize_batch(batch);
+                            }
                         } catch (const std::exception& e) {
                             ok = false;
                             thread_local bool logged = false;
@@ -376,24 +480,33 @@ namespace veilsight {
                                 std::cerr << "[Pipeline](recognizer) recognize failed: " << e.what() << "\n";
                                 logged = true;
                             }
-                            result.stream_id = task.stream_id;
-                            result.frame_id = task.frame_id;
-                            result.frame = task.frame;
-                            result.tracks = task.tracks;
-                            for (auto& track : result.tracks) {
-                                track.recognition_state = "failed";
+                            results.clear();
+                            for (const auto& failed : batch) {
+                                RecognitionResult result;
+                                result.stream_id = failed.stream_id;
+                                result.frame_id = failed.frame_id;
+                                result.frame = failed.frame;
+                                result.tracks = failed.tracks;
+                                for (auto& track : result.tracks) {
+                                    track.recognition_state = "failed";
+                                }
+                                results.push_back(std::move(result));
                             }
                         }
 
                         if (metrics_) {
-                            const uint64_t dt_ns = steady_now_ns() - t0_ns;
-                            metrics_->observe_global(RuntimeStage::Recognizer, dt_ns, ok);
-                            metrics_->observe_stream(task.stream_id, RuntimeStage::Recognizer, dt_ns, ok);
+                            const uint64_t dt_ns = (steady_now_ns() - t0_ns) / batch.size();
+                            for (const auto& done : batch) {
+                                metrics_->observe_global(RuntimeStage::Recognizer, dt_ns, ok);
+                                metrics_->observe_stream(done.stream_id, RuntimeStage::Recognizer, dt_ns, ok);
+                            }
                         }
 
-                        auto it = pipes_by_stream_id_.find(result.stream_id);
-                        if (it != pipes_by_stream_id_.end() && it->second) {
-                            it->second->recognitions_in.push_drop_oldest(std::move(result));
+                        for (auto& result : results) {
+                            auto it = pipes_by_stream_id_.find(result.stream_id);
+                            if (it != pipes_by_stream_id_.end() && it->second) {
+                                it->second->recognitions_in.push_drop_oldest(std::move(result));
+                            }
                         }
                     }
                 });
@@ -591,16 +704,45 @@ namespace veilsight {
             ctx->inf = std::move(dp.inf_frame);
             ctx->inf_w = ctx->inf.cols;
             ctx->inf_h = ctx->inf.rows;
+            if (share_preprocess_) ctx->preprocess = std::make_shared<PreprocessCache>(ctx->inf);
             ctx->ui_w = ctx->ui.cols;
             ctx->ui_h = ctx->ui.rows;
 
-            PersonDetectionTask person_task;
-            person_task.stream_id = ctx->stream_id;
-            person_task.frame_id = ctx->frame_id;
-            person_task.input.image = ctx->inf;
-            person_task.input.image_to_frame = identity_transform(ctx->inf.size());
-            person_task.frame_ctx = ctx;
-            person_detector_stage_->input.push_drop_oldest(std::move(person_task));
+            const bool tracks_live = pipe->live_tracks.load(std::memory_order_relaxed) > 0;
+            if (!pipe->motion_gate || pipe->motion_gate->should_detect(ctx->inf, tracks_live)) {
+                PersonDetectionTask person_task;
+                person_task.stream_id = ctx->stream_id;
+                person_task.frame_id = ctx->frame_id;
+                person_task.input.image = ctx->inf;
+                person_task.input.image_to_frame = identity_transform(ctx->inf.size());
+                if (pipe->detection_regions) {
+                    person_task.regions = pipe->detection_regions->layout(ctx->inf.size());
+                }
+                person_task.hints.tracks_live = tracks_live;
+                if (pipe->person_resolution) {
+                    const size_t level = pipe->person_resolution->level();
+                    person_task.hints.input_size = pipe->person_resolution->update(
+                        queue_pressure(person_detector_stage_->input),
+                        pipe->small_track_height.load(std::memory_order_relaxed),
+                        ctx->inf.size());
+                    if (metrics_ && pipe->person_resolution->level() != level) {
+                        metrics_->add_stream_counter(cfg.id, "person_resolution_changes");
+                    }
+                }
+                // A scaled-down person pass no longer matches the face input, so it keeps its own buffer.
+                if (person_task.hints.input_size.empty() ||
+                    person_task.hints.input_size == person_detector_input_size(opt_.person_detector)) {
+                    person_task.hints.preprocess = ctx->preprocess;
+                }
+                person_task.hints.refresh = pipe->detections_since_refresh == 0;
+                pipe->detections_since_refresh =
+                    (pipe->detections_since_refresh + 1) % std::max(1, opt_.person_detector.cascade.refresh_interval);
+                person_task.frame_ctx = ctx;
+                person_detector_stage_->input.push_drop_oldest(std::move(person_task));
+            } else {
+                pipe->person_detections_in.push_drop_oldest(PersonDetectionResult{ctx->stream_id, ctx->frame_id, {}});
+                if (metrics_) metrics_->add_stream_counter(cfg.id, "motion_gate_skipped");
+            }
             pipe->frames_in.push_drop_oldest(ctx);
 
             if (metrics_) {
@@ -616,14 +758,28 @@ namespace veilsight {
         if (!pipe || !pipe->coordinator) return;
 
         StreamCoordinator::Callbacks callbacks;
-        callbacks.on_tracker_timing = [this](const FrameCtx& frame, uint64_t duration_ns) {
+        callbacks.on_tracker_timing = [this, pipe](const FrameCtx& frame, uint64_t duration_ns) {
+            pipe->live_tracks.store(frame.tracked_boxes.size(), std::memory_order_relaxed);
+            pipe->small_track_height.store(small_track_height(frame.tracked_boxes), std::memory_order_relaxed);
             if (!metrics_) return;
             metrics_->observe_global(RuntimeStage::Tracker, duration_ns);
             metrics_->observe_stream(frame.stream_id, RuntimeStage::Tracker, duration_ns);
         };
-        callbacks.on_face_probes_ready = [this](std::vector<FaceDetectionTask> probes) {
+        callbacks.on_face_probes_ready = [this, pipe](std::vector<FaceDetectionTask> probes) {
             if (!face_detector_stage_) return;
             for (auto& probe : probes) {
+                if (pipe->face_resolution && probe.kind == FaceProbeKind::FullFrame) {
+                    const size_t level = pipe->face_resolution->level();
+                    const cv::Size size = pipe->face_resolution->update(
+                        queue_pressure(face_detector_stage_->input),
+                        pipe->small_face_height.load(std::memory_order_relaxed),
+                        probe.input.image.size());
+                    probe.run.input_w = size.width;
+                    probe.run.input_h = size.height;
+                    if (metrics_ && pipe->face_resolution->level() != level) {
+                        metrics_->add_stream_counter(probe.stream_id, "face_resolution_changes");
+                    }
+                }
                 face_detector_stage_->input.push_drop_oldest(std::move(probe));
             }
         };
@@ -635,7 +791,10 @@ namespace veilsight {
             if (!recognizer_stage_) return;
             recognizer_stage_->input.push_drop_oldest(std::move(task));
         };
-        callbacks.on_frame_committed = [this](const FramePtr& frame) {
+        callbacks.on_frame_committed = [this, pipe](const FramePtr& frame) {
+            if (pipe->face_resolution) {
+                pipe->small_face_height.store(small_face_height(frame->tracked_boxes), std::memory_order_relaxed);
+            }
             commit_frame_(frame);
         };
 
@@ -682,7 +841,17 @@ namespace veilsight {
         if (!frame) return;
         committed_tracks_total_.fetch_add(frame->tracked_boxes.size(), std::memory_order_relaxed);
         publish_frame_analytics_(*frame, frame->tracked_boxes);
+        if (frame->preprocess && metrics_) {
+            metrics_->add_stream_counter(frame->stream_id, "preprocess_cache_hits", frame->preprocess->hits());
+            metrics_->add_stream_counter(frame->stream_id, "preprocess_cache_derived", frame->preprocess->derived());
+            metrics_->add_stream_counter(frame->stream_id, "preprocess_cache_misses", frame->preprocess->misses());
+        }
+        frame->preprocess.reset();
         frame->inf.release();
+        if (metrics_ && frame->face_probes_issued + frame->face_probes_avoided > 0) {
+            metrics_->add_stream_counter(frame->stream_id, "face_probes_issued", frame->face_probes_issued);
+            metrics_->add_stream_counter(frame->stream_id, "face_probes_avoided", frame->face_probes_avoided);
+        }
         AnonymizeTask task;
         task.stream_id = frame->stream_id;
         task.frame_id = frame->frame_id;
@@ -942,6 +1111,43 @@ namespace veilsight {
                       << "committed_tracks_total=" << committed_tracks
                       << "\n";
 
+            for (const auto& [stream_id, counters] : snap.stream_counters) {
+                auto it = counters.find("motion_gate_skipped");
+                if (it == counters.end()) continue;
+                std::cerr << "[Metrics] motion_gate " << stream_id << " skipped_frames=" << it->second << "\n";
+            }
+
+            for (const auto& [stream_id, counters] : snap.stream_counters) {
+                const auto person = counters.find("person_resolution_changes");
+                const auto face = counters.find("face_resolution_changes");
+                if (person == counters.end() && face == counters.end()) continue;
+                std::cerr << "[Metrics] adaptive_resolution " << stream_id
+                          << " person_changes=" << (person == counters.end() ? 0 : person->second)
+                          << " face_changes=" << (face == counters.end() ? 0 : face->second) << "\n";
+            }
+
+            for (const auto& [stream_id, counters] : snap.stream_counters) {
+                const auto counter = [&counters](const char* name) -> uint64_t {
+                    const auto it = counters.find(name);
+                    return it == counters.end() ? 0 : it->second;
+                };
+                const uint64_t hits = counter("preprocess_cache_hits");
+                const uint64_t derived = counter("preprocess_cache_derived");
+                const uint64_t misses = counter("preprocess_cache_misses");
+                if (hits + derived + misses == 0) continue;
+                std::cerr << "[Metrics] preprocess_cache " << stream_id << " hits=" << hits << " derived=" << derived
+                          << " misses=" << misses << "\n";
+            }
+
+            for (const auto& [stream_id, counters] : snap.stream_counters) {
+                const auto issued = counters.find("face_probes_issued");
+                const auto avoided = counters.find("face_probes_avoided");
+                if (avoided == counters.end() || avoided->second == 0) continue;
+                const uint64_t total = avoided->second + (issued == counters.end() ? 0 : issued->second);
+                std::cerr << "[Metrics] face_reuse " << stream_id << " probes_avoided=" << avoided->second
+                          << " ratio=" << static_cast<double>(avoided->second) / static_cast<double>(total) << "\n";
+            }
+
             for (const auto& [name, q] : queues) {
                 if (q.capacity == 0) continue;
                 if ((100 * q.size) / q.capacity >= 80) {
@@ -110,6 +110,7 @@ namespace veilsight {
 
     void StreamCoordinator::drain_independent_face_probes_(const Callbacks& callbacks) {
         if (!face_detection_enabled_ || !independent_face_detection_ || !callbacks.on_face_probes_ready) return;
+        if (face_probe_planner_.needs_tracks()) return;
 
         for (auto& [frame_id, frame] : pending_frames_) {
             if (!frame) continue;
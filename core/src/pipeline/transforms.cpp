@@ -22,6 +22,17 @@ namespace veilsight {
         return transform;
     }
 
+    SpatialTransform crop_transform(const cv::Rect& crop, cv::Size frame_size) {
+        SpatialTransform transform;
+        transform.source_size = crop.size();
+        transform.target_size = frame_size;
+        transform.source_to_target = cv::Matx23f(1.0f, 0.0f, static_cast<float>(crop.x),
+                                                  0.0f, 1.0f, static_cast<float>(crop.y));
+        transform.target_to_source = cv::Matx23f(1.0f, 0.0f, -static_cast<float>(crop.x),
+                                                  0.0f, 1.0f, -static_cast<float>(crop.y));
+        return transform;
+    }
+
     PointF map_point(const SpatialTransform& transform, const PointF& point) {
         return apply(transform.source_to_target, point);
     }
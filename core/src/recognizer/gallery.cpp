@@ -0,0 +1,847 @@
+#include <recognizer/gallery.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace veilsight {
+    namespace {
+        constexpr size_t kFloatLanes = 16; // row stride granularity: one 64-byte line
+        constexpr size_t kInt8Lanes = 32;
+        constexpr size_t kBlockRows = 256; // ~128 KiB of 128-d float rows, stays in L2 while every query visits it
+        constexpr size_t kRerankFactor = 8;
+        constexpr size_t kMinRerank = 32;
+        size_t round_up(size_t n, size_t to) {
+            return (n + to - 1) / to * to;
+        }
+
+        constexpr char kSnapshotMagic[8] = {'V', 'S', 'G', 'A', 'L', '0', '0', '2'};
+        constexpr size_t kSnapshotAlign = 64;
+
+        // Fixed-size snapshot header; followed by the source tag, then 64-byte aligned sections for the float rows
+        // (rows x stride), row identities (uint32), row ids (int64, 8-byte aligned), the int8 copy (rows x qstride
+        // codes, then one float scale per row) when qstride is nonzero, the IVF-PQ index (centroids, codebooks, list
+        // offsets, list rows, list codes) when index_lists is nonzero, and length-prefixed identity keys.
+        struct SnapshotHeader {
+            char magic[8];
+            int32_t dim;
+            int32_t stride;
+            uint64_t rows;
+            uint64_t identities;
+            int64_t change_seq;
+            uint32_t tag_bytes;
+            uint32_t qstride;
+            uint32_t index_lists;
+            uint32_t index_subspaces;
+            uint32_t index_ksub;
+            uint32_t reserved;
+        };
+
+        struct SnapshotLayout {
+            size_t values = 0;
+            size_t identity = 0;
+            size_t ids = 0;
+            size_t qvalues = 0;
+            size_t qscales = 0;
+            size_t centroids = 0;
+            size_t codebooks = 0;
+            size_t list_offsets = 0;
+            size_t list_rows = 0;
+            size_t list_codes = 0;
+            size_t keys = 0;
+        };
+
+        // Callers check that dim and stride match the matrix and that the section sizes fit the file.
+        SnapshotLayout snapshot_layout(const SnapshotHeader& header) {
+            const auto rows = static_cast<size_t>(header.rows);
+            const auto stride = static_cast<size_t>(header.stride);
+            const size_t lists = header.index_lists;
+            SnapshotLayout layout;
+            layout.values = round_up(sizeof(SnapshotHeader) + header.tag_bytes, kSnapshotAlign);
+            layout.identity = layout.values + rows * stride * sizeof(float);
+            layout.ids = round_up(layout.identity + rows * sizeof(uint32_t), sizeof(int64_t));
+            layout.qvalues = round_up(layout.ids + rows * sizeof(int64_t), kSnapshotAlign);
+            layout.qscales = layout.qvalues + rows * header.qstride;
+            layout.centroids = round_up(layout.qscales + (header.qstride ? rows * sizeof(float) : 0), kSnapshotAlign);
+            layout.codebooks = layout.centroids + lists * stride * sizeof(float);
+            const size_t codebook_floats = static_cast<size_t>(header.index_ksub) * static_cast<size_t>(header.dim);
+            layout.list_offsets = layout.codebooks + (lists ? codebook_floats * sizeof(float) : 0);
+            layout.list_rows = layout.list_offsets + (lists ? (lists + 1) * sizeof(uint32_t) : 0);
+            layout.list_codes = layout.list_rows + (lists ? rows * sizeof(uint32_t) : 0);
+            layout.keys = layout.list_codes + (lists ? rows * header.index_subspaces : 0);
+            return layout;
+        }
+
+        // Number of IVF lists an index over n rows is built with.
+        size_t ivf_list_count(const GalleryIndexConfig& cfg, size_t n) {
+            return std::clamp<size_t>(
+                cfg.lists > 0 ? static_cast<size_t>(cfg.lists)
+                              : static_cast<size_t>(std::lround(std::sqrt(static_cast<double>(n)))),
+                1, std::max<size_t>(n, 1));
+        }
+
+        // n is a multiple of kFloatLanes and both pointers are 64-byte aligned.
+        float dot_f32(const float* a, const float* b, size_t n) {
+#if defined(__AVX2__)
+            __m256 acc0 = _mm256_setzero_ps();
+            __m256 acc1 = _mm256_setzero_ps();
+            for (size_t i = 0; i < n; i += 16) {
+                acc0 = _mm256_add_ps(acc0, _mm256_mul_ps(_mm256_load_ps(a + i), _mm256_load_ps(b + i)));
+                acc1 = _mm256_add_ps(acc1, _mm256_mul_ps(_mm256_load_ps(a + i + 8), _mm256_load_ps(b + i + 8)));
+            }
+            const __m256 acc = _mm256_add_ps(acc0, acc1);
+            __m128 sum = _mm_add_ps(_mm256_castps256_ps128(acc), _mm256_extractf128_ps(acc, 1));
+            sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+            sum = _mm_add_ss(sum, _mm_shuffle_ps(sum, sum, 0x55));
+            return _mm_cvtss_f32(sum);
+#elif defined(__ARM_NEON)
+            float32x4_t acc0 = vdupq_n_f32(0.0f);
+            float32x4_t acc1 = vdupq_n_f32(0.0f);
+            float32x4_t acc2 = vdupq_n_f32(0.0f);
+            float32x4_t acc3 = vdupq_n_f32(0.0f);
+            for (size_t i = 0; i < n; i += 16) {
+                acc0 = vfmaq_f32(acc0, vld1q_f32(a + i), vld1q_f32(b + i));
+                acc1 = vfmaq_f32(acc1, vld1q_f32(a + i + 4), vld1q_f32(b + i + 4));
+                acc2 = vfmaq_f32(acc2, vld1q_f32(a + i + 8), vld1q_f32(b + i + 8));
+                acc3 = vfmaq_f32(acc3, vld1q_f32(a + i + 12), vld1q_f32(b + i + 12));
+            }
+            return vaddvq_f32(vaddq_f32(vaddq_f32(acc0, acc1), vaddq_f32(acc2, acc3)));
+#else
+            float acc[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+            for (size_t i = 0; i < n; i += 4) {
+                acc[0] += a[i] * b[i];
+                acc[1] += a[i + 1] * b[i + 1];
+                acc[2] += a[i + 2] * b[i + 2];
+                acc[3] += a[i + 3] * b[i + 3];
+            }
+            return (acc[0] + acc[1]) + (acc[2] + acc[3]);
+#endif
+        }
+
+        // n is a multiple of kInt8Lanes.
+        int32_t dot_i8(const int8_t* a, const int8_t* b, size_t n) {
+#if defined(__AVX2__)
+            __m256i acc = _mm256_setzero_si256();
+            for (size_t i = 0; i < n; i += 16) {
+                const __m256i va = _mm256_cvtepi8_epi16(_mm_load_si128(reinterpret_cast<const __m128i*>(a + i)));
+                const __m256i vb = _mm256_cvtepi8_epi16(_mm_load_si128(reinterpret_cast<const __m128i*>(b + i)));
+                acc = _mm256_add_epi32(acc, _mm256_madd_epi16(va, vb));
+            }
+            __m128i sum = _mm_add_epi32(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1));
+            sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0x4e));
+            sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0xb1));
+            return _mm_cvtsi128_si32(sum);
+#elif defined(__ARM_NEON)
+            int32x4_t acc = vdupq_n_s32(0);
+            for (size_t i = 0; i < n; i += 16) {
+                const int8x16_t va = vld1q_s8(a + i);
+                const int8x16_t vb = vld1q_s8(b + i);
+                acc = vpadalq_s16(acc, vmull_s8(vget_low_s8(va), vget_low_s8(vb)));
+                acc = vpadalq_s16(acc, vmull_high_s8(va, vb));
+            }
+            return vaddvq_s32(acc);
+#else
+            int32_t acc = 0;
+            for (size_t i = 0; i < n; ++i) acc += static_cast<int32_t>(a[i]) * static_cast<int32_t>(b[i]);
+            return acc;
+#endif
+        }
+
+        // Symmetric per-vector quantization; returns the scale that maps int8 back to float.
+        float quantize_symmetric(const float* in, size_t n, int8_t* out) {
+            float max_abs = 0.0f;
+            for (size_t i = 0; i < n; ++i) max_abs = std::max(max_abs, std::abs(in[i]));
+            if (max_abs <= 0.0f) {
+                std::fill(out, out + n, int8_t{0});
+                return 0.0f;
+            }
+            const float inv = 127.0f / max_abs;
+            for (size_t i = 0; i < n; ++i) {
+                const long q = std::lround(in[i] * inv);
+                out[i] = static_cast<int8_t>(std::clamp(q, -127L, 127L));
+            }
+            return max_abs / 127.0f;
+        }
+
+        // Best k entries by score with unique keys, kept sorted best first. A key seen again only moves up.
+        class TopK {
+        public:
+            void reset(size_t k) {
+                k_ = k;
+                items_.clear();
+            }
+
+            void push(uint32_t key, float score) {
+                if (items_.size() >= k_ && !(score > items_.back().score)) return;
+                auto it = std::find_if(items_.begin(), items_.end(),
+                                       [key](const GalleryMatch& m) { return m.identity == key; });
+                if (it != items_.end()) {
+                    if (!(score > it->score)) return;
+                    items_.erase(it);
+                } else if (items_.size() >= k_) {
+                    items_.pop_back();
+                }
+                auto pos = std::find_if(items_.begin(), items_.end(),
+                                        [score](const GalleryMatch& m) { return m.score < score; });
+                items_.insert(pos, GalleryMatch{key, score});
+            }
+
+            std::vector<GalleryMatch>& items() { return items_; }
+
+        private:
+            size_t k_ = 0;
+            std::vector<GalleryMatch> items_;
+        };
+
+        using AlignedFloats = std::vector<float, AlignedAllocator<float, 64>>;
+
+        // Copies row-major queries into zero-padded, aligned rows of stride floats.
+        const float* pad_queries(const float* queries, size_t num_queries, size_t dim, size_t stride) {
+            thread_local AlignedFloats padded;
+            padded.assign(num_queries * stride, 0.0f);
+            for (size_t q = 0; q < num_queries; ++q) {
+                std::memcpy(padded.data() + q * stride, queries + q * dim, dim * sizeof(float));
+            }
+            return padded.data();
+        }
+
+        void require_query_dim(const std::vector<float>& query, int dim) {
+            if (query.size() != static_cast<size_t>(dim)) {
+                throw std::runtime_error("gallery query has dim " + std::to_string(query.size()) +
+                                         ", expected " + std::to_string(dim));
+            }
+        }
+
+        // Candidates are re-scored in row order so equal float scores resolve to the earlier row, as in a full scan.
+        void rerank_rows(const GalleryMatrix& matrix,
+                         const float* padded_query,
+                         size_t stride,
+                         std::vector<uint32_t>& rows,
+                         TopK& top) {
+            // Callers only pass rows that survived their skip mask.
+            std::sort(rows.begin(), rows.end());
+            for (const uint32_t r : rows) top.push(matrix.row_identity(r), dot_f32(matrix.row(r), padded_query, stride));
+        }
+
+        void candidate_rows(TopK& candidates, std::vector<uint32_t>& rows) {
+            rows.clear();
+            for (const auto& c : candidates.items()) rows.push_back(c.identity);
+        }
+
+        constexpr size_t kTrainPerList = 32;
+        constexpr size_t kMinTrain = 4096;
+        constexpr size_t kCodebookSize = 256;
+        constexpr int kTrainIterations = 8;
+
+        std::vector<uint32_t> sample_rows(size_t n, size_t count, std::mt19937& rng) {
+            std::vector<uint32_t> rows(n);
+            for (size_t i = 0; i < n; ++i) rows[i] = static_cast<uint32_t>(i);
+            if (count >= n) return rows;
+            for (size_t i = 0; i < count; ++i) {
+                std::uniform_int_distribution<size_t> pick(i, n - 1);
+                std::swap(rows[i], rows[pick(rng)]);
+            }
+            rows.resize(count);
+            return rows;
+        }
+
+        uint32_t nearest_centroid(const AlignedFloats& centroids, size_t k, const float* x, size_t stride) {
+            uint32_t best = 0;
+            float best_score = -std::numeric_limits<float>::infinity();
+            for (size_t c = 0; c < k; ++c) {
+                const float score = dot_f32(centroids.data() + c * stride, x, stride);
+                if (score > best_score) {
+                    best_score = score;
+                    best = static_cast<uint32_t>(c);
+                }
+            }
+            return best;
+        }
+
+        // Cosine k-means over normalized rows: assign by largest dot product, re-normalize each mean.
+        AlignedFloats train_spherical_kmeans(const GalleryMatrix& matrix,
+                                             const std::vector<uint32_t>& sample,
+                                             size_t k,
+                                             size_t stride,
+                                             std::mt19937& rng) {
+            const size_t dim = static_cast<size_t>(matrix.dim());
+            AlignedFloats centroids(k * stride, 0.0f);
+            for (size_t c = 0; c < k; ++c) {
+                std::memcpy(centroids.data() + c * stride, matrix.row(sample[c % sample.size()]), dim * sizeof(float));
+            }
+
+            std::vector<double> sums(k * dim);
+            std::vector<size_t> counts(k);
+            std::uniform_int_distribution<size_t> pick(0, sample.size() - 1);
+            for (int it = 0; it < kTrainIterations; ++it) {
+                std::fill(sums.begin(), sums.end(), 0.0);
+                std::fill(counts.begin(), counts.end(), 0);
+                for (const uint32_t r : sample) {
+                    const uint32_t c = nearest_centroid(centroids, k, matrix.row(r), stride);
+                    const float* x = matrix.row(r);
+                    for (size_t d = 0; d < dim; ++d) sums[c * dim + d] += x[d];
+                    ++counts[c];
+                }
+                for (size_t c = 0; c < k; ++c) {
+                    float* centroid = centroids.data() + c * stride;
+                    if (counts[c] == 0) {
+                        std::memcpy(centroid, matrix.row(sample[pick(rng)]), dim * sizeof(float));
+                        continue;
+                    }
+                    double norm = 0.0;
+                    for (size_t d = 0; d < dim; ++d) norm += sums[c * dim + d] * sums[c * dim + d];
+                    const double inv = norm > 0.0 ? 1.0 / std::sqrt(norm) : 0.0;
+                    for (size_t d = 0; d < dim; ++d) centroid[d] = static_cast<float>(sums[c * dim + d] * inv);
+                }
+            }
+            return centroids;
+        }
+
+        // book_t is the codebook transposed to dim x k, so centroids are scored eight at a time in independent lanes.
+        size_t nearest_l2(const float* book_t, size_t k, const float* x, size_t dim) {
+            size_t best = 0;
+            float best_dist = std::numeric_limits<float>::infinity();
+            size_t c0 = 0;
+            for (; c0 + 8 <= k; c0 += 8) {
+                float acc[8] = {};
+                for (size_t d = 0; d < dim; ++d) {
+                    const float* row = book_t + d * k + c0;
+                    for (size_t j = 0; j < 8; ++j) {
+                        const float diff = row[j] - x[d];
+                        acc[j] += diff * diff;
+                    }
+                }
+                for (size_t j = 0; j < 8; ++j) {
+                    if (acc[j] < best_dist) {
+                        best_dist = acc[j];
+                        best = c0 + j;
+                    }
+                }
+            }
+            for (size_t c = c0; c < k; ++c) {
+                float dist = 0.0f;
+                for (size_t d = 0; d < dim; ++d) {
+                    const float diff = book_t[d * k + c] - x[d];
+                    dist += diff * diff;
+                }
+                if (dist < best_dist) {
+                    best_dist = dist;
+                    best = c;
+                }
+            }
+            return best;
+        }
+
+        std::vector<float> transpose(const float* values, size_t rows, size_t cols) {
+            std::vector<float> out(rows * cols);
+            for (size_t r = 0; r < rows; ++r) {
+                for (size_t c = 0; c < cols; ++c) out[c * rows + r] = values[r * cols + c];
+            }
+            return out;
+        }
+
+        // Plain Lloyd iterations for the small residual sub-vectors of one PQ subspace.
+        std::vector<float> train_kmeans_l2(const std::vector<float>& data, size_t n, size_t dim, size_t k, std::mt19937& rng) {
+            std::vector<float> centroids(k * dim);
+            std::copy(data.begin(), data.begin() + static_cast<std::ptrdiff_t>(k * dim), centroids.begin());
+
+            std::vector<double> sums(k * dim);
+            std::vector<size_t> counts(k);
+            std::uniform_int_distribution<size_t> pick(0, n - 1);
+            for (int it = 0; it < kTrainIterations; ++it) {
+                std::fill(sums.begin(), sums.end(), 0.0);
+                std::fill(counts.begin(), counts.end(), 0);
+                const std::vector<float> centroids_t = transpose(centroids.data(), k, dim);
+                for (size_t i = 0; i < n; ++i) {
+                    const size_t c = nearest_l2(centroids_t.data(), k, data.data() + i * dim, dim);
+                    for (size_t d = 0; d < dim; ++d) sums[c * dim + d] += data[i * dim + d];
+                    ++counts[c];
+                }
+                for (size_t c = 0; c < k; ++c) {
+                    if (counts[c] == 0) {
+                        const size_t i = pick(rng);
+                        std::copy(data.begin() + static_cast<std::ptrdiff_t>(i * dim),
+                                  data.begin() + static_cast<std::ptrdiff_t>((i + 1) * dim),
+                                  centroids.begin() + static_cast<std::ptrdiff_t>(c * dim));
+                        continue;
+                    }
+                    for (size_t d = 0; d < dim; ++d) {
+                        centroids[c * dim + d] = static_cast<float>(sums[c * dim + d] / static_cast<double>(counts[c]));
+                    }
+                }
+            }
+            return centroids;
+        }
+    }
+
+    GalleryMatrix::GalleryMatrix(int dim)
+        : dim_(dim) {
+        if (dim_ <= 0) throw std::runtime_error("gallery embedding dim must be positive");
+        stride_ = round_up(static_cast<size_t>(dim_), kFloatLanes);
+        qstride_ = round_up(static_cast<size_t>(dim_), kInt8Lanes);
+    }
+
+    void GalleryMatrix::add(const std::string& identity_key, const float* embedding, int64_t row_id) {
+        if (mapping_) throw std::runtime_error("cannot add rows to a mapped gallery snapshot");
+        const auto [it, inserted] = identity_index_.try_emplace(identity_key, static_cast<uint32_t>(identities_.size()));
+        if (inserted) identities_.push_back(identity_key);
+        row_identity_.push_back(it->second);
+        row_ids_.push_back(row_id);
+        ++rows_;
+
+        const size_t offset = values_.size();
+        values_.resize(offset + stride_, 0.0f);
+        std::memcpy(values_.data() + offset, embedding, static_cast<size_t>(dim_) * sizeof(float));
+        if (quantize_) quantize_row_(rows() - 1);
+    }
+
+    void GalleryMatrix::quantize_int8() {
+        quantize_ = true;
+        mapped_qvalues_ = nullptr;
+        mapped_qscales_ = nullptr;
+        qvalues_.assign(rows() * qstride_, 0);
+        qscales_.assign(rows(), 0.0f);
+        for (size_t r = 0; r < rows(); ++r) quantize_row_(r);
+    }
+
+    void GalleryMatrix::quantize_row_(size_t row) {
+        if (qscales_.size() <= row) {
+            qvalues_.resize((row + 1) * qstride_, 0);
+            qscales_.resize(row + 1, 0.0f);
+        }
+        qscales_[row] = quantize_symmetric(this->row(row), static_cast<size_t>(dim_), qvalues_.data() + row * qstride_);
+    }
+
+    void GalleryMatrix::search(const float* queries,
+                               size_t num_queries,
+                               size_t k,
+                               std::vector<std::vector<GalleryMatch>>& out,
+                               const uint8_t* skip_rows) const {
+        out.assign(num_queries, {});
+        if (num_queries == 0 || k == 0 || empty()) return;
+
+        const size_t dim = static_cast<size_t>(dim_);
+        const uint32_t* row_identity = identity_data_();
+        const float* padded = pad_queries(queries, num_queries, dim, stride_);
+
+        thread_local std::vector<TopK> tops;
+        if (tops.size() < num_queries) tops.resize(num_queries);
+        for (size_t q = 0; q < num_queries; ++q) tops[q].reset(k);
+
+        const size_t n = rows();
+        if (!quantize_) {
+            for (size_t begin = 0; begin < n; begin += kBlockRows) {
+                const size_t end = std::min(n, begin + kBlockRows);
+                for (size_t q = 0; q < num_queries; ++q) {
+                    const float* query = padded + q * stride_;
+                    TopK& top = tops[q];
+                    for (size_t r = begin; r < end; ++r) {
+                        if (skip_rows && skip_rows[r]) continue;
+                        top.push(row_identity[r], dot_f32(row(r), query, stride_));
+                    }
+                }
+            }
+        } else {
+            thread_local Int8Rows qpadded;
+            thread_local std::vector<TopK> candidates; // keyed by row index rather than identity
+            thread_local std::vector<uint32_t> found;
+            qpadded.assign(num_queries * qstride_, 0);
+            if (candidates.size() < num_queries) candidates.resize(num_queries);
+            const size_t rerank = std::max(k * kRerankFactor, kMinRerank);
+            for (size_t q = 0; q < num_queries; ++q) {
+                quantize_symmetric(padded + q * stride_, dim, qpadded.data() + q * qstride_);
+                candidates[q].reset(rerank);
+            }
+
+            // The query scale is the same for every row, so ranking only needs the row scales.
+            const int8_t* qvalues = qvalues_data_();
+            const float* qscales = qscales_data_();
+            for (size_t begin = 0; begin < n; begin += kBlockRows) {
+                const size_t end = std::min(n, begin + kBlockRows);
+                for (size_t q = 0; q < num_queries; ++q) {
+                    const int8_t* query = qpadded.data() + q * qstride_;
+                    TopK& cand = candidates[q];
+                    for (size_t r = begin; r < end; ++r) {
+                        if (skip_rows && skip_rows[r]) continue;
+                        const int32_t dot = dot_i8(qvalues + r * qstride_, query, qstride_);
+                        cand.push(static_cast<uint32_t>(r), static_cast<float>(dot) * qscales[r]);
+                    }
+                }
+            }
+
+            for (size_t q = 0; q < num_queries; ++q) {
+                candidate_rows(candidates[q], found);
+                rerank_rows(*this, padded + q * stride_, stride_, found, tops[q]);
+            }
+        }
+
+        for (size_t q = 0; q < num_queries; ++q) out[q] = tops[q].items();
+    }
+
+    std::vector<GalleryMatch> GalleryMatrix::search(const std::vector<float>& query,
+                                                    size_t k,
+                                                    const uint8_t* skip_rows) const {
+        require_query_dim(query, dim_);
+        std::vector<std::vector<GalleryMatch>> out;
+        search(query.data(), 1, k, out, skip_rows);
+        return std::move(out.front());
+    }
+
+    std::vector<GalleryMatch> GalleryMatrix::rerank(const float* query, std::vector<uint32_t> rows, size_t k) const {
+        TopK top;
+        top.reset(k);
+        rerank_rows(*this, pad_queries(query, 1, static_cast<size_t>(dim_), stride_), stride_, rows, top);
+        return std::move(top.items());
+    }
+
+    void GalleryMatrix::save_snapshot(const std::string& path,
+                                      const GallerySnapshotInfo& info,
+                                      const GalleryIvfPqIndex* index) const {
+        namespace fs = std::filesystem;
+        if (index && index->lists() > 0 && (index->rows_ != rows_ || index->dim_ != static_cast<size_t>(dim_))) {
+            throw std::runtime_error("gallery index was not built from the snapshot matrix");
+        }
+        const bool with_index = index && index->lists() > 0;
+        SnapshotHeader header{};
+        std::memcpy(header.magic, kSnapshotMagic, sizeof(header.magic));
+        header.dim = dim_;
+        header.stride = static_cast<int32_t>(stride_);
+        header.rows = rows_;
+        header.identities = identities_.size();
+        header.change_seq = info.change_seq;
+        header.tag_bytes = static_cast<uint32_t>(info.source_tag.size());
+        header.qstride = quantize_ ? static_cast<uint32_t>(qstride_) : 0;
+        if (with_index) {
+            header.index_lists = static_cast<uint32_t>(index->lists_);
+            header.index_subspaces = static_cast<uint32_t>(index->subspaces_);
+            header.index_ksub = static_cast<uint32_t>(index->ksub_);
+        }
+        const SnapshotLayout layout = snapshot_layout(header);
+
+        const fs::path target(path);
+        // A unique name next to the target, so concurrent writers never share a temp file and the rename stays
+        // on one filesystem.
+        std::string tmp_name = target.string() + ".XXXXXX";
+        const int tmp_fd = ::mkstemp(tmp_name.data());
+        if (tmp_fd < 0) throw std::runtime_error("failed to create gallery snapshot temp file for: " + path);
+        ::fchmod(tmp_fd, 0644); // mkstemp creates 0600; readers such as the controller may run as another user
+        ::close(tmp_fd);
+        const fs::path tmp(tmp_name);
+        {
+            std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+            if (!out) {
+                std::error_code ignored;
+                fs::remove(tmp, ignored);
+                throw std::runtime_error("failed to open gallery snapshot for writing: " + tmp.string());
+            }
+            const auto pad_to = [&out](size_t offset) {
+                static const char zeros[kSnapshotAlign] = {};
+                const auto at = static_cast<size_t>(out.tellp());
+                if (offset > at) out.write(zeros, static_cast<std::streamsize>(offset - at));
+            };
+            const auto write = [&out](const void* data, size_t bytes) {
+                out.write(static_cast<const char*>(data), static_cast<std::streamsize>(bytes));
+            };
+            write(&header, sizeof(header));
+            write(info.source_tag.data(), info.source_tag.size());
+            pad_to(layout.values);
+            write(values_data_(), rows_ * stride_ * sizeof(float));
+            write(identity_data_(), rows_ * sizeof(uint32_t));
+            pad_to(layout.ids);
+            write(id_data_(), rows_ * sizeof(int64_t));
+            if (quantize_) {
+                pad_to(layout.qvalues);
+                write(qvalues_data_(), rows_ * qstride_);
+                write(qscales_data_(), rows_ * sizeof(float));
+            }
+            if (with_index) {
+                pad_to(layout.centroids);
+                write(index->centroids_data_(), index->lists_ * index->stride_ * sizeof(float));
+                write(index->codebooks_data_(), index->subspaces_ * index->ksub_ * index->dsub_ * sizeof(float));
+                write(index->list_offsets_data_(), (index->lists_ + 1) * sizeof(uint32_t));
+                write(index->list_rows_data_(), rows_ * sizeof(uint32_t));
+                write(index->list_codes_data_(), rows_ * index->subspaces_);
+            }
+            pad_to(layout.keys);
+            for (const auto& key : identities_) {
+                const auto bytes = static_cast<uint32_t>(key.size());
+                write(&bytes, sizeof(bytes));
+                write(key.data(), key.size());
+            }
+            if (!out) {
+                std::error_code ignored;
+                fs::remove(tmp, ignored);
+                throw std::runtime_error("failed to write gallery snapshot: " + tmp.string());
+            }
+        }
+        std::error_code ec;
+        fs::rename(tmp, target, ec);
+        if (ec) {
+            fs::remove(tmp, ec);
+            throw std::runtime_error("failed to replace gallery snapshot: " + target.string());
+        }
+    }
+
+    GalleryMatrix GalleryMatrix::map_snapshot(const std::string& path, int dim, GallerySnapshotInfo& info) {
+        const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) throw std::runtime_error("gallery snapshot not found: " + path);
+        struct stat st {};
+        if (::fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(SnapshotHeader))) {
+            ::close(fd);
+            throw std::runtime_error("gallery snapshot is truncated: " + path);
+        }
+        const auto size = static_cast<size_t>(st.st_size);
+        void* addr = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (addr == MAP_FAILED) throw std::runtime_error("failed to map gallery snapshot: " + path);
+        std::shared_ptr<const void> mapping(addr, [size](const void* p) { ::munmap(const_cast<void*>(p), size); });
+
+        const auto* base = static_cast<const char*>(addr);
+        SnapshotHeader header{};
+        std::memcpy(&header, base, sizeof(header));
+        if (std::memcmp(header.magic, kSnapshotMagic, sizeof(header.magic)) != 0) {
+            throw std::runtime_error("not a gallery snapshot: " + path);
+        }
+        GalleryMatrix matrix(dim);
+        if (header.dim != dim || header.stride != static_cast<int32_t>(matrix.stride_)) {
+            throw std::runtime_error("gallery snapshot has dim " + std::to_string(header.dim) +
+                                     ", expected " + std::to_string(dim));
+        }
+        if (header.qstride != 0 && header.qstride != matrix.qstride_) {
+            throw std::runtime_error("gallery snapshot has an unexpected int8 stride: " + path);
+        }
+        const auto rows = static_cast<size_t>(header.rows);
+        const size_t lists = header.index_lists;
+        const size_t subspaces = header.index_subspaces;
+        const size_t ksub = header.index_ksub;
+        if (rows > size / (matrix.stride_ * sizeof(float))) {
+            throw std::runtime_error("gallery snapshot is truncated: " + path);
+        }
+        if (lists > 0 && (lists > rows || subspaces == 0 || static_cast<size_t>(dim) % subspaces != 0 || ksub == 0 ||
+                          ksub > 256)) {
+            throw std::runtime_error("gallery snapshot has an invalid index: " + path);
+        }
+        const SnapshotLayout layout = snapshot_layout(header);
+        if (layout.keys > size) throw std::runtime_error("gallery snapshot is truncated: " + path);
+
+        size_t at = layout.keys;
+        matrix.identities_.reserve(static_cast<size_t>(header.identities));
+        for (uint64_t i = 0; i < header.identities; ++i) {
+            uint32_t bytes = 0;
+            if (at + sizeof(bytes) > size) throw std::runtime_error("gallery snapshot is truncated: " + path);
+            std::memcpy(&bytes, base + at, sizeof(bytes));
+            at += sizeof(bytes);
+            if (at + bytes > size) throw std::runtime_error("gallery snapshot is truncated: " + path);
+            matrix.identities_.emplace_back(base + at, bytes);
+            matrix.identity_index_.emplace(matrix.identities_.back(), static_cast<uint32_t>(i));
+            at += bytes;
+        }
+
+        matrix.mapped_values_ = reinterpret_cast<const float*>(base + layout.values);
+        matrix.mapped_identity_ = reinterpret_cast<const uint32_t*>(base + layout.identity);
+        matrix.mapped_ids_ = reinterpret_cast<const int64_t*>(base + layout.ids);
+        for (size_t r = 0; r < rows; ++r) {
+            if (matrix.mapped_identity_[r] >= matrix.identities_.size()) {
+                throw std::runtime_error("gallery snapshot has an invalid identity index: " + path);
+            }
+        }
+        if (header.qstride != 0) {
+            matrix.quantize_ = true;
+            matrix.mapped_qvalues_ = reinterpret_cast<const int8_t*>(base + layout.qvalues);
+            matrix.mapped_qscales_ = reinterpret_cast<const float*>(base + layout.qscales);
+        }
+        if (lists > 0) {
+            // The index is adopted later by GalleryIvfPqIndex; check now that its lists cover every row once.
+            const auto* offsets = reinterpret_cast<const uint32_t*>(base + layout.list_offsets);
+            const auto* list_rows = reinterpret_cast<const uint32_t*>(base + layout.list_rows);
+            const auto* codes = reinterpret_cast<const uint8_t*>(base + layout.list_codes);
+            bool valid = offsets[0] == 0 && offsets[lists] == rows;
+            for (size_t l = 0; valid && l < lists; ++l) valid = offsets[l] <= offsets[l + 1];
+            std::vector<uint8_t> listed(rows, 0);
+            for (size_t i = 0; valid && i < rows; ++i) {
+                valid = list_rows[i] < rows && listed[list_rows[i]]++ == 0;
+            }
+            for (size_t i = 0; valid && i < rows * subspaces; ++i) valid = codes[i] < ksub;
+            if (!valid) throw std::runtime_error("gallery snapshot has an invalid index: " + path);
+        }
+        matrix.rows_ = rows;
+        matrix.mapping_ = std::move(mapping);
+        info.source_tag.assign(base + sizeof(SnapshotHeader), header.tag_bytes);
+        info.change_seq = header.change_seq;
+        return matrix;
+    }
+
+    GalleryIvfPqIndex::GalleryIvfPqIndex(const GalleryMatrix& matrix, const GalleryIndexConfig& cfg, uint32_t seed)
+        : dim_(static_cast<size_t>(matrix.dim())),
+          stride_(round_up(static_cast<size_t>(matrix.dim()), kFloatLanes)),
+          subspaces_(static_cast<size_t>(std::max(1, cfg.pq_subspaces))),
+          probes_(static_cast<size_t>(std::max(1, cfg.probes))),
+          rerank_(static_cast<size_t>(std::max(1, cfg.rerank))) {
+        if (dim_ % subspaces_ != 0) {
+            throw std::runtime_error("gallery index pq_subspaces must divide the embedding dim");
+        }
+        dsub_ = dim_ / subspaces_;
+        const size_t n = matrix.rows();
+        if (n == 0) return;
+        const size_t lists = ivf_list_count(cfg, n);
+
+        if (matrix.mapping_) {
+            SnapshotHeader header{};
+            std::memcpy(&header, matrix.mapping_.get(), sizeof(header));
+            if (header.index_lists == lists && header.index_subspaces == subspaces_) {
+                const auto* base = static_cast<const char*>(matrix.mapping_.get());
+                const SnapshotLayout layout = snapshot_layout(header);
+                ksub_ = header.index_ksub;
+                lists_ = lists;
+                rows_ = n;
+                mapped_centroids_ = reinterpret_cast<const float*>(base + layout.centroids);
+                mapped_codebooks_ = reinterpret_cast<const float*>(base + layout.codebooks);
+                mapped_list_offsets_ = reinterpret_cast<const uint32_t*>(base + layout.list_offsets);
+                mapped_list_rows_ = reinterpret_cast<const uint32_t*>(base + layout.list_rows);
+                mapped_list_codes_ = reinterpret_cast<const uint8_t*>(base + layout.list_codes);
+                mapping_ = matrix.mapping_;
+                return;
+            }
+        }
+
+        std::mt19937 rng(seed);
+        const std::vector<uint32_t> sample = sample_rows(n, std::max(lists * kTrainPerList, kMinTrain), rng);
+
+        centroids_ = train_spherical_kmeans(matrix, sample, lists, stride_, rng);
+        std::vector<uint32_t> assignment(n);
+        for (size_t r = 0; r < n; ++r) assignment[r] = nearest_centroid(centroids_, lists, matrix.row(r), stride_);
+
+        // Residual codebooks are shared by every list, so a query builds one lookup table for all of them.
+        ksub_ = std::min<size_t>(kCodebookSize, sample.size());
+        std::vector<float> residuals(sample.size() * dim_);
+        for (size_t i = 0; i < sample.size(); ++i) {
+            const float* x = matrix.row(sample[i]);
+            const float* c = centroids_.data() + static_cast<size_t>(assignment[sample[i]]) * stride_;
+            for (size_t d = 0; d < dim_; ++d) residuals[i * dim_ + d] = x[d] - c[d];
+        }
+        codebooks_.assign(subspaces_ * ksub_ * dsub_, 0.0f);
+        std::vector<float> sub(sample.size() * dsub_);
+        for (size_t m = 0; m < subspaces_; ++m) {
+            for (size_t i = 0; i < sample.size(); ++i) {
+                std::memcpy(sub.data() + i * dsub_, residuals.data() + i * dim_ + m * dsub_, dsub_ * sizeof(float));
+            }
+            const std::vector<float> book = train_kmeans_l2(sub, sample.size(), dsub_, ksub_, rng);
+            std::copy(book.begin(), book.end(), codebooks_.begin() + static_cast<std::ptrdiff_t>(m * ksub_ * dsub_));
+        }
+
+        lists_ = lists;
+        rows_ = n;
+        list_offsets_.assign(lists + 1, 0);
+        for (size_t r = 0; r < n; ++r) ++list_offsets_[assignment[r] + 1];
+        for (size_t l = 0; l < lists; ++l) list_offsets_[l + 1] += list_offsets_[l];
+        list_rows_.resize(n);
+        list_codes_.resize(n * subspaces_);
+        std::vector<uint32_t> fill(list_offsets_.begin(), list_offsets_.end() - 1);
+        std::vector<std::vector<float>> books_t(subspaces_);
+        for (size_t m = 0; m < subspaces_; ++m) books_t[m] = transpose(codebooks_.data() + m * ksub_ * dsub_, ksub_, dsub_);
+        std::vector<float> residual(dim_);
+        for (size_t r = 0; r < n; ++r) {
+            const size_t l = assignment[r];
+            const float* x = matrix.row(r);
+            const float* c = centroids_.data() + l * stride_;
+            for (size_t d = 0; d < dim_; ++d) residual[d] = x[d] - c[d];
+            const size_t slot = fill[l]++;
+            list_rows_[slot] = static_cast<uint32_t>(r);
+            for (size_t m = 0; m < subspaces_; ++m) {
+                list_codes_[slot * subspaces_ + m] = static_cast<uint8_t>(
+                    nearest_l2(books_t[m].data(), ksub_, residual.data() + m * dsub_, dsub_));
+            }
+        }
+    }
+
+    void GalleryIvfPqIndex::search(const GalleryMatrix& matrix,
+                                   const float* queries,
+                                   size_t num_queries,
+                                   size_t k,
+                                   std::vector<std::vector<GalleryMatch>>& out,
+                                   const uint8_t* skip_rows) const {
+        out.assign(num_queries, {});
+        if (num_queries == 0 || k == 0 || lists_ == 0) return;
+
+        const float* padded = pad_queries(queries, num_queries, dim_, stride_);
+        const size_t lists = lists_;
+        const size_t probes = std::min(probes_, lists);
+        const float* centroids = centroids_data_();
+        const float* codebooks = codebooks_data_();
+        const uint32_t* list_offsets = list_offsets_data_();
+        const uint32_t* list_rows = list_rows_data_();
+        const uint8_t* list_codes = list_codes_data_();
+        thread_local std::vector<std::pair<float, uint32_t>> list_scores;
+        thread_local std::vector<float> lut;
+        thread_local std::vector<uint32_t> found;
+        TopK candidates; // keyed by row index rather than identity
+        TopK top;
+
+        for (size_t q = 0; q < num_queries; ++q) {
+            const float* query = padded + q * stride_;
+            list_scores.resize(lists);
+            for (size_t l = 0; l < lists; ++l) {
+                list_scores[l] = {dot_f32(centroids + l * stride_, query, stride_), static_cast<uint32_t>(l)};
+            }
+            std::partial_sort(list_scores.begin(), list_scores.begin() + static_cast<std::ptrdiff_t>(probes), list_scores.end(),
+                              [](const auto& a, const auto& b) { return a.first > b.first; });
+
+            lut.resize(subspaces_ * ksub_);
+            for (size_t m = 0; m < subspaces_; ++m) {
+                const float* qs = query + m * dsub_;
+                const float* book = codebooks + m * ksub_ * dsub_;
+                for (size_t j = 0; j < ksub_; ++j) {
+                    float dot = 0.0f;
+                    for (size_t d = 0; d < dsub_; ++d) dot += qs[d] * book[j * dsub_ + d];
+                    lut[m * ksub_ + j] = dot;
+                }
+            }
+
+            candidates.reset(std::max(rerank_, k));
+            for (size_t p = 0; p < probes; ++p) {
+                const auto [base, l] = list_scores[p];
+                const uint8_t* codes = list_codes + static_cast<size_t>(list_offsets[l]) * subspaces_;
+                for (size_t i = list_offsets[l]; i < list_offsets[l + 1]; ++i, codes += subspaces_) {
+                    const uint32_t row = list_rows[i];
+                    if (skip_rows && skip_rows[row]) continue;
+                    float score = base;
+                    for (size_t m = 0; m < subspaces_; ++m) score += lut[m * ksub_ + codes[m]];
+                    candidates.push(row, score);
+                }
+            }
+
+            top.reset(k);
+            candidate_rows(candidates, found);
+            rerank_rows(matrix, query, stride_, found, top);
+            out[q] = top.items();
+        }
+    }
+
+    std::vector<GalleryMatch> GalleryIvfPqIndex::search(const GalleryMatrix& matrix,
+                                                        const std::vector<float>& query,
+                                                        size_t k,
+                                                        const uint8_t* skip_rows) const {
+        require_query_dim(query, static_cast<int>(dim_));
+        std::vector<std::vector<GalleryMatch>> out;
+        search(matrix, query.data(), 1, k, out, skip_rows);
+        return std::move(out.front());
+    }
+}
@@ -1,15 +1,18 @@
 #include <recognizer/recognizer.hpp>
 
 #include <face_detector/face_detector.hpp>
+#include <recognizer/gallery.hpp>
 
 #include <algorithm>
 #include <array>
 #include <cmath>
 #include <cstring>
 #include <filesystem>
+#include <iostream>
 #include <limits>
 #include <memory>
 #include <mutex>
+#include <optional>
 #include <stdexcept>
 #include <string>
 #include <unordered_map>
@@ -26,14 +29,30 @@ namespace veilsight {
     namespace {
         constexpr float kDuplicateFaceIou = 0.45f;
         constexpr float kPi = 3.14159265358979323846f;
-
-        struct GalleryEntry {
-            std::string identity_key;
-            std::vector<float> embedding;
-        };
-
+        // A reload applies logged changes while they touch fewer rows than this share of the base (or the floor
+        // below); past that the gallery is reloaded in full so the base, its index and the snapshot are compacted.
+        constexpr size_t kGalleryDeltaDivisor = 10;
+        constexpr size_t kGalleryDeltaFloor = 256;
+        // Laplacian variance at which a face counts as half sharp; sampled on 8-bit luma.
+        constexpr float kSharpnessHalfVariance = 150.0f;
+        constexpr int kSharpnessSamples = 32;
+
+        // A gallery is a shared base matrix (loaded from the DB or mapped from a snapshot, plus its index) with the
+        // rows changed since then masked out, and a small matrix holding their current versions. Reloads that only
+        // see a few logged changes reuse the base and rebuild just the mask and the added rows.
         struct Gallery {
-            std::vector<GalleryEntry> entries;
+            std::shared_ptr<const GalleryMatrix> base = std::make_shared<const GalleryMatrix>();
+            std::shared_ptr<const GalleryIvfPqIndex> index; // built from base, or mapped along with it
+            // Per base row, set once the DB row changed; shared between reloads until a row is removed.
+            std::shared_ptr<const std::vector<uint8_t>> removed;
+            size_t removed_count = 0;
+            GalleryMatrix added;
+            std::string generation; // gallery_meta generation; empty when the DB keeps no change log
+            int64_t change_seq = 0; // last gallery_changes seq reflected in the rows
+
+            bool empty() const {
+                return base->rows() == removed_count && added.empty();
+            }
         };
 
         struct SharedGallery {
@@ -42,11 +61,17 @@ namespace veilsight {
         };
 
         enum class TrackRecognitionState {
+            Collecting, // best-shot window open
             InProgress,
             DecidedKnown,
             DecidedUnknown,
         };
 
+        struct BestShot {
+            float quality = 0.0f;
+            std::vector<unsigned char> aligned;
+        };
+
         struct TrackDecision {
             TrackRecognitionState state = TrackRecognitionState::InProgress;
             std::string identity_key;
@@ -54,6 +79,9 @@ namespace veilsight {
             std::string privacy_action = "anonymize";
             std::string recognition_state = "pending";
             int64_t last_seen_frame = 0;
+            int64_t window_start = 0;    // first frame of the open best-shot window
+            int embeddings_used = 0;     // best-shot budget spent on this track
+            std::vector<BestShot> shots; // best aligned faces of the open window, highest quality first
         };
 
         struct StreamTrackState {
@@ -101,18 +129,22 @@ namespace veilsight {
             return std::sqrt(dx * dx + dy * dy);
         }
 
-        bool normalize_l2(std::vector<float>& values) {
+        bool normalize_l2(float* values, size_t n) {
             double sum = 0.0;
-            for (const float v : values) {
-                sum += static_cast<double>(v) * static_cast<double>(v);
+            for (size_t i = 0; i < n; ++i) {
+                sum += static_cast<double>(values[i]) * static_cast<double>(values[i]);
             }
             if (sum <= 0.0) return false;
 
             const float inv_norm = 1.0f / static_cast<float>(std::sqrt(sum));
-            for (float& v : values) v *= inv_norm;
+            for (size_t i = 0; i < n; ++i) values[i] *= inv_norm;
             return true;
         }
 
+        bool normalize_l2(std::vector<float>& values) {
+            return normalize_l2(values.data(), values.size());
+        }
+
         void apply_no_decision(Box& track) {
             track.identity_key.clear();
             track.identity_confidence = 0.0f;
@@ -198,54 +230,272 @@ namespace veilsight {
             sqlite3_stmt* stmt_ = nullptr;
         };
 
-        std::shared_ptr<const Gallery> load_gallery(const RecognizerModuleConfig& cfg) {
+        void exec_sql(sqlite3* db, const char* sql) {
+            if (sqlite3_exec(db, sql, nullptr, nullptr, nullptr) != SQLITE_OK) {
+                throw std::runtime_error("gallery query failed: " + std::string(sqlite3_errmsg(db)));
+            }
+        }
+
+        // Reads identity_key, dim and embedding from columns first..first+2 into embedding (normalized).
+        std::string read_gallery_row(sqlite3_stmt* stmt,
+                                     int first,
+                                     const RecognizerModuleConfig& cfg,
+                                     std::vector<float>& embedding) {
+            const auto* key_text = sqlite3_column_text(stmt, first);
+            const int dim = sqlite3_column_int(stmt, first + 1);
+            const void* blob = sqlite3_column_blob(stmt, first + 2);
+            const int bytes = sqlite3_column_bytes(stmt, first + 2);
+
+            if (!key_text || !blob) {
+                throw std::runtime_error("gallery contains null identity_key or embedding");
+            }
+            if (dim != cfg.embedding_dim) {
+                throw std::runtime_error("gallery embedding has dim " + std::to_string(dim) +
+                                         ", expected " + std::to_string(cfg.embedding_dim));
+            }
+            const int expected_bytes = cfg.embedding_dim * static_cast<int>(sizeof(float));
+            if (bytes != expected_bytes) {
+                throw std::runtime_error("gallery embedding has " + std::to_string(bytes) +
+                                         " bytes, expected " + std::to_string(expected_bytes));
+            }
+
+            std::string identity_key = reinterpret_cast<const char*>(key_text);
+            embedding.resize(static_cast<size_t>(cfg.embedding_dim));
+            std::memcpy(embedding.data(), blob, static_cast<size_t>(expected_bytes));
+            if (!normalize_l2(embedding)) {
+                throw std::runtime_error("gallery embedding for " + identity_key + " has zero norm");
+            }
+            return identity_key;
+        }
+
+        struct ChangeLogHead {
+            std::string generation;
+            int64_t seq = 0;
+            int64_t pruned_seq = 0; // changes up to here were trimmed from the log
+        };
+
+        // Generation and latest seq of the change log kept by the gallery DB triggers, if the DB has one. The
+        // controller trims changes already folded into the gallery snapshot and records how far in 'pruned_seq'; a
+        // gallery older than that cannot be brought up to date from the log.
+        std::optional<ChangeLogHead> read_change_log_head(sqlite3* db) {
+            {
+                SqliteStmt tables(db,
+                                  "SELECT COUNT(*) FROM sqlite_master "
+                                  "WHERE type = 'table' AND name IN ('gallery_meta', 'gallery_changes')");
+                if (sqlite3_step(tables.get()) != SQLITE_ROW || sqlite3_column_int(tables.get(), 0) != 2) {
+                    return std::nullopt;
+                }
+            }
+            SqliteStmt stmt(db,
+                            "SELECT (SELECT value FROM gallery_meta WHERE key = 'generation'), "
+                            "(SELECT COALESCE(MAX(seq), 0) FROM gallery_changes), "
+                            "(SELECT CAST(value AS INTEGER) FROM gallery_meta WHERE key = 'pruned_seq')");
+            if (sqlite3_step(stmt.get()) != SQLITE_ROW) {
+                throw std::runtime_error("failed to read gallery change log: " + std::string(sqlite3_errmsg(db)));
+            }
+            const auto* generation = sqlite3_column_text(stmt.get(), 0);
+            if (!generation) return std::nullopt;
+            const int64_t pruned_seq = sqlite3_column_int64(stmt.get(), 2);
+            return ChangeLogHead{reinterpret_cast<const char*>(generation),
+                                 std::max<int64_t>(sqlite3_column_int64(stmt.get(), 1), pruned_seq),
+                                 pruned_seq};
+        }
+
+        // A base mapped from a snapshot brings its int8 copy and index along, so neither is rebuilt here.
+        std::shared_ptr<Gallery> with_base(GalleryMatrix base, const RecognizerModuleConfig& cfg) {
+            if (cfg.gallery_precision == "int8" && !base.quantized()) base.quantize_int8();
             auto gallery = std::make_shared<Gallery>();
-            if (cfg.gallery_path.empty()) return gallery;
+            if (cfg.gallery_index.type == "ivfpq" &&
+                base.rows() >= static_cast<size_t>(std::max(0, cfg.gallery_index.min_rows))) {
+                gallery->index = std::make_shared<const GalleryIvfPqIndex>(base, cfg.gallery_index);
+            }
+            gallery->base = std::make_shared<const GalleryMatrix>(std::move(base));
+            gallery->added = GalleryMatrix(cfg.embedding_dim);
+            return gallery;
+        }
 
-            SqliteDb db(cfg.gallery_path);
+        std::shared_ptr<Gallery> load_full_gallery(sqlite3* db, const RecognizerModuleConfig& cfg) {
+            // Rows stay in id order so delta reloads can find a changed embedding by binary search.
             SqliteStmt stmt(
-                db.get(),
-                "SELECT fe.identity_key, fe.dim, fe.embedding "
+                db,
+                "SELECT fe.id, fe.identity_key, fe.dim, fe.embedding "
                 "FROM face_embeddings fe "
                 "JOIN identities i ON i.identity_key = fe.identity_key "
                 "WHERE fe.active = 1 AND i.active = 1 AND fe.model = 'mobilefacenet' "
-                "ORDER BY fe.identity_key, fe.id");
+                "ORDER BY fe.id");
 
+            GalleryMatrix base(cfg.embedding_dim);
+            std::vector<float> embedding;
             while (true) {
                 const int rc = sqlite3_step(stmt.get());
                 if (rc == SQLITE_DONE) break;
                 if (rc != SQLITE_ROW) {
-                    throw std::runtime_error("failed to read gallery rows: " + std::string(sqlite3_errmsg(db.get())));
+                    throw std::runtime_error("failed to read gallery rows: " + std::string(sqlite3_errmsg(db)));
                 }
+                const std::string identity_key = read_gallery_row(stmt.get(), 1, cfg, embedding);
+                base.add(identity_key, embedding.data(), sqlite3_column_int64(stmt.get(), 0));
+            }
+            return with_base(std::move(base), cfg);
+        }
 
-                const auto* key_text = sqlite3_column_text(stmt.get(), 0);
-                const int dim = sqlite3_column_int(stmt.get(), 1);
-                const void* blob = sqlite3_column_blob(stmt.get(), 2);
-                const int bytes = sqlite3_column_bytes(stmt.get(), 2);
+        // Folds the changes logged after current.change_seq into a copy of current that shares its base. Returns
+        // nullptr when so many rows changed that a full reload is cheaper to search.
+        std::shared_ptr<Gallery> apply_gallery_changes(const Gallery& current,
+                                                       sqlite3* db,
+                                                       const ChangeLogHead& head,
+                                                       const RecognizerModuleConfig& cfg) {
+            const size_t limit = std::max(kGalleryDeltaFloor, current.base->rows() / kGalleryDeltaDivisor);
+            std::vector<int64_t> changed;
+            {
+                SqliteStmt stmt(db,
+                                "SELECT DISTINCT embedding_id FROM gallery_changes "
+                                "WHERE seq > ? AND seq <= ? ORDER BY embedding_id");
+                sqlite3_bind_int64(stmt.get(), 1, current.change_seq);
+                sqlite3_bind_int64(stmt.get(), 2, head.seq);
+                while (true) {
+                    const int rc = sqlite3_step(stmt.get());
+                    if (rc == SQLITE_DONE) break;
+                    if (rc != SQLITE_ROW) {
+                        throw std::runtime_error("failed to read gallery changes: " + std::string(sqlite3_errmsg(db)));
+                    }
+                    changed.push_back(sqlite3_column_int64(stmt.get(), 0));
+                    if (changed.size() > limit) return nullptr;
+                }
+            }
+
+            auto next = std::make_shared<Gallery>();
+            next->base = current.base;
+            next->index = current.index;
+            next->removed = current.removed;
+            next->removed_count = current.removed_count;
+            next->generation = head.generation;
+            next->change_seq = head.seq;
+            next->added = GalleryMatrix(cfg.embedding_dim);
+            if (changed.empty()) {
+                next->added = current.added;
+                return next;
+            }
 
-                if (!key_text || !blob) {
-                    throw std::runtime_error("gallery contains null identity_key or embedding");
+            const GalleryMatrix& base = *next->base;
+            std::shared_ptr<std::vector<uint8_t>> removed;
+            for (const int64_t id : changed) {
+                size_t lo = 0;
+                size_t hi = base.rows();
+                while (lo < hi) {
+                    const size_t mid = lo + (hi - lo) / 2;
+                    if (base.row_id(mid) < id) {
+                        lo = mid + 1;
+                    } else {
+                        hi = mid;
+                    }
                 }
-                if (dim != cfg.embedding_dim) {
-                    throw std::runtime_error("gallery embedding has dim " + std::to_string(dim) +
-                                             ", expected " + std::to_string(cfg.embedding_dim));
+                if (lo >= base.rows() || base.row_id(lo) != id) continue;
+                if (!removed) {
+                    if (current.removed && (*current.removed)[lo]) continue;
+                    removed = current.removed ? std::make_shared<std::vector<uint8_t>>(*current.removed)
+                                              : std::make_shared<std::vector<uint8_t>>(base.rows(), 0);
                 }
-                const int expected_bytes = cfg.embedding_dim * static_cast<int>(sizeof(float));
-                if (bytes != expected_bytes) {
-                    throw std::runtime_error("gallery embedding has " + std::to_string(bytes) +
-                                             " bytes, expected " + std::to_string(expected_bytes));
+                if (!(*removed)[lo]) {
+                    (*removed)[lo] = 1;
+                    ++next->removed_count;
                 }
+            }
+            if (removed) next->removed = std::move(removed);
 
-                GalleryEntry entry;
-                entry.identity_key = reinterpret_cast<const char*>(key_text);
-                entry.embedding.resize(static_cast<size_t>(cfg.embedding_dim));
-                std::memcpy(entry.embedding.data(), blob, static_cast<size_t>(expected_bytes));
-                if (!normalize_l2(entry.embedding)) {
-                    throw std::runtime_error("gallery embedding for " + entry.identity_key + " has zero norm");
+            const GalleryMatrix& added = current.added;
+            for (size_t r = 0; r < added.rows(); ++r) {
+                if (std::binary_search(changed.begin(), changed.end(), added.row_id(r))) continue;
+                next->added.add(added.identities()[added.row_identity(r)], added.row(r), added.row_id(r));
+            }
+
+            SqliteStmt stmt(
+                db,
+                "SELECT fe.identity_key, fe.dim, fe.embedding "
+                "FROM face_embeddings fe "
+                "JOIN identities i ON i.identity_key = fe.identity_key "
+                "WHERE fe.id = ? AND fe.active = 1 AND i.active = 1 AND fe.model = 'mobilefacenet'");
+            std::vector<float> embedding;
+            for (const int64_t id : changed) {
+                sqlite3_reset(stmt.get());
+                sqlite3_bind_int64(stmt.get(), 1, id);
+                const int rc = sqlite3_step(stmt.get());
+                if (rc == SQLITE_DONE) continue;
+                if (rc != SQLITE_ROW) {
+                    throw std::runtime_error("failed to read gallery rows: " + std::string(sqlite3_errmsg(db)));
                 }
-                gallery->entries.push_back(std::move(entry));
+                const std::string identity_key = read_gallery_row(stmt.get(), 0, cfg, embedding);
+                next->added.add(identity_key, embedding.data(), id);
             }
+            if (next->added.rows() > limit) return nullptr;
+            return next;
+        }
 
+        // Maps the snapshot left by an earlier full load when it was taken from this DB generation, no change it
+        // needs was trimmed from the log, and it was written with the configured precision.
+        std::shared_ptr<Gallery> map_gallery_snapshot(const std::string& path,
+                                                      const ChangeLogHead& head,
+                                                      const RecognizerModuleConfig& cfg) {
+            if (!std::filesystem::exists(path)) return nullptr;
+            try {
+                GallerySnapshotInfo info;
+                GalleryMatrix base = GalleryMatrix::map_snapshot(path, cfg.embedding_dim, info);
+                if (info.source_tag != head.generation || info.change_seq > head.seq ||
+                    info.change_seq < head.pruned_seq || base.quantized() != (cfg.gallery_precision == "int8")) {
+                    return nullptr;
+                }
+                auto gallery = with_base(std::move(base), cfg);
+                gallery->generation = info.source_tag;
+                gallery->change_seq = info.change_seq;
+                return gallery;
+            } catch (const std::exception& e) {
+                std::cerr << "[Recognizer] ignoring gallery snapshot " << path << ": " << e.what() << "\n";
+                return nullptr;
+            }
+        }
+
+        // Loads the gallery, reusing current (or the on-disk snapshot at startup) when the DB change log allows
+        // applying only what changed since.
+        std::shared_ptr<const Gallery> load_gallery(const RecognizerModuleConfig& cfg, const Gallery* current) {
+            if (cfg.gallery_path.empty()) {
+                auto gallery = std::make_shared<Gallery>();
+                gallery->base = std::make_shared<const GalleryMatrix>(cfg.embedding_dim);
+                gallery->added = GalleryMatrix(cfg.embedding_dim);
+                return gallery;
+            }
+
+            const std::string db_path = resolve_path_or_throw(cfg.gallery_path);
+            const std::string snapshot_path = db_path + ".vsgallery";
+            SqliteDb db(db_path);
+            // One read transaction so the change log head and the rows come from the same DB state; closing the
+            // connection ends it.
+            exec_sql(db.get(), "BEGIN");
+            const auto head = read_change_log_head(db.get());
+            if (head) {
+                std::shared_ptr<Gallery> reused;
+                if (current && current->generation == head->generation && current->change_seq <= head->seq &&
+                    current->change_seq >= head->pruned_seq) {
+                    reused = apply_gallery_changes(*current, db.get(), *head, cfg);
+                } else if (!current && cfg.gallery_snapshot) {
+                    if (auto mapped = map_gallery_snapshot(snapshot_path, *head, cfg)) {
+                        reused = apply_gallery_changes(*mapped, db.get(), *head, cfg);
+                    }
+                }
+                if (reused) return reused;
+            }
+
+            auto gallery = load_full_gallery(db.get(), cfg);
+            if (head) {
+                gallery->generation = head->generation;
+                gallery->change_seq = head->seq;
+                if (cfg.gallery_snapshot) {
+                    try {
+                        gallery->base->save_snapshot(snapshot_path, GallerySnapshotInfo{head->generation, head->seq},
+                                                     gallery->index.get());
+                    } catch (const std::exception& e) {
+                        std::cerr << "[Recognizer] failed to write gallery snapshot: " << e.what() << "\n";
+                    }
+                }
+            }
             return gallery;
         }
 
@@ -298,28 +548,105 @@ namespace veilsight {
             return true;
         }
 
-        MatchResult best_gallery_match(const std::vector<float>& embedding, const Gallery& gallery) {
-            MatchResult out;
-            out.score = gallery.entries.empty() ? 0.0f : -std::numeric_limits<float>::infinity();
-            for (const auto& entry : gallery.entries) {
-                float score = 0.0f;
-                for (size_t i = 0; i < embedding.size(); ++i) {
-                    score += embedding[i] * entry.embedding[i];
+        // Variance of the 4-neighbour Laplacian of luma on a grid of up to kSharpnessSamples^2 points spanning the
+        // landmarks; blurred or heavily compressed faces score low.
+        float landmark_sharpness(const cv::Mat& bgr, const FaceObservation& face) {
+            if (bgr.empty() || bgr.type() != CV_8UC3) return 0.0f;
+            float x1 = face.landmarks[0].x;
+            float y1 = face.landmarks[0].y;
+            float x2 = x1;
+            float y2 = y1;
+            for (int i = 1; i < 5; ++i) {
+                x1 = std::min(x1, face.landmarks[static_cast<size_t>(i)].x);
+                y1 = std::min(y1, face.landmarks[static_cast<size_t>(i)].y);
+                x2 = std::max(x2, face.landmarks[static_cast<size_t>(i)].x);
+                y2 = std::max(y2, face.landmarks[static_cast<size_t>(i)].y);
+            }
+            const int left = std::max(1, static_cast<int>(x1));
+            const int top = std::max(1, static_cast<int>(y1));
+            const int right = std::min(bgr.cols - 2, static_cast<int>(x2));
+            const int bottom = std::min(bgr.rows - 2, static_cast<int>(y2));
+            if (right <= left || bottom <= top) return 0.0f;
+
+            const size_t step = static_cast<size_t>(bgr.step);
+            const auto luma = [&](int x, int y) {
+                const unsigned char* p = bgr.data + static_cast<size_t>(y) * step + static_cast<size_t>(x) * 3u;
+                return static_cast<float>(p[0] + 2 * p[1] + p[2]) * 0.25f;
+            };
+            const int sx = std::max(1, (right - left) / kSharpnessSamples);
+            const int sy = std::max(1, (bottom - top) / kSharpnessSamples);
+            double sum = 0.0;
+            double sum_sq = 0.0;
+            size_t n = 0;
+            for (int y = top; y <= bottom; y += sy) {
+                for (int x = left; x <= right; x += sx) {
+                    const float lap = 4.0f * luma(x, y) - luma(x - 1, y) - luma(x + 1, y) - luma(x, y - 1) - luma(x, y + 1);
+                    sum += lap;
+                    sum_sq += static_cast<double>(lap) * lap;
+                    ++n;
+                }
+            }
+            const double mean = sum / static_cast<double>(n);
+            return static_cast<float>(std::max(0.0, sum_sq / static_cast<double>(n) - mean * mean));
+        }
+
+        // Ranks a track's usable faces for best-shot selection: detector score, size up to twice the minimum,
+        // roll and yaw relative to their gates, and sharpness. Only the order matters.
+        float face_quality(const FaceObservation& face, const cv::Mat& bgr, const RecognizerModuleConfig& cfg) {
+            const PointF& left_eye = face.landmarks[0];
+            const PointF& right_eye = face.landmarks[1];
+            const PointF& nose = face.landmarks[2];
+            const float inter_eye = std::max(distance(left_eye, right_eye), 1.0f);
+            const float roll_deg = std::abs(std::atan2(right_eye.y - left_eye.y, right_eye.x - left_eye.x)) * 180.0f / kPi;
+            const float yaw_ratio = std::abs(nose.x - (left_eye.x + right_eye.x) * 0.5f) / inter_eye;
+
+            const float size = std::min(1.0f, std::min(face.bbox.w, face.bbox.h) /
+                                                  std::max(1.0f, 2.0f * cfg.min_face_size_px));
+            const float roll = 1.0f - 0.5f * std::min(1.0f, roll_deg / std::max(cfg.max_roll_deg, 1e-3f));
+            const float yaw = 1.0f - 0.5f * std::min(1.0f, yaw_ratio / std::max(cfg.max_yaw_offset_ratio, 1e-3f));
+            const float variance = landmark_sharpness(bgr, face);
+            const float sharpness = 0.5f + 0.5f * variance / (variance + kSharpnessHalfVariance);
+            return face.score * size * roll * yaw * sharpness;
+        }
+
+        // Best identity for each of n row-major embeddings: one blocked scan over the base rows (or its index),
+        // skipping rows changed since the base was loaded, and one over the rows added since.
+        std::vector<MatchResult> best_gallery_matches(const float* embeddings, size_t n, const Gallery& gallery) {
+            std::vector<MatchResult> out(n);
+            if (n == 0) return out;
+
+            const uint8_t* skip = gallery.removed_count > 0 ? gallery.removed->data() : nullptr;
+            std::vector<std::vector<GalleryMatch>> base;
+            std::vector<std::vector<GalleryMatch>> added;
+            if (gallery.index) {
+                gallery.index->search(*gallery.base, embeddings, n, 1, base, skip);
+            } else {
+                gallery.base->search(embeddings, n, 1, base, skip);
+            }
+            gallery.added.search(embeddings, n, 1, added);
+
+            for (size_t q = 0; q < n; ++q) {
+                if (!base[q].empty()) {
+                    out[q].identity_key = gallery.base->identities()[base[q].front().identity];
+                    out[q].score = base[q].front().score;
                 }
-                if (score > out.score) {
-                    out.score = score;
-                    out.identity_key = entry.identity_key;
+                if (!added[q].empty() && (base[q].empty() || added[q].front().score > out[q].score)) {
+                    out[q].identity_key = gallery.added.identities()[added[q].front().identity];
+                    out[q].score = added[q].front().score;
                 }
             }
-            if (gallery.entries.empty()) out.score = 0.0f;
             return out;
         }
 
-        std::vector<float> extract_mobilefacenet_embedding(ncnn::Net& net,
-                                                           ncnn::PoolAllocator& workspace_pool_allocator,
-                                                           const RecognizerModuleConfig& cfg,
-                                                           const cv::Mat& bgr,
-                                                           const FaceObservation& face) {
+        size_t aligned_face_bytes(const RecognizerModuleConfig& cfg) {
+            return static_cast<size_t>(cfg.input_w) * static_cast<size_t>(cfg.input_h) * 3u;
+        }
+
+        // Warps the face onto the canonical five-landmark layout; dst holds aligned_face_bytes(cfg) BGR bytes.
+        void align_mobilefacenet_face(const RecognizerModuleConfig& cfg,
+                                      const cv::Mat& bgr,
+                                      const FaceObservation& face,
+                                      unsigned char* dst) {
             if (bgr.empty()) {
                 throw std::runtime_error("recognition image is empty");
             }
@@ -346,27 +673,32 @@ namespace veilsight {
             ncnn::get_affine_transform(src.data(), canonical.data(), 5, tm_src_to_dst);
             ncnn::invert_affine_transform(tm_src_to_dst, tm_dst_to_src);
 
-            std::vector<unsigned char> aligned(
-                static_cast<size_t>(cfg.input_w) * static_cast<size_t>(cfg.input_h) * 3u);
             ncnn::warpaffine_bilinear_c3(
                 bgr.data,
                 bgr.cols,
                 bgr.rows,
                 static_cast<int>(bgr.step),
-                aligned.data(),
+                dst,
                 cfg.input_w,
                 cfg.input_h,
                 cfg.input_w * 3,
                 tm_dst_to_src);
+        }
 
+        // Runs one aligned face through the network; out receives embedding_dim L2-normalized floats.
+        void embed_aligned_face(ncnn::Net& net,
+                                ncnn::PoolAllocator& workspace_pool_allocator,
+                                const RecognizerModuleConfig& cfg,
+                                const unsigned char* aligned,
+                                float* out) {
             ncnn::Mat in = ncnn::Mat::from_pixels(
-                aligned.data(),
+                aligned,
                 ncnn::Mat::PIXEL_BGR2RGB,
                 cfg.input_w,
                 cfg.input_h);
 
             ncnn::Extractor ex = net.create_extractor();
-            ex.set_light_mode(true);
+            ex.set_light_mode(net.opt.lightmode);
 
             thread_local ncnn::UnlockedPoolAllocator blob_pool_allocator;
             thread_local bool blob_pool_initialized = false;
@@ -392,11 +724,21 @@ namespace veilsight {
             const float* data = static_cast<const float*>(fc1.data);
             if (!data) throw std::runtime_error("MobileFaceNet output is empty");
 
-            std::vector<float> embedding(static_cast<size_t>(cfg.embedding_dim));
-            std::copy(data, data + cfg.embedding_dim, embedding.begin());
-            if (!normalize_l2(embedding)) {
+            std::copy(data, data + cfg.embedding_dim, out);
+            if (!normalize_l2(out, static_cast<size_t>(cfg.embedding_dim))) {
                 throw std::runtime_error("MobileFaceNet output has zero norm");
             }
+        }
+
+        std::vector<float> extract_mobilefacenet_embedding(ncnn::Net& net,
+                                                           ncnn::PoolAllocator& workspace_pool_allocator,
+                                                           const RecognizerModuleConfig& cfg,
+                                                           const cv::Mat& bgr,
+                                                           const FaceObservation& face) {
+            std::vector<unsigned char> aligned(aligned_face_bytes(cfg));
+            align_mobilefacenet_face(cfg, bgr, face, aligned.data());
+            std::vector<float> embedding(static_cast<size_t>(cfg.embedding_dim));
+            embed_aligned_face(net, workspace_pool_allocator, cfg, aligned.data(), embedding.data());
             return embedding;
         }
 
@@ -453,82 +795,369 @@ namespace veilsight {
                 net_.opt.num_threads = std::max(1, cfg_.ncnn_threads);
                 workspace_pool_allocator_.set_size_compare_ratio(0.0f);
 
-                const std::string param = resolve_path_or_throw(cfg_.param_path);
-                const std::string bin = resolve_path_or_throw(cfg_.bin_path);
-                if (net_.load_param(param.c_str()) != 0) {
-                    throw std::runtime_error("Failed to load MobileFaceNet param: " + param);
-                }
-                if (net_.load_model(bin.c_str()) != 0) {
-                    throw std::runtime_error("Failed to load MobileFaceNet weights: " + bin);
+                const NcnnModelProbe probe = mobilefacenet_model_probe(cfg_);
+                if (const auto tuning = resolve_ncnn_tuning(cfg_.ncnn_autotune, probe)) {
+                    apply_ncnn_tuning(net_.opt, *tuning);
                 }
+                probe.load(net_);
             }
 
             RecognitionResult recognize(const RecognitionTask& task) override {
-                RecognitionResult out;
-                out.stream_id = task.stream_id;
-                out.frame_id = task.frame_id;
-                out.frame = task.frame;
-                out.tracks = task.tracks;
+                const RecognitionTask* tasks[] = {&task};
+                return std::move(recognize_tasks(tasks, 1).front());
+            }
 
-                cleanup_cache(task.stream_id, task.frame_id);
+            std::vector<RecognitionResult> recognize_batch(const std::vector<RecognitionTask>& tasks) override {
+                std::vector<const RecognitionTask*> ptrs;
+                ptrs.reserve(tasks.size());
+                for (const auto& task : tasks) ptrs.push_back(&task);
+                return recognize_tasks(ptrs.data(), ptrs.size());
+            }
 
-                for (size_t i = 0; i < out.tracks.size(); ++i) {
-                    Box& track = out.tracks[i];
-                    apply_no_decision(track);
-                    const bool cacheable_track = track.id >= 0;
+        private:
+            struct PendingFace {
+                size_t task = 0;
+                size_t track = 0;
+                std::vector<BestShot> shots; // best-shot crops, best first; empty: align from the task frame
+            };
 
-                    if (cacheable_track && apply_cached_decision(task.stream_id, track.id, task.frame_id, track)) {
-                        continue;
+            // Resolves cached decisions and quality gates for every track first, then aligns the remaining faces of
+            // all tasks into one reused buffer, embeds them back-to-back and scores them in one gallery scan.
+            std::vector<RecognitionResult> recognize_tasks(const RecognitionTask* const* tasks, size_t count) {
+                std::vector<RecognitionResult> results(count);
+                std::vector<PendingFace> pending;
+                std::vector<PendingFace> deferred; // tracks waiting on a decision started earlier in this batch
+                for (size_t t = 0; t < count; ++t) {
+                    const RecognitionTask& task = *tasks[t];
+                    RecognitionResult& out = results[t];
+                    out.stream_id = task.stream_id;
+                    out.frame_id = task.frame_id;
+                    out.frame = task.frame;
+                    out.tracks = task.tracks;
+
+                    cleanup_cache(task.stream_id, task.frame_id);
+
+                    for (size_t i = 0; i < out.tracks.size(); ++i) {
+                        Box& track = out.tracks[i];
+                        apply_no_decision(track);
+                        const bool cacheable_track = track.id >= 0;
+
+                        if (cacheable_track && apply_cached_decision(task.stream_id, track.id, task.frame_id, track)) {
+                            if (started_in_batch(results, pending, task.stream_id, track.id)) {
+                                deferred.push_back(PendingFace{t, i, {}});
+                            }
+                            continue;
+                        }
+
+                        if (!passes_quality_gates(track, i, out.tracks, cfg_)) {
+                            if (cacheable_track && cfg_.best_shot.enabled) {
+                                // A window whose faces stopped passing the gates still closes on time.
+                                PendingFace face{t, i, {}};
+                                if (close_elapsed_window(task.stream_id, track, task.frame_id, face.shots)) {
+                                    pending.push_back(std::move(face));
+                                }
+                            }
+                            continue;
+                        }
+
+                        if (cacheable_track && cfg_.best_shot.enabled) {
+                            PendingFace face{t, i, {}};
+                            if (collect_best_shot(task, track, face.shots)) pending.push_back(std::move(face));
+                            continue;
+                        }
+                        if (cacheable_track && !mark_in_progress(task.stream_id, track.id, task.frame_id, track)) {
+                            continue;
+                        }
+                        pending.push_back(PendingFace{t, i, {}});
                     }
+                }
 
-                    if (!passes_quality_gates(track, i, out.tracks, cfg_)) {
-                        continue;
+                if (!pending.empty()) {
+                    const auto gallery = current_gallery();
+                    const size_t chunk = static_cast<size_t>(std::max(1, cfg_.batch.max_faces));
+                    for (size_t begin = 0; begin < pending.size(); begin += chunk) {
+                        const size_t end = std::min(pending.size(), begin + chunk);
+                        recognize_faces(tasks, results, pending.data() + begin, end - begin, *gallery);
                     }
+                }
+
+                for (const PendingFace& face : deferred) {
+                    const RecognitionTask& task = *tasks[face.task];
+                    Box& track = results[face.task].tracks[face.track];
+                    apply_cached_decision(task.stream_id, track.id, task.frame_id, track);
+                }
+
+                for (auto& out : results) {
+                    if (out.frame) {
+                        out.frame->tracked_boxes = out.tracks;
+                    }
+                }
+                return results;
+            }
 
-                    if (cacheable_track && !mark_in_progress(task.stream_id, track.id, task.frame_id, track)) {
+            void recognize_faces(const RecognitionTask* const* tasks,
+                                 std::vector<RecognitionResult>& results,
+                                 const PendingFace* faces,
+                                 size_t count,
+                                 const Gallery& gallery) {
+                const size_t face_bytes = aligned_face_bytes(cfg_);
+                const size_t dim = static_cast<size_t>(cfg_.embedding_dim);
+
+                // One aligned row per face, or one per buffered shot; rows of a face are contiguous.
+                std::vector<size_t> row_face;
+                std::vector<size_t> row_shot;
+                for (size_t k = 0; k < count; ++k) {
+                    for (size_t shot = 0; shot < std::max<size_t>(1, faces[k].shots.size()); ++shot) {
+                        row_face.push_back(k);
+                        row_shot.push_back(shot);
+                    }
+                }
+                aligned_.resize(row_face.size() * face_bytes);
+                embeddings_.resize(row_face.size() * dim);
+
+                std::vector<uint8_t> aligned_ok(row_face.size(), 0);
+                for (size_t r = 0; r < row_face.size(); ++r) {
+                    const PendingFace& face = faces[row_face[r]];
+                    unsigned char* dst = aligned_.data() + r * face_bytes;
+                    if (!face.shots.empty()) {
+                        const auto& shot = face.shots[row_shot[r]].aligned;
+                        if (shot.size() == face_bytes) {
+                            std::memcpy(dst, shot.data(), face_bytes);
+                            aligned_ok[r] = 1;
+                        }
                         continue;
                     }
+                    const FramePtr& frame = tasks[face.task]->frame;
+                    const Box& track = results[face.task].tracks[face.track];
+                    try {
+                        if (!frame || frame->inf.empty()) {
+                            throw std::runtime_error("recognition frame has no inference image");
+                        }
+                        align_mobilefacenet_face(cfg_, frame->inf, *track.face, dst);
+                        aligned_ok[r] = 1;
+                    } catch (...) {
+                    }
+                }
 
+                // Embeddings that made it through are packed densely so they form one query block.
+                std::vector<size_t> embedded;
+                embedded.reserve(row_face.size());
+                for (size_t r = 0; r < row_face.size(); ++r) {
+                    if (!aligned_ok[r]) continue;
                     try {
-                        const std::vector<float> embedding = extract_embedding(task.frame, *track.face);
-                        const auto gallery = current_gallery();
-                        const MatchResult match = best_gallery_match(embedding, *gallery);
+                        embed_aligned_face(net_,
+                                           workspace_pool_allocator_,
+                                           cfg_,
+                                           aligned_.data() + r * face_bytes,
+                                           embeddings_.data() + embedded.size() * dim);
+                        embedded.push_back(r);
+                    } catch (...) {
+                    }
+                }
 
-                        TrackDecision decision;
-                        decision.last_seen_frame = task.frame_id;
-                        if (!gallery->entries.empty() && match.score >= cfg_.unknown_threshold) {
-                            decision.state = TrackRecognitionState::DecidedKnown;
-                            decision.identity_key = match.identity_key;
-                            decision.identity_confidence = match.score;
-                            decision.privacy_action = "allow";
-                            decision.recognition_state = "known";
-                        } else {
-                            decision.state = TrackRecognitionState::DecidedUnknown;
-                            decision.identity_key.clear();
-                            decision.identity_confidence = gallery->entries.empty() ? 0.0f : match.score;
-                            decision.privacy_action = "anonymize";
-                            decision.recognition_state = "unknown";
+                const auto matches = best_gallery_matches(embeddings_.data(), embedded.size(), gallery);
+                std::vector<int> best(count, -1); // index into matches of each face's best row
+                std::vector<int> rows(count, 0);  // rows embedded per face
+                for (size_t e = 0; e < embedded.size(); ++e) {
+                    const size_t k = row_face[embedded[e]];
+                    ++rows[k];
+                    if (best[k] < 0 || matches[e].score > matches[static_cast<size_t>(best[k])].score) {
+                        best[k] = static_cast<int>(e);
+                    }
+                }
+
+                for (size_t k = 0; k < count; ++k) {
+                    const PendingFace& face = faces[k];
+                    const RecognitionTask& task = *tasks[face.task];
+                    Box& track = results[face.task].tracks[face.track];
+                    if (best[k] < 0) {
+                        track.recognition_state = "failed";
+                        if (!face.shots.empty()) {
+                            fail_best_shot(task.stream_id, track.id, task.frame_id, face.shots, track);
+                        } else if (track.id >= 0) {
+                            clear_in_progress(task.stream_id, track.id);
                         }
-                        if (cacheable_track) {
-                            finish_decision(task.stream_id, track.id, decision, track);
+                        continue;
+                    }
+                    const MatchResult& match = matches[static_cast<size_t>(best[k])];
+
+                    TrackDecision decision;
+                    decision.last_seen_frame = task.frame_id;
+                    if (!gallery.empty() && match.score >= cfg_.unknown_threshold) {
+                        decision.state = TrackRecognitionState::DecidedKnown;
+                        decision.identity_key = match.identity_key;
+                        decision.identity_confidence = match.score;
+                        decision.privacy_action = "allow";
+                        decision.recognition_state = "known";
+                    } else {
+                        decision.state = TrackRecognitionState::DecidedUnknown;
+                        decision.identity_key.clear();
+                        decision.identity_confidence = gallery.empty() ? 0.0f : match.score;
+                        decision.privacy_action = "anonymize";
+                        decision.recognition_state = "unknown";
+                    }
+                    if (!face.shots.empty()) {
+                        finish_best_shot(task.stream_id, track.id, rows[k], std::move(decision), track);
+                    } else if (track.id >= 0) {
+                        finish_decision(task.stream_id, track.id, decision, track);
+                    } else {
+                        apply_decision(track, decision);
+                    }
+                }
+            }
+
+            // Offers this frame's face to the track's best-shot window. Returns true, with the window's best crops
+            // in shots, once the window has run its course; the track is then in progress until finish_best_shot.
+            bool collect_best_shot(const RecognitionTask& task, Box& track, std::vector<BestShot>& shots) {
+                const cv::Mat& bgr = task.frame ? task.frame->inf : cv::Mat();
+                const float quality = face_quality(*track.face, bgr, cfg_);
+                const size_t keep = static_cast<size_t>(std::max(1, cfg_.best_shot.candidates));
+
+                bool wanted = false;
+                {
+                    std::lock_guard lk(state_->mutex);
+                    auto& tracks = state_->streams[task.stream_id].tracks;
+                    auto [it, created] = tracks.try_emplace(track.id);
+                    TrackDecision& decision = it->second;
+                    if (created) {
+                        decision.state = TrackRecognitionState::Collecting;
+                        decision.window_start = task.frame_id;
+                        decision.last_seen_frame = task.frame_id;
+                    }
+                    if (decision.state != TrackRecognitionState::Collecting) {
+                        // Another worker took the window; report its state like apply_cached_decision.
+                        if (decision.state == TrackRecognitionState::InProgress) {
+                            track.recognition_state = decision.recognition_state;
                         } else {
+                            decision.last_seen_frame = task.frame_id;
                             apply_decision(track, decision);
                         }
+                        return false;
+                    }
+                    wanted = decision.shots.size() < keep || quality > decision.shots.back().quality;
+                    track.recognition_state = decision.recognition_state;
+                }
+
+                // Aligning outside the lock; most faces of a window lose to an earlier shot and are never aligned.
+                BestShot shot{quality, {}};
+                if (wanted) {
+                    try {
+                        if (bgr.empty()) throw std::runtime_error("recognition frame has no inference image");
+                        shot.aligned.resize(aligned_face_bytes(cfg_));
+                        align_mobilefacenet_face(cfg_, bgr, *track.face, shot.aligned.data());
                     } catch (...) {
-                        track.recognition_state = "failed";
-                        if (cacheable_track) {
-                            clear_in_progress(task.stream_id, track.id);
-                        }
+                        wanted = false;
                     }
                 }
 
-                if (out.frame) {
-                    out.frame->tracked_boxes = out.tracks;
+                std::lock_guard lk(state_->mutex);
+                auto stream_it = state_->streams.find(task.stream_id);
+                if (stream_it == state_->streams.end()) return false;
+                auto it = stream_it->second.tracks.find(track.id);
+                if (it == stream_it->second.tracks.end() || it->second.state != TrackRecognitionState::Collecting) {
+                    return false;
                 }
-                return out;
+                TrackDecision& decision = it->second;
+                if (wanted) {
+                    auto pos = std::find_if(decision.shots.begin(), decision.shots.end(),
+                                            [&](const BestShot& s) { return quality > s.quality; });
+                    decision.shots.insert(pos, std::move(shot));
+                    if (decision.shots.size() > keep) decision.shots.pop_back();
+                }
+                if (!take_elapsed_window(decision, task.frame_id, shots)) return false;
+                track.recognition_state = decision.recognition_state;
+                return true;
+            }
+
+            // Closes the track's window once window_frames have passed even though this frame's face failed the
+            // gates, so a track whose faces turn bad mid-window is still decided from the shots it collected.
+            bool close_elapsed_window(const std::string& stream_id,
+                                      Box& track,
+                                      int64_t frame_id,
+                                      std::vector<BestShot>& shots) {
+                std::lock_guard lk(state_->mutex);
+                auto stream_it = state_->streams.find(stream_id);
+                if (stream_it == state_->streams.end()) return false;
+                auto it = stream_it->second.tracks.find(track.id);
+                if (it == stream_it->second.tracks.end() || !take_elapsed_window(it->second, frame_id, shots)) {
+                    return false;
+                }
+                track.recognition_state = it->second.recognition_state;
+                return true;
+            }
+
+            // Moves the best shots of an elapsed window, within the embedding budget, into shots and marks the track
+            // in progress. Callers hold state_->mutex.
+            bool take_elapsed_window(TrackDecision& decision, int64_t frame_id, std::vector<BestShot>& shots) const {
+                if (decision.state != TrackRecognitionState::Collecting || decision.shots.empty() ||
+                    frame_id - decision.window_start + 1 < static_cast<int64_t>(cfg_.best_shot.window_frames)) {
+                    return false;
+                }
+                const size_t budget = static_cast<size_t>(std::max(0, cfg_.best_shot.max_embeddings - decision.embeddings_used));
+                const size_t take = std::min(decision.shots.size(), std::max<size_t>(1, budget));
+                for (size_t k = 0; k < take; ++k) shots.push_back(std::move(decision.shots[k]));
+                decision.shots.clear();
+                decision.state = TrackRecognitionState::InProgress;
+                return true;
+            }
+
+            // A window none of whose shots could be embedded keeps its shots and charges the attempt to the budget:
+            // the next window retries them against fresh faces, and a spent budget settles the track as unknown.
+            void fail_best_shot(const std::string& stream_id,
+                                int track_id,
+                                int64_t frame_id,
+                                const std::vector<BestShot>& shots,
+                                Box& track) {
+                std::lock_guard lk(state_->mutex);
+                TrackDecision& decision = state_->streams[stream_id].tracks[track_id];
+                decision.embeddings_used += static_cast<int>(shots.size());
+                decision.last_seen_frame = frame_id;
+                if (decision.embeddings_used >= cfg_.best_shot.max_embeddings) {
+                    decision.state = TrackRecognitionState::DecidedUnknown;
+                    decision.identity_key.clear();
+                    decision.identity_confidence = 0.0f;
+                    decision.privacy_action = "anonymize";
+                    decision.recognition_state = "unknown";
+                    decision.shots.clear();
+                    apply_decision(track, decision);
+                    return;
+                }
+                decision.state = TrackRecognitionState::Collecting;
+                decision.window_start = frame_id + 1;
+                decision.shots = shots;
+            }
+
+            // Settles a closed best-shot window: known results and spent budgets are final, an unknown result with
+            // budget left opens the next window.
+            void finish_best_shot(const std::string& stream_id,
+                                  int track_id,
+                                  int embedded,
+                                  TrackDecision decision,
+                                  Box& track) {
+                std::lock_guard lk(state_->mutex);
+                TrackDecision& current = state_->streams[stream_id].tracks[track_id];
+                decision.embeddings_used = current.embeddings_used + embedded;
+                if (decision.state == TrackRecognitionState::DecidedUnknown &&
+                    decision.embeddings_used < cfg_.best_shot.max_embeddings) {
+                    decision.state = TrackRecognitionState::Collecting;
+                    decision.window_start = decision.last_seen_frame + 1;
+                }
+                current = std::move(decision);
+                apply_decision(track, current);
+            }
+
+            static bool started_in_batch(const std::vector<RecognitionResult>& results,
+                                         const std::vector<PendingFace>& pending,
+                                         const std::string& stream_id,
+                                         int track_id) {
+                for (const PendingFace& face : pending) {
+                    if (results[face.task].stream_id == stream_id && results[face.task].tracks[face.track].id == track_id) {
+                        return true;
+                    }
+                }
+                return false;
             }
 
-        private:
             std::shared_ptr<const Gallery> current_gallery() const {
                 std::lock_guard lk(gallery_->mutex);
                 return gallery_->gallery ? gallery_->gallery : std::make_shared<Gallery>();
@@ -562,6 +1191,12 @@ namespace veilsight {
                 if (track_it == stream_it->second.tracks.end()) return false;
 
                 TrackDecision& decision = track_it->second;
+                if (decision.state == TrackRecognitionState::Collecting) {
+                    // The open window still takes this frame's face, if it passes the gates.
+                    decision.last_seen_frame = frame_id;
+                    track.recognition_state = decision.recognition_state;
+                    return false;
+                }
                 if (decision.state == TrackRecognitionState::InProgress) {
                     track.recognition_state = decision.recognition_state.empty() ? "pending" : decision.recognition_state;
                     return true;
@@ -622,18 +1257,13 @@ namespace veilsight {
                 if (stream_it->second.tracks.empty()) state_->streams.erase(stream_it);
             }
 
-            std::vector<float> extract_embedding(const FramePtr& frame, const FaceObservation& face) {
-                if (!frame || frame->inf.empty()) {
-                    throw std::runtime_error("recognition frame has no inference image");
-                }
-                return extract_mobilefacenet_embedding(net_, workspace_pool_allocator_, cfg_, frame->inf, face);
-            }
-
             RecognizerModuleConfig cfg_;
             std::shared_ptr<SharedGallery> gallery_;
             std::shared_ptr<SharedTrackState> state_;
             ncnn::Net net_;
             mutable ncnn::PoolAllocator workspace_pool_allocator_;
+            std::vector<unsigned char> aligned_; // max_faces aligned crops, reused across batches
+            std::vector<float> embeddings_;
         };
 
         class MobileFaceNetRecognizerFactory final : public IRecognizerFactory {
@@ -642,7 +1272,7 @@ namespace veilsight {
                 : cfg_(std::move(cfg)),
                   gallery_(std::make_shared<SharedGallery>()),
                   state_(std::make_shared<SharedTrackState>()) {
-                gallery_->gallery = load_gallery(cfg_);
+                gallery_->gallery = load_gallery(cfg_, nullptr);
             }
 
             std::unique_ptr<IRecognizer> create() const override {
@@ -655,7 +1285,12 @@ namespace veilsight {
 
             bool reload_gallery(std::string* error) override {
                 try {
-                    auto next = load_gallery(cfg_);
+                    std::shared_ptr<const Gallery> current;
+                    {
+                        std::lock_guard lk(gallery_->mutex);
+                        current = gallery_->gallery;
+                    }
+                    auto next = load_gallery(cfg_, current.get());
                     {
                         std::lock_guard lk(gallery_->mutex);
                         gallery_->gallery = std::move(next);
@@ -678,6 +1313,26 @@ namespace veilsight {
         };
     }
 
+    NcnnModelProbe mobilefacenet_model_probe(const RecognizerModuleConfig& cfg) {
+        NcnnModelProbe probe;
+        const auto [param_file, bin_file] = ncnn_model_files(cfg);
+        probe.name = cfg.precision == "int8" ? "mobilefacenet_int8" : "mobilefacenet";
+        probe.param_path = resolve_path_or_throw(param_file);
+        probe.bin_path = resolve_path_or_throw(bin_file);
+        probe.input_w = cfg.input_w;
+        probe.input_h = cfg.input_h;
+        probe.threads = std::max(1, cfg.ncnn_threads);
+        probe.load = [param = probe.param_path, bin = probe.bin_path](ncnn::Net& net) {
+            if (net.load_param(param.c_str()) != 0) {
+                throw std::runtime_error("Failed to load MobileFaceNet param: " + param);
+            }
+            if (net.load_model(bin.c_str()) != 0) {
+                throw std::runtime_error("Failed to load MobileFaceNet weights: " + bin);
+            }
+        };
+        return probe;
+    }
+
     EnrollmentAnalysisResult analyze_mobilefacenet_enrollment_image(
         const FaceDetectorModuleConfig& face_cfg,
         const RecognizerModuleConfig& recognizer_cfg,
@@ -708,14 +1363,11 @@ namespace veilsight {
             net.opt.num_threads = std::max(1, recognizer_cfg.ncnn_threads);
             ncnn::PoolAllocator workspace_pool_allocator;
             workspace_pool_allocator.set_size_compare_ratio(0.0f);
-            const std::string param = resolve_path_or_throw(recognizer_cfg.param_path);
-            const std::string bin = resolve_path_or_throw(recognizer_cfg.bin_path);
-            if (net.load_param(param.c_str()) != 0) {
-                throw std::runtime_error("Failed to load MobileFaceNet param: " + param);
-            }
-            if (net.load_model(bin.c_str()) != 0) {
-                throw std::runtime_error("Failed to load MobileFaceNet weights: " + bin);
+            const NcnnModelProbe probe = mobilefacenet_model_probe(recognizer_cfg);
+            if (const auto tuning = resolve_ncnn_tuning(recognizer_cfg.ncnn_autotune, probe)) {
+                apply_ncnn_tuning(net.opt, *tuning);
             }
+            probe.load(net);
 
             out.candidates.reserve(faces.size());
             for (const auto& face : faces) {
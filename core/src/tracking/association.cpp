@@ -8,6 +8,172 @@ namespace veilsight {
         float area_of(const Box& b) {
             return std::max(0.0f, b.w) * std::max(0.0f, b.h);
         }
+
+        struct CandidatePair {
+            int track = -1;
+            int detection = -1;
+            float cost = 1.0f;
+            float iou = 0.0f;
+            float grid_cost = 0.0f;
+        };
+
+        struct SpanX {
+            float x1 = 0.0f;
+            float x2 = 0.0f;
+            int index = -1;
+        };
+
+        class DisjointSet {
+        public:
+            explicit DisjointSet(int n) : parent_(static_cast<size_t>(n)) {
+                for (int i = 0; i < n; ++i) parent_[static_cast<size_t>(i)] = i;
+            }
+
+            int find(int x) {
+                while (parent_[static_cast<size_t>(x)] != x) {
+                    parent_[static_cast<size_t>(x)] = parent_[static_cast<size_t>(parent_[static_cast<size_t>(x)])];
+                    x = parent_[static_cast<size_t>(x)];
+                }
+                return x;
+            }
+
+            void unite(int a, int b) {
+                a = find(a);
+                b = find(b);
+                if (a != b) parent_[static_cast<size_t>(std::max(a, b))] = std::min(a, b);
+            }
+
+        private:
+            std::vector<int> parent_;
+        };
+
+        // Jonker-Volgenant on the matrix padded square with zero-cost dummy rows/columns: column reduction
+        // seeds the duals and most of the assignment, then each free row is placed by one Dijkstra-style
+        // shortest augmenting path. Works in double; buffers persist across calls.
+        struct LapjvSolver {
+            int n = 0;
+            std::vector<double> c;
+            std::vector<double> v;
+            std::vector<double> d;
+            std::vector<int> rowsol;
+            std::vector<int> colsol;
+            std::vector<int> pred;
+            std::vector<int> collist;
+            std::vector<int> free_rows;
+
+            double at(int i, int j) const { return c[static_cast<size_t>(i) * static_cast<size_t>(n) + static_cast<size_t>(j)]; }
+
+            void solve(const CostMatrix& cost) {
+                n = std::max(cost.rows, cost.cols);
+                const size_t un = static_cast<size_t>(n);
+                c.assign(un * un, 0.0);
+                for (int i = 0; i < cost.rows; ++i) {
+                    for (int j = 0; j < cost.cols; ++j) {
+                        c[static_cast<size_t>(i) * un + static_cast<size_t>(j)] = cost.at(i, j);
+                    }
+                }
+                v.assign(un, 0.0);
+                d.assign(un, 0.0);
+                rowsol.assign(un, -1);
+                colsol.assign(un, -1);
+                pred.assign(un, 0);
+                collist.assign(un, 0);
+
+                for (int j = n - 1; j >= 0; --j) {
+                    int imin = 0;
+                    double min = at(0, j);
+                    for (int i = 1; i < n; ++i) {
+                        if (at(i, j) < min) {
+                            min = at(i, j);
+                            imin = i;
+                        }
+                    }
+                    v[static_cast<size_t>(j)] = min;
+                    if (rowsol[static_cast<size_t>(imin)] < 0) {
+                        rowsol[static_cast<size_t>(imin)] = j;
+                        colsol[static_cast<size_t>(j)] = imin;
+                    }
+                }
+
+                free_rows.clear();
+                for (int i = 0; i < n; ++i) {
+                    if (rowsol[static_cast<size_t>(i)] < 0) free_rows.push_back(i);
+                }
+                for (int f : free_rows) augment(f);
+            }
+
+            void augment(int f) {
+                for (int j = 0; j < n; ++j) {
+                    d[static_cast<size_t>(j)] = at(f, j) - v[static_cast<size_t>(j)];
+                    pred[static_cast<size_t>(j)] = f;
+                    collist[static_cast<size_t>(j)] = j;
+                }
+
+                // collist[0, low) are settled, [low, up) sit at the current minimum distance, the rest are open.
+                int low = 0;
+                int up = 0;
+                int last = 0;
+                int end_of_path = -1;
+                double min = 0.0;
+                while (end_of_path < 0) {
+                    if (up == low) {
+                        last = low;
+                        min = d[static_cast<size_t>(collist[static_cast<size_t>(up++)])];
+                        for (int k = up; k < n; ++k) {
+                            const int j = collist[static_cast<size_t>(k)];
+                            const double h = d[static_cast<size_t>(j)];
+                            if (h <= min) {
+                                if (h < min) {
+                                    up = low;
+                                    min = h;
+                                }
+                                collist[static_cast<size_t>(k)] = collist[static_cast<size_t>(up)];
+                                collist[static_cast<size_t>(up++)] = j;
+                            }
+                        }
+                        for (int k = low; k < up; ++k) {
+                            if (colsol[static_cast<size_t>(collist[static_cast<size_t>(k)])] < 0) {
+                                end_of_path = collist[static_cast<size_t>(k)];
+                                break;
+                            }
+                        }
+                        if (end_of_path >= 0) break;
+                    }
+
+                    const int j1 = collist[static_cast<size_t>(low++)];
+                    const int i = colsol[static_cast<size_t>(j1)];
+                    const double h = at(i, j1) - v[static_cast<size_t>(j1)] - min;
+                    for (int k = up; k < n; ++k) {
+                        const int j = collist[static_cast<size_t>(k)];
+                        const double reduced = at(i, j) - v[static_cast<size_t>(j)] - h;
+                        if (reduced < d[static_cast<size_t>(j)]) {
+                            pred[static_cast<size_t>(j)] = i;
+                            if (reduced == min) {
+                                if (colsol[static_cast<size_t>(j)] < 0) {
+                                    end_of_path = j;
+                                    break;
+                                }
+                                collist[static_cast<size_t>(k)] = collist[static_cast<size_t>(up)];
+                                collist[static_cast<size_t>(up++)] = j;
+                            }
+                            d[static_cast<size_t>(j)] = reduced;
+                        }
+                    }
+                }
+
+                for (int k = 0; k < last; ++k) {
+                    const int j = collist[static_cast<size_t>(k)];
+                    v[static_cast<size_t>(j)] += d[static_cast<size_t>(j)] - min;
+                }
+
+                int i = -1;
+                do {
+                    i = pred[static_cast<size_t>(end_of_path)];
+                    colsol[static_cast<size_t>(end_of_path)] = i;
+                    std::swap(end_of_path, rowsol[static_cast<size_t>(i)]);
+                } while (i != f);
+            }
+        };
     }
 
     float box_iou(const Box& a, const Box& b) {
@@ -31,101 +197,49 @@ namespace veilsight {
         return inter / uni;
     }
 
-    std::vector<int> hungarian_assignment(const std::vector<std::vector<float>>& cost) {
-        const int rows = static_cast<int>(cost.size());
-        const int cols = rows > 0 ? static_cast<int>(cost[0].size()) : 0;
-        if (rows == 0 || cols == 0) return {};
-
-        bool transposed = false;
-        std::vector<std::vector<float>> mat = cost;
-        int n = rows;
-        int m = cols;
-        if (n > m) {
-            transposed = true;
-            std::vector<std::vector<float>> tmat(static_cast<size_t>(m),
-                                                 std::vector<float>(static_cast<size_t>(n), 0.0f));
-            for (int i = 0; i < n; ++i) {
-                for (int j = 0; j < m; ++j) {
-                    tmat[static_cast<size_t>(j)][static_cast<size_t>(i)] =
-                        mat[static_cast<size_t>(i)][static_cast<size_t>(j)];
-                }
-            }
-            mat = std::move(tmat);
-            std::swap(n, m);
-        }
-
-        const float inf = 1e9f;
-        std::vector<float> u(static_cast<size_t>(n + 1), 0.0f);
-        std::vector<float> v(static_cast<size_t>(m + 1), 0.0f);
-        std::vector<int> p(static_cast<size_t>(m + 1), 0);
-        std::vector<int> way(static_cast<size_t>(m + 1), 0);
-
-        for (int i = 1; i <= n; ++i) {
-            p[0] = i;
-            int j0 = 0;
-            std::vector<float> minv(static_cast<size_t>(m + 1), inf);
-            std::vector<char> used(static_cast<size_t>(m + 1), 0);
-
-            do {
-                used[static_cast<size_t>(j0)] = 1;
-                const int i0 = p[static_cast<size_t>(j0)];
-                float delta = inf;
-                int j1 = 0;
-                for (int j = 1; j <= m; ++j) {
-                    if (used[static_cast<size_t>(j)]) continue;
-                    const float cur =
-                        mat[static_cast<size_t>(i0 - 1)][static_cast<size_t>(j - 1)] -
-                        u[static_cast<size_t>(i0)] - v[static_cast<size_t>(j)];
-                    if (cur < minv[static_cast<size_t>(j)]) {
-                        minv[static_cast<size_t>(j)] = cur;
-                        way[static_cast<size_t>(j)] = j0;
-                    }
-                    if (minv[static_cast<size_t>(j)] < delta) {
-                        delta = minv[static_cast<size_t>(j)];
-                        j1 = j;
-                    }
-                }
-
-                for (int j = 0; j <= m; ++j) {
-                    if (used[static_cast<size_t>(j)]) {
-                        u[static_cast<size_t>(p[static_cast<size_t>(j)])] += delta;
-                        v[static_cast<size_t>(j)] -= delta;
-                    } else {
-                        minv[static_cast<size_t>(j)] -= delta;
-                    }
-                }
-                j0 = j1;
-            } while (p[static_cast<size_t>(j0)] != 0);
-
-            do {
-                const int j1 = way[static_cast<size_t>(j0)];
-                p[static_cast<size_t>(j0)] = p[static_cast<size_t>(j1)];
-                j0 = j1;
-            } while (j0 != 0);
-        }
+    std::vector<int> solve_assignment(const CostMatrix& cost) {
+        const int rows = cost.rows;
+        const int cols = cost.cols;
+        if (rows <= 0 || cols <= 0) return {};
 
         std::vector<int> assignment(static_cast<size_t>(rows), -1);
-        if (!transposed) {
-            for (int j = 1; j <= m; ++j) {
-                if (p[static_cast<size_t>(j)] > 0) {
-                    assignment[static_cast<size_t>(p[static_cast<size_t>(j)] - 1)] = j - 1;
+        if (rows == 1 || cols == 1) {
+            int best_r = 0;
+            int best_c = 0;
+            for (int r = 0; r < rows; ++r) {
+                for (int c = 0; c < cols; ++c) {
+                    if (cost.at(r, c) < cost.at(best_r, best_c)) {
+                        best_r = r;
+                        best_c = c;
+                    }
                 }
             }
+            assignment[static_cast<size_t>(best_r)] = best_c;
             return assignment;
         }
 
-        for (int j = 1; j <= m; ++j) {
-            const int row_t = p[static_cast<size_t>(j)] - 1;
-            if (row_t < 0) continue;
-            const int original_col = row_t;
-            const int original_row = j - 1;
-            if (original_row >= 0 && original_row < rows) {
-                assignment[static_cast<size_t>(original_row)] = original_col;
-            }
+        thread_local LapjvSolver solver;
+        solver.solve(cost);
+        for (int r = 0; r < rows; ++r) {
+            const int c = solver.rowsol[static_cast<size_t>(r)];
+            if (c < cols) assignment[static_cast<size_t>(r)] = c;
         }
         return assignment;
     }
 
+    std::vector<int> hungarian_assignment(const std::vector<std::vector<float>>& cost) {
+        const int rows = static_cast<int>(cost.size());
+        const int cols = rows > 0 ? static_cast<int>(cost[0].size()) : 0;
+        if (rows == 0 || cols == 0) return {};
+
+        CostMatrix flat;
+        flat.reset(rows, cols, 0.0f);
+        for (int i = 0; i < rows; ++i) {
+            std::copy(cost[static_cast<size_t>(i)].begin(), cost[static_cast<size_t>(i)].end(), &flat.at(i, 0));
+        }
+        return solve_assignment(flat);
+    }
+
     AssociationResult associate_detections(const std::vector<Box>& tracks,
                                            const std::vector<Box>& detections,
                                            const AssociationOptions& options) {
@@ -144,55 +258,185 @@ namespace veilsight {
             return result;
         }
 
-        std::vector<std::vector<float>> costs(static_cast<size_t>(rows),
-                                              std::vector<float>(static_cast<size_t>(cols), 1.0f));
-        std::vector<std::vector<float>> ious(static_cast<size_t>(rows),
-                                             std::vector<float>(static_cast<size_t>(cols), 0.0f));
-        std::vector<std::vector<float>> grid_costs(static_cast<size_t>(rows),
-                                                   std::vector<float>(static_cast<size_t>(cols), 0.0f));
+        const float threshold_iou = std::clamp(options.iou_threshold, 0.0f, 0.999f);
+        std::vector<CandidatePair> pairs;
+        // The dense cost of any pair, gated or not; gate-failing pairs inside a component are priced with it too.
+        // The per-component solve matches a full tracks x detections solve only when gated-out pairs are
+        // infeasible there as well: a dense solve free to assign a gated-out pair across components (and drop
+        // it afterwards) can settle on a different set of in-gate matches.
+        const auto pair_cost = [&](int i, int j, float iou, const SceneGridAssociationCost& grid) {
+            const float det_score = std::clamp(detections[static_cast<size_t>(j)].score, 0.0f, 1.0f);
+            float total_cost = options.fuse_score ? 1.0f - (iou * det_score) : 1.0f - iou;
+            total_cost += grid.extra_cost;
+            if (options.cost_bonus) {
+                total_cost -= options.cost_bonus->at(i, j);
+            }
+            return total_cost;
+        };
+        // Gating uses IoU alone; costs are filled per component once its rows and columns are known.
+        const auto add_candidate = [&](int i, int j) {
+            const float iou = box_iou(tracks[static_cast<size_t>(i)], detections[static_cast<size_t>(j)]);
+            if (iou < threshold_iou) return;
+            pairs.push_back(CandidatePair{i, j, 1.0f, iou, 0.0f});
+        };
 
-        for (int i = 0; i < rows; ++i) {
+        if (threshold_iou <= 0.0f) {
+            for (int i = 0; i < rows; ++i) {
+                for (int j = 0; j < cols; ++j) add_candidate(i, j);
+            }
+        } else {
+            // A positive gate needs the boxes to overlap, so sweep detections sorted by left edge and only
+            // test the ones whose x-span can reach each track.
+            std::vector<SpanX> spans(static_cast<size_t>(cols));
+            float widest = 0.0f;
             for (int j = 0; j < cols; ++j) {
-                const float iou = box_iou(tracks[static_cast<size_t>(i)], detections[static_cast<size_t>(j)]);
-                const float det_score = std::clamp(detections[static_cast<size_t>(j)].score, 0.0f, 1.0f);
-                float total_cost = options.fuse_score ? 1.0f - (iou * det_score) : 1.0f - iou;
-
-                float grid_raw_cost = 0.0f;
-                if (options.scene_grid) {
-                    const SceneGridAssociationCost grid =
-                        options.scene_grid->association_cost(options.stream_id,
-                                                             options.frame_width,
-                                                             options.frame_height,
-                                                             tracks[static_cast<size_t>(i)],
-                                                             detections[static_cast<size_t>(j)]);
-                    grid_raw_cost = grid.raw_cost;
-                    total_cost += grid.extra_cost;
+                const Box& det = detections[static_cast<size_t>(j)];
+                spans[static_cast<size_t>(j)] = SpanX{det.x, det.x + det.w, j};
+                widest = std::max(widest, det.w);
+            }
+            std::sort(spans.begin(), spans.end(), [](const SpanX& a, const SpanX& b) {
+                return a.x1 < b.x1 || (a.x1 == b.x1 && a.index < b.index);
+            });
+            for (int i = 0; i < rows; ++i) {
+                const Box& track = tracks[static_cast<size_t>(i)];
+                const float left = track.x - widest;
+                const float right = track.x + track.w;
+                auto it = std::lower_bound(spans.begin(), spans.end(), left,
+                                           [](const SpanX& s, float x) { return s.x1 < x; });
+                for (; it != spans.end() && it->x1 < right; ++it) {
+                    if (it->x2 > track.x) add_candidate(i, it->index);
                 }
+            }
+        }
 
-                costs[static_cast<size_t>(i)][static_cast<size_t>(j)] = total_cost;
-                ious[static_cast<size_t>(i)][static_cast<size_t>(j)] = iou;
-                grid_costs[static_cast<size_t>(i)][static_cast<size_t>(j)] = grid_raw_cost;
+        // Tracks are nodes [0, rows), detections [rows, rows + cols).
+        DisjointSet components(rows + cols);
+        for (const auto& pair : pairs) components.unite(pair.track, rows + pair.detection);
+
+        std::vector<int> component_of(static_cast<size_t>(rows + cols), -1);
+        std::vector<int> offsets(1, 0);
+        for (const auto& pair : pairs) {
+            int& id = component_of[static_cast<size_t>(components.find(pair.track))];
+            if (id < 0) {
+                id = static_cast<int>(offsets.size()) - 1;
+                offsets.push_back(0);
+            }
+            ++offsets[static_cast<size_t>(id) + 1];
+        }
+        for (size_t k = 1; k < offsets.size(); ++k) offsets[k] += offsets[k - 1];
+        std::vector<int> by_component(pairs.size());
+        {
+            std::vector<int> cursor(offsets.begin(), offsets.end() - 1);
+            for (size_t p = 0; p < pairs.size(); ++p) {
+                const int id = component_of[static_cast<size_t>(components.find(pairs[p].track))];
+                by_component[static_cast<size_t>(cursor[static_cast<size_t>(id)]++)] = static_cast<int>(p);
             }
         }
 
-        const std::vector<int> assignment = hungarian_assignment(costs);
-        std::vector<char> detection_taken(static_cast<size_t>(cols), 0);
-        const float threshold_iou = std::clamp(options.iou_threshold, 0.0f, 0.999f);
+        std::vector<int> matched_pair(static_cast<size_t>(rows), -1);
+        std::vector<int> local_row(static_cast<size_t>(rows), -1);
+        std::vector<int> local_col(static_cast<size_t>(cols), -1);
+        std::vector<int> row_tracks;
+        std::vector<int> col_detections;
+        std::vector<int> pair_at;
+        CostMatrix cost;
+        // SceneGrid costs are computed per component block, so the grid never sees a dense
+        // tracks x detections product either.
+        thread_local SceneGridCostBlock grid_costs;
+        thread_local std::vector<Box> block_tracks;
+        thread_local std::vector<Box> block_detections;
+        for (size_t id = 0; id + 1 < offsets.size(); ++id) {
+            const int begin = offsets[id];
+            const int end = offsets[id + 1];
+
+            row_tracks.clear();
+            col_detections.clear();
+            for (int k = begin; k < end; ++k) {
+                const CandidatePair& pair = pairs[static_cast<size_t>(by_component[static_cast<size_t>(k)])];
+                if (local_row[static_cast<size_t>(pair.track)] < 0) {
+                    local_row[static_cast<size_t>(pair.track)] = static_cast<int>(row_tracks.size());
+                    row_tracks.push_back(pair.track);
+                }
+                if (local_col[static_cast<size_t>(pair.detection)] < 0) {
+                    local_col[static_cast<size_t>(pair.detection)] = static_cast<int>(col_detections.size());
+                    col_detections.push_back(pair.detection);
+                }
+            }
+            const int n_rows = static_cast<int>(row_tracks.size());
+            const int n_cols = static_cast<int>(col_detections.size());
+
+            grid_costs.active = false;
+            if (options.scene_grid) {
+                block_tracks.clear();
+                block_detections.clear();
+                for (const int i : row_tracks) block_tracks.push_back(tracks[static_cast<size_t>(i)]);
+                for (const int j : col_detections) block_detections.push_back(detections[static_cast<size_t>(j)]);
+                options.scene_grid->association_costs(options.stream_id,
+                                                      options.frame_width,
+                                                      options.frame_height,
+                                                      block_tracks,
+                                                      block_detections,
+                                                      grid_costs);
+            }
+            for (int k = begin; k < end; ++k) {
+                CandidatePair& pair = pairs[static_cast<size_t>(by_component[static_cast<size_t>(k)])];
+                const SceneGridAssociationCost grid = grid_costs.at(local_row[static_cast<size_t>(pair.track)],
+                                                                    local_col[static_cast<size_t>(pair.detection)]);
+                pair.cost = pair_cost(pair.track, pair.detection, pair.iou, grid);
+                pair.grid_cost = grid.raw_cost;
+            }
+
+            if (end - begin == 1) {
+                const int p = by_component[static_cast<size_t>(begin)];
+                matched_pair[static_cast<size_t>(pairs[static_cast<size_t>(p)].track)] = p;
+            } else {
+                cost.reset(n_rows, n_cols, 0.0f);
+                for (int r = 0; r < n_rows; ++r) {
+                    const int i = row_tracks[static_cast<size_t>(r)];
+                    for (int c = 0; c < n_cols; ++c) {
+                        const int j = col_detections[static_cast<size_t>(c)];
+                        const float iou = box_iou(tracks[static_cast<size_t>(i)], detections[static_cast<size_t>(j)]);
+                        cost.at(r, c) = pair_cost(i, j, iou, grid_costs.at(r, c));
+                    }
+                }
+                pair_at.assign(static_cast<size_t>(n_rows) * static_cast<size_t>(n_cols), -1);
+                for (int k = begin; k < end; ++k) {
+                    const int p = by_component[static_cast<size_t>(k)];
+                    const CandidatePair& pair = pairs[static_cast<size_t>(p)];
+                    const int r = local_row[static_cast<size_t>(pair.track)];
+                    const int c = local_col[static_cast<size_t>(pair.detection)];
+                    pair_at[static_cast<size_t>(r) * static_cast<size_t>(n_cols) + static_cast<size_t>(c)] = p;
+                }
 
+                const std::vector<int> assignment = solve_assignment(cost);
+                for (int r = 0; r < n_rows; ++r) {
+                    const int c = assignment[static_cast<size_t>(r)];
+                    if (c < 0) continue;
+                    const int p =
+                        pair_at[static_cast<size_t>(r) * static_cast<size_t>(n_cols) + static_cast<size_t>(c)];
+                    if (p >= 0) matched_pair[static_cast<size_t>(row_tracks[static_cast<size_t>(r)])] = p;
+                }
+            }
+
+            for (const int i : row_tracks) local_row[static_cast<size_t>(i)] = -1;
+            for (const int j : col_detections) local_col[static_cast<size_t>(j)] = -1;
+        }
+
+        std::vector<char> detection_taken(static_cast<size_t>(cols), 0);
         for (int i = 0; i < rows; ++i) {
-            const int j = i < static_cast<int>(assignment.size()) ? assignment[static_cast<size_t>(i)] : -1;
-            if (j < 0 || j >= cols ||
-                ious[static_cast<size_t>(i)][static_cast<size_t>(j)] < threshold_iou) {
+            const int p = matched_pair[static_cast<size_t>(i)];
+            if (p < 0) {
                 result.unmatched_tracks.push_back(i);
                 continue;
             }
-            detection_taken[static_cast<size_t>(j)] = 1;
+            const CandidatePair& pair = pairs[static_cast<size_t>(p)];
+            detection_taken[static_cast<size_t>(pair.detection)] = 1;
             result.matches.push_back(AssociationMatch{
                 i,
-                j,
-                costs[static_cast<size_t>(i)][static_cast<size_t>(j)],
-                ious[static_cast<size_t>(i)][static_cast<size_t>(j)],
-                grid_costs[static_cast<size_t>(i)][static_cast<size_t>(j)],
+                pair.detection,
+                pair.cost,
+                pair.iou,
+                pair.grid_cost,
                 options.stage,
             });
         }
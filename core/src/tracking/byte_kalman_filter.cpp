@@ -0,0 +1,152 @@
+#include <tracking/byte_kalman_filter.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+
+namespace veilsight {
+    void ByteKalmanFilter::initiate(const cv::Vec4f& measurement, KalmanMean& mean, KalmanCovariance& covariance) const {
+        mean = KalmanMean();
+        for (int i = 0; i < 4; ++i) mean(i, 0) = measurement[i];
+
+        const float h = std::max(1.0f, measurement[3]);
+        const std::array<float, 8> std = {
+            2.0f * kStdWeightPosition * h,
+            2.0f * kStdWeightPosition * h,
+            1e-2f,
+            2.0f * kStdWeightPosition * h,
+            10.0f * kStdWeightVelocity * h,
+            10.0f * kStdWeightVelocity * h,
+            1e-5f,
+            10.0f * kStdWeightVelocity * h,
+        };
+
+        covariance = KalmanCovariance();
+        for (int i = 0; i < 8; ++i) covariance(i, i) = std[static_cast<size_t>(i)] * std[static_cast<size_t>(i)];
+    }
+
+    void ByteKalmanFilter::predict(const std::vector<KalmanState*>& states) {
+        const size_t n = states.size();
+        if (n == 0) return;
+        soa_.resize(kRows * n);
+        const auto row = [this, n](int r) { return soa_.data() + static_cast<size_t>(r) * n; };
+        const auto cov = [&row](int i, int j) { return row(8 + i * 8 + j); };
+
+        for (size_t t = 0; t < n; ++t) {
+            const KalmanState& state = *states[t];
+            for (int i = 0; i < 8; ++i) row(i)[t] = state.mean(i, 0);
+            for (int i = 0; i < 8; ++i) {
+                for (int j = 0; j < 8; ++j) cov(i, j)[t] = state.covariance(i, j);
+            }
+        }
+
+        // P' = F P F^T with P = [A B; B^T C]: A' = A + B + B^T + C, B' = B + C, C' = C.
+        for (int i = 0; i < 4; ++i) {
+            for (int j = 0; j < 4; ++j) {
+                float* a = cov(i, j);
+                const float* b = cov(i, j + 4);
+                const float* bt = cov(i + 4, j);
+                const float* c = cov(i + 4, j + 4);
+                for (size_t t = 0; t < n; ++t) a[t] += b[t] + bt[t] + c[t];
+            }
+        }
+        for (int i = 0; i < 4; ++i) {
+            for (int j = 0; j < 4; ++j) {
+                float* b = cov(i, j + 4);
+                float* bt = cov(j + 4, i);
+                const float* c = cov(i + 4, j + 4);
+                const float* ct = cov(j + 4, i + 4);
+                for (size_t t = 0; t < n; ++t) {
+                    b[t] += c[t];
+                    bt[t] += ct[t];
+                }
+            }
+        }
+
+        // Process noise scales with the height before motion, as in ByteTrack's reference filter.
+        const float* h = row(3);
+        for (size_t t = 0; t < n; ++t) {
+            const float height = std::max(1.0f, h[t]);
+            const float pos = kStdWeightPosition * height;
+            const float vel = kStdWeightVelocity * height;
+            cov(0, 0)[t] += pos * pos;
+            cov(1, 1)[t] += pos * pos;
+            cov(2, 2)[t] += 1e-4f;
+            cov(3, 3)[t] += pos * pos;
+            cov(4, 4)[t] += vel * vel;
+            cov(5, 5)[t] += vel * vel;
+            cov(6, 6)[t] += 1e-10f;
+            cov(7, 7)[t] += vel * vel;
+        }
+
+        for (int i = 0; i < 4; ++i) {
+            float* pos = row(i);
+            const float* vel = row(i + 4);
+            for (size_t t = 0; t < n; ++t) pos[t] += vel[t];
+        }
+
+        for (size_t t = 0; t < n; ++t) {
+            KalmanState& state = *states[t];
+            for (int i = 0; i < 8; ++i) state.mean(i, 0) = row(i)[t];
+            for (int i = 0; i < 8; ++i) {
+                for (int j = 0; j < 8; ++j) state.covariance(i, j) = cov(i, j)[t];
+            }
+        }
+    }
+
+    void ByteKalmanFilter::update(KalmanMean& mean, KalmanCovariance& covariance, const cv::Vec4f& measurement) const {
+        const float h = std::max(1.0f, mean(3, 0));
+        const float pos = kStdWeightPosition * h;
+        const std::array<float, 4> noise = {pos * pos, pos * pos, 1e-2f, pos * pos};
+
+        // S = H P H^T + R is the top-left block of P plus measurement noise; factor it as L L^T.
+        float l[4][4] = {};
+        for (int i = 0; i < 4; ++i) {
+            for (int j = 0; j <= i; ++j) {
+                float sum = covariance(i, j) + (i == j ? noise[static_cast<size_t>(i)] : 0.0f);
+                for (int k = 0; k < j; ++k) sum -= l[i][k] * l[j][k];
+                if (i == j) {
+                    l[i][i] = std::sqrt(std::max(sum, 1e-12f));
+                } else {
+                    l[i][j] = sum / l[j][j];
+                }
+            }
+        }
+
+        // K^T = S^-1 (H P): solve against the top four rows of P by forward and back substitution.
+        float gain_t[4][8];
+        for (int c = 0; c < 8; ++c) {
+            float y[4];
+            for (int i = 0; i < 4; ++i) {
+                float sum = covariance(i, c);
+                for (int k = 0; k < i; ++k) sum -= l[i][k] * y[k];
+                y[i] = sum / l[i][i];
+            }
+            for (int i = 3; i >= 0; --i) {
+                float sum = y[i];
+                for (int k = i + 1; k < 4; ++k) sum -= l[k][i] * gain_t[k][c];
+                gain_t[i][c] = sum / l[i][i];
+            }
+        }
+
+        float innovation[4];
+        for (int i = 0; i < 4; ++i) innovation[i] = measurement[i] - mean(i, 0);
+
+        // P -= K (H P), read from a copy of H P since those rows are overwritten.
+        float hp[4][8];
+        for (int i = 0; i < 4; ++i) {
+            for (int c = 0; c < 8; ++c) hp[i][c] = covariance(i, c);
+        }
+        for (int r = 0; r < 8; ++r) {
+            float dm = 0.0f;
+            for (int k = 0; k < 4; ++k) dm += gain_t[k][r] * innovation[k];
+            mean(r, 0) += dm;
+            for (int c = 0; c < 8; ++c) {
+                float dp = 0.0f;
+                for (int k = 0; k < 4; ++k) dp += gain_t[k][r] * hp[k][c];
+                covariance(r, c) -= dp;
+            }
+        }
+    }
+}
@@ -1,12 +1,15 @@
 #include <tracking/tracker.hpp>
 #include <tracking/association.hpp>
+#include <tracking/byte_kalman_filter.hpp>
 #include <tracking/scene_grid.hpp>
 
 #include <algorithm>
+#include <array>
+#include <bit>
 #include <cmath>
+#include <cstdint>
 #include <memory>
 #include <stdexcept>
-#include <unordered_set>
 #include <utility>
 #include <vector>
 
@@ -21,7 +24,7 @@ enum class TrackState : uint8_t {
     Removed = 2,
 };
 
-struct Track {
+struct Track : KalmanState {
     int id = 0;
     int64_t start_frame = 0;
     int64_t frame_id = 0;
@@ -29,116 +32,75 @@ struct Track {
     float score = 0.0f;
     bool is_activated = false;
     TrackState state = TrackState::Tracked;
+    uint64_t tracked_seq = 0; // when the track last joined the tracked list; orders the output
     Box tlwh{};
 
-    cv::Mat mean;       // 8x1 (x, y, a, h, vx, vy, va, vh)
-    cv::Mat covariance; // 8x8
+    bool has_filter = false; // detections carry no filter state until activated
 
     int64_t end_frame() const { return frame_id; }
 };
 
-using TrackPtr = std::shared_ptr<Track>;
+using TrackHandle = uint32_t;
 
-class ByteKalmanFilter {
+// Tracks live in one contiguous pool addressed by stable handles. List membership is one bit per state, so
+// moving a track between tracked, lost and removed is O(1) and each list is walked in slot order. Removed
+// slots go back on a free list instead of being deallocated.
+class TrackArena {
 public:
-    ByteKalmanFilter() {
-        motion_mat_ = cv::Mat::eye(8, 8, CV_32F);
-        for (int i = 0; i < 4; ++i) motion_mat_.at<float>(i, i + 4) = 1.0f;
-
-        update_mat_ = cv::Mat::zeros(4, 8, CV_32F);
-        for (int i = 0; i < 4; ++i) update_mat_.at<float>(i, i) = 1.0f;
+    TrackHandle create(TrackState state) {
+        TrackHandle h;
+        if (!free_.empty()) {
+            h = free_.back();
+            free_.pop_back();
+            slots_[h] = Track{};
+        } else {
+            h = static_cast<TrackHandle>(slots_.size());
+            slots_.emplace_back();
+            const size_t words = (slots_.size() + 63) / 64;
+            for (auto& bits : bits_) bits.resize(words, 0);
+        }
+        slots_[h].state = state;
+        bits_[index(state)][h / 64] |= bit(h);
+        return h;
     }
 
-    void initiate(const cv::Vec4f& measurement, cv::Mat& mean, cv::Mat& covariance) const {
-        mean = cv::Mat::zeros(8, 1, CV_32F);
-        mean.at<float>(0, 0) = measurement[0];
-        mean.at<float>(1, 0) = measurement[1];
-        mean.at<float>(2, 0) = measurement[2];
-        mean.at<float>(3, 0) = measurement[3];
-
-        const float h = std::max(1.0f, measurement[3]);
-        const std::vector<float> std = {
-            2.0f * std_weight_position_ * h,
-            2.0f * std_weight_position_ * h,
-            1e-2f,
-            2.0f * std_weight_position_ * h,
-            10.0f * std_weight_velocity_ * h,
-            10.0f * std_weight_velocity_ * h,
-            1e-5f,
-            10.0f * std_weight_velocity_ * h,
-        };
-
-        covariance = cv::Mat::zeros(8, 8, CV_32F);
-        for (int i = 0; i < 8; ++i) covariance.at<float>(i, i) = std[i] * std[i];
-    }
+    Track& operator[](TrackHandle h) { return slots_[h]; }
+    const Track& operator[](TrackHandle h) const { return slots_[h]; }
 
-    void predict(cv::Mat& mean, cv::Mat& covariance) const {
-        if (mean.empty() || covariance.empty()) return;
-
-        const float h = std::max(1.0f, mean.at<float>(3, 0));
-        const std::vector<float> std = {
-            std_weight_position_ * h,
-            std_weight_position_ * h,
-            1e-2f,
-            std_weight_position_ * h,
-            std_weight_velocity_ * h,
-            std_weight_velocity_ * h,
-            1e-5f,
-            std_weight_velocity_ * h,
-        };
-
-        cv::Mat motion_cov = cv::Mat::zeros(8, 8, CV_32F);
-        for (int i = 0; i < 8; ++i) motion_cov.at<float>(i, i) = std[i] * std[i];
-
-        mean = motion_mat_ * mean;
-        covariance = motion_mat_ * covariance * motion_mat_.t() + motion_cov;
+    void set_state(TrackHandle h, TrackState state) {
+        Track& track = slots_[h];
+        bits_[index(track.state)][h / 64] &= ~bit(h);
+        bits_[index(state)][h / 64] |= bit(h);
+        track.state = state;
     }
 
-    void update(cv::Mat& mean, cv::Mat& covariance, const cv::Vec4f& measurement) const {
-        if (mean.empty() || covariance.empty()) return;
-
-        cv::Mat projected_mean;
-        cv::Mat projected_covariance;
-        project_(mean, covariance, projected_mean, projected_covariance);
-
-        cv::Mat innovation = cv::Mat::zeros(4, 1, CV_32F);
-        innovation.at<float>(0, 0) = measurement[0] - projected_mean.at<float>(0, 0);
-        innovation.at<float>(1, 0) = measurement[1] - projected_mean.at<float>(1, 0);
-        innovation.at<float>(2, 0) = measurement[2] - projected_mean.at<float>(2, 0);
-        innovation.at<float>(3, 0) = measurement[3] - projected_mean.at<float>(3, 0);
-
-        cv::Mat projected_cov_inv;
-        cv::invert(projected_covariance, projected_cov_inv, cv::DECOMP_SVD);
-        const cv::Mat kalman_gain = covariance * update_mat_.t() * projected_cov_inv;
+    // Appends the handles in `state`, in slot order.
+    void collect(TrackState state, std::vector<TrackHandle>& out) const {
+        const auto& bits = bits_[index(state)];
+        for (size_t w = 0; w < bits.size(); ++w) {
+            for (uint64_t word = bits[w]; word != 0; word &= word - 1) {
+                out.push_back(static_cast<TrackHandle>(w * 64 + static_cast<size_t>(std::countr_zero(word))));
+            }
+        }
+    }
 
-        mean = mean + kalman_gain * innovation;
-        covariance = covariance - kalman_gain * projected_covariance * kalman_gain.t();
+    void recycle_removed() {
+        auto& removed = bits_[index(TrackState::Removed)];
+        for (size_t w = 0; w < removed.size(); ++w) {
+            for (uint64_t word = removed[w]; word != 0; word &= word - 1) {
+                free_.push_back(static_cast<TrackHandle>(w * 64 + static_cast<size_t>(std::countr_zero(word))));
+            }
+            removed[w] = 0;
+        }
     }
 
 private:
-    void project_(const cv::Mat& mean,
-                  const cv::Mat& covariance,
-                  cv::Mat& projected_mean,
-                  cv::Mat& projected_covariance) const {
-        const float h = std::max(1.0f, mean.at<float>(3, 0));
-        const std::vector<float> std = {
-            std_weight_position_ * h,
-            std_weight_position_ * h,
-            1e-1f,
-            std_weight_position_ * h,
-        };
-
-        cv::Mat innovation_cov = cv::Mat::zeros(4, 4, CV_32F);
-        for (int i = 0; i < 4; ++i) innovation_cov.at<float>(i, i) = std[i] * std[i];
-
-        projected_mean = update_mat_ * mean;
-        projected_covariance = update_mat_ * covariance * update_mat_.t() + innovation_cov;
-    }
+    static size_t index(TrackState state) { return static_cast<size_t>(state); }
+    static uint64_t bit(TrackHandle h) { return uint64_t{1} << (h % 64); }
 
-    cv::Mat motion_mat_;
-    cv::Mat update_mat_;
-    const float std_weight_position_ = 1.0f / 20.0f;
-    const float std_weight_velocity_ = 1.0f / 160.0f;
+    std::vector<Track> slots_;
+    std::array<std::vector<uint64_t>, 3> bits_;
+    std::vector<TrackHandle> free_;
 };
 
 // ---------------------------
@@ -154,11 +116,11 @@ static inline cv::Vec4f tlwh_to_xyah(const Box& b) {
     return cv::Vec4f(b.x + w * 0.5f, b.y + h * 0.5f, w / h, h);
 }
 
-static inline Box xyah_to_tlwh(const cv::Mat& mean) {
-    const float cx = mean.at<float>(0, 0);
-    const float cy = mean.at<float>(1, 0);
-    const float a  = mean.at<float>(2, 0);
-    const float h  = std::max(1.0f, mean.at<float>(3, 0));
+static inline Box xyah_to_tlwh(const KalmanMean& mean) {
+    const float cx = mean(0, 0);
+    const float cy = mean(1, 0);
+    const float a  = mean(2, 0);
+    const float h  = std::max(1.0f, mean(3, 0));
     const float w  = std::max(1.0f, a * h);
 
     Box out;
@@ -169,20 +131,26 @@ static inline Box xyah_to_tlwh(const cv::Mat& mean) {
     return out;
 }
 
-static inline void damp_or_reset_velocity(cv::Mat& mean, TrackState state) {
-    if (mean.empty()) return;
-
+static inline void damp_or_reset_velocity(KalmanMean& mean, TrackState state) {
     if (state != TrackState::Tracked) {
-        for (int i = 4; i < 8; ++i) mean.at<float>(i, 0) = 0.0f;
+        for (int i = 4; i < 8; ++i) mean(i, 0) = 0.0f;
     }
 }
 
-static inline void predict_track(Track& track, const ByteKalmanFilter& kf) {
-    if (track.mean.empty() || track.covariance.empty()) return;
-
-    damp_or_reset_velocity(track.mean, track.state);
-    kf.predict(track.mean, track.covariance);
-    track.tlwh = xyah_to_tlwh(track.mean);
+static void predict_tracks(TrackArena& arena, const std::vector<TrackHandle>& pool, ByteKalmanFilter& kf) {
+    std::vector<KalmanState*> filtered;
+    filtered.reserve(pool.size());
+    for (TrackHandle h : pool) {
+        Track& t = arena[h];
+        if (!t.has_filter) continue;
+        damp_or_reset_velocity(t.mean, t.state);
+        filtered.push_back(&t);
+    }
+    kf.predict(filtered);
+    for (KalmanState* state : filtered) {
+        Track& t = static_cast<Track&>(*state);
+        t.tlwh = xyah_to_tlwh(t.mean);
+    }
 }
 
 static inline void activate_track(Track& track,
@@ -191,98 +159,62 @@ static inline void activate_track(Track& track,
                                   int track_id) {
     const cv::Vec4f xyah = tlwh_to_xyah(track.tlwh);
     kf.initiate(xyah, track.mean, track.covariance);
+    track.has_filter = true;
     track.tlwh = xyah_to_tlwh(track.mean);
 
     track.id = track_id;
     track.frame_id = frame_id;
     track.start_frame = frame_id;
     track.tracklet_len = 0;
-    track.state = TrackState::Tracked;
 
     track.is_activated = true;
 }
 
+// Leaves the state to the caller, which moves the track through the arena.
 static inline void update_track(Track& track,
-                                const Track& detection,
+                                const Box& detection,
                                 const ByteKalmanFilter& kf,
                                 int64_t frame_id) {
-    const cv::Vec4f meas_xyah = tlwh_to_xyah(detection.tlwh);
-    kf.update(track.mean, track.covariance, meas_xyah);
-    track.tlwh = xyah_to_tlwh(track.mean);
+    if (track.has_filter) {
+        kf.update(track.mean, track.covariance, tlwh_to_xyah(detection));
+        track.tlwh = xyah_to_tlwh(track.mean);
+    }
 
     track.frame_id = frame_id;
     track.tracklet_len += 1;
-    track.state = TrackState::Tracked;
     track.is_activated = true;
     track.score = detection.score;
 }
 
-static inline void reactivate_track(Track& track,
-                                    const Track& detection,
-                                    const ByteKalmanFilter& kf,
-                                    int64_t frame_id) {
-    update_track(track, detection, kf, frame_id);
-}
-
-static std::vector<Box> track_boxes(const std::vector<TrackPtr>& tracks) {
+static std::vector<Box> track_boxes(const TrackArena& arena, const std::vector<TrackHandle>& handles) {
     std::vector<Box> out;
-    out.reserve(tracks.size());
-    for (const auto& t : tracks) out.push_back(t ? t->tlwh : Box{});
-    return out;
-}
-
-static std::vector<TrackPtr> joint_tracks(const std::vector<TrackPtr>& a,
-                                          const std::vector<TrackPtr>& b) {
-    std::vector<TrackPtr> out;
-    out.reserve(a.size() + b.size());
-    std::unordered_set<int> seen;
-    for (const auto& t : a) if (t && seen.insert(t->id).second) out.push_back(t);
-    for (const auto& t : b) if (t && seen.insert(t->id).second) out.push_back(t);
+    out.reserve(handles.size());
+    for (TrackHandle h : handles) out.push_back(arena[h].tlwh);
     return out;
 }
 
-static std::vector<TrackPtr> sub_tracks(const std::vector<TrackPtr>& a,
-                                        const std::vector<TrackPtr>& b) {
-    std::unordered_set<int> drop;
-    for (const auto& t : b) if (t) drop.insert(t->id);
-
-    std::vector<TrackPtr> out;
-    out.reserve(a.size());
-    for (const auto& t : a) if (t && drop.find(t->id) == drop.end()) out.push_back(t);
-    return out;
-}
-
-static std::pair<std::vector<TrackPtr>, std::vector<TrackPtr>> remove_duplicate_tracks(
-    const std::vector<TrackPtr>& tracked,
-    const std::vector<TrackPtr>& lost,
-    float duplicate_iou_thresh) {
-
-    if (tracked.empty() || lost.empty()) return {tracked, lost};
+// Of each tracked/lost pair overlapping above the threshold, the shorter-lived one is removed.
+static void remove_duplicate_tracks(TrackArena& arena,
+                                    const std::vector<TrackHandle>& tracked,
+                                    const std::vector<TrackHandle>& lost,
+                                    float duplicate_iou_thresh) {
+    if (tracked.empty() || lost.empty()) return;
 
     const float duplicate_iou = std::clamp(duplicate_iou_thresh, 0.0f, 0.999f);
 
-    std::unordered_set<int> drop_tracked;
-    std::unordered_set<int> drop_lost;
-    for (size_t i = 0; i < tracked.size(); ++i) {
-        for (size_t j = 0; j < lost.size(); ++j) {
-            if (box_iou(tracked[i]->tlwh, lost[j]->tlwh) < duplicate_iou) continue;
+    std::vector<TrackHandle> drop;
+    for (TrackHandle ht : tracked) {
+        const Track& t = arena[ht];
+        for (TrackHandle hl : lost) {
+            const Track& l = arena[hl];
+            if (box_iou(t.tlwh, l.tlwh) < duplicate_iou) continue;
 
-            const int tracked_len = tracked[i]->frame_id - tracked[i]->start_frame;
-            const int lost_len = lost[j]->frame_id - lost[j]->start_frame;
-            if (tracked_len > lost_len) drop_lost.insert(lost[j]->id);
-            else drop_tracked.insert(tracked[i]->id);
+            const int64_t tracked_len = t.frame_id - t.start_frame;
+            const int64_t lost_len = l.frame_id - l.start_frame;
+            drop.push_back(tracked_len > lost_len ? hl : ht);
         }
     }
-
-    std::vector<TrackPtr> tracked_out;
-    tracked_out.reserve(tracked.size());
-    for (const auto& t : tracked) if (t && drop_tracked.find(t->id) == drop_tracked.end()) tracked_out.push_back(t);
-
-    std::vector<TrackPtr> lost_out;
-    lost_out.reserve(lost.size());
-    for (const auto& t : lost) if (t && drop_lost.find(t->id) == drop_lost.end()) lost_out.push_back(t);
-
-    return {std::move(tracked_out), std::move(lost_out)};
+    for (TrackHandle h : drop) arena.set_state(h, TrackState::Removed);
 }
 
 class ByteTracker final : public ITracker {
@@ -310,8 +242,8 @@ public:
         frame_id_ = frame.frame_id > 0 ? frame.frame_id : frame_id_ + 1;
         scene_grid_.begin_frame(frame.stream_id);
 
-        std::vector<TrackPtr> high_dets;
-        std::vector<TrackPtr> low_dets;
+        std::vector<Box> high_dets;
+        std::vector<Box> low_dets;
         high_dets.reserve(detections.size());
         low_dets.reserve(detections.size());
 
@@ -319,42 +251,32 @@ public:
             if (det.w <= 1.0f || det.h <= 1.0f) continue;
             if (area_of(det) < cfg_.min_box_area) continue;
 
-            auto t = std::make_shared<Track>();
-            t->tlwh = det;
-            t->score = det.score;
-
-            if (det.score >= cfg_.high_thresh) high_dets.push_back(std::move(t));
-            else if (det.score >= cfg_.low_thresh) low_dets.push_back(std::move(t));
+            if (det.score >= cfg_.high_thresh) high_dets.push_back(det);
+            else if (det.score >= cfg_.low_thresh) low_dets.push_back(det);
         }
 
-        std::vector<TrackPtr> activated_tracks;
-        std::vector<TrackPtr> refind_tracks;
-        std::vector<TrackPtr> lost_tracks;
-        std::vector<TrackPtr> removed_tracks;
-
         // split tracked into confirmed / unconfirmed
-        std::vector<TrackPtr> unconfirmed;
-        std::vector<TrackPtr> tracked_tracks;
-        for (const auto& t : tracked_tracks_) {
-            if (!t) continue;
-            if (!t->is_activated) unconfirmed.push_back(t);
-            else tracked_tracks.push_back(t);
+        std::vector<TrackHandle> tracked;
+        arena_.collect(TrackState::Tracked, tracked);
+        std::vector<TrackHandle> unconfirmed;
+        std::vector<TrackHandle> track_pool;
+        for (TrackHandle h : tracked) {
+            if (!arena_[h].is_activated) unconfirmed.push_back(h);
+            else track_pool.push_back(h);
         }
 
         // pool = tracked + lost, then predict
-        std::vector<TrackPtr> track_pool = joint_tracks(tracked_tracks, lost_tracks_);
-        for (auto& t : track_pool) if (t) predict_track(*t, kf_);
-
-        // 1) match pool with high dets
-        std::vector<std::pair<int, int>> matches;
-        std::vector<int> unmatched_track_idx;
-        std::vector<int> unmatched_det_idx;
+        std::vector<TrackHandle> lost_before;
+        arena_.collect(TrackState::Lost, lost_before);
+        track_pool.insert(track_pool.end(), lost_before.begin(), lost_before.end());
+        predict_tracks(arena_, track_pool, kf_);
 
         const SceneGrid* grid = (cfg_.scene_grid.enabled && frame.width > 0 && frame.height > 0) ? &scene_grid_ : nullptr;
 
+        // 1) match pool with high dets
         AssociationResult assoc = associate_detections(
-            track_boxes(track_pool),
-            track_boxes(high_dets),
+            track_boxes(arena_, track_pool),
+            high_dets,
             AssociationOptions{
                 AssociationStage::High,
                 cfg_.match_iou_thresh,
@@ -363,44 +285,36 @@ public:
                 frame.stream_id,
                 frame.width,
                 frame.height,
+                nullptr,
             });
-        for (const auto& m : assoc.matches) matches.emplace_back(m.track_index, m.detection_index);
-        unmatched_track_idx = std::move(assoc.unmatched_tracks);
-        unmatched_det_idx = std::move(assoc.unmatched_detections);
-
-        for (const auto& m : matches) {
-            TrackPtr& track = track_pool[static_cast<size_t>(m.first)];
-            const TrackPtr& det = high_dets[static_cast<size_t>(m.second)];
-            if (!track || !det) continue;
-
-            const Box before_update = track->tlwh;
-            if (track->state == TrackState::Tracked) {
-                update_track(*track, *det, kf_, frame_id_);
-                activated_tracks.push_back(track);
-            } else {
-                reactivate_track(*track, *det, kf_, frame_id_);
-                refind_tracks.push_back(track);
+
+        std::vector<TrackHandle> refound;
+        for (const auto& m : assoc.matches) {
+            const TrackHandle h = track_pool[static_cast<size_t>(m.track_index)];
+            const Box& det = high_dets[static_cast<size_t>(m.detection_index)];
+            Track& track = arena_[h];
+            const Box before_update = track.tlwh;
+            update_track(track, det, kf_, frame_id_);
+            if (track.state != TrackState::Tracked) {
+                arena_.set_state(h, TrackState::Tracked);
+                refound.push_back(h);
             }
-            scene_grid_.observe_transition(frame.stream_id, frame.width, frame.height, before_update, det->tlwh);
+            scene_grid_.observe_transition(frame.stream_id, frame.width, frame.height, before_update, det);
         }
+        const std::vector<int> unmatched_det_idx = std::move(assoc.unmatched_detections);
 
         // remaining tracked-only for low association
-        std::vector<TrackPtr> remaining_tracked;
-        remaining_tracked.reserve(unmatched_track_idx.size());
-        for (int idx : unmatched_track_idx) {
-            if (idx < 0 || idx >= static_cast<int>(track_pool.size())) continue;
-            TrackPtr& t = track_pool[static_cast<size_t>(idx)];
-            if (t && t->state == TrackState::Tracked) remaining_tracked.push_back(t);
+        std::vector<TrackHandle> remaining_tracked;
+        remaining_tracked.reserve(assoc.unmatched_tracks.size());
+        for (int idx : assoc.unmatched_tracks) {
+            const TrackHandle h = track_pool[static_cast<size_t>(idx)];
+            if (arena_[h].state == TrackState::Tracked) remaining_tracked.push_back(h);
         }
 
         // 2) match remaining tracked with low dets
-        matches.clear();
-        std::vector<int> unmatched_remaining_idx;
-        std::vector<int> unmatched_low_det_idx;
-
         assoc = associate_detections(
-            track_boxes(remaining_tracked),
-            track_boxes(low_dets),
+            track_boxes(arena_, remaining_tracked),
+            low_dets,
             AssociationOptions{
                 AssociationStage::Low,
                 cfg_.low_match_iou_thresh,
@@ -409,46 +323,31 @@ public:
                 frame.stream_id,
                 frame.width,
                 frame.height,
+                nullptr,
             });
-        for (const auto& m : assoc.matches) matches.emplace_back(m.track_index, m.detection_index);
-        unmatched_remaining_idx = std::move(assoc.unmatched_tracks);
-        unmatched_low_det_idx = std::move(assoc.unmatched_detections);
-
-        for (const auto& m : matches) {
-            TrackPtr& track = remaining_tracked[static_cast<size_t>(m.first)];
-            const TrackPtr& det = low_dets[static_cast<size_t>(m.second)];
-            if (!track || !det) continue;
-            const Box before_update = track->tlwh;
-            update_track(*track, *det, kf_, frame_id_);
-            activated_tracks.push_back(track);
-            scene_grid_.observe_transition(frame.stream_id, frame.width, frame.height, before_update, det->tlwh);
+
+        for (const auto& m : assoc.matches) {
+            Track& track = arena_[remaining_tracked[static_cast<size_t>(m.track_index)]];
+            const Box& det = low_dets[static_cast<size_t>(m.detection_index)];
+            const Box before_update = track.tlwh;
+            update_track(track, det, kf_, frame_id_);
+            scene_grid_.observe_transition(frame.stream_id, frame.width, frame.height, before_update, det);
         }
 
         // unmatched remaining tracked => Lost
-        for (int idx : unmatched_remaining_idx) {
-            if (idx < 0 || idx >= static_cast<int>(remaining_tracked.size())) continue;
-            TrackPtr& track = remaining_tracked[static_cast<size_t>(idx)];
-            if (!track) continue;
-            track->state = TrackState::Lost;
-            lost_tracks.push_back(track);
+        for (int idx : assoc.unmatched_tracks) {
+            arena_.set_state(remaining_tracked[static_cast<size_t>(idx)], TrackState::Lost);
         }
 
         // build unmatched high det list
-        std::vector<TrackPtr> unmatched_high_dets;
+        std::vector<Box> unmatched_high_dets;
         unmatched_high_dets.reserve(unmatched_det_idx.size());
-        for (int idx : unmatched_det_idx) {
-            if (idx < 0 || idx >= static_cast<int>(high_dets.size())) continue;
-            unmatched_high_dets.push_back(high_dets[static_cast<size_t>(idx)]);
-        }
+        for (int idx : unmatched_det_idx) unmatched_high_dets.push_back(high_dets[static_cast<size_t>(idx)]);
 
         // 3) match unconfirmed with remaining high dets
-        matches.clear();
-        std::vector<int> unmatched_unconfirmed_idx;
-        std::vector<int> unmatched_unconfirmed_det_idx;
-
         assoc = associate_detections(
-            track_boxes(unconfirmed),
-            track_boxes(unmatched_high_dets),
+            track_boxes(arena_, unconfirmed),
+            unmatched_high_dets,
             AssociationOptions{
                 AssociationStage::Unconfirmed,
                 cfg_.unconfirmed_match_iou_thresh,
@@ -457,78 +356,63 @@ public:
                 frame.stream_id,
                 frame.width,
                 frame.height,
+                nullptr,
             });
-        for (const auto& m : assoc.matches) matches.emplace_back(m.track_index, m.detection_index);
-        unmatched_unconfirmed_idx = std::move(assoc.unmatched_tracks);
-        unmatched_unconfirmed_det_idx = std::move(assoc.unmatched_detections);
-
-        for (const auto& m : matches) {
-            TrackPtr& track = unconfirmed[static_cast<size_t>(m.first)];
-            const TrackPtr& det = unmatched_high_dets[static_cast<size_t>(m.second)];
-            if (!track || !det) continue;
-            const Box before_update = track->tlwh;
-            update_track(*track, *det, kf_, frame_id_);
-            activated_tracks.push_back(track);
-            scene_grid_.observe_transition(frame.stream_id, frame.width, frame.height, before_update, det->tlwh);
+
+        for (const auto& m : assoc.matches) {
+            Track& track = arena_[unconfirmed[static_cast<size_t>(m.track_index)]];
+            const Box& det = unmatched_high_dets[static_cast<size_t>(m.detection_index)];
+            const Box before_update = track.tlwh;
+            update_track(track, det, kf_, frame_id_);
+            scene_grid_.observe_transition(frame.stream_id, frame.width, frame.height, before_update, det);
         }
 
-        for (int idx : unmatched_unconfirmed_idx) {
-            if (idx < 0 || idx >= static_cast<int>(unconfirmed.size())) continue;
-            TrackPtr& track = unconfirmed[static_cast<size_t>(idx)];
-            if (!track) continue;
-            track->state = TrackState::Removed;
-            removed_tracks.push_back(track);
+        for (int idx : assoc.unmatched_tracks) {
+            arena_.set_state(unconfirmed[static_cast<size_t>(idx)], TrackState::Removed);
         }
 
         // 4) init new tracks from remaining unmatched high dets
-        for (int idx : unmatched_unconfirmed_det_idx) {
-            if (idx < 0 || idx >= static_cast<int>(unmatched_high_dets.size())) continue;
-            TrackPtr& det = unmatched_high_dets[static_cast<size_t>(idx)];
-            if (!det) continue;
-            if (det->score < cfg_.new_track_thresh) continue;
-            activate_track(*det, kf_, frame_id_, next_track_id_++);
-            activated_tracks.push_back(det);
-            scene_grid_.observe(frame.stream_id, frame.width, frame.height, det->tlwh);
+        for (int idx : assoc.unmatched_detections) {
+            const Box& det = unmatched_high_dets[static_cast<size_t>(idx)];
+            if (det.score < cfg_.new_track_thresh) continue;
+            Track& track = arena_[arena_.create(TrackState::Tracked)];
+            track.tlwh = det;
+            track.score = det.score;
+            track.tracked_seq = next_tracked_seq_++;
+            activate_track(track, kf_, frame_id_, next_track_id_++);
+            scene_grid_.observe(frame.stream_id, frame.width, frame.height, track.tlwh);
         }
+        // Re-found tracks join the tracked list after this frame's new tracks, as in reference ByteTrack.
+        for (TrackHandle h : refound) arena_[h].tracked_seq = next_tracked_seq_++;
 
         // 5) remove too-old lost tracks
-        for (const auto& track : lost_tracks_) {
-            if (!track) continue;
-            if (frame_id_ - track->end_frame() > max_time_lost_) {
-                track->state = TrackState::Removed;
-                removed_tracks.push_back(track);
+        for (TrackHandle h : lost_before) {
+            const Track& track = arena_[h];
+            if (track.state == TrackState::Lost && frame_id_ - track.end_frame() > max_time_lost_) {
+                arena_.set_state(h, TrackState::Removed);
             }
         }
 
-        // 6) merge lists
-        std::vector<TrackPtr> tracked_next;
-        tracked_next.reserve(tracked_tracks_.size());
-        for (const auto& t : tracked_tracks_) {
-            if (t && t->state == TrackState::Tracked) tracked_next.push_back(t);
-        }
-        tracked_next = joint_tracks(tracked_next, activated_tracks);
-        tracked_next = joint_tracks(tracked_next, refind_tracks);
-
-        std::vector<TrackPtr> lost_next = sub_tracks(lost_tracks_, tracked_next);
-        lost_next.insert(lost_next.end(), lost_tracks.begin(), lost_tracks.end());
-        lost_next = sub_tracks(lost_next, removed_tracks);
-
-        tracked_tracks_ = std::move(tracked_next);
-        lost_tracks_ = std::move(lost_next);
-
-        // 7) deduplicate
-        auto dedup = remove_duplicate_tracks(tracked_tracks_, lost_tracks_, cfg_.duplicate_iou_thresh);
-        tracked_tracks_ = std::move(dedup.first);
-        lost_tracks_ = std::move(dedup.second);
-
-        // output
+        // 6) deduplicate
+        tracked.clear();
+        arena_.collect(TrackState::Tracked, tracked);
+        std::vector<TrackHandle> lost;
+        arena_.collect(TrackState::Lost, lost);
+        remove_duplicate_tracks(arena_, tracked, lost, cfg_.duplicate_iou_thresh);
+        arena_.recycle_removed();
+
+        // output, in the order tracks joined the tracked list rather than slot order
+        std::sort(tracked.begin(), tracked.end(), [this](TrackHandle a, TrackHandle b) {
+            return arena_[a].tracked_seq < arena_[b].tracked_seq;
+        });
         std::vector<Box> output;
-        output.reserve(tracked_tracks_.size());
-        for (const auto& t : tracked_tracks_) {
-            if (!t || !t->is_activated || t->state != TrackState::Tracked) continue;
-            Box b = t->tlwh;
-            b.id = t->id;
-            b.score = t->score;
+        output.reserve(tracked.size());
+        for (TrackHandle h : tracked) {
+            const Track& t = arena_[h];
+            if (!t.is_activated || t.state != TrackState::Tracked) continue;
+            Box b = t.tlwh;
+            b.id = t.id;
+            b.score = t.score;
             b.occluded = false;
             output.push_back(std::move(b));
         }
@@ -541,10 +425,10 @@ private:
     SceneGrid scene_grid_;
     int64_t frame_id_ = 0;
     int next_track_id_ = 1;
+    uint64_t next_tracked_seq_ = 0;
     int max_time_lost_ = 30;
 
-    std::vector<TrackPtr> tracked_tracks_;
-    std::vector<TrackPtr> lost_tracks_;
+    TrackArena arena_;
 };
 
 } // namespace
@@ -245,6 +245,19 @@ namespace veilsight {
         private:
             ByteTrackModuleConfig cfg_;
         };
+
+        class OCSortFactory final : public ITrackerFactory {
+        public:
+            explicit OCSortFactory(OCSortModuleConfig cfg)
+                : cfg_(std::move(cfg)) {}
+
+            std::unique_ptr<ITracker> create() const override {
+                return create_ocsort_tracker(cfg_);
+            }
+
+        private:
+            OCSortModuleConfig cfg_;
+        };
     } // namespace
 
     std::unique_ptr<ITracker> create_demo_tracker(const TrackerConfig& cfg) {
@@ -258,6 +271,9 @@ namespace veilsight {
         if (cfg.type == "bytetrack") {
             return std::make_unique<ByteTrackFactory>(cfg.bytetrack);
         }
+        if (cfg.type == "ocsort") {
+            return std::make_unique<OCSortFactory>(cfg.ocsort);
+        }
         throw std::invalid_argument("[Tracker] Unsupported tracker type: " + cfg.type);
     }
 
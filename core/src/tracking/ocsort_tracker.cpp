@@ -0,0 +1,347 @@
+#include <tracking/tracker.hpp>
+#include <tracking/association.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <utility>
+#include <vector>
+
+#include <opencv2/core.hpp>
+
+namespace veilsight {
+    namespace {
+        constexpr int kMaxDeltaT = 15;
+        constexpr int kHistory = kMaxDeltaT + 1;
+        constexpr float kPi = 3.14159265358979f;
+
+        using StateVec = cv::Matx<float, 7, 1>; // cx, cy, area, aspect, vcx, vcy, varea
+        using StateCov = cv::Matx<float, 7, 7>;
+        using MeasVec = cv::Matx<float, 4, 1>;  // cx, cy, area, aspect
+
+        struct KalmanState {
+            StateVec x;
+            StateCov p;
+        };
+
+        MeasVec to_measurement(const Box& b) {
+            const float w = std::max(1.0f, b.w);
+            const float h = std::max(1.0f, b.h);
+            return MeasVec(b.x + w * 0.5f, b.y + h * 0.5f, w * h, w / h);
+        }
+
+        Box to_box(float cx, float cy, float area, float aspect) {
+            const float w = std::sqrt(std::max(1.0f, area) * std::max(1e-3f, aspect));
+            const float h = std::max(1.0f, area) / std::max(1.0f, w);
+            Box out;
+            out.x = cx - w * 0.5f;
+            out.y = cy - h * 0.5f;
+            out.w = w;
+            out.h = h;
+            return out;
+        }
+
+        Box state_box(const KalmanState& s) {
+            return to_box(s.x(0, 0), s.x(1, 0), s.x(2, 0), s.x(3, 0));
+        }
+
+        // SORT's constant-velocity filter; all matrices are fixed-size so predict/update never allocate.
+        class OCSortKalmanFilter {
+        public:
+            OCSortKalmanFilter() {
+                f_ = StateCov::eye();
+                for (int i = 0; i < 3; ++i) f_(i, i + 4) = 1.0f;
+                for (int i = 0; i < 4; ++i) h_(i, i) = 1.0f;
+                r_ = cv::Matx44f::eye();
+                r_(2, 2) = 10.0f;
+                r_(3, 3) = 10.0f;
+                q_ = StateCov::eye();
+                for (int i = 4; i < 7; ++i) q_(i, i) = 0.01f;
+                q_(6, 6) = 1e-4f;
+            }
+
+            KalmanState initiate(const MeasVec& z) const {
+                KalmanState s;
+                for (int i = 0; i < 4; ++i) s.x(i, 0) = z(i, 0);
+                s.p = StateCov::eye() * 10.0;
+                for (int i = 4; i < 7; ++i) s.p(i, i) = 10000.0f;
+                return s;
+            }
+
+            void predict(KalmanState& s) const {
+                if (s.x(2, 0) + s.x(6, 0) <= 0.0f) s.x(6, 0) = 0.0f;
+                s.x = f_ * s.x;
+                s.p = f_ * s.p * f_.t() + q_;
+            }
+
+            void update(KalmanState& s, const MeasVec& z) const {
+                const MeasVec innovation = z - h_ * s.x;
+                const cv::Matx44f projected = h_ * s.p * h_.t() + r_;
+                const cv::Matx<float, 7, 4> gain = s.p * h_.t() * projected.inv(cv::DECOMP_CHOLESKY);
+                s.x = s.x + gain * innovation;
+                s.p = (StateCov::eye() - gain * h_) * s.p;
+            }
+
+        private:
+            StateCov f_;
+            cv::Matx<float, 4, 7> h_;
+            cv::Matx44f r_;
+            StateCov q_;
+        };
+
+        struct OCSortTrack {
+            int id = 0;
+            KalmanState kf;
+            KalmanState frozen;                      // filter right after the first missed predict
+            std::array<Box, kHistory> history{};     // observations, slot = age % kHistory
+            std::array<int, kHistory> history_age{}; // age each slot was written at, -1 when empty
+            Box last_observation{};
+            float direction_x = 0.0f; // unit direction of recent observed motion, 0 until known
+            float direction_y = 0.0f;
+            int age = 0;
+            int time_since_update = 0;
+            int hits = 0;
+            int hit_streak = 0;
+            float score = 0.0f;
+        };
+
+        // Unit (dx, dy) between box centers.
+        std::pair<float, float> motion_direction(const Box& from, const Box& to) {
+            const float dx = (to.x + to.w * 0.5f) - (from.x + from.w * 0.5f);
+            const float dy = (to.y + to.h * 0.5f) - (from.y + from.h * 0.5f);
+            const float norm = std::sqrt(dx * dx + dy * dy) + 1e-6f;
+            return {dx / norm, dy / norm};
+        }
+
+        class OCSortTracker final : public ITracker {
+        public:
+            explicit OCSortTracker(OCSortModuleConfig cfg)
+                : cfg_(std::move(cfg)) {
+                cfg_.det_thresh = std::clamp(cfg_.det_thresh, 0.0f, 1.0f);
+                cfg_.low_det_thresh = std::clamp(cfg_.low_det_thresh, 0.0f, cfg_.det_thresh);
+                cfg_.iou_threshold = std::clamp(cfg_.iou_threshold, 0.01f, 0.99f);
+                cfg_.low_iou_threshold = std::clamp(cfg_.low_iou_threshold, 0.01f, 0.99f);
+                cfg_.delta_t = std::clamp(cfg_.delta_t, 1, kMaxDeltaT);
+                cfg_.min_hits = std::max(0, cfg_.min_hits);
+                cfg_.max_age = std::max(1, cfg_.max_age);
+                cfg_.min_box_area = std::max(0.0f, cfg_.min_box_area);
+            }
+
+            std::vector<Box> update(const TrackerFrameInfo& frame,
+                                    const std::vector<Box>& detections) override {
+                ++frame_count_;
+
+                high_.clear();
+                low_.clear();
+                for (const auto& det : detections) {
+                    if (det.w <= 1.0f || det.h <= 1.0f || det.w * det.h < cfg_.min_box_area) continue;
+                    if (det.score >= cfg_.det_thresh) high_.push_back(det);
+                    else if (cfg_.use_byte && det.score >= cfg_.low_det_thresh) low_.push_back(det);
+                }
+
+                for (auto& track : tracks_) predict_(track);
+                tracks_.erase(std::remove_if(tracks_.begin(), tracks_.end(), [](const OCSortTrack& t) {
+                                  return !std::isfinite(t.kf.x(0, 0)) || !std::isfinite(t.kf.x(2, 0));
+                              }),
+                              tracks_.end());
+
+                track_matched_.assign(tracks_.size(), 0);
+                high_matched_.assign(high_.size(), 0);
+
+                // 1) predicted boxes vs confident detections, rewarding pairs that continue each track's
+                //    observed direction of motion
+                track_boxes_.clear();
+                for (const auto& track : tracks_) track_boxes_.push_back(state_box(track.kf));
+                direction_bonus_(track_boxes_.size());
+                const auto first = associate_detections(track_boxes_, high_, options_(frame, cfg_.iou_threshold, &bonus_));
+                for (const auto& m : first.matches) {
+                    observe_(tracks_[static_cast<size_t>(m.track_index)], high_[static_cast<size_t>(m.detection_index)]);
+                    track_matched_[static_cast<size_t>(m.track_index)] = 1;
+                    high_matched_[static_cast<size_t>(m.detection_index)] = 1;
+                }
+
+                // 2) BYTE: still-unmatched predictions vs low-score detections
+                if (cfg_.use_byte && !low_.empty()) {
+                    second_stage_(frame, low_, nullptr, cfg_.low_iou_threshold, false);
+                }
+
+                // 3) OCR: last observations of unmatched tracks vs leftover confident detections, which recovers
+                //    tracks whose prediction drifted while they were occluded
+                second_stage_(frame, high_, &high_matched_, cfg_.iou_threshold, true);
+
+                for (size_t i = 0; i < tracks_.size(); ++i) {
+                    if (!track_matched_[i] && tracks_[i].time_since_update == 1) tracks_[i].frozen = tracks_[i].kf;
+                }
+                for (size_t j = 0; j < high_.size(); ++j) {
+                    if (!high_matched_[j]) start_track_(high_[j]);
+                }
+
+                std::vector<Box> output;
+                output.reserve(tracks_.size());
+                for (const auto& track : tracks_) {
+                    if (track.time_since_update >= 1) continue;
+                    if (track.hit_streak < cfg_.min_hits && frame_count_ > cfg_.min_hits) continue;
+                    Box b = track.last_observation;
+                    b.id = track.id;
+                    b.score = track.score;
+                    b.occluded = false;
+                    output.push_back(b);
+                }
+                tracks_.erase(std::remove_if(tracks_.begin(), tracks_.end(), [this](const OCSortTrack& t) {
+                                  return t.time_since_update > cfg_.max_age;
+                              }),
+                              tracks_.end());
+                return output;
+            }
+
+        private:
+            AssociationOptions options_(const TrackerFrameInfo& frame,
+                                        float iou_threshold,
+                                        const CostMatrix* bonus) const {
+                return AssociationOptions{
+                    AssociationStage::High,
+                    iou_threshold,
+                    false,
+                    nullptr,
+                    frame.stream_id,
+                    frame.width,
+                    frame.height,
+                    bonus,
+                };
+            }
+
+            // Observation from delta_t frames back, or the closest younger one; the last one otherwise.
+            const Box& previous_observation_(const OCSortTrack& track) const {
+                for (int dt = cfg_.delta_t; dt >= 1; --dt) {
+                    const int age = track.age - dt;
+                    if (age < 0) continue;
+                    const size_t slot = static_cast<size_t>(age % kHistory);
+                    if (track.history_age[slot] == age) return track.history[slot];
+                }
+                return track.last_observation;
+            }
+
+            // Velocity direction consistency: how well the direction from a track's earlier observation to each
+            // detection agrees with the track's own motion, scaled by inertia and detection confidence.
+            void direction_bonus_(size_t rows) {
+                bonus_.reset(static_cast<int>(rows), static_cast<int>(high_.size()), 0.0f);
+                for (size_t i = 0; i < rows; ++i) {
+                    const OCSortTrack& track = tracks_[i];
+                    if (track.direction_x == 0.0f && track.direction_y == 0.0f) continue;
+                    const Box& previous = previous_observation_(track);
+                    for (size_t j = 0; j < high_.size(); ++j) {
+                        const auto [dx, dy] = motion_direction(previous, high_[j]);
+                        const float cos = std::clamp(track.direction_x * dx + track.direction_y * dy, -1.0f, 1.0f);
+                        const float agreement = (kPi * 0.5f - std::fabs(std::acos(cos))) / kPi;
+                        bonus_.at(static_cast<int>(i), static_cast<int>(j)) = agreement * cfg_.inertia * high_[j].score;
+                    }
+                }
+            }
+
+            // Matches still-unmatched tracks against the unclaimed entries of `dets` by plain IoU.
+            void second_stage_(const TrackerFrameInfo& frame,
+                               const std::vector<Box>& dets,
+                               std::vector<char>* claimed,
+                               float iou_threshold,
+                               bool use_last_observation) {
+                pending_tracks_.clear();
+                track_boxes_.clear();
+                for (size_t i = 0; i < tracks_.size(); ++i) {
+                    if (track_matched_[i]) continue;
+                    pending_tracks_.push_back(i);
+                    track_boxes_.push_back(use_last_observation ? tracks_[i].last_observation : state_box(tracks_[i].kf));
+                }
+                pending_dets_.clear();
+                det_boxes_.clear();
+                for (size_t j = 0; j < dets.size(); ++j) {
+                    if (claimed && (*claimed)[j]) continue;
+                    pending_dets_.push_back(j);
+                    det_boxes_.push_back(dets[j]);
+                }
+                if (pending_tracks_.empty() || pending_dets_.empty()) return;
+
+                const auto result = associate_detections(track_boxes_, det_boxes_, options_(frame, iou_threshold, nullptr));
+                for (const auto& m : result.matches) {
+                    const size_t ti = pending_tracks_[static_cast<size_t>(m.track_index)];
+                    const size_t dj = pending_dets_[static_cast<size_t>(m.detection_index)];
+                    observe_(tracks_[ti], dets[dj]);
+                    track_matched_[ti] = 1;
+                    if (claimed) (*claimed)[dj] = 1;
+                }
+            }
+
+            void predict_(OCSortTrack& track) const {
+                kf_.predict(track.kf);
+                ++track.age;
+                if (track.time_since_update > 0) track.hit_streak = 0;
+                ++track.time_since_update;
+            }
+
+            void observe_(OCSortTrack& track, const Box& det) {
+                const Box& previous = previous_observation_(track);
+                const auto [dx, dy] = motion_direction(previous, det);
+                track.direction_x = dx;
+                track.direction_y = dy;
+
+                const int gap = track.time_since_update;
+                if (gap > 1) {
+                    // Observation-centric re-update: rewind to the first missed frame and replay the gap along a
+                    // straight line from the last observation, instead of trusting the coasted prediction.
+                    track.kf = track.frozen;
+                    const MeasVec from = to_measurement(track.last_observation);
+                    const MeasVec to = to_measurement(det);
+                    for (int step = 1; step <= gap; ++step) {
+                        const float t = static_cast<float>(step) / static_cast<float>(gap);
+                        kf_.update(track.kf, from + (to - from) * t);
+                        if (step < gap) kf_.predict(track.kf);
+                    }
+                } else {
+                    kf_.update(track.kf, to_measurement(det));
+                }
+
+                const size_t slot = static_cast<size_t>(track.age % kHistory);
+                track.history[slot] = det;
+                track.history_age[slot] = track.age;
+                track.last_observation = det;
+                track.time_since_update = 0;
+                ++track.hits;
+                ++track.hit_streak;
+                track.score = det.score;
+            }
+
+            void start_track_(const Box& det) {
+                OCSortTrack track;
+                track.id = next_track_id_++;
+                track.kf = kf_.initiate(to_measurement(det));
+                track.frozen = track.kf;
+                track.history_age.fill(-1);
+                track.history[0] = det;
+                track.history_age[0] = 0;
+                track.last_observation = det;
+                track.score = det.score;
+                tracks_.push_back(track);
+            }
+
+            OCSortModuleConfig cfg_;
+            OCSortKalmanFilter kf_;
+            int64_t frame_count_ = 0;
+            int next_track_id_ = 1;
+            std::vector<OCSortTrack> tracks_;
+
+            // per-frame scratch, kept across frames so steady state reuses its capacity
+            std::vector<Box> high_;
+            std::vector<Box> low_;
+            std::vector<Box> track_boxes_;
+            std::vector<Box> det_boxes_;
+            std::vector<size_t> pending_tracks_;
+            std::vector<size_t> pending_dets_;
+            std::vector<char> track_matched_;
+            std::vector<char> high_matched_;
+            CostMatrix bonus_;
+        };
+    } // namespace
+
+    std::unique_ptr<ITracker> create_ocsort_tracker(const OCSortModuleConfig& cfg) {
+        return std::make_unique<OCSortTracker>(cfg);
+    }
+}
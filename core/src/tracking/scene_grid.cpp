@@ -1,15 +1,164 @@
 #include <tracking/scene_grid.hpp>
 
 #include <algorithm>
-#include <cstddef>
+#include <cctype>
 #include <cmath>
-#include <numeric>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
 
 namespace veilsight {
     namespace {
+        constexpr float kMinScale = 1e-10f;
+        constexpr char kPersistMagic[8] = {'V', 'S', 'G', 'R', 'I', 'D', '0', '1'};
+
         float clamp01(float v) {
             return std::clamp(v, 0.0f, 1.0f);
         }
+
+        struct CostWeights {
+            float cell_distance = 0.0f;
+            float occupancy = 0.0f;
+            float transition = 0.0f;
+            float association = 0.0f;
+            float max_extra = 0.0f;
+            float max_dist = 1.0f;
+        };
+
+        CostWeights cost_weights(const SceneGridConfig& cfg) {
+            CostWeights w;
+            w.cell_distance = cfg.cell_distance_weight;
+            w.occupancy = cfg.occupancy_weight;
+            w.transition = cfg.transition_weight;
+            w.association = cfg.association_weight;
+            w.max_extra = cfg.max_extra_cost;
+            w.max_dist = std::max(
+                1.0f,
+                std::sqrt(static_cast<float>((cfg.rows - 1) * (cfg.rows - 1) + (cfg.cols - 1) * (cfg.cols - 1))));
+            return w;
+        }
+
+        SceneGridAssociationCost pair_cost(const CostWeights& w,
+                                           float dr,
+                                           float dc,
+                                           float normalized_occupancy,
+                                           float transition_probability) {
+            const float normalized_cell_distance = clamp01(std::sqrt(dr * dr + dc * dc) / w.max_dist);
+            SceneGridAssociationCost out;
+            out.raw_cost =
+                w.cell_distance * normalized_cell_distance +
+                w.occupancy * (1.0f - normalized_occupancy) +
+                w.transition * (1.0f - transition_probability);
+            out.extra_cost = std::clamp(w.association * out.raw_cost, 0.0f, w.max_extra);
+            return out;
+        }
+
+        // Per-detection inputs of a cost block, laid out for the row kernel.
+        struct BlockScratch {
+            std::vector<float> row;
+            std::vector<float> col;
+            std::vector<float> occupancy;
+            std::vector<float> transition;
+            std::vector<int> cell;
+        };
+
+        // One track against every detection. `transition` holds the track's transition counts gathered per
+        // detection cell, and `transition_sum` their row total (1 with zero counts when the row is empty).
+        void cost_row(const CostWeights& w,
+                      float from_row,
+                      float from_col,
+                      float transition_sum,
+                      const BlockScratch& in,
+                      int n,
+                      float* raw,
+                      float* extra) {
+            int j = 0;
+#if defined(__AVX2__)
+            const __m256 vfr = _mm256_set1_ps(from_row);
+            const __m256 vfc = _mm256_set1_ps(from_col);
+            const __m256 vmax_dist = _mm256_set1_ps(w.max_dist);
+            const __m256 vsum = _mm256_set1_ps(transition_sum);
+            const __m256 vwd = _mm256_set1_ps(w.cell_distance);
+            const __m256 vwo = _mm256_set1_ps(w.occupancy);
+            const __m256 vwt = _mm256_set1_ps(w.transition);
+            const __m256 vwa = _mm256_set1_ps(w.association);
+            const __m256 vmax_extra = _mm256_set1_ps(w.max_extra);
+            const __m256 zero = _mm256_setzero_ps();
+            const __m256 one = _mm256_set1_ps(1.0f);
+            for (; j + 8 <= n; j += 8) {
+                const __m256 dr = _mm256_sub_ps(_mm256_loadu_ps(&in.row[static_cast<size_t>(j)]), vfr);
+                const __m256 dc = _mm256_sub_ps(_mm256_loadu_ps(&in.col[static_cast<size_t>(j)]), vfc);
+                const __m256 dist = _mm256_min_ps(
+                    one,
+                    _mm256_max_ps(zero,
+                                  _mm256_div_ps(_mm256_sqrt_ps(_mm256_add_ps(_mm256_mul_ps(dr, dr), _mm256_mul_ps(dc, dc))),
+                                                vmax_dist)));
+                const __m256 tp = _mm256_min_ps(
+                    one, _mm256_max_ps(zero, _mm256_div_ps(_mm256_loadu_ps(&in.transition[static_cast<size_t>(j)]), vsum)));
+                const __m256 occ = _mm256_loadu_ps(&in.occupancy[static_cast<size_t>(j)]);
+                const __m256 r = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(vwd, dist), _mm256_mul_ps(vwo, _mm256_sub_ps(one, occ))),
+                                               _mm256_mul_ps(vwt, _mm256_sub_ps(one, tp)));
+                _mm256_storeu_ps(raw + j, r);
+                _mm256_storeu_ps(extra + j, _mm256_min_ps(vmax_extra, _mm256_max_ps(zero, _mm256_mul_ps(vwa, r))));
+            }
+#elif defined(__ARM_NEON)
+            const float32x4_t vfr = vdupq_n_f32(from_row);
+            const float32x4_t vfc = vdupq_n_f32(from_col);
+            const float32x4_t vmax_dist = vdupq_n_f32(w.max_dist);
+            const float32x4_t vsum = vdupq_n_f32(transition_sum);
+            const float32x4_t vwd = vdupq_n_f32(w.cell_distance);
+            const float32x4_t vwo = vdupq_n_f32(w.occupancy);
+            const float32x4_t vwt = vdupq_n_f32(w.transition);
+            const float32x4_t vwa = vdupq_n_f32(w.association);
+            const float32x4_t vmax_extra = vdupq_n_f32(w.max_extra);
+            const float32x4_t zero = vdupq_n_f32(0.0f);
+            const float32x4_t one = vdupq_n_f32(1.0f);
+            for (; j + 4 <= n; j += 4) {
+                const float32x4_t dr = vsubq_f32(vld1q_f32(&in.row[static_cast<size_t>(j)]), vfr);
+                const float32x4_t dc = vsubq_f32(vld1q_f32(&in.col[static_cast<size_t>(j)]), vfc);
+                const float32x4_t dist = vminq_f32(
+                    one, vmaxq_f32(zero, vdivq_f32(vsqrtq_f32(vaddq_f32(vmulq_f32(dr, dr), vmulq_f32(dc, dc))), vmax_dist)));
+                const float32x4_t tp = vminq_f32(
+                    one, vmaxq_f32(zero, vdivq_f32(vld1q_f32(&in.transition[static_cast<size_t>(j)]), vsum)));
+                const float32x4_t occ = vld1q_f32(&in.occupancy[static_cast<size_t>(j)]);
+                const float32x4_t r = vaddq_f32(vaddq_f32(vmulq_f32(vwd, dist), vmulq_f32(vwo, vsubq_f32(one, occ))),
+                                                vmulq_f32(vwt, vsubq_f32(one, tp)));
+                vst1q_f32(raw + j, r);
+                vst1q_f32(extra + j, vminq_f32(vmax_extra, vmaxq_f32(zero, vmulq_f32(vwa, r))));
+            }
+#endif
+            for (; j < n; ++j) {
+                const size_t k = static_cast<size_t>(j);
+                const SceneGridAssociationCost c = pair_cost(w,
+                                                             in.row[k] - from_row,
+                                                             in.col[k] - from_col,
+                                                             in.occupancy[k],
+                                                             clamp01(in.transition[k] / transition_sum));
+                raw[j] = c.raw_cost;
+                extra[j] = c.extra_cost;
+            }
+        }
+
+        std::string stream_file_name(const std::string& stream_id) {
+            std::string name = stream_id.empty() ? "default" : stream_id;
+            for (char& c : name) {
+                if (!std::isalnum(static_cast<unsigned char>(c)) && c != '-' && c != '_') c = '_';
+            }
+            return name + ".grid";
+        }
     }
 
     SceneGrid::SceneGrid(SceneGridConfig cfg)
@@ -24,6 +173,11 @@ namespace veilsight {
         cfg_.occupancy_decay = clamp01(cfg_.occupancy_decay);
         cfg_.transition_decay = clamp01(cfg_.transition_decay);
         cfg_.warmup_frames = std::max(0, cfg_.warmup_frames);
+        cfg_.persist_interval_frames = std::max(0, cfg_.persist_interval_frames);
+    }
+
+    SceneGrid::~SceneGrid() {
+        save();
     }
 
     void SceneGrid::begin_frame(const std::string& stream_id) {
@@ -31,8 +185,15 @@ namespace veilsight {
 
         StreamState& st = state_(stream_id);
         st.frames_seen += 1;
-        for (float& value : st.occupancy) value *= cfg_.occupancy_decay;
-        for (float& value : st.transitions) value *= cfg_.transition_decay;
+        st.occupancy_scale *= cfg_.occupancy_decay;
+        st.transition_scale *= cfg_.transition_decay;
+        if (st.occupancy_scale < kMinScale) fold_occupancy_(st);
+        if (st.transition_scale < kMinScale) fold_transitions_(st);
+
+        if (!cfg_.persist_dir.empty() && cfg_.persist_interval_frames > 0 &&
+            st.frames_seen % cfg_.persist_interval_frames == 0) {
+            save_(stream_id, st);
+        }
     }
 
     void SceneGrid::observe(const std::string& stream_id, int width, int height, const Box& box) {
@@ -40,7 +201,9 @@ namespace veilsight {
 
         StreamState& st = state_(stream_id);
         const auto [row, col] = cell_for_box(width, height, box);
-        st.occupancy[static_cast<size_t>(cell_index_(row, col))] += 1.0f;
+        float& cell = st.occupancy[static_cast<size_t>(cell_index_(row, col))];
+        cell += 1.0f / st.occupancy_scale;
+        st.occupancy_max = std::max(st.occupancy_max, cell);
     }
 
     void SceneGrid::observe_transition(const std::string& stream_id,
@@ -56,8 +219,13 @@ namespace veilsight {
         const int from_idx = cell_index_(from_row, from_col);
         const int to_idx = cell_index_(to_row, to_col);
         const int cells = cfg_.rows * cfg_.cols;
-        st.transitions[static_cast<size_t>(from_idx * cells + to_idx)] += 1.0f;
-        st.occupancy[static_cast<size_t>(to_idx)] += 1.0f;
+        const float step = 1.0f / st.transition_scale;
+        st.transitions[static_cast<size_t>(from_idx * cells + to_idx)] += step;
+        st.transition_row_sums[static_cast<size_t>(from_idx)] += step;
+
+        float& cell = st.occupancy[static_cast<size_t>(to_idx)];
+        cell += 1.0f / st.occupancy_scale;
+        st.occupancy_max = std::max(st.occupancy_max, cell);
     }
 
     std::pair<int, int> SceneGrid::cell_for_box(int width, int height, const Box& box) const {
@@ -80,11 +248,8 @@ namespace veilsight {
                                                          int height,
                                                          const Box& track,
                                                          const Box& detection) const {
-        SceneGridAssociationCost out;
-        if (!cfg_.enabled || width <= 0 || height <= 0) return out;
-
         const StreamState* st = find_state_(stream_id);
-        if (!st || st->frames_seen < cfg_.warmup_frames) return out;
+        if (!active_(st, width, height)) return {};
 
         const auto [from_row, from_col] = cell_for_box(width, height, track);
         const auto [to_row, to_col] = cell_for_box(width, height, detection);
@@ -92,34 +257,84 @@ namespace veilsight {
         const int to_idx = cell_index_(to_row, to_col);
         const int cells = cfg_.rows * cfg_.cols;
 
-        const float dr = static_cast<float>(to_row - from_row);
-        const float dc = static_cast<float>(to_col - from_col);
-        const float max_dist = std::max(
-            1.0f,
-            std::sqrt(static_cast<float>((cfg_.rows - 1) * (cfg_.rows - 1) +
-                                         (cfg_.cols - 1) * (cfg_.cols - 1))));
-        const float normalized_cell_distance = clamp01(std::sqrt(dr * dr + dc * dc) / max_dist);
-
-        const float max_occupancy = st->occupancy.empty()
-            ? 0.0f
-            : *std::max_element(st->occupancy.begin(), st->occupancy.end());
-        const float normalized_occupancy = max_occupancy > 0.0f
-            ? clamp01(st->occupancy[static_cast<size_t>(to_idx)] / max_occupancy)
+        const float normalized_occupancy = st->occupancy_max > 0.0f
+            ? clamp01(st->occupancy[static_cast<size_t>(to_idx)] / st->occupancy_max)
             : 0.0f;
-
-        const auto row_begin = st->transitions.begin() + static_cast<std::ptrdiff_t>(from_idx * cells);
-        const auto row_end = row_begin + cells;
-        const float transition_sum = std::accumulate(row_begin, row_end, 0.0f);
+        const float transition_sum = st->transition_row_sums[static_cast<size_t>(from_idx)];
         const float transition_probability = transition_sum > 0.0f
             ? clamp01(st->transitions[static_cast<size_t>(from_idx * cells + to_idx)] / transition_sum)
             : 0.0f;
 
-        out.raw_cost =
-            cfg_.cell_distance_weight * normalized_cell_distance +
-            cfg_.occupancy_weight * (1.0f - normalized_occupancy) +
-            cfg_.transition_weight * (1.0f - transition_probability);
-        out.extra_cost = std::clamp(cfg_.association_weight * out.raw_cost, 0.0f, cfg_.max_extra_cost);
-        return out;
+        return pair_cost(cost_weights(cfg_),
+                         static_cast<float>(to_row - from_row),
+                         static_cast<float>(to_col - from_col),
+                         normalized_occupancy,
+                         transition_probability);
+    }
+
+    void SceneGrid::association_costs(const std::string& stream_id,
+                                      int width,
+                                      int height,
+                                      const std::vector<Box>& tracks,
+                                      const std::vector<Box>& detections,
+                                      SceneGridCostBlock& out) const {
+        out.rows = static_cast<int>(tracks.size());
+        out.cols = static_cast<int>(detections.size());
+        out.active = false;
+        const StreamState* st = find_state_(stream_id);
+        if (!active_(st, width, height) || out.rows == 0 || out.cols == 0) return;
+
+        out.active = true;
+        const size_t total = static_cast<size_t>(out.rows) * static_cast<size_t>(out.cols);
+        out.raw_cost.resize(total);
+        out.extra_cost.resize(total);
+
+        thread_local BlockScratch in;
+        const size_t n = detections.size();
+        in.row.resize(n);
+        in.col.resize(n);
+        in.occupancy.resize(n);
+        in.transition.resize(n);
+        in.cell.resize(n);
+        for (size_t j = 0; j < n; ++j) {
+            const auto [row, col] = cell_for_box(width, height, detections[j]);
+            const int idx = cell_index_(row, col);
+            in.row[j] = static_cast<float>(row);
+            in.col[j] = static_cast<float>(col);
+            in.cell[j] = idx;
+            in.occupancy[j] = st->occupancy_max > 0.0f
+                ? clamp01(st->occupancy[static_cast<size_t>(idx)] / st->occupancy_max)
+                : 0.0f;
+        }
+
+        const CostWeights weights = cost_weights(cfg_);
+        const size_t cells = static_cast<size_t>(cfg_.rows * cfg_.cols);
+        for (int i = 0; i < out.rows; ++i) {
+            const auto [from_row, from_col] = cell_for_box(width, height, tracks[static_cast<size_t>(i)]);
+            const size_t from_idx = static_cast<size_t>(cell_index_(from_row, from_col));
+            float transition_sum = st->transition_row_sums[from_idx];
+            if (transition_sum > 0.0f) {
+                const float* counts = &st->transitions[from_idx * cells];
+                for (size_t j = 0; j < n; ++j) in.transition[j] = counts[static_cast<size_t>(in.cell[j])];
+            } else {
+                std::fill(in.transition.begin(), in.transition.end(), 0.0f);
+                transition_sum = 1.0f;
+            }
+            const size_t offset = static_cast<size_t>(i) * n;
+            cost_row(weights,
+                     static_cast<float>(from_row),
+                     static_cast<float>(from_col),
+                     transition_sum,
+                     in,
+                     out.cols,
+                     &out.raw_cost[offset],
+                     &out.extra_cost[offset]);
+        }
+    }
+
+    void SceneGrid::save() const {
+        if (cfg_.persist_dir.empty()) return;
+        for (const auto& [stream_id, st] : streams_) save_(stream_id, st);
     }
 
     int SceneGrid::cell_index_(int row, int col) const {
@@ -127,14 +342,15 @@ namespace veilsight {
     }
 
     SceneGrid::StreamState& SceneGrid::state_(const std::string& stream_id) {
+        const auto it = streams_.find(stream_id);
+        if (it != streams_.end()) return it->second;
+
         StreamState& st = streams_[stream_id];
-        const int cells = cfg_.rows * cfg_.cols;
-        if (static_cast<int>(st.occupancy.size()) != cells) {
-            st.occupancy.assign(static_cast<size_t>(cells), 0.0f);
-        }
-        if (static_cast<int>(st.transitions.size()) != cells * cells) {
-            st.transitions.assign(static_cast<size_t>(cells * cells), 0.0f);
-        }
+        const size_t cells = static_cast<size_t>(cfg_.rows * cfg_.cols);
+        st.occupancy.assign(cells, 0.0f);
+        st.transitions.assign(cells * cells, 0.0f);
+        st.transition_row_sums.assign(cells, 0.0f);
+        if (!cfg_.persist_dir.empty()) load_(stream_id, st);
         return st;
     }
 
@@ -142,4 +358,96 @@ namespace veilsight {
         const auto it = streams_.find(stream_id);
         return it == streams_.end() ? nullptr : &it->second;
     }
+
+    bool SceneGrid::active_(const StreamState* st, int width, int height) const {
+        return cfg_.enabled && width > 0 && height > 0 && st && st->frames_seen >= cfg_.warmup_frames;
+    }
+
+    void SceneGrid::fold_occupancy_(StreamState& st) const {
+        st.occupancy_max = 0.0f;
+        for (float& value : st.occupancy) {
+            value *= st.occupancy_scale;
+            st.occupancy_max = std::max(st.occupancy_max, value);
+        }
+        st.occupancy_scale = 1.0f;
+    }
+
+    void SceneGrid::fold_transitions_(StreamState& st) const {
+        const size_t cells = st.transition_row_sums.size();
+        for (size_t from = 0; from < cells; ++from) {
+            float sum = 0.0f;
+            for (size_t to = 0; to < cells; ++to) {
+                float& value = st.transitions[from * cells + to];
+                value *= st.transition_scale;
+                sum += value;
+            }
+            st.transition_row_sums[from] = sum;
+        }
+        st.transition_scale = 1.0f;
+    }
+
+    std::string SceneGrid::persist_path_(const std::string& stream_id) const {
+        return (std::filesystem::path(cfg_.persist_dir) / stream_file_name(stream_id)).string();
+    }
+
+    bool SceneGrid::load_(const std::string& stream_id, StreamState& st) const {
+        const std::string path = persist_path_(stream_id);
+        std::ifstream in(path, std::ios::binary);
+        if (!in.is_open()) return false;
+
+        char magic[sizeof(kPersistMagic)] = {};
+        int32_t header[3] = {};
+        float scales[2] = {};
+        in.read(magic, sizeof(magic));
+        in.read(reinterpret_cast<char*>(header), sizeof(header));
+        in.read(reinterpret_cast<char*>(scales), sizeof(scales));
+        if (!in || std::memcmp(magic, kPersistMagic, sizeof(magic)) != 0 ||
+            header[0] != cfg_.rows || header[1] != cfg_.cols) {
+            std::cerr << "[SceneGrid] ignoring " << path << ": not a " << cfg_.rows << "x" << cfg_.cols << " grid\n";
+            return false;
+        }
+
+        StreamState loaded = st;
+        in.read(reinterpret_cast<char*>(loaded.occupancy.data()),
+                static_cast<std::streamsize>(loaded.occupancy.size() * sizeof(float)));
+        in.read(reinterpret_cast<char*>(loaded.transitions.data()),
+                static_cast<std::streamsize>(loaded.transitions.size() * sizeof(float)));
+        if (!in) {
+            std::cerr << "[SceneGrid] ignoring truncated " << path << "\n";
+            return false;
+        }
+
+        loaded.frames_seen = std::max(0, header[2]);
+        loaded.occupancy_scale = scales[0];
+        loaded.transition_scale = scales[1];
+        fold_occupancy_(loaded);
+        fold_transitions_(loaded);
+        st = std::move(loaded);
+        return true;
+    }
+
+    void SceneGrid::save_(const std::string& stream_id, const StreamState& st) const {
+        namespace fs = std::filesystem;
+        try {
+            const fs::path path = persist_path_(stream_id);
+            fs::create_directories(path.parent_path());
+            const fs::path tmp = path.string() + ".tmp";
+            {
+                std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+                const int32_t header[3] = {cfg_.rows, cfg_.cols, st.frames_seen};
+                const float scales[2] = {st.occupancy_scale, st.transition_scale};
+                out.write(kPersistMagic, sizeof(kPersistMagic));
+                out.write(reinterpret_cast<const char*>(header), sizeof(header));
+                out.write(reinterpret_cast<const char*>(scales), sizeof(scales));
+                out.write(reinterpret_cast<const char*>(st.occupancy.data()),
+                          static_cast<std::streamsize>(st.occupancy.size() * sizeof(float)));
+                out.write(reinterpret_cast<const char*>(st.transitions.data()),
+                          static_cast<std::streamsize>(st.transitions.size() * sizeof(float)));
+                if (!out) throw std::runtime_error("failed to write " + tmp.string());
+            }
+            fs::rename(tmp, path);
+        } catch (const std::exception& e) {
+            std::cerr << "[SceneGrid] " << e.what() << "\n";
+        }
+    }
 }
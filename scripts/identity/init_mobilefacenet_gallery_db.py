@@ -28,8 +28,51 @@ CREATE TABLE IF NOT EXISTS face_embeddings (
   active INTEGER NOT NULL DEFAULT 1,
   FOREIGN KEY(identity_key) REFERENCES identities(identity_key)
 );
+
+-- Change log read by the recognizer for incremental reloads. Every embedding row that may have entered or left
+-- the active gallery is appended; 'generation' changes only when the DB is recreated. Rows already folded into the
+-- recognizer's gallery snapshot are trimmed, and 'pruned_seq' records the last trimmed seq.
+CREATE TABLE IF NOT EXISTS gallery_meta (
+  key TEXT PRIMARY KEY,
+  value TEXT NOT NULL
+);
+
+INSERT OR IGNORE INTO gallery_meta(key, value) VALUES ('generation', lower(hex(randomblob(8))));
+
+CREATE TABLE IF NOT EXISTS gallery_changes (
+  seq INTEGER PRIMARY KEY AUTOINCREMENT,
+  embedding_id INTEGER NOT NULL
+);
+
+CREATE TRIGGER IF NOT EXISTS face_embeddings_log_insert AFTER INSERT ON face_embeddings
+BEGIN
+  INSERT INTO gallery_changes(embedding_id) VALUES (NEW.id);
+END;
+
+CREATE TRIGGER IF NOT EXISTS face_embeddings_log_update
+AFTER UPDATE OF identity_key, model, dim, embedding, active ON face_embeddings
+BEGIN
+  INSERT INTO gallery_changes(embedding_id) VALUES (NEW.id);
+END;
+
+CREATE TRIGGER IF NOT EXISTS face_embeddings_log_delete AFTER DELETE ON face_embeddings
+BEGIN
+  INSERT INTO gallery_changes(embedding_id) VALUES (OLD.id);
+END;
+
+CREATE TRIGGER IF NOT EXISTS identities_log_active AFTER UPDATE OF active ON identities
+BEGIN
+  INSERT INTO gallery_changes(embedding_id)
+  SELECT id FROM face_embeddings WHERE identity_key = NEW.identity_key;
+END;
 """
 
+# Leading fields of the recognizer's <db>.vsgallery header (see gallery_store.py in the controller): magic, dim,
+# stride, rows, identities, change_seq, tag_bytes. The source tag follows the fixed 64-byte header.
+SNAPSHOT_MAGIC = b"VSGAL002"
+SNAPSHOT_HEADER = struct.Struct("<8s2i2QqI")
+SNAPSHOT_HEADER_BYTES = 64
+
 
 def parse_args() -> argparse.Namespace:
     parser = argparse.ArgumentParser(description=__doc__)
@@ -88,6 +131,29 @@ def iter_records(payload: object) -> Iterable[tuple[str, str | None, list[float]
     raise ValueError("unsupported JSON shape")
 
 
+def prune_gallery_changes(db: sqlite3.Connection, db_path: Path) -> int:
+    """Trim change-log rows already covered by a gallery snapshot of this DB generation."""
+    generation = db.execute("SELECT value FROM gallery_meta WHERE key = 'generation'").fetchone()
+    try:
+        with db_path.with_name(db_path.name + ".vsgallery").open("rb") as snapshot:
+            header = snapshot.read(SNAPSHOT_HEADER_BYTES)
+            if generation is None or len(header) < SNAPSHOT_HEADER_BYTES:
+                return 0
+            magic, _dim, _stride, _rows, _identities, seq, tag_bytes = SNAPSHOT_HEADER.unpack_from(header)
+            if magic != SNAPSHOT_MAGIC or snapshot.read(tag_bytes) != generation[0].encode() or seq <= 0:
+                return 0
+    except OSError:
+        return 0
+    db.execute(
+        """
+        INSERT INTO gallery_meta(key, value) VALUES ('pruned_seq', ?)
+        ON CONFLICT(key) DO UPDATE SET value = max(CAST(value AS INTEGER), CAST(excluded.value AS INTEGER))
+        """,
+        (seq,),
+    )
+    return db.execute("DELETE FROM gallery_changes WHERE seq <= ?", (seq,)).rowcount
+
+
 def main() -> int:
     args = parse_args()
     if args.replace and args.db_path.exists():
@@ -112,6 +178,7 @@ def main() -> int:
                     "INSERT INTO face_embeddings(identity_key, model, dim, embedding, active) VALUES (?, ?, ?, ?, 1)",
                     (identity_key, "mobilefacenet", 128, struct.pack("<128f", *embedding)),
                 )
+        prune_gallery_changes(db, args.db_path)
         db.commit()
     return 0
 
@@ -358,6 +358,8 @@ namespace {
             "        rows: 5\n"
             "        cols: 7\n"
             "        association_weight: 0.2\n"
+            "        persist_dir: \"cache/scene_grid\"\n"
+            "        persist_interval_frames: 900\n"
             "streams:\n"
             "  - id: \"file0\"\n"
             "    type: \"file\"\n"
@@ -390,6 +392,10 @@ namespace {
         check(cfg.modules.tracker.bytetrack.scene_grid.cols == 7, "scene_grid cols should parse");
         check(cfg.modules.tracker.bytetrack.scene_grid.association_weight == 0.2f,
               "scene_grid association_weight should parse");
+        check(cfg.modules.tracker.bytetrack.scene_grid.persist_dir == "cache/scene_grid",
+              "scene_grid persist_dir should parse");
+        check(cfg.modules.tracker.bytetrack.scene_grid.persist_interval_frames == 900,
+              "scene_grid persist_interval_frames should parse");
     }
 
     void test_uhd_person_detector_config_parses() {
@@ -458,6 +464,349 @@ namespace {
                   "    uhd:\n"
                   "      input_h: 0\n")),
               "uhd input_h should reject zero");
+        check(load_throws(minimal_config_yaml(
+                  "modules:\n"
+                  "  person_detector:\n"
+                  "    type: \"uhd\"\n"
+                  "    uhd:\n"
+                  "      nms_mode: \"fast\"\n")),
+              "uhd nms_mode should reject unknown modes");
+    }
+
+    void test_person_detector_soft_nms_config_parses() {
+        const std::string yaml = minimal_config_yaml(
+            "modules:\n"
+            "  person_detector:\n"
+            "    type: \"yolox\"\n"
+            "    yolox:\n"
+            "      nms_mode: \"soft\"\n"
+            "      soft_nms_sigma: 0.3\n");
+
+        const std::string path = write_yaml_file("veilsight_soft_nms_cfg", yaml);
+        const auto cfg = veilsight::load_config_yaml(path);
+        std::filesystem::remove(path);
+
+        check(cfg.modules.person_detector.yolox.nms_mode == "soft", "yolox.nms_mode should parse");
+        check(std::fabs(cfg.modules.person_detector.yolox.soft_nms_sigma - 0.3f) < 0.0001f,
+              "yolox.soft_nms_sigma should parse");
+        check(cfg.modules.person_detector.uhd.nms_mode == "hard", "uhd.nms_mode should default to hard");
+        check(load_throws(minimal_config_yaml(
+                  "modules:\n"
+                  "  person_detector:\n"
+                  "    yolox:\n"
+                  "      soft_nms_sigma: 0.0\n")),
+              "yolox soft_nms_sigma should reject zero");
+    }
+
+    void test_face_detector_soft_nms_config_parses() {
+        const std::string yaml = minimal_config_yaml(
+            "modules:\n"
+            "  face_detector:\n"
+            "    type: \"scrfd\"\n"
+            "    scrfd:\n"
+            "      nms_mode: \"soft\"\n"
+            "      soft_nms_sigma: 0.4\n");
+
+        const std::string path = write_yaml_file("veilsight_face_soft_nms_cfg", yaml);
+        const auto cfg = veilsight::load_config_yaml(path);
+        std::filesystem::remove(path);
+
+        check(cfg.modules.face_detector.scrfd.nms_mode == "soft", "scrfd.nms_mode should parse");
+        check(std::fabs(cfg.modules.face_detector.scrfd.soft_nms_sigma - 0.4f) < 0.0001f,
+              "scrfd.soft_nms_sigma should parse");
+        check(cfg.modules.face_detector.yunet.nms_mode == "hard", "yunet.nms_mode should default to hard");
+        check(load_throws(minimal_config_yaml(
+                  "modules:\n"
+                  "  face_detector:\n"
+                  "    yunet:\n"
+                  "      nms_mode: \"fast\"\n")),
+              "yunet nms_mode should reject unknown modes");
+    }
+
+    void test_person_detector_motion_gate_config_parses() {
+        const std::string yaml = minimal_config_yaml(
+            "modules:\n"
+            "  person_detector:\n"
+            "    motion_gate:\n"
+            "      enabled: true\n"
+            "      downscale_width: 128\n"
+            "      pixel_threshold: 24\n"
+            "      cell_change_ratio: 0.05\n"
+            "      keyframe_interval: 15\n");
+
+        const std::string path = write_yaml_file("veilsight_motion_gate_cfg", yaml);
+        const auto cfg = veilsight::load_config_yaml(path);
+        std::filesystem::remove(path);
+
+        const auto& gate = cfg.modules.person_detector.motion_gate;
+        check(gate.enabled, "motion_gate.enabled should parse");
+        check(gate.downscale_width == 128, "motion_gate.downscale_width should parse");
+        check(gate.pixel_threshold == 24, "motion_gate.pixel_threshold should parse");
+        check(std::fabs(gate.cell_change_ratio - 0.05f) < 0.0001f, "motion_gate.cell_change_ratio should parse");
+        check(gate.keyframe_interval == 15, "motion_gate.keyframe_interval should parse");
+        check(gate.grid_rows == 6 && gate.grid_cols == 8, "motion_gate grid should keep defaults");
+        check(load_throws(minimal_config_yaml(
+                  "modules:\n"
+                  "  person_detector:\n"
+                  "    motion_gate:\n"
+                  "      enabled: true\n"
+                  "      keyframe_interval: 0\n")),
+              "motion_gate.keyframe_interval should reject zero");
+        check(load_throws(minimal_config_yaml(
+                  "modules:\n"
+                  "  person_detector:\n"
+                  "    motion_gate:\n"
+                  "      enabled: true\n"
+                  "      cell_change_ratio: 1.5\n")),
+              "motion_gate.cell_change_ratio should reject values above 1");
+    }
+
+    void test_cascade_person_detector_config_parses() {
+        const std::string yaml = minimal_config_yaml(
+            "modules:\n"
+            "  person_detector:\n"
+            "    type: \"cascade\"\n"
+            "    cascade:\n"
+            "      refresh_interval: 10\n"
+            "      crop_margin: 0.5\n");
+
+        const std::string path = write_yaml_file("veilsight_cascade_cfg", yaml);
+        const auto cfg = veilsight::load_config_yaml(path);
+        std::filesystem::remove(path);
+
+        check(cfg.modules.person_detector.type == "cascade", "cascade person detector type should parse");
+        check(cfg.modules.person_detector.cascade.refresh_interval == 10, "cascade.refresh_interval should parse");
+        check(std::fabs(cfg.modules.person_detector.cascade.crop_margin - 0.5f) < 0.0001f,
+              "cascade.crop_margin should parse");
+        check(load_throws(minimal_config_yaml(
+                  "modules:\n"
+                  "  person_detector:\n"
+                  "    type: \"cascade\"\n"
+                  "    cascade:\n"
+                  "      refresh_interval: 0\n")),
+              "cascade.refresh_interval should reject zero");
+    }
+
+    void test_ncnn_autotune_config_propagates_to_modules() {
+        const std::string yaml = minimal_config_yaml(
+            "modules:\n"
+            "  ncnn_autotune:\n"
+            "    mode: \"cached\"\n"
+            "    cache_path: \"/tmp/veilsight_autotune.tsv\"\n"
+            "    iterations: 4\n");
+
+        const std::string path = write_yaml_file("veilsight_ncnn_autotune_cfg", yaml);
+        const auto cfg = veilsight::load_config_yaml(path);
+        std::filesystem::remove(path);
+
+        check(cfg.modules.ncnn_autotune.mode == "cached", "ncnn_autotune.mode should parse");
+        check(cfg.modules.person_detector.yolox.ncnn_autotune.mode == "cached",
+              "ncnn_autotune should reach the yolox config");
+        check(cfg.modules.person_detector.uhd.ncnn_autotune.iterations == 4,
+              "ncnn_autotune should reach the uhd config");
+        check(cfg.modules.face_detector.scrfd.ncnn_autotune.cache_path == "/tmp/veilsight_autotune.tsv",
+              "ncnn_autotune should reach the face scrfd config");
+        check(cfg.modules.recognizer.ncnn_autotune.mode == "cached",
+              "ncnn_autotune should reach the recognizer config");
+        check(load_throws(minimal_config_yaml(
+                  "modules:\n"
+                  "  ncnn_autotune:\n"
+                  "    mode: \"always\"\n")),
+              "ncnn_autotune.mode should reject unknown modes");
+        check(load_throws(minimal_config_yaml(
+                  "modules:\n"
+                  "  ncnn_autotune:\n"
+                  "    iterations: 0\n")),
+              "ncnn_autotune.iterations should reject zero");
+    }
+
+    void test_adaptive_resolution_config_parses() {
+        const std::string yaml = minimal_config_yaml(
+            "modules:\n"
+            "  person_detector:\n"
+            "    adaptive_resolution:\n"
+            "      enabled: true\n"
+            "      levels: [320, 480]\n"
+            "      high_pressure: 0.8\n"
+            "      cooldown_frames: 10\n"
+            "  face_detector:\n"
+            "    adaptive_resolution:\n"
+            "      enabled: true\n"
+            "      min_track_height_px: 32\n");
+
+        const std::string path = write_yaml_file("veilsight_adaptive_resolution_cfg", yaml);
+        const auto cfg = veilsight::load_config_yaml(path);
+        std::filesystem::remove(path);
+
+        const auto& person = cfg.modules.person_detector.adaptive_resolution;
+        check(person.enabled, "person adaptive_resolution.enabled should parse");
+        check(person.levels == std::vector<int>({320, 480}), "adaptive_resolution.levels should parse");
+        check(std::fabs(person.high_pressure - 0.8f) < 0.0001f, "adaptive_resolution.high_pressure should parse");
+        check(person.cooldown_frames == 10, "adaptive_resolution.cooldown_frames should parse");
+        const auto& face = cfg.modules.face_detector.adaptive_resolution;
+        check(face.enabled && std::fabs(face.min_track_height_px - 32.0f) < 0.0001f,
+              "face adaptive_resolution should parse");
+        check(face.levels.size() == 3, "face adaptive_resolution.levels should keep defaults");
+        check(std::fabs(person.min_track_height_px - 48.0f) < 0.0001f &&
+                  std::fabs(veilsight::FaceDetectorModuleConfig{}.adaptive_resolution.min_track_height_px - 16.0f) <
+                      0.0001f,
+              "face adaptive_resolution should default to a face-sized minimum height");
+        check(load_throws(minimal_config_yaml(
+                  "modules:\n"
+                  "  person_detector:\n"
+                  "    adaptive_resolution:\n"
+                  "      enabled: true\n"
+                  "      low_pressure: 0.9\n"
+                  "      high_pressure: 0.5\n")),
+              "adaptive_resolution should reject low_pressure >= high_pressure");
+        check(load_throws(minimal_config_yaml(
+                  "modules:\n"
+                  "  person_detector:\n"
+                  "    adaptive_resolution:\n"
+                  "      enabled: true\n"
+                  "      levels: [16]\n")),
+              "adaptive_resolution should reject levels below 32");
+    }
+
+    void test_face_probe_config_parses() {
+        const std::string yaml = minimal_config_yaml(
+            "modules:\n"
+            "  face_detector:\n"
+            "    type: \"scrfd\"\n"
+            "    assignment: \"hungarian\"\n"
+            "    probes:\n"
+            "      mode: \"head_crop\"\n"
+            "      crop_input: 160\n"
+            "      full_frame_interval: 30\n"
+            "      reuse_interval: 5\n"
+            "    mosaic:\n"
+            "      enabled: true\n"
+            "      max_tasks: 4\n");
+
+        const std::string path = write_yaml_file("veilsight_face_probe_cfg", yaml);
+        const auto cfg = veilsight::load_config_yaml(path);
+        std::filesystem::remove(path);
+
+        check(cfg.modules.face_detector.assignment == "hungarian", "face_detector.assignment should parse");
+        const auto& probes = cfg.modules.face_detector.probes;
+        check(probes.mode == "head_crop", "face_detector.probes.mode should parse");
+        check(probes.crop_input == 160, "face_detector.probes.crop_input should parse");
+        check(probes.full_frame_interval == 30, "face_detector.probes.full_frame_interval should parse");
+        check(probes.reuse_interval == 5, "face_detector.probes.reuse_interval should parse");
+        check(std::fabs(probes.head_fraction - 0.40f) < 0.0001f, "face_detector.probes.head_fraction should default");
+        const auto& mosaic = cfg.modules.face_detector.mosaic;
+        check(mosaic.enabled && mosaic.max_tasks == 4, "face_detector.mosaic should parse");
+        check(mosaic.gap_px == 8, "face_detector.mosaic.gap_px should default");
+        check(load_throws(minimal_config_yaml(
+                  "modules:\n"
+                  "  face_detector:\n"
+                  "    type: \"scrfd\"\n"
+                  "    probes:\n"
+                  "      mode: \"tiles\"\n")),
+              "face_detector.probes.mode should reject unknown modes");
+        check(load_throws(minimal_config_yaml(
+                  "modules:\n"
+                  "  face_detector:\n"
+                  "    type: \"scrfd\"\n"
+                  "    assignment: \"auction\"\n")),
+              "face_detector.assignment should reject unknown solvers");
+        check(load_throws(minimal_config_yaml(
+                  "modules:\n"
+                  "  face_detector:\n"
+                  "    type: \"scrfd\"\n"
+                  "    probes:\n"
+                  "      head_fraction: 0\n")),
+              "face_detector.probes.head_fraction should reject zero");
+        check(load_throws(minimal_config_yaml(
+                  "modules:\n"
+                  "  face_detector:\n"
+                  "    type: \"scrfd\"\n"
+                  "    probes:\n"
+                  "      full_frame_interval: 0\n")),
+              "face_detector.probes.full_frame_interval should keep a periodic full-frame probe");
+        check(load_throws(minimal_config_yaml(
+                  "modules:\n"
+                  "  face_detector:\n"
+                  "    type: \"scrfd\"\n"
+                  "    scrfd:\n"
+                  "      input_w: 320\n"
+                  "      input_h: 320\n"
+                  "    probes:\n"
+                  "      crop_input: 400\n"
+                  "    mosaic:\n"
+                  "      enabled: true\n")),
+              "face_detector.mosaic should reject crops larger than the detector input");
+    }
+
+    void test_int8_precision_config_parses() {
+        const std::string yaml = minimal_config_yaml(
+            "modules:\n"
+            "  person_detector:\n"
+            "    yolox:\n"
+            "      precision: \"int8\"\n"
+            "  recognizer:\n"
+            "    type: \"mobilefacenet\"\n"
+            "    precision: \"int8\"\n"
+            "    int8_param_path: \"models/custom/mfn_q.param\"\n");
+
+        const std::string path = write_yaml_file("veilsight_int8_cfg", yaml);
+        const auto cfg = veilsight::load_config_yaml(path);
+        std::filesystem::remove(path);
+
+        check(cfg.modules.person_detector.yolox.precision == "int8", "yolox.precision should parse");
+        check(cfg.modules.person_detector.yolox.int8_param_path.empty(),
+              "yolox.int8_param_path should stay empty so it derives from param_path");
+        check(cfg.modules.recognizer.int8_param_path == "models/custom/mfn_q.param",
+              "recognizer.int8_param_path should parse");
+        check(cfg.modules.face_detector.scrfd.precision == "fp32", "scrfd.precision should default to fp32");
+        check(veilsight::int8_model_path("models/x/bytetrack_nano.ncnn.param") ==
+                  "models/x/bytetrack_nano_int8.ncnn.param",
+              "int8_model_path should keep the .ncnn.param suffix");
+        check(veilsight::int8_model_path("models/x/mobilefacenets.bin") == "models/x/mobilefacenets_int8.bin",
+              "int8_model_path should keep the .bin suffix");
+        check(load_throws(minimal_config_yaml(
+                  "modules:\n"
+                  "  person_detector:\n"
+                  "    yolox:\n"
+                  "      precision: \"fp16\"\n")),
+              "yolox.precision should reject unknown precisions");
+    }
+
+    void test_stream_detection_regions_config_parses() {
+        const std::string yaml =
+            "streams:\n"
+            "  - id: \"cam0\"\n"
+            "    type: \"file\"\n"
+            "    file:\n"
+            "      path: \"/tmp/test.mp4\"\n"
+            "    detection_regions:\n"
+            "      polygons:\n"
+            "        - [[0.1, 0.2], [0.9, 0.2], [0.9, 1.0], [0.1, 1.0]]\n"
+            "      tiling: \"auto\"\n"
+            "      tile_overlap: 0.25\n";
+
+        const auto cfg = veilsight::load_config_yaml_string(yaml);
+        const auto& regions = cfg.streams.at(0).detection_regions;
+        check(regions.polygons.size() == 1 && regions.polygons[0].size() == 4, "detection_regions.polygons should parse");
+        check(std::fabs(regions.polygons[0][1].x - 0.9f) < 0.0001f, "polygon points should parse as [x, y]");
+        check(regions.tiling == "auto", "detection_regions.tiling should parse");
+        check(std::fabs(regions.tile_overlap - 0.25f) < 0.0001f, "detection_regions.tile_overlap should parse");
+        check(regions.full_region_pass, "detection_regions.full_region_pass should default to true");
+
+        const std::string stream_head =
+            "streams:\n"
+            "  - id: \"cam0\"\n"
+            "    type: \"file\"\n"
+            "    file:\n"
+            "      path: \"/tmp/test.mp4\"\n"
+            "    detection_regions:\n";
+        check(load_throws(stream_head + "      polygons:\n        - [[0.1, 0.2], [0.9, 0.2]]\n"),
+              "detection_regions polygon with fewer than 3 points should be rejected");
+        check(load_throws(stream_head + "      polygons:\n        - [[0.1, 0.2], [1.9, 0.2], [0.5, 0.8]]\n"),
+              "detection_regions polygon outside [0, 1] should be rejected");
+        check(load_throws(stream_head + "      polygons:\n        - [[0.1, 0.2], [0.5, 0.5], [0.9, 0.8]]\n"),
+              "detection_regions polygon with collinear points should be rejected");
+        check(load_throws(stream_head + "      tiling: \"grid\"\n"), "detection_regions.tiling should reject unknown modes");
     }
 
     void test_legacy_person_class_id_alias() {
@@ -576,6 +925,21 @@ namespace {
             "    type: \"mobilefacenet\"\n"
             "    model_instances: 2\n"
             "    gallery_path: \"/tmp/gallery.sqlite3\"\n"
+            "    gallery_precision: \"int8\"\n"
+            "    gallery_index:\n"
+            "      type: \"ivfpq\"\n"
+            "      min_rows: 1000\n"
+            "      lists: 64\n"
+            "      probes: 8\n"
+            "      pq_subspaces: 32\n"
+            "      rerank: 40\n"
+            "    gallery_snapshot: false\n"
+            "    batch:\n"
+            "      max_tasks: 6\n"
+            "    best_shot:\n"
+            "      enabled: true\n"
+            "      window_frames: 5\n"
+            "      candidates: 1\n"
             "    param_path: \"models/face_embeddings/mobilefacenet/mobilefacenets.param\"\n"
             "    bin_path: \"models/face_embeddings/mobilefacenet/mobilefacenets.bin\"\n"
             "    input_blob: \"data\"\n"
@@ -600,6 +964,19 @@ namespace {
         check(cfg.modules.recognizer.type == "mobilefacenet", "recognizer.type should parse mobilefacenet");
         check(cfg.modules.recognizer.workers == 2, "mobilefacenet model_instances should parse");
         check(cfg.modules.recognizer.gallery_path == "/tmp/gallery.sqlite3", "mobilefacenet gallery_path should parse");
+        check(cfg.modules.recognizer.gallery_precision == "int8", "mobilefacenet gallery_precision should parse");
+        check(cfg.modules.recognizer.gallery_index.type == "ivfpq" && cfg.modules.recognizer.gallery_index.min_rows == 1000 &&
+                  cfg.modules.recognizer.gallery_index.lists == 64 && cfg.modules.recognizer.gallery_index.probes == 8 &&
+                  cfg.modules.recognizer.gallery_index.pq_subspaces == 32 && cfg.modules.recognizer.gallery_index.rerank == 40,
+              "mobilefacenet gallery_index should parse");
+        check(!cfg.modules.recognizer.gallery_snapshot, "mobilefacenet gallery_snapshot should parse");
+        check(cfg.modules.recognizer.batch.enabled && cfg.modules.recognizer.batch.max_tasks == 6 &&
+                  cfg.modules.recognizer.batch.max_faces == 16,
+              "mobilefacenet batch should parse with defaults");
+        const auto& best_shot = cfg.modules.recognizer.best_shot;
+        check(best_shot.enabled && best_shot.window_frames == 5 && best_shot.candidates == 1 &&
+                  best_shot.max_embeddings == 4,
+              "mobilefacenet best_shot should parse with defaults");
         check(cfg.modules.recognizer.unknown_threshold == 0.45f,
               "mobilefacenet unknown_threshold should default to 0.45");
         check(cfg.modules.recognizer.input_blob == "data", "mobilefacenet input_blob should parse");
@@ -629,6 +1006,35 @@ namespace {
                   "    type: \"mobilefacenet\"\n"
                   "    embedding_dim: 127\n")),
               "mobilefacenet should reject non-128 embedding_dim");
+        check(load_throws(minimal_config_yaml(
+                  "modules:\n"
+                  "  recognizer:\n"
+                  "    type: \"mobilefacenet\"\n"
+                  "    gallery_precision: \"fp16\"\n")),
+              "recognizer should reject unknown gallery_precision");
+        check(load_throws(minimal_config_yaml(
+                  "modules:\n"
+                  "  recognizer:\n"
+                  "    type: \"mobilefacenet\"\n"
+                  "    gallery_index:\n"
+                  "      type: \"ivfpq\"\n"
+                  "      pq_subspaces: 12\n")),
+              "ivfpq gallery index should reject pq_subspaces that do not divide embedding_dim");
+        check(load_throws(minimal_config_yaml(
+                  "modules:\n"
+                  "  recognizer:\n"
+                  "    type: \"mobilefacenet\"\n"
+                  "    batch:\n"
+                  "      max_faces: 0\n")),
+              "recognizer batch should reject zero max_faces");
+        check(load_throws(minimal_config_yaml(
+                  "modules:\n"
+                  "  recognizer:\n"
+                  "    type: \"mobilefacenet\"\n"
+                  "    best_shot:\n"
+                  "      candidates: 3\n"
+                  "      max_embeddings: 2\n")),
+              "recognizer best_shot should reject a budget below the candidates per window");
         check(load_throws(minimal_config_yaml(
                   "modules:\n"
                   "  recognizer:\n"
@@ -939,6 +1345,15 @@ int main() {
     test_person_detector_and_scene_grid_config();
     test_uhd_person_detector_config_parses();
     test_uhd_person_detector_config_validates();
+    test_person_detector_soft_nms_config_parses();
+    test_face_detector_soft_nms_config_parses();
+    test_person_detector_motion_gate_config_parses();
+    test_cascade_person_detector_config_parses();
+    test_ncnn_autotune_config_propagates_to_modules();
+    test_adaptive_resolution_config_parses();
+    test_face_probe_config_parses();
+    test_int8_precision_config_parses();
+    test_stream_detection_regions_config_parses();
     test_legacy_person_class_id_alias();
     test_face_detector_recognizer_identity_config_parses();
     test_mobilefacenet_recognizer_config_parses_and_validates();
@@ -1,10 +1,13 @@
+#include <face_detector/face_mosaic.hpp>
 #include <face_detector/face_policy.hpp>
 #include <recognizer/recognizer.hpp>
 #include <face_detector/scrfd_detector.hpp>
 
+#include <algorithm>
 #include <cmath>
 #include <iostream>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include <opencv2/core.hpp>
@@ -237,6 +240,229 @@ namespace {
         check(tracks[0].privacy_action == "anonymize", "no-face fallback should keep whole person anonymized");
     }
 
+    void test_head_crop_probes_attach_faces_to_their_tracks() {
+        auto cfg = test_face_detector_config();
+        cfg.association_mode = "independent";
+        cfg.probes.mode = "head_crop";
+        cfg.probes.crop_input = 128;
+        cfg.probes.full_frame_interval = 15;
+        FakeFaceDetector detector;
+        detector.responses.push_back({face(54.0f, 30.0f, 40.0f, 40.0f)});
+        detector.responses.push_back({});
+        detector.responses.push_back({face(111.0f, 49.0f, 40.0f, 40.0f)});
+
+        auto state = std::make_shared<veilsight::FaceStateStore>();
+        veilsight::HybridFacePolicy policy(cfg, state);
+        auto f = frame(40);
+        std::vector<veilsight::Box> tracks = {
+            person(80.0f, 50.0f, 120.0f, 260.0f, 1),
+            person(380.0f, 45.0f, 125.0f, 270.0f, 2),
+        };
+
+        const cv::Rect crop = veilsight::head_crop_rect(tracks[0], f.inf.size(), cfg.probes);
+        check(crop == cv::Rect(56, 18, 168, 168), "head crop should be a padded square over the upper body");
+
+        policy.annotate(f, tracks, detector);
+
+        check(detector.runs.size() == 3, "first frame should probe both head crops and the full frame");
+        check(!detector.runs.empty() && detector.runs[0].input_w == 128 && detector.runs[0].input_h == 128,
+              "head crops should run at the crop input size");
+        check(tracks.size() == 2, "full-frame duplicate of a head-crop face should not become a face-only box");
+        check(tracks[0].face && tracks[0].face->source == veilsight::FaceSource::HeadCrop &&
+                  near(tracks[0].face->bbox.x, 110.0f) && near(tracks[0].face->bbox.y, 48.0f),
+              "head-crop face should map back to frame coordinates on its own track");
+        check(!tracks[1].face.has_value(), "track without a face in its crop should stay faceless");
+
+        auto f2 = frame(41);
+        policy.annotate(f2, tracks, detector);
+        check(detector.runs.size() == 5, "full-frame fallback should wait for its interval");
+    }
+
+    void test_face_reuse_skips_probes_until_stale() {
+        auto cfg = test_face_detector_config();
+        cfg.probes.reuse_interval = 3;
+        FakeFaceDetector detector;
+        detector.responses.push_back({face(410.0f, 55.0f, 48.0f, 48.0f)});
+        detector.responses.push_back({face(420.0f, 55.0f, 48.0f, 48.0f)});
+
+        auto state = std::make_shared<veilsight::FaceStateStore>();
+        veilsight::HybridFacePolicy policy(cfg, state);
+        std::vector<veilsight::Box> tracks = {person(380.0f, 45.0f, 125.0f, 270.0f, 2)};
+        auto f1 = frame(1);
+        policy.annotate(f1, tracks, detector);
+        check(detector.runs.size() == 1 && tracks[0].face && tracks[0].face->fresh,
+              "first frame should probe and attach a fresh face");
+
+        tracks[0].x = 390.0f;
+        auto f2 = frame(2);
+        policy.annotate(f2, tracks, detector);
+        check(detector.runs.size() == 1, "recent face should be reused instead of probing");
+        check(f2.face_probes_avoided == 1 && f2.face_probes_issued == 0, "reused frame should count an avoided probe");
+        check(tracks[0].face && !tracks[0].face->fresh && near(tracks[0].face->bbox.x, 420.0f) &&
+                  tracks[0].face->frame_id == 1,
+              "reused face should move with the track and keep its detection frame");
+
+        auto f3 = frame(3);
+        policy.annotate(f3, tracks, detector);
+        check(detector.runs.size() == 1, "face should be reused until reuse_interval frames old");
+
+        auto f4 = frame(4);
+        policy.annotate(f4, tracks, detector);
+        check(detector.runs.size() == 2 && f4.face_probes_issued == 1, "stale face should trigger a probe");
+        check(tracks[0].face && tracks[0].face->fresh, "re-probed track should carry a fresh face");
+
+        tracks[0].h = 400.0f;
+        auto f5 = frame(5);
+        policy.annotate(f5, tracks, detector);
+        check(detector.runs.size() == 3, "person box shape change should trigger a probe");
+        check(!tracks[0].face.has_value(), "re-probe without a detection should drop the reused face");
+    }
+
+    void test_face_reuse_keeps_periodic_full_frame_probe() {
+        auto cfg = test_face_detector_config();
+        cfg.association_mode = "independent";
+        cfg.probes.reuse_interval = 30;
+        cfg.probes.full_frame_interval = 4;
+        FakeFaceDetector detector;
+        detector.responses.push_back({face(410.0f, 55.0f, 48.0f, 48.0f)});
+        detector.responses.push_back({face(410.0f, 55.0f, 48.0f, 48.0f), face(60.0f, 300.0f, 40.0f, 40.0f)});
+
+        auto state = std::make_shared<veilsight::FaceStateStore>();
+        veilsight::HybridFacePolicy policy(cfg, state);
+        std::vector<veilsight::Box> tracks = {person(380.0f, 45.0f, 125.0f, 270.0f, 2)};
+        for (int64_t id = 1; id <= 4; ++id) {
+            auto f = frame(id);
+            policy.annotate(f, tracks, detector);
+        }
+        check(detector.runs.size() == 1, "reused faces should skip the full-frame probe within its interval");
+
+        auto f5 = frame(5);
+        policy.annotate(f5, tracks, detector);
+        check(detector.runs.size() == 2 && f5.face_probes_issued == 1,
+              "full-frame probe should still run every full_frame_interval frames while faces are reused");
+        const bool stranger = std::any_of(tracks.begin(), tracks.end(), [](const veilsight::Box& b) {
+            return b.id < 0 && b.face && near(b.face->bbox.x, 60.0f);
+        });
+        check(stranger, "an untracked face should be detected within full_frame_interval frames");
+    }
+
+    veilsight::FaceDetectionTask head_crop_task(const std::string& stream_id,
+                                                const cv::Mat& image,
+                                                const std::vector<std::pair<cv::Rect, int>>& crops) {
+        veilsight::FaceDetectionTask task;
+        task.stream_id = stream_id;
+        task.frame_id = 7;
+        task.probe_id = "head_crops";
+        task.kind = veilsight::FaceProbeKind::HeadCrops;
+        task.run = veilsight::FaceDetectorRunConfig{128, 128};
+        for (const auto& [rect, track_id] : crops) {
+            task.crops.push_back(veilsight::FaceProbeCrop{
+                veilsight::StageImage{image(rect), veilsight::crop_transform(rect, image.size())}, track_id});
+        }
+        return task;
+    }
+
+    void test_face_mosaic_unpacks_detections_by_tile() {
+        const veilsight::FaceMosaicLayout layout{cv::Size(640, 640), 128, 8};
+        check(veilsight::face_mosaic_capacity(layout) == 16, "640px canvas should hold a 4x4 grid of 128px tiles");
+
+        const auto f0 = frame(7);
+        const auto f1 = frame(7);
+        const std::vector<veilsight::FaceDetectionTask> tasks = {
+            head_crop_task("cam0", f0.inf, {{cv::Rect(56, 18, 168, 168), 1}, {cv::Rect(300, 10, 100, 100), 2}}),
+            head_crop_task("cam1", f1.inf, {{cv::Rect(0, 0, 64, 64), 5}}),
+        };
+
+        FakeFaceDetector detector;
+        detector.responses.push_back({
+            face(32.0f, 32.0f, 64.0f, 64.0f),  // tile 0
+            face(282.0f, 10.0f, 32.0f, 32.0f), // tile 2
+            face(126.0f, 40.0f, 8.0f, 8.0f),   // centered in the gap between tiles 0 and 1
+        });
+
+        const auto results = veilsight::run_face_mosaic_tasks(detector, tasks, layout);
+        check(detector.runs.size() == 1 && detector.runs[0].input_w == 640 && detector.runs[0].input_h == 640,
+              "all crops should share one forward at the detector input size");
+        check(results.size() == 2 && results[0].stream_id == "cam0" && results[1].stream_id == "cam1",
+              "mosaic should return one result per task");
+        check(results.size() == 2 && results[0].faces.size() == 1 && results[0].track_ids == std::vector<int>{1} &&
+                  near(results[0].faces[0].bbox.x, 98.0f) && near(results[0].faces[0].bbox.y, 60.0f) &&
+                  near(results[0].faces[0].bbox.w, 84.0f),
+              "tile face should map through its crop back to frame coordinates");
+        check(results.size() == 2 && results[1].faces.size() == 1 && results[1].track_ids == std::vector<int>{5} &&
+                  near(results[1].faces[0].bbox.x, 5.0f) && near(results[1].faces[0].bbox.w, 16.0f),
+              "faces should go back to the task and track that owns the tile");
+
+        std::vector<std::pair<cv::Rect, int>> many;
+        for (int i = 0; i < 17; ++i) many.push_back({cv::Rect(i * 10, 0, 64, 64), i});
+        const auto mosaics = veilsight::pack_face_mosaics({head_crop_task("cam0", f0.inf, many)}, layout);
+        check(mosaics.size() == 2 && mosaics[0].tiles.size() == 16 && mosaics[1].tiles.size() == 1,
+              "crops beyond one canvas should spill into another");
+    }
+
+    void test_hungarian_assignment_recovers_stranded_faces() {
+        auto cfg = test_face_detector_config();
+        const std::vector<veilsight::FaceObservation> faces = {
+            face(160.0f, 70.0f, 40.0f, 40.0f, 0.9f), // plausible for both tracks, slightly better on track 1
+            face(110.0f, 70.0f, 36.0f, 36.0f, 0.8f), // only plausible for track 1
+        };
+
+        FakeFaceDetector greedy_detector;
+        greedy_detector.responses.push_back(faces);
+        veilsight::HybridFacePolicy greedy(cfg);
+        std::vector<veilsight::Box> greedy_tracks = {
+            person(100.0f, 50.0f, 120.0f, 260.0f, 1),
+            person(150.0f, 40.0f, 120.0f, 270.0f, 2),
+        };
+        auto f1 = frame(1);
+        greedy.annotate(f1, greedy_tracks, greedy_detector);
+        check(greedy_tracks[0].face && near(greedy_tracks[0].face->bbox.x, 160.0f) && !greedy_tracks[1].face,
+              "greedy assignment should give the strongest face its best track");
+
+        cfg.assignment = "hungarian";
+        FakeFaceDetector hungarian_detector;
+        hungarian_detector.responses.push_back(faces);
+        veilsight::HybridFacePolicy hungarian(cfg);
+        std::vector<veilsight::Box> hungarian_tracks = {
+            person(100.0f, 50.0f, 120.0f, 260.0f, 1),
+            person(150.0f, 40.0f, 120.0f, 270.0f, 2),
+        };
+        auto f2 = frame(1);
+        hungarian.annotate(f2, hungarian_tracks, hungarian_detector);
+        check(hungarian_tracks[0].face && near(hungarian_tracks[0].face->bbox.x, 110.0f) &&
+                  hungarian_tracks[1].face && near(hungarian_tracks[1].face->bbox.x, 160.0f),
+              "hungarian assignment should attach both faces");
+    }
+
+    void test_face_assignment_in_crowd() {
+        for (const std::string assignment : {"greedy", "hungarian"}) {
+            auto cfg = test_face_detector_config();
+            cfg.assignment = assignment;
+            std::vector<veilsight::Box> tracks;
+            std::vector<veilsight::FaceObservation> faces;
+            for (int r = 0; r < 10; ++r) {
+                for (int c = 0; c < 15; ++c) {
+                    const float x = static_cast<float>(c * 42);
+                    const float y = static_cast<float>(r * 48);
+                    tracks.push_back(person(x, y, 40.0f, 46.0f, r * 15 + c + 1));
+                    faces.push_back(face(x + 14.0f, y + 4.0f, 12.0f, 12.0f));
+                }
+            }
+            FakeFaceDetector detector;
+            detector.responses.push_back(faces);
+            veilsight::HybridFacePolicy policy(cfg);
+            auto f = frame(1);
+            policy.annotate(f, tracks, detector);
+
+            bool all_matched = tracks.size() == 150;
+            for (const auto& track : tracks) {
+                all_matched = all_matched && track.face && near(track.face->bbox.x, track.x + 14.0f) &&
+                              near(track.face->bbox.y, track.y + 4.0f);
+            }
+            check(all_matched, assignment + " assignment should give every crowd track its own face");
+        }
+    }
+
     void test_noop_recognizer_passes_tracks_through() {
         veilsight::RecognizerModuleConfig cfg;
         cfg.type = "noop";
@@ -267,6 +493,12 @@ int main() {
     test_independent_faces_become_face_only_boxes();
     test_person_bbox_mode_ignores_unassigned_faces();
     test_face_detector_runs_full_frame_each_frame();
+    test_head_crop_probes_attach_faces_to_their_tracks();
+    test_face_reuse_skips_probes_until_stale();
+    test_face_reuse_keeps_periodic_full_frame_probe();
+    test_face_mosaic_unpacks_detections_by_tile();
+    test_hungarian_assignment_recovers_stranded_faces();
+    test_face_assignment_in_crowd();
     test_noop_recognizer_passes_tracks_through();
 
     if (g_failures != 0) {
@@ -1,11 +1,20 @@
 #include <anonymization/anonymizer.hpp>
+#include <common/ncnn_autotune.hpp>
 #include <face_detector/face_policy.hpp>
 #include <identity/identity_decider.hpp>
+#include <person_detector/cascade_detector.hpp>
+#include <pipeline/adaptive_resolution.hpp>
 #include <pipeline/bounded_queue.hpp>
+#include <pipeline/detection_regions.hpp>
 #include <pipeline/metrics.hpp>
+#include <pipeline/motion_gate.hpp>
+#include <pipeline/preprocess_cache.hpp>
 #include <pipeline/stream_coordinator.hpp>
 #include <tracking/tracker.hpp>
 
+#include <cmath>
+#include <filesystem>
+#include <fstream>
 #include <iostream>
 #include <memory>
 #include <string>
@@ -115,6 +124,418 @@ namespace {
         check(json.find("producer") != std::string::npos, "metrics JSON should keep queue metadata");
     }
 
+    void test_metrics_json_reports_stream_counters() {
+        veilsight::RuntimeMetrics metrics;
+        metrics.add_stream_counter("cam0", "motion_gate_skipped");
+        metrics.add_stream_counter("cam0", "motion_gate_skipped", 2);
+        const auto snap = metrics.snapshot();
+        check(snap.stream_counters.at("cam0").at("motion_gate_skipped") == 3, "stream counters should accumulate");
+        const auto json = veilsight::metrics_snapshot_to_json(snap, {});
+        check(json.find("\"counters\":{\"cam0\":{\"motion_gate_skipped\":3}}") != std::string::npos,
+              "metrics JSON should report stream counters");
+    }
+
+    void test_motion_gate_skips_static_frames_until_keyframe() {
+        veilsight::MotionGateConfig cfg;
+        cfg.enabled = true;
+        cfg.downscale_width = 64;
+        cfg.grid_rows = 4;
+        cfg.grid_cols = 4;
+        cfg.keyframe_interval = 4;
+        veilsight::MotionGate gate(cfg);
+
+        const cv::Mat still(120, 160, CV_8UC3, cv::Scalar(40, 40, 40));
+        check(gate.should_detect(still, false), "first frame should always run the detector");
+        check(!gate.should_detect(still, false), "static frame should be skipped");
+        check(!gate.should_detect(still, false), "static frame should still be skipped");
+        check(gate.should_detect(still, true), "live tracks should force detection");
+        check(!gate.should_detect(still, false), "static frame after forced run should be skipped");
+        check(!gate.should_detect(still, false), "static frame should be skipped before keyframe");
+        check(!gate.should_detect(still, false), "static frame should be skipped before keyframe");
+        check(gate.should_detect(still, false), "keyframe interval should force detection");
+        check(gate.skipped_frames() == 5, "gate should count skipped frames");
+
+        cv::Mat moved = still.clone();
+        moved(cv::Rect(100, 60, 40, 40)).setTo(cv::Scalar(220, 220, 220));
+        check(gate.should_detect(moved, false), "changed region should run the detector");
+        check(gate.last_active_cells() >= 1, "changed region should mark at least one active cell");
+        check(!gate.should_detect(moved, false), "reference should follow the last detected frame");
+
+        veilsight::MotionGateConfig disabled;
+        veilsight::MotionGate passthrough(disabled);
+        check(passthrough.should_detect(still, false) && passthrough.should_detect(still, false),
+              "disabled gate should never skip");
+    }
+
+    void test_detection_regions_tile_and_merge_across_crops() {
+        veilsight::DetectionRegionsConfig cfg;
+        cfg.tiling = "auto";
+        cfg.tile_overlap = 0.25f;
+        veilsight::DetectionRegionPlanner planner(cfg, cv::Size(64, 64));
+        check(planner.active(), "auto tiling should activate the region planner");
+
+        const cv::Mat frame(100, 160, CV_8UC3, cv::Scalar(0, 0, 0));
+        const auto layout = planner.layout(frame.size());
+        check(planner.layout(frame.size()) == layout, "layout should be reused for the same frame size");
+        check(layout->crops.size() == 1 + 3 * 2, "full pass plus a 3x2 tile grid should be planned");
+        check(layout->crops.back() == cv::Rect(96, 36, 64, 64), "last tile should end at the frame corner");
+
+        const auto crops = veilsight::crop_detection_regions(frame, *layout);
+        check(crops.size() == layout->crops.size(), "each planned crop should produce a view");
+        const auto mapped = veilsight::map_box(crops[2].image_to_frame, box(5.0f, 6.0f, 10.0f, 20.0f));
+        check(mapped.x == 5.0f + static_cast<float>(layout->crops[2].x) &&
+                  mapped.y == 6.0f + static_cast<float>(layout->crops[2].y),
+              "crop transform should offset boxes back into frame coordinates");
+
+        std::vector<std::vector<veilsight::Box>> crop_boxes(3);
+        crop_boxes[0] = {box(40.0f, 20.0f, 20.0f, 40.0f)};
+        crop_boxes[1] = {box(41.0f, 21.0f, 20.0f, 40.0f)};
+        crop_boxes[2] = {box(40.0f, 20.0f, 20.0f, 18.0f), box(120.0f, 20.0f, 20.0f, 40.0f)};
+        crop_boxes[2][0].score = 0.95f;
+        const auto merged = veilsight::merge_region_detections(*layout, crop_boxes);
+        check(merged.size() == 2, "duplicates and partial boxes across crops should merge");
+        check(!merged.empty() && merged[0].h == 40.0f && merged[0].score == 0.95f,
+              "merge should keep the full box with the best score");
+
+        std::vector<std::vector<veilsight::Box>> nested(6);
+        nested[0] = {box(55.0f, 20.0f, 30.0f, 75.0f)};
+        nested[5] = {box(60.0f, 50.0f, 15.0f, 30.0f)};
+        check(layout->crops[5] == cv::Rect(48, 36, 64, 64), "nested case should use an interior tile");
+        const auto both = veilsight::merge_region_detections(*layout, nested);
+        check(both.size() == 2, "a person nested inside another but clear of tile seams should survive the merge");
+
+        veilsight::DetectionRegionsConfig masked;
+        masked.polygons = {{{0.0f, 0.0f}, {0.5f, 0.0f}, {0.5f, 1.0f}, {0.0f, 1.0f}}};
+        veilsight::DetectionRegionPlanner roi(masked, cv::Size(64, 64));
+        const auto roi_layout = roi.layout(frame.size());
+        check(roi_layout->crops.size() == 1 && roi_layout->crops[0] == cv::Rect(0, 0, 80, 100),
+              "polygon should crop to its bounding rectangle");
+        const auto kept = veilsight::merge_region_detections(
+            *roi_layout, {{box(10.0f, 10.0f, 20.0f, 40.0f), box(120.0f, 10.0f, 20.0f, 40.0f)}});
+        check(kept.size() == 1 && kept[0].x == 10.0f, "detections centred outside the polygon should be dropped");
+
+        veilsight::DetectionRegionsConfig sliver;
+        sliver.polygons = {{{0.5f, 0.5f}, {0.505f, 0.5f}, {0.505f, 0.505f}}};
+        veilsight::DetectionRegionPlanner fallback(sliver, cv::Size(64, 64));
+        const auto fallback_layout = fallback.layout(frame.size());
+        check(fallback_layout->crops.size() == 1 && fallback_layout->crops[0] == cv::Rect(0, 0, 160, 100),
+              "a polygon under 2px at this frame size should fall back to the full frame");
+        const auto unmasked = veilsight::merge_region_detections(*fallback_layout, {{box(120.0f, 10.0f, 20.0f, 40.0f)}});
+        check(unmasked.size() == 1, "the full-frame fallback should not filter detections by the dropped polygon");
+    }
+
+    class ScriptedPersonDetector final : public veilsight::IPersonDetector {
+    public:
+        explicit ScriptedPersonDetector(std::vector<veilsight::Box> boxes, std::vector<cv::Size>* seen = nullptr)
+            : boxes_(std::move(boxes)),
+              seen_(seen) {}
+
+        std::vector<veilsight::Box> detect(const cv::Mat& bgr) override {
+            if (seen_) seen_->push_back(bgr.size());
+            return boxes_;
+        }
+
+    private:
+        std::vector<veilsight::Box> boxes_;
+        std::vector<cv::Size>* seen_ = nullptr;
+    };
+
+    class HintRecordingDetector final : public veilsight::IPersonDetector {
+    public:
+        explicit HintRecordingDetector(std::vector<cv::Size>* input_sizes) : input_sizes_(input_sizes) {}
+
+        std::vector<veilsight::Box> detect(const cv::Mat& bgr) override {
+            return detect(bgr, veilsight::PersonDetectionHints{});
+        }
+        std::vector<veilsight::Box> detect(const cv::Mat&, const veilsight::PersonDetectionHints& hints) override {
+            input_sizes_->push_back(hints.input_size);
+            return {};
+        }
+
+    private:
+        std::vector<cv::Size>* input_sizes_ = nullptr;
+    };
+
+    void test_adaptive_resolution_follows_queue_pressure() {
+        veilsight::AdaptiveResolutionConfig cfg;
+        cfg.enabled = true;
+        cfg.levels = {416, 512, 640};
+        cfg.min_track_height_px = 48.0f;
+        cfg.cooldown_frames = 2;
+        const cv::Size frame_size(1280, 720);
+
+        veilsight::AdaptiveResolution paced(cfg, cv::Size(640, 640));
+        check(paced.sizes().size() == 3, "levels below the configured input should add two smaller sizes");
+        check(paced.current().width == 640, "controller should start at the configured input");
+        check(paced.update(0.9f, 0.0f, frame_size).width == 512, "high pressure should step down one level");
+        check(paced.update(0.9f, 0.0f, frame_size).width == 512, "cooldown should hold the level");
+        check(paced.update(0.9f, 0.0f, frame_size).width == 512, "cooldown should hold the level");
+        check(paced.update(0.9f, 0.0f, frame_size).width == 416, "high pressure after cooldown should step down");
+        check(paced.update(0.9f, 0.0f, frame_size).width == 416, "lowest level should not step further");
+        paced.update(0.1f, 0.0f, frame_size);
+        check(paced.update(0.1f, 0.0f, frame_size).width == 512, "drained queue should step back up");
+
+        cfg.cooldown_frames = 0;
+        veilsight::AdaptiveResolution guarded(cfg, cv::Size(640, 640));
+        check(guarded.update(0.9f, 100.0f, frame_size).width == 640,
+              "step down should be refused when small tracks would fall below min height");
+        check(guarded.update(0.9f, 200.0f, frame_size).width == 512, "large tracks should allow a step down");
+        check(guarded.update(0.9f, 200.0f, frame_size).width == 416, "large tracks should allow a step down");
+        check(guarded.update(0.5f, 100.0f, frame_size).width == 512,
+              "tracks too small at the current level should step up below high pressure");
+
+        veilsight::AdaptiveResolutionConfig wide;
+        wide.enabled = true;
+        wide.levels = {416};
+        veilsight::AdaptiveResolution rounded(wide, cv::Size(1088, 608));
+        check(rounded.sizes().size() == 2 && rounded.sizes().front().width == 416 &&
+                  rounded.sizes().front().height == 224,
+              "levels should keep the input aspect rounded to stride 32");
+
+        veilsight::AdaptiveResolution disabled(veilsight::AdaptiveResolutionConfig{}, cv::Size(640, 640));
+        check(disabled.update(1.0f, 0.0f, frame_size).width == 640, "disabled controller should keep the configured size");
+
+        std::vector<veilsight::Box> tracks;
+        for (int i = 1; i <= 10; ++i) tracks.push_back(box(0.0f, 0.0f, 10.0f, 10.0f * static_cast<float>(i)));
+        check(std::fabs(veilsight::small_track_height(tracks) - 20.0f) < 0.001f,
+              "small track height should be the 10th percentile");
+        check(veilsight::small_track_height({}) == 0.0f, "no tracks should report zero height");
+
+        for (int i = 0; i < 10; ++i) {
+            veilsight::FaceObservation face;
+            face.bbox.h = 4.0f * static_cast<float>(i + 1);
+            if (i % 2 == 0) tracks[static_cast<size_t>(i)].face = face;
+        }
+        check(std::fabs(veilsight::small_face_height(tracks) - 4.0f) < 0.001f,
+              "small face height should follow attached faces, not person boxes");
+        tracks.front().face.reset();
+        check(std::fabs(veilsight::small_face_height(tracks) - 12.0f) < 0.001f, "boxes without a face should be skipped");
+        check(veilsight::small_face_height({box()}) == 0.0f, "no faces should report zero height");
+    }
+
+    void test_cascade_detector_gates_full_detector() {
+        std::vector<cv::Size> full_calls;
+        veilsight::CascadeModuleConfig cfg;
+        cfg.crop_margin = 0.0f;
+        cfg.max_crop_area_ratio = 0.5f;
+
+        veilsight::CascadeDetector idle(cfg,
+                                        std::make_unique<ScriptedPersonDetector>(std::vector<veilsight::Box>{}),
+                                        std::make_unique<ScriptedPersonDetector>(std::vector<veilsight::Box>{box(1.0f, 2.0f)},
+                                                                                 &full_calls));
+        const cv::Mat frame(100, 200, CV_8UC3, cv::Scalar(0, 0, 0));
+        check(idle.detect(frame).empty(), "cascade should skip the full detector when the gate sees nobody");
+        check(full_calls.empty(), "cascade should not run the full detector on empty gate frames");
+        check(idle.detect(frame, veilsight::PersonDetectionHints{true, false}).size() == 1,
+              "live tracks should force the full detector");
+        check(idle.detect(frame, veilsight::PersonDetectionHints{false, true}).size() == 1,
+              "refresh should force the full detector");
+        check(full_calls.size() == 2 && full_calls.back() == frame.size(), "forced runs should use the whole frame");
+
+        full_calls.clear();
+        veilsight::CascadeDetector sparse(cfg,
+                                          std::make_unique<ScriptedPersonDetector>(std::vector<veilsight::Box>{
+                                              box(120.0f, 30.0f, 20.0f, 40.0f)}),
+                                          std::make_unique<ScriptedPersonDetector>(std::vector<veilsight::Box>{
+                                              box(2.0f, 3.0f, 10.0f, 20.0f)},
+                                                                                   &full_calls));
+        const auto boxes = sparse.detect(frame);
+        check(full_calls.size() == 1 && full_calls[0] == cv::Size(20, 40), "sparse gate hits should crop the full detector");
+        check(boxes.size() == 1 && boxes[0].x == 122.0f && boxes[0].y == 33.0f,
+              "cropped detections should map back to frame coordinates");
+
+        full_calls.clear();
+        veilsight::CascadeDetector crowded(cfg,
+                                           std::make_unique<ScriptedPersonDetector>(std::vector<veilsight::Box>{
+                                               box(0.0f, 0.0f, 20.0f, 40.0f), box(170.0f, 50.0f, 30.0f, 50.0f)}),
+                                           std::make_unique<ScriptedPersonDetector>(std::vector<veilsight::Box>{},
+                                                                                    &full_calls));
+        (void)crowded.detect(frame);
+        check(full_calls.size() == 1 && full_calls[0] == frame.size(),
+              "gate hits spread over the frame should run the full detector on the whole frame");
+
+        std::vector<cv::Size> input_sizes;
+        veilsight::CascadeDetector adaptive(cfg,
+                                            std::make_unique<ScriptedPersonDetector>(std::vector<veilsight::Box>{
+                                                box(120.0f, 30.0f, 20.0f, 40.0f)}),
+                                            std::make_unique<HintRecordingDetector>(&input_sizes));
+        veilsight::PersonDetectionHints hints;
+        hints.input_size = cv::Size(320, 192);
+        (void)adaptive.detect(frame, hints);
+        hints.refresh = true;
+        (void)adaptive.detect(frame, hints);
+        check(input_sizes.size() == 2 && input_sizes[0].empty() && input_sizes[1] == cv::Size(320, 192),
+              "adaptive input size should apply to full-frame runs only, not to cascade crops");
+    }
+
+    void test_ncnn_tuning_cache_round_trips_by_model_hash() {
+        const auto dir = std::filesystem::temp_directory_path() / "veilsight_ncnn_autotune_test";
+        std::filesystem::remove_all(dir);
+        std::filesystem::create_directories(dir);
+        const auto write_file = [](const std::filesystem::path& path, const std::string& content) {
+            std::ofstream out(path, std::ios::binary | std::ios::trunc);
+            out << content;
+        };
+        write_file(dir / "model.param", "7767517\n1 1\nInput in0 0 1 in0\n");
+        write_file(dir / "model.bin", "weights-v1");
+
+        veilsight::NcnnModelProbe probe;
+        probe.name = "test";
+        probe.param_path = (dir / "model.param").string();
+        probe.bin_path = (dir / "model.bin").string();
+        probe.input_w = 64;
+        probe.input_h = 32;
+        const std::string key = veilsight::ncnn_tuning_cache_key(probe);
+        probe.threads = 2;
+        const std::string key_threads = veilsight::ncnn_tuning_cache_key(probe);
+        probe.threads = 1;
+        write_file(dir / "model.bin", "weights-v2");
+        const std::string key_weights = veilsight::ncnn_tuning_cache_key(probe);
+        check(key != key_threads, "autotune cache key should include the thread count");
+        check(key != key_weights, "autotune cache key should change with the model weights");
+
+        const std::string cache = (dir / "nested" / "autotune.tsv").string();
+        check(!veilsight::load_cached_ncnn_tuning(cache, key).has_value(), "missing cache should miss");
+
+        veilsight::NcnnTuning fp32;
+        fp32.use_fp16_packed = false;
+        fp32.use_fp16_storage = false;
+        fp32.use_fp16_arithmetic = false;
+        fp32.avg_ms = 4.0;
+        veilsight::NcnnTuning no_winograd;
+        no_winograd.use_winograd_convolution = false;
+        no_winograd.avg_ms = 2.5;
+        veilsight::store_cached_ncnn_tuning(cache, key, fp32);
+        veilsight::store_cached_ncnn_tuning(cache, key_weights, no_winograd);
+        veilsight::store_cached_ncnn_tuning(cache, key, no_winograd);
+
+        const auto hit = veilsight::load_cached_ncnn_tuning(cache, key);
+        check(hit.has_value() && *hit == no_winograd, "autotune cache should return the latest entry for a key");
+        check(hit.has_value() && std::abs(hit->avg_ms - 2.5) < 1e-6, "autotune cache should keep the timing");
+        const auto other = veilsight::load_cached_ncnn_tuning(cache, key_weights);
+        check(other.has_value() && *other == no_winograd, "autotune cache should keep other keys");
+
+        std::vector<veilsight::NcnnAutotuneReport> reports(3);
+        reports[0].tuning = fp32;
+        reports[1].tuning = no_winograd;
+        reports[1].tuning.avg_ms = 1.0;
+        reports[1].within_tolerance = false;
+        reports[2].tuning = veilsight::NcnnTuning{};
+        reports[2].tuning.avg_ms = 3.0;
+        check(veilsight::pick_ncnn_tuning(reports) == veilsight::NcnnTuning{},
+              "autotune should pick the fastest candidate within tolerance");
+
+        std::filesystem::remove_all(dir);
+    }
+
+    void test_preprocess_cache_attached_only_when_detectors_share() {
+        veilsight::PersonDetectorModuleConfig person;
+        veilsight::FaceDetectorModuleConfig face;
+        check(!veilsight::detectors_share_preprocess(person, face),
+              "default YOLOX letterbox and SCRFD stretch should not share a preprocess cache");
+        person.yolox.input_w = 1088;
+        person.yolox.input_h = 608;
+        check(!veilsight::detectors_share_preprocess(person, face),
+              "the reference 1088x608 letterbox input should keep YOLOX on its own reused buffer");
+
+        person.yolox.input_w = 640;
+        person.yolox.input_h = 640;
+        person.yolox.letterbox = false;
+        check(veilsight::detectors_share_preprocess(person, face),
+              "YOLOX stretch at the SCRFD input size should share the full-frame input");
+        face.type = "yunet";
+        face.yunet.input_w = 320;
+        face.yunet.input_h = 320;
+        check(!veilsight::detectors_share_preprocess(person, face), "different input sizes should not share");
+        face.type = "none";
+        check(!veilsight::detectors_share_preprocess(person, face), "no face detector leaves nothing to share");
+        face.type = "scrfd";
+        person.type = "uhd";
+        check(!veilsight::detectors_share_preprocess(person, face), "only YOLOX-based detectors use the cache");
+    }
+
+    void test_preprocess_cache_reuses_and_derives_tensors() {
+        cv::Mat source(6, 8, CV_8UC3);
+        for (int y = 0; y < source.rows; ++y) {
+            for (int x = 0; x < source.cols; ++x) {
+                source.at<cv::Vec3b>(y, x) = cv::Vec3b(static_cast<unsigned char>(10 * x),
+                                                       static_cast<unsigned char>(20 * y),
+                                                       static_cast<unsigned char>(5 * (x + y)));
+            }
+        }
+        const auto build_for = [](const cv::Mat& image, const veilsight::PreprocessKey& key) {
+            ncnn::Mat tensor = ncnn::Mat::from_pixels_resize(
+                image.data,
+                key.rgb ? ncnn::Mat::PIXEL_BGR2RGB : ncnn::Mat::PIXEL_BGR,
+                image.cols,
+                image.rows,
+                static_cast<int>(image.step[0]),
+                key.width,
+                key.height);
+            tensor.substract_mean_normalize(key.mean.data(), key.norm.data());
+            return tensor;
+        };
+
+        veilsight::PreprocessKey person;
+        person.width = 4;
+        person.height = 4;
+        person.rgb = true;
+        person.norm = {1.0f / 255.0f, 1.0f / 255.0f, 1.0f / 255.0f};
+        veilsight::PreprocessKey face;
+        face.width = 4;
+        face.height = 4;
+        face.mean = {127.5f, 127.5f, 127.5f};
+        face.norm = {1.0f / 128.0f, 1.0f / 128.0f, 1.0f / 128.0f};
+
+        veilsight::PreprocessCache cache(source);
+        int builds = 0;
+        const auto first = cache.get(source, person, [&]() {
+            ++builds;
+            return build_for(source, person);
+        });
+        const auto again = cache.get(source, person, [&]() {
+            ++builds;
+            return build_for(source, person);
+        });
+        check(builds == 1 && cache.misses() == 1 && cache.hits() == 1, "same key should reuse the cached tensor");
+        check(first.data == again.data, "cache hits should share the tensor");
+
+        const auto derived = cache.get(source, face, [&]() {
+            ++builds;
+            return build_for(source, face);
+        });
+        check(builds == 1 && cache.derived() == 1, "same geometry should derive instead of resizing again");
+        const auto direct = build_for(source, face);
+        bool matches = derived.w == direct.w && derived.h == direct.h && derived.c == direct.c;
+        for (int c = 0; matches && c < direct.c; ++c) {
+            const float* a = derived.channel(c);
+            const float* b = direct.channel(c);
+            for (int i = 0; i < direct.w * direct.h; ++i) {
+                if (std::fabs(a[i] - b[i]) > 1e-3f) matches = false;
+            }
+        }
+        check(matches, "derived tensor should match a directly built one");
+
+        veilsight::PreprocessKey boxed = person;
+        boxed.resize = veilsight::PreprocessResize::Letterbox;
+        cache.get(source, boxed, [&]() {
+            ++builds;
+            return build_for(source, person);
+        });
+        check(builds == 2, "different geometry should build");
+
+        const cv::Mat crop = source(cv::Rect(0, 0, 4, 4));
+        cache.get(crop, person, [&]() {
+            ++builds;
+            return build_for(crop, person);
+        });
+        cache.get(crop, person, [&]() {
+            ++builds;
+            return build_for(crop, person);
+        });
+        check(builds == 4 && cache.misses() == 2, "images other than the source should never be cached");
+    }
+
     void test_stream_coordinator_commits_in_order_with_out_of_order_person_detections() {
         veilsight::FaceDetectorModuleConfig face_detector;
         veilsight::StreamCoordinator coordinator(
@@ -367,6 +788,7 @@ namespace {
         veilsight::FaceProbePlanner planner(cfg);
 
         auto f = frame(10);
+        f->preprocess = std::make_shared<veilsight::PreprocessCache>(f->inf);
         std::vector<veilsight::Box> tracks = {box(20, 10, 30, 70)};
         tracks[0].id = 7;
         const auto probes = planner.plan(*f, tracks);
@@ -374,6 +796,8 @@ namespace {
         check(probes.size() == 1, "face probe planner should emit one probe per frame");
         check(!probes.empty() && probes[0].kind == veilsight::FaceProbeKind::FullFrame,
               "face probe planner should emit full-frame probes only");
+        check(!probes.empty() && probes[0].run.preprocess == f->preprocess,
+              "full-frame probes should carry the frame's preprocess cache");
     }
 
     void test_passthrough_identity_preserves_recognizer_decisions() {
@@ -442,6 +866,14 @@ namespace {
 
 int main() {
     test_queue_catalog_snapshot_has_new_names_and_metadata();
+    test_metrics_json_reports_stream_counters();
+    test_motion_gate_skips_static_frames_until_keyframe();
+    test_detection_regions_tile_and_merge_across_crops();
+    test_adaptive_resolution_follows_queue_pressure();
+    test_cascade_detector_gates_full_detector();
+    test_ncnn_tuning_cache_round_trips_by_model_hash();
+    test_preprocess_cache_attached_only_when_detectors_share();
+    test_preprocess_cache_reuses_and_derives_tensors();
     test_stream_coordinator_commits_in_order_with_out_of_order_person_detections();
     test_stale_results_are_discarded_after_commit();
     test_stream_coordinator_orders_face_recognition_identity();
@@ -1,11 +1,18 @@
+#include <recognizer/gallery.hpp>
 #include <recognizer/recognizer.hpp>
 
+#include <algorithm>
 #include <chrono>
 #include <cmath>
+#include <cstring>
+#include <fstream>
 #include <filesystem>
 #include <iostream>
+#include <iterator>
+#include <random>
 #include <stdexcept>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include <ncnn/mat.h>
@@ -259,6 +266,288 @@ namespace {
         }
     }
 
+    // Same change log the gallery DB scripts create; lets the recognizer reload only changed rows.
+    void add_gallery_change_log(const std::filesystem::path& path) {
+        sqlite3* db = nullptr;
+        if (sqlite3_open(path.string().c_str(), &db) != SQLITE_OK) {
+            throw std::runtime_error("failed to open test gallery DB");
+        }
+        try {
+            exec_sql(db,
+                     "CREATE TABLE gallery_meta (key TEXT PRIMARY KEY, value TEXT NOT NULL);"
+                     "INSERT INTO gallery_meta(key, value) VALUES ('generation', 'test');"
+                     "CREATE TABLE gallery_changes (seq INTEGER PRIMARY KEY AUTOINCREMENT, embedding_id INTEGER NOT NULL);"
+                     "CREATE TRIGGER fe_insert AFTER INSERT ON face_embeddings "
+                     "BEGIN INSERT INTO gallery_changes(embedding_id) VALUES (NEW.id); END;"
+                     "CREATE TRIGGER fe_update AFTER UPDATE OF identity_key, model, dim, embedding, active "
+                     "ON face_embeddings BEGIN INSERT INTO gallery_changes(embedding_id) VALUES (NEW.id); END;"
+                     "CREATE TRIGGER fe_delete AFTER DELETE ON face_embeddings "
+                     "BEGIN INSERT INTO gallery_changes(embedding_id) VALUES (OLD.id); END;"
+                     "CREATE TRIGGER identity_active AFTER UPDATE OF active ON identities "
+                     "BEGIN INSERT INTO gallery_changes(embedding_id) "
+                     "SELECT id FROM face_embeddings WHERE identity_key = NEW.identity_key; END;");
+        } catch (...) {
+            sqlite3_close(db);
+            throw;
+        }
+        sqlite3_close(db);
+    }
+
+    void test_gallery_matrix_top_k_matches_brute_force() {
+        constexpr int kDim = 128;
+        constexpr int kRows = 600;
+        constexpr int kIdentities = 150;
+        constexpr size_t kTop = 4;
+        std::mt19937 rng(7);
+        std::normal_distribution<float> noise(0.0f, 1.0f);
+
+        veilsight::GalleryMatrix fp32(kDim);
+        veilsight::GalleryMatrix int8(kDim);
+        int8.quantize_int8();
+        std::vector<std::vector<float>> rows;
+        for (int r = 0; r < kRows; ++r) {
+            std::vector<float> v(kDim);
+            for (float& x : v) x = noise(rng);
+            v = l2_normalize(std::move(v));
+            const std::string key = "id" + std::to_string(r % kIdentities);
+            fp32.add(key, v.data());
+            int8.add(key, v.data());
+            rows.push_back(std::move(v));
+        }
+        check(fp32.rows() == kRows && fp32.identities().size() == kIdentities,
+              "gallery matrix should intern one identity per key");
+
+        const std::vector<int> probes = {3, 77, 150, 299, 598};
+        std::vector<float> queries;
+        for (const int p : probes) {
+            std::vector<float> q = rows[static_cast<size_t>(p)];
+            for (float& x : q) x += 0.05f * noise(rng);
+            q = l2_normalize(std::move(q));
+            queries.insert(queries.end(), q.begin(), q.end());
+        }
+
+        std::vector<std::vector<veilsight::GalleryMatch>> exact;
+        std::vector<std::vector<veilsight::GalleryMatch>> quantized;
+        fp32.search(queries.data(), probes.size(), kTop, exact);
+        int8.search(queries.data(), probes.size(), kTop, quantized);
+        check(exact.size() == probes.size() && quantized.size() == probes.size(),
+              "gallery search should answer every query");
+
+        for (size_t q = 0; q < probes.size(); ++q) {
+            const float* query = queries.data() + q * kDim;
+            std::vector<std::pair<float, int>> best(kIdentities, {-2.0f, 0});
+            for (int r = 0; r < kRows; ++r) {
+                double dot = 0.0;
+                for (int i = 0; i < kDim; ++i) dot += static_cast<double>(query[i]) * rows[static_cast<size_t>(r)][static_cast<size_t>(i)];
+                auto& slot = best[static_cast<size_t>(r % kIdentities)];
+                slot = std::max(slot, std::make_pair(static_cast<float>(dot), r % kIdentities));
+            }
+            std::sort(best.begin(), best.end(), [](const auto& a, const auto& b) { return a.first > b.first; });
+
+            check(exact[q].size() == kTop, "gallery search should return k distinct identities");
+            for (size_t i = 0; i < exact[q].size(); ++i) {
+                check(fp32.identities()[exact[q][i].identity] == "id" + std::to_string(best[i].second),
+                      "gallery top-k identity should match brute force");
+                check(std::abs(exact[q][i].score - best[i].first) < 1e-4f, "gallery top-k score should match brute force");
+            }
+            check(!quantized[q].empty() && quantized[q][0].identity == exact[q][0].identity &&
+                      std::abs(quantized[q][0].score - exact[q][0].score) < 1e-4f,
+                  "int8 gallery scan should re-rank to the exact best identity");
+
+            const auto single = fp32.search(std::vector<float>(query, query + kDim), 1);
+            check(single.size() == 1 && single[0].identity == exact[q][0].identity,
+                  "single-query gallery search should match the batched scan");
+        }
+
+        std::vector<std::vector<veilsight::GalleryMatch>> none;
+        veilsight::GalleryMatrix(kDim).search(queries.data(), 1, kTop, none);
+        check(none.size() == 1 && none[0].empty(), "empty gallery should return no matches");
+    }
+
+    void test_gallery_ivfpq_index_reranks_to_exact_scores() {
+        constexpr int kDim = 128;
+        constexpr int kRows = 3000;
+        std::mt19937 rng(11);
+        std::normal_distribution<float> noise(0.0f, 1.0f);
+
+        veilsight::GalleryMatrix matrix(kDim);
+        std::vector<std::vector<float>> rows;
+        for (int r = 0; r < kRows; ++r) {
+            std::vector<float> v(kDim);
+            for (float& x : v) x = noise(rng);
+            v = l2_normalize(std::move(v));
+            matrix.add("id" + std::to_string(r), v.data());
+            rows.push_back(std::move(v));
+        }
+
+        veilsight::GalleryIndexConfig cfg;
+        cfg.type = "ivfpq";
+        cfg.lists = 24;
+        cfg.probes = 6;
+        cfg.pq_subspaces = 16;
+        cfg.rerank = 32;
+        const veilsight::GalleryIvfPqIndex index(matrix, cfg);
+        check(index.lists() == 24, "ivfpq index should build the configured number of lists");
+
+        int hits = 0;
+        constexpr int kQueries = 40;
+        for (int q = 0; q < kQueries; ++q) {
+            std::vector<float> query = rows[static_cast<size_t>(q * 71)];
+            for (float& x : query) x += 0.03f * noise(rng);
+            query = l2_normalize(std::move(query));
+
+            const auto exact = matrix.search(query, 1);
+            const auto approx = index.search(matrix, query, 3);
+            check(!approx.empty() && approx.size() <= 3, "ivfpq search should return at most k identities");
+            if (approx.empty()) continue;
+            if (approx[0].identity == exact[0].identity) {
+                ++hits;
+                check(std::abs(approx[0].score - exact[0].score) < 1e-5f, "ivfpq scores should be re-ranked exactly");
+            }
+        }
+        check(hits >= kQueries - 2, "ivfpq index should find near-duplicate queries");
+
+        cfg.pq_subspaces = 12;
+        bool threw = false;
+        try {
+            const veilsight::GalleryIvfPqIndex bad(matrix, cfg);
+        } catch (const std::exception&) {
+            threw = true;
+        }
+        check(threw, "ivfpq index should reject subspaces that do not divide the embedding dim");
+    }
+
+    void test_gallery_snapshot_round_trips_and_rejects_corrupt_files() {
+        constexpr int kDim = 128;
+        std::mt19937 rng(5);
+        std::normal_distribution<float> noise(0.0f, 1.0f);
+        veilsight::GalleryMatrix matrix(kDim);
+        for (int r = 0; r < 40; ++r) {
+            std::vector<float> v(kDim);
+            for (float& x : v) x = noise(rng);
+            v = l2_normalize(std::move(v));
+            matrix.add("id" + std::to_string(r % 7), v.data(), 100 + r);
+        }
+
+        const auto path = temp_db_path("veilsight_gallery_snapshot").replace_extension(".vsgallery");
+        matrix.save_snapshot(path.string(), veilsight::GallerySnapshotInfo{"gen-a", 42});
+        veilsight::GallerySnapshotInfo info;
+        auto mapped = veilsight::GalleryMatrix::map_snapshot(path.string(), kDim, info);
+        check(mapped.mapped() && info.source_tag == "gen-a" && info.change_seq == 42,
+              "gallery snapshot should map with its source tag and change seq");
+        check(mapped.rows() == matrix.rows() && mapped.identities() == matrix.identities(),
+              "mapped gallery snapshot should keep rows and identities");
+
+        bool same = true;
+        for (size_t r = 0; r < matrix.rows(); ++r) {
+            same = same && mapped.row_id(r) == matrix.row_id(r) && mapped.row_identity(r) == matrix.row_identity(r) &&
+                   std::equal(matrix.row(r), matrix.row(r) + kDim, mapped.row(r));
+        }
+        check(same, "mapped gallery rows should match the saved matrix");
+
+        std::vector<uint8_t> skip(matrix.rows(), 0);
+        skip[3] = 1;
+        const std::vector<float> query(matrix.row(3), matrix.row(3) + kDim);
+        mapped.quantize_int8();
+        const auto hit = mapped.search(query, 1);
+        const auto skipped = mapped.search(query, 1, skip.data());
+        check(!hit.empty() && hit[0].identity == matrix.row_identity(3) && hit[0].score > 0.999f,
+              "mapped gallery should find its own row");
+        check(!skipped.empty() && skipped[0].score < 0.999f, "skipped gallery rows should not match");
+
+        // The int8 copy and the IVF-PQ index are stored with the rows, so mapping neither requantizes nor retrains.
+        veilsight::GalleryIndexConfig index_cfg;
+        index_cfg.type = "ivfpq";
+        index_cfg.lists = 4;
+        index_cfg.probes = 2;
+        index_cfg.pq_subspaces = 16;
+        index_cfg.rerank = 8;
+        matrix.quantize_int8();
+        const veilsight::GalleryIvfPqIndex index(matrix, index_cfg);
+        matrix.save_snapshot(path.string(), veilsight::GallerySnapshotInfo{"gen-b", 43}, &index);
+        auto indexed = veilsight::GalleryMatrix::map_snapshot(path.string(), kDim, info);
+        const veilsight::GalleryIvfPqIndex adopted(indexed, index_cfg, 0x1234);
+        check(indexed.quantized() && adopted.mapped() && adopted.lists() == index.lists(),
+              "gallery snapshot should map its int8 copy and index");
+        bool same_results = true;
+        for (size_t r = 0; r < matrix.rows(); ++r) {
+            const std::vector<float> q(matrix.row(r), matrix.row(r) + kDim);
+            const auto want = index.search(matrix, q, 3);
+            const auto got = adopted.search(indexed, q, 3);
+            const auto want_int8 = matrix.search(q, 3);
+            const auto got_int8 = indexed.search(q, 3);
+            same_results = same_results && want.size() == got.size() && want_int8.size() == got_int8.size();
+            for (size_t i = 0; same_results && i < want.size(); ++i) {
+                same_results = want[i].identity == got[i].identity && want[i].score == got[i].score;
+            }
+            for (size_t i = 0; same_results && i < want_int8.size(); ++i) {
+                same_results = want_int8[i].identity == got_int8[i].identity && want_int8[i].score == got_int8[i].score;
+            }
+        }
+        check(same_results, "mapped int8 copy and index should answer like the saved ones");
+        index_cfg.lists = 5;
+        const veilsight::GalleryIvfPqIndex retrained(indexed, index_cfg);
+        check(!retrained.mapped() && retrained.lists() == 5, "index with other lists should retrain, not map");
+
+        size_t stray_temps = 0;
+        for (const auto& entry : std::filesystem::directory_iterator(path.parent_path())) {
+            const std::string name = entry.path().filename().string();
+            if (name != path.filename().string() && name.rfind(path.filename().string(), 0) == 0) ++stray_temps;
+        }
+        check(stray_temps == 0, "saving a gallery snapshot should not leave its temp file behind");
+
+        // The index row list is a permutation of the rows; listing one row twice must be rejected.
+        std::string bytes;
+        {
+            std::ifstream in(path, std::ios::binary);
+            bytes.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+        }
+        const size_t n = matrix.rows();
+        size_t list_rows_at = 0;
+        for (size_t at = 0; list_rows_at == 0 && at + n * sizeof(uint32_t) <= bytes.size(); at += sizeof(uint32_t)) {
+            std::vector<uint8_t> seen(n, 0);
+            bool permutation = true;
+            for (size_t i = 0; permutation && i < n; ++i) {
+                uint32_t row = 0;
+                std::memcpy(&row, bytes.data() + at + i * sizeof(uint32_t), sizeof(row));
+                permutation = row < n && seen[row]++ == 0;
+            }
+            if (permutation) list_rows_at = at;
+        }
+        check(list_rows_at > 0, "gallery snapshot should store the index row lists");
+        std::memcpy(bytes.data() + list_rows_at + sizeof(uint32_t), bytes.data() + list_rows_at, sizeof(uint32_t));
+        {
+            std::ofstream out(path, std::ios::binary | std::ios::trunc);
+            out.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+        }
+        bool duplicate_threw = false;
+        try {
+            (void)veilsight::GalleryMatrix::map_snapshot(path.string(), kDim, info);
+        } catch (const std::exception&) {
+            duplicate_threw = true;
+        }
+        check(duplicate_threw, "gallery snapshot whose index lists a row twice should be rejected");
+
+        std::filesystem::resize_file(path, 100);
+        bool threw = false;
+        try {
+            (void)veilsight::GalleryMatrix::map_snapshot(path.string(), kDim, info);
+        } catch (const std::exception&) {
+            threw = true;
+        }
+        check(threw, "truncated gallery snapshot should be rejected");
+
+        matrix.save_snapshot(path.string(), veilsight::GallerySnapshotInfo{"gen-a", 42});
+        threw = false;
+        try {
+            (void)veilsight::GalleryMatrix::map_snapshot(path.string(), 64, info);
+        } catch (const std::exception&) {
+            threw = true;
+        }
+        check(threw, "gallery snapshot for another dim should be rejected");
+        std::filesystem::remove(path);
+    }
+
     void test_mobilefacenet_factory_loads_empty_gallery_and_caches_unknown() {
         auto cfg = mobilefacenet_cfg();
         cfg.gallery_path.clear();
@@ -442,15 +731,242 @@ namespace {
               "later high-quality face should retry after low-quality non-decision");
         std::filesystem::remove(db_path);
     }
+
+    void test_mobilefacenet_batch_matches_single_task_results() {
+        auto cfg = mobilefacenet_cfg();
+        cfg.batch.max_faces = 2;
+        const auto face = good_face();
+        const auto embedding = compute_embedding_for_test(cfg, frame(7), face);
+
+        const auto db_path = temp_db_path("veilsight_gallery_batch");
+        create_gallery_db(db_path, {{"alice", embedding}});
+        cfg.gallery_path = db_path.string();
+
+        const auto make_tasks = [&]() {
+            std::vector<veilsight::RecognitionTask> tasks(3);
+            const char* streams[] = {"cam0", "cam0", "cam1"};
+            for (size_t t = 0; t < tasks.size(); ++t) {
+                tasks[t].stream_id = streams[t];
+                tasks[t].frame_id = 7 + static_cast<int64_t>(t);
+                tasks[t].frame = frame(tasks[t].frame_id);
+                tasks[t].frame->stream_id = streams[t];
+                tasks[t].tracks = {track_with_face(71, face)};
+            }
+            tasks[2].tracks.push_back(track_with_face(-1, face));
+            return tasks;
+        };
+
+        auto batched_recognizer = veilsight::create_recognizer(cfg);
+        const auto batched = batched_recognizer->recognize_batch(make_tasks());
+        auto single_recognizer = veilsight::create_recognizer(cfg);
+        std::vector<veilsight::RecognitionResult> single;
+        for (const auto& task : make_tasks()) single.push_back(single_recognizer->recognize(task));
+
+        check(batched.size() == single.size(), "batched recognition should return one result per task");
+        for (size_t t = 0; t < batched.size() && t < single.size(); ++t) {
+            check(batched[t].stream_id == single[t].stream_id && batched[t].frame_id == single[t].frame_id,
+                  "batched recognition should keep task order");
+            check(batched[t].tracks.size() == single[t].tracks.size(), "batched recognition should preserve tracks");
+            for (size_t i = 0; i < batched[t].tracks.size() && i < single[t].tracks.size(); ++i) {
+                const auto& a = batched[t].tracks[i];
+                const auto& b = single[t].tracks[i];
+                check(a.identity_key == "alice" && a.privacy_action == "allow",
+                      "batched recognition should match every face to the gallery");
+                check(a.identity_key == b.identity_key && a.recognition_state == b.recognition_state &&
+                          std::abs(a.identity_confidence - b.identity_confidence) < 1e-5f,
+                      "batched recognition should match single-task decisions");
+            }
+            check(batched[t].frame && batched[t].frame->tracked_boxes.size() == batched[t].tracks.size() &&
+                      batched[t].frame->tracked_boxes[0].identity_key == "alice",
+                  "batched recognition should update each frame's tracks");
+        }
+        std::filesystem::remove(db_path);
+    }
+
+    veilsight::FaceObservation shifted_face(float score, float dx, float dy) {
+        auto face = good_face(score);
+        face.bbox.x += dx;
+        face.bbox.y += dy;
+        for (auto& landmark : face.landmarks) {
+            landmark.x += dx;
+            landmark.y += dy;
+        }
+        return face;
+    }
+
+    float dot(const std::vector<float>& a, const std::vector<float>& b) {
+        float sum = 0.0f;
+        for (size_t i = 0; i < a.size() && i < b.size(); ++i) sum += a[i] * b[i];
+        return sum;
+    }
+
+    void test_mobilefacenet_best_shot_waits_for_window() {
+        auto cfg = mobilefacenet_cfg();
+        cfg.best_shot.enabled = true;
+        cfg.best_shot.window_frames = 3;
+        cfg.best_shot.candidates = 1;
+        cfg.best_shot.max_embeddings = 2;
+        const auto face = good_face();
+        const auto embedding = compute_embedding_for_test(cfg, frame(8), face);
+        // Lower-quality faces of the window sit elsewhere in the frame and do not match alice, so a known
+        // decision proves the best face was the one embedded.
+        const auto decoy = [](float score) { return shifted_face(score, 12.0f, 8.0f); };
+        check(dot(compute_embedding_for_test(cfg, frame(8), decoy(0.75f)), embedding) < cfg.unknown_threshold,
+              "best-shot decoy face should not match the gallery");
+
+        const auto db_path = temp_db_path("veilsight_gallery_best_shot");
+        create_gallery_db(db_path, {{"alice", embedding}});
+        cfg.gallery_path = db_path.string();
+
+        auto recognizer = veilsight::create_recognizer(cfg);
+        const auto recognize_frame = [&](int track_id, int64_t frame_id, const veilsight::FaceObservation& obs) {
+            veilsight::RecognitionTask task;
+            task.stream_id = "cam0";
+            task.frame_id = frame_id;
+            task.frame = frame(frame_id);
+            task.tracks = {track_with_face(track_id, obs)};
+            return recognizer->recognize(task).tracks[0];
+        };
+
+        const veilsight::FaceObservation window[] = {decoy(0.75f), good_face(0.95f), decoy(0.72f)};
+        std::vector<veilsight::Box> seen;
+        for (int k = 0; k < 3; ++k) seen.push_back(recognize_frame(81, 8 + k, window[k]));
+
+        check(seen[0].recognition_state == "pending" && seen[0].privacy_action == "anonymize" &&
+                  seen[1].recognition_state == "pending" && seen[1].privacy_action == "anonymize",
+              "best-shot track should stay pending and anonymized while its window is open");
+        check(seen[2].identity_key == "alice" && seen[2].privacy_action == "allow",
+              "best-shot window should embed its best face and match the gallery");
+
+        // An unknown window leaves budget for another; the matching face in the second window is embedded.
+        for (int k = 0; k < 3; ++k) recognize_frame(82, 20 + k, decoy(0.9f));
+        veilsight::Box retried;
+        for (int k = 0; k < 3; ++k) retried = recognize_frame(82, 23 + k, face);
+        check(retried.identity_key == "alice", "unknown best-shot window should open another within budget");
+
+        // Two unknown windows spend max_embeddings; the track's later matching faces are never embedded.
+        for (int k = 0; k < 6; ++k) recognize_frame(83, 30 + k, decoy(0.9f));
+        veilsight::Box spent;
+        for (int k = 0; k < 6; ++k) {
+            spent = recognize_frame(83, 36 + k, face);
+            check(spent.recognition_state == "unknown" && spent.identity_key.empty() &&
+                      spent.privacy_action == "anonymize",
+                  "best-shot track should stop embedding once max_embeddings is spent");
+        }
+        std::filesystem::remove(db_path);
+    }
+
+    void test_mobilefacenet_best_shot_closes_window_without_fresh_faces() {
+        auto cfg = mobilefacenet_cfg();
+        cfg.best_shot.enabled = true;
+        cfg.best_shot.window_frames = 4;
+        cfg.best_shot.candidates = 1;
+        const auto face = good_face();
+        const auto embedding = compute_embedding_for_test(cfg, frame(50), face);
+
+        const auto db_path = temp_db_path("veilsight_gallery_best_shot_gates");
+        create_gallery_db(db_path, {{"alice", embedding}});
+        cfg.gallery_path = db_path.string();
+
+        auto recognizer = veilsight::create_recognizer(cfg);
+        std::vector<veilsight::Box> seen;
+        for (int k = 0; k < 5; ++k) {
+            veilsight::RecognitionTask task;
+            task.stream_id = "cam0";
+            task.frame_id = 50 + k;
+            task.frame = frame(task.frame_id);
+            // Only the first face passes the gates; the rest of the window sees faces below min_face_score.
+            task.tracks = {track_with_face(91, k == 0 ? face : good_face(0.1f))};
+            seen.push_back(recognizer->recognize(task).tracks[0]);
+        }
+
+        check(seen[2].recognition_state == "pending" && seen[2].privacy_action == "anonymize",
+              "best-shot window should stay open until window_frames have passed");
+        check(seen[3].identity_key == "alice" && seen[3].privacy_action == "allow",
+              "best-shot window should close on time even when later faces fail the gates");
+        check(seen[4].identity_key == "alice", "closed best-shot window should cache its decision");
+        std::filesystem::remove(db_path);
+    }
+
+    void test_mobilefacenet_reload_applies_logged_gallery_changes() {
+        auto cfg = mobilefacenet_cfg();
+        const auto f = frame(6);
+        const auto face = good_face();
+        const auto embedding = compute_embedding_for_test(cfg, f, face);
+        std::vector<float> other(128, 0.0f);
+        other[0] = 1.0f;
+
+        const auto db_path = temp_db_path("veilsight_gallery_delta");
+        const std::string snapshot_path = db_path.string() + ".vsgallery";
+        create_gallery_db(db_path, {{"alice", embedding}, {"bob", other}});
+        add_gallery_change_log(db_path);
+        cfg.gallery_path = db_path.string();
+
+        const auto recognize_once = [&](veilsight::IRecognizerFactory& factory, int track_id) {
+            veilsight::RecognitionTask task;
+            task.stream_id = "cam0";
+            task.frame_id = 6;
+            task.frame = f;
+            task.tracks = {track_with_face(track_id, face)};
+            return factory.create()->recognize(task).tracks[0].identity_key;
+        };
+
+        auto factory = veilsight::create_recognizer_factory(cfg);
+        check(std::filesystem::exists(snapshot_path), "gallery with a change log should write a snapshot");
+        check(recognize_once(*factory, 61) == "alice", "gallery should match before changes");
+
+        sqlite3* db = nullptr;
+        check(sqlite3_open(db_path.string().c_str(), &db) == SQLITE_OK, "test gallery DB should reopen");
+        exec_sql(db, "UPDATE identities SET active = 0 WHERE identity_key = 'alice';"
+                     "INSERT INTO identities(identity_key, display_name, active) VALUES ('carol', 'carol', 1);"
+                     "INSERT INTO face_embeddings(identity_key, model, dim, embedding, active) "
+                     "SELECT 'carol', model, dim, embedding, 1 FROM face_embeddings WHERE identity_key = 'alice';");
+        sqlite3_close(db);
+
+        std::string error;
+        check(factory->reload_gallery(&error), "delta gallery reload should succeed: " + error);
+        check(recognize_once(*factory, 62) == "carol", "delta reload should drop alice and add carol");
+
+        auto restarted = veilsight::create_recognizer_factory(cfg);
+        check(recognize_once(*restarted, 63) == "carol",
+              "startup from the snapshot should apply the changes logged after it");
+
+        std::ofstream(snapshot_path, std::ios::binary | std::ios::trunc) << "garbage";
+        auto recovered = veilsight::create_recognizer_factory(cfg);
+        check(recognize_once(*recovered, 64) == "carol", "corrupt gallery snapshot should fall back to the DB");
+
+        // Re-enabling alice is trimmed from the log (as the gallery tools do once a snapshot covers it) before carol
+        // is disabled, so only a full load sees both.
+        check(sqlite3_open(db_path.string().c_str(), &db) == SQLITE_OK, "test gallery DB should reopen");
+        exec_sql(db, "UPDATE identities SET active = 1 WHERE identity_key = 'alice';"
+                     "INSERT INTO gallery_meta(key, value) SELECT 'pruned_seq', MAX(seq) FROM gallery_changes;"
+                     "DELETE FROM gallery_changes;"
+                     "UPDATE identities SET active = 0 WHERE identity_key = 'carol';");
+        sqlite3_close(db);
+        auto after_prune = veilsight::create_recognizer_factory(cfg);
+        check(recognize_once(*after_prune, 65) == "alice", "snapshot older than the trimmed log should be ignored");
+        check(recovered->reload_gallery(&error), "reload after a trimmed log should succeed: " + error);
+        check(recognize_once(*recovered, 66) == "alice", "gallery older than the trimmed log should reload in full");
+
+        std::filesystem::remove(snapshot_path);
+        std::filesystem::remove(db_path);
+    }
 }
 
 int main() {
+    test_gallery_matrix_top_k_matches_brute_force();
+    test_gallery_ivfpq_index_reranks_to_exact_scores();
+    test_gallery_snapshot_round_trips_and_rejects_corrupt_files();
     test_mobilefacenet_factory_loads_empty_gallery_and_caches_unknown();
     test_gallery_db_loads_multiple_embeddings_and_rejects_invalid_rows();
     test_mobilefacenet_gallery_self_match_allows();
     test_mobilefacenet_face_only_box_can_match_gallery();
     test_duplicate_face_only_detections_keep_best_match();
     test_low_quality_attempt_does_not_cache_unknown();
+    test_mobilefacenet_batch_matches_single_task_results();
+    test_mobilefacenet_best_shot_waits_for_window();
+    test_mobilefacenet_best_shot_closes_window_without_fresh_faces();
+    test_mobilefacenet_reload_applies_logged_gallery_changes();
 
     if (g_failures != 0) {
         std::cerr << "[FAIL] total failures: " << g_failures << "\n";
@@ -1,15 +1,25 @@
+#include <common/fast_math.hpp>
+#include <common/nms.hpp>
+#include <person_detector/letterbox.hpp>
 #include <person_detector/person_detector.hpp>
 #include <tracking/association.hpp>
+#include <tracking/byte_kalman_filter.hpp>
 #include <tracking/scene_grid.hpp>
 #include <tracking/tracker.hpp>
 
+#include <algorithm>
+#include <array>
 #include <cmath>
+#include <cstdint>
+#include <filesystem>
 #include <iostream>
 #include <memory>
+#include <random>
 #include <string>
 #include <vector>
 
 #include <opencv2/core.hpp>
+#include <opencv2/imgproc.hpp>
 #include <opencv2/videoio.hpp>
 
 namespace {
@@ -65,6 +75,105 @@ namespace {
         check(factory->backend_threads() == 3, "UHD factory should expose configured NCNN internal threads");
     }
 
+    void test_letterbox_kernel_matches_opencv_reference() {
+        cv::Mat bgr(90, 160, CV_8UC3);
+        cv::randu(bgr, cv::Scalar::all(0), cv::Scalar::all(255));
+
+        const auto layout = veilsight::make_letterbox_layout(bgr.cols, bgr.rows, 96, 96, true);
+        check(layout.resized_w == 96 && layout.resized_h == 54, "letterbox should preserve aspect ratio");
+        check(layout.pad_x == 0 && layout.pad_y == 21, "letterbox should center the resized image");
+
+        const size_t plane = 96 * 96;
+        std::vector<float> planar(plane * 3, -1.0f);
+        veilsight::letterbox_bgr_to_planar_rgb(bgr, layout, 114.0f, 1.0f / 255.0f, planar.data(), plane);
+
+        cv::Mat resized;
+        cv::resize(bgr, resized, cv::Size(layout.resized_w, layout.resized_h));
+        float max_error = 0.0f;
+        for (int y = 0; y < layout.resized_h; ++y) {
+            for (int x = 0; x < layout.resized_w; ++x) {
+                const cv::Vec3b ref = resized.at<cv::Vec3b>(y, x);
+                const size_t idx = static_cast<size_t>(y + layout.pad_y) * 96 + static_cast<size_t>(x + layout.pad_x);
+                for (int c = 0; c < 3; ++c) {
+                    const float expected = static_cast<float>(ref[2 - c]) / 255.0f;
+                    max_error = std::max(max_error, std::fabs(planar[static_cast<size_t>(c) * plane + idx] - expected));
+                }
+            }
+        }
+        check(max_error <= 1.5f / 255.0f, "fused letterbox should match OpenCV bilinear resize with BGR->RGB swap");
+        check(std::fabs(planar[0] - 114.0f / 255.0f) < 1e-6f && std::fabs(planar[plane * 3 - 1] - 114.0f / 255.0f) < 1e-6f,
+              "fused letterbox should fill padding with the normalized pad value");
+    }
+
+    void test_letterbox_cache_keeps_alternating_source_sizes() {
+        veilsight::LetterboxLayoutCache cache;
+        for (int round = 0; round < 3; ++round) {
+            const auto& frame = cache.get(1920, 1080, 640, 640, true);
+            check(frame.src_w == 1920 && frame.src_h == 1080, "letterbox cache should return the frame layout");
+            const auto& tile = cache.get(960, 720, 640, 640, true);
+            check(tile.src_w == 960 && tile.src_h == 720, "letterbox cache should return the tile layout");
+            const auto& crop = cache.get(200, 400, 640, 640, true);
+            check(crop.src_w == 200 && crop.src_h == 400, "letterbox cache should return the crop layout");
+        }
+        check(cache.builds() == 3, "alternating source sizes should reuse cached letterbox layouts");
+
+        for (int i = 0; i < 5; ++i) cache.get(100 + i, 100, 640, 640, true);
+        cache.get(1920, 1080, 640, 640, true);
+        check(cache.builds() == 9, "letterbox cache should evict the least recently used layout");
+    }
+
+    void test_nms_keeps_best_box_and_respects_top_k() {
+        veilsight::NmsCandidates candidates;
+        candidates.push(0, 0, 100, 100, 0.6f);
+        candidates.push(5, 0, 105, 100, 0.9f);
+        candidates.push(300, 300, 400, 400, 0.7f);
+        candidates.push(600, 0, 700, 100, 0.2f);
+
+        veilsight::NmsOptions options;
+        options.iou_threshold = 0.5f;
+        const auto keep = veilsight::non_max_suppression(candidates, options);
+        check(keep == std::vector<int>({1, 2, 3}), "NMS should keep the best overlapping box and all disjoint boxes");
+
+        options.top_k = 2;
+        const auto limited = veilsight::non_max_suppression(candidates, options);
+        check(limited == std::vector<int>({1, 2}), "NMS top_k should cut candidates before suppression");
+    }
+
+    void test_nms_hard_and_soft_modes() {
+        veilsight::NmsCandidates candidates;
+        candidates.push(0, 0, 100, 100, 0.9f);
+        candidates.push(5, 0, 105, 100, 0.8f);
+
+        veilsight::NmsOptions options;
+        options.iou_threshold = 0.5f;
+        check(veilsight::non_max_suppression(candidates, options).size() == 1,
+              "hard NMS should suppress overlapping boxes");
+
+        options.mode = veilsight::NmsMode::Soft;
+        options.soft_min_score = 0.1f;
+        const auto soft = veilsight::non_max_suppression(candidates, options);
+        check(soft.size() == 2 && soft[0] == 0, "soft NMS should keep the overlapping box with a decayed score");
+        check(soft.size() == 2 && candidates.score[1] < 0.8f && candidates.score[1] > 0.1f,
+              "soft NMS should decay but not remove the overlapping box");
+    }
+
+    void test_fast_math_matches_std_within_tolerance() {
+        float max_exp_error = 0.0f;
+        float max_sigmoid_error = 0.0f;
+        for (float x = -20.0f; x <= 20.0f; x += 0.01f) {
+            const float ref = std::exp(x);
+            max_exp_error = std::max(max_exp_error, std::fabs(veilsight::fast_exp(x) - ref) / ref);
+            max_sigmoid_error = std::max(max_sigmoid_error,
+                                         std::fabs(veilsight::fast_sigmoid(x) - 1.0f / (1.0f + std::exp(-x))));
+        }
+        check(max_exp_error < 1e-5f, "fast_exp should stay within 1e-5 relative error");
+        check(max_sigmoid_error < 1e-6f, "fast_sigmoid should stay within 1e-6 absolute error");
+
+        const float logit = veilsight::logit_threshold(0.25f);
+        check(std::fabs(veilsight::fast_sigmoid(logit) - 0.25f) < 1e-6f,
+              "logit_threshold should invert the sigmoid");
+    }
+
     void test_yolox_ncnn_detector_loads_and_runs() {
         veilsight::PersonDetectorModuleConfig cfg;
         cfg.type = "yolox";
@@ -192,6 +301,96 @@ namespace {
         check(result.unmatched_detections.empty(), "association should leave no unmatched detections");
     }
 
+    float best_assignment_cost(const veilsight::CostMatrix& cost, int row, std::vector<char>& used, int left) {
+        if (left == 0 || row == cost.rows) return left == 0 ? 0.0f : 1e9f;
+        float best = cost.rows - row > left ? best_assignment_cost(cost, row + 1, used, left) : 1e9f;
+        for (int c = 0; c < cost.cols; ++c) {
+            if (used[static_cast<size_t>(c)]) continue;
+            used[static_cast<size_t>(c)] = 1;
+            best = std::min(best, cost.at(row, c) + best_assignment_cost(cost, row + 1, used, left - 1));
+            used[static_cast<size_t>(c)] = 0;
+        }
+        return best;
+    }
+
+    void test_solve_assignment_matches_brute_force() {
+        uint32_t state = 12345u;
+        for (int rows = 1; rows <= 6; ++rows) {
+            for (int cols = 1; cols <= 6; ++cols) {
+                veilsight::CostMatrix cost;
+                cost.reset(rows, cols, 0.0f);
+                for (float& value : cost.values) {
+                    state = state * 1664525u + 1013904223u;
+                    value = static_cast<float>(state >> 8) / 16777216.0f - 0.25f;
+                }
+
+                const auto assignment = veilsight::solve_assignment(cost);
+                std::vector<char> used(static_cast<size_t>(cols), 0);
+                float total = 0.0f;
+                int assigned = 0;
+                bool distinct = true;
+                for (int r = 0; r < rows; ++r) {
+                    const int c = assignment[static_cast<size_t>(r)];
+                    if (c < 0) continue;
+                    distinct = distinct && !used[static_cast<size_t>(c)];
+                    used[static_cast<size_t>(c)] = 1;
+                    total += cost.at(r, c);
+                    ++assigned;
+                }
+                std::fill(used.begin(), used.end(), 0);
+                const float expected = best_assignment_cost(cost, 0, used, std::min(rows, cols));
+                const std::string shape = std::to_string(rows) + "x" + std::to_string(cols);
+                check(distinct && assigned == std::min(rows, cols), "assignment should be complete for " + shape);
+                check(std::fabs(total - expected) < 1e-4f, "assignment should be optimal for " + shape);
+            }
+        }
+    }
+
+    void test_association_solves_components_independently() {
+        // Each cluster needs the globally optimal pairing: taking the best IoU pair first strands a track.
+        std::vector<veilsight::Box> tracks;
+        std::vector<veilsight::Box> detections;
+        for (float dx : {0.0f, 400.0f}) {
+            tracks.push_back(box(dx + 30, 0, 100, 100));
+            tracks.push_back(box(dx + 70, 0, 100, 100));
+            detections.push_back(box(dx + 40, 0, 100, 100));
+            detections.push_back(box(dx, 0, 100, 100));
+        }
+        tracks.push_back(box(30, 300, 100, 100));
+        detections.push_back(box(400, 300, 100, 100));
+
+        const auto result = veilsight::associate_detections(
+            tracks,
+            detections,
+            veilsight::AssociationOptions{veilsight::AssociationStage::High, 0.3f, false, nullptr, "cam0", 640, 480});
+
+        check(result.matches.size() == 4, "sparse association should match both tracks of each cluster");
+        for (const auto& m : result.matches) {
+            const int expected = m.track_index % 2 == 0 ? m.track_index + 1 : m.track_index - 1;
+            check(m.detection_index == expected, "sparse association should pick the optimal pairing in each cluster");
+        }
+        check(result.unmatched_tracks == std::vector<int>{4}, "isolated track should stay unmatched");
+        check(result.unmatched_detections == std::vector<int>{4}, "isolated detection should stay unmatched");
+    }
+
+    void test_association_prices_gated_pairs_like_dense_solve() {
+        // Track A fits det 0 well and det 1 poorly; track B only grazes det 0. A dense solve keeps A-det 0 and
+        // leaves B unmatched, so the component must not price the gated B-det 1 cell as prohibitive.
+        const std::vector<veilsight::Box> tracks = {box(0, 0, 100, 100), box(-80, 0, 100, 100)};
+        const std::vector<veilsight::Box> detections = {box(0, 0, 100, 90), box(66, 0, 100, 100)};
+
+        const auto result = veilsight::associate_detections(
+            tracks,
+            detections,
+            veilsight::AssociationOptions{veilsight::AssociationStage::Low, 0.1f, false, nullptr, "cam0", 640, 480});
+
+        check(result.matches.size() == 1 && result.matches[0].track_index == 0 &&
+                  result.matches[0].detection_index == 0,
+              "gated pairs inside a component should keep the dense baseline's A-det 0 match");
+        check(result.unmatched_tracks == std::vector<int>{1}, "weakly overlapping track should stay unmatched");
+        check(result.unmatched_detections == std::vector<int>{1}, "poorly overlapping detection should stay unmatched");
+    }
+
     void test_grid_disabled_equals_baseline_association() {
         const std::vector<veilsight::Box> tracks = {box(10, 10, 100, 200)};
         const std::vector<veilsight::Box> detections = {box(15, 10, 100, 200)};
@@ -250,6 +449,42 @@ namespace {
               "grid should change an ambiguous association toward the same floor cell");
     }
 
+    void test_grid_costs_match_per_pair_costs_across_components() {
+        veilsight::SceneGridConfig grid_cfg;
+        grid_cfg.rows = 4;
+        grid_cfg.cols = 4;
+        grid_cfg.warmup_frames = 0;
+        grid_cfg.association_weight = 0.30f;
+        grid_cfg.max_extra_cost = 0.30f;
+        grid_cfg.cell_distance_weight = 1.0f;
+        veilsight::SceneGrid grid(grid_cfg);
+        grid.begin_frame("cam0");
+        grid.observe_transition("cam0", 640, 480, box(0, 200, 100, 100), box(20, 210, 100, 100));
+
+        // Two overlapping pairs near the left edge and one isolated pair on the right: grid costs come from
+        // per-component blocks and must equal the single-pair costs.
+        const std::vector<veilsight::Box> tracks = {
+            box(0, 150, 100, 200), box(40, 150, 100, 200), box(500, 20, 100, 100)};
+        const std::vector<veilsight::Box> detections = {
+            box(510, 30, 100, 100), box(45, 170, 100, 200), box(5, 170, 100, 200)};
+
+        const auto result = veilsight::associate_detections(
+            tracks,
+            detections,
+            veilsight::AssociationOptions{veilsight::AssociationStage::High, 0.3f, false, &grid, "cam0", 640, 480});
+
+        check(result.matches.size() == 3, "every track should match in the component-blocked grid association");
+        for (const auto& m : result.matches) {
+            const auto expected = grid.association_cost(
+                "cam0", 640, 480, tracks[static_cast<size_t>(m.track_index)],
+                detections[static_cast<size_t>(m.detection_index)]);
+            check(std::fabs(m.grid_cost - expected.raw_cost) < 1e-5f,
+                  "component grid block should report the pair's own grid cost");
+            check(std::fabs(m.total_cost - (1.0f - m.iou + expected.extra_cost)) < 1e-5f,
+                  "component grid block should add the pair's own extra cost");
+        }
+    }
+
     void test_grid_cost_cannot_force_match_past_threshold() {
         veilsight::SceneGridConfig grid_cfg;
         grid_cfg.warmup_frames = 0;
@@ -310,6 +545,104 @@ namespace {
         check(bottom_right.first == 1 && bottom_right.second == 1, "grid cell should clamp bottom-right edge");
     }
 
+    void test_scene_grid_decays_lazily() {
+        veilsight::SceneGridConfig cfg;
+        cfg.rows = 1;
+        cfg.cols = 4;
+        cfg.warmup_frames = 0;
+        cfg.association_weight = 1.0f;
+        cfg.max_extra_cost = 10.0f;
+        cfg.cell_distance_weight = 0.0f;
+        cfg.occupancy_weight = 1.0f;
+        cfg.transition_weight = 0.0f;
+        cfg.occupancy_decay = 0.5f;
+        veilsight::SceneGrid grid(cfg);
+
+        const auto in_col = [](int col) { return box(static_cast<float>(col * 160 + 10), 10, 40, 80); };
+        const auto occupancy_cost = [&](int col) {
+            return grid.association_cost("cam0", 640, 480, in_col(col), in_col(col)).raw_cost;
+        };
+
+        grid.begin_frame("cam0");
+        grid.observe("cam0", 640, 480, in_col(0));
+        for (int f = 0; f < 3; ++f) grid.begin_frame("cam0");
+        grid.observe("cam0", 640, 480, in_col(1));
+        check(std::fabs(occupancy_cost(0) - 0.875f) < 1e-5f, "older occupancy should be decayed by 0.5^3");
+        check(std::fabs(occupancy_cost(1)) < 1e-5f, "fresh occupancy should be the maximum");
+
+        for (int f = 0; f < 100; ++f) grid.begin_frame("cam0");
+        grid.observe("cam0", 640, 480, in_col(2));
+        check(std::fabs(occupancy_cost(1) - 1.0f) < 1e-5f, "occupancy should keep decaying across a rescale");
+        check(std::fabs(occupancy_cost(2)) < 1e-5f, "occupancy after a rescale should be the maximum");
+    }
+
+    void test_scene_grid_block_matches_pair_costs() {
+        veilsight::SceneGridConfig cfg;
+        cfg.warmup_frames = 0;
+        veilsight::SceneGrid grid(cfg);
+
+        std::vector<veilsight::Box> tracks;
+        std::vector<veilsight::Box> detections;
+        for (int i = 0; i < 13; ++i) tracks.push_back(box(static_cast<float>((i * 97) % 600), static_cast<float>((i * 53) % 300), 40, 120));
+        for (int j = 0; j < 11; ++j) detections.push_back(box(static_cast<float>((j * 71) % 600), static_cast<float>((j * 37) % 300), 40, 120));
+        for (int f = 0; f < 20; ++f) {
+            grid.begin_frame("cam0");
+            for (size_t k = 0; k < tracks.size(); ++k) {
+                grid.observe_transition("cam0", 640, 480, tracks[k], detections[(k + static_cast<size_t>(f)) % detections.size()]);
+            }
+        }
+
+        veilsight::SceneGridCostBlock block;
+        grid.association_costs("cam0", 640, 480, tracks, detections, block);
+        check(block.active && block.rows == 13 && block.cols == 11, "warm grid should fill the whole cost block");
+        float worst = 0.0f;
+        for (int i = 0; i < block.rows; ++i) {
+            for (int j = 0; j < block.cols; ++j) {
+                const auto pair = grid.association_cost("cam0", 640, 480, tracks[static_cast<size_t>(i)], detections[static_cast<size_t>(j)]);
+                const auto cell = block.at(i, j);
+                worst = std::max({worst, std::fabs(pair.raw_cost - cell.raw_cost), std::fabs(pair.extra_cost - cell.extra_cost)});
+            }
+        }
+        check(worst < 1e-5f, "block costs should match per-pair costs");
+
+        grid.association_costs("cam1", 640, 480, tracks, detections, block);
+        check(!block.active && block.at(0, 0).raw_cost == 0.0f, "unseen stream should give an inactive block");
+    }
+
+    void test_scene_grid_persists_across_restart() {
+        const auto dir = std::filesystem::temp_directory_path() / "veilsight_scene_grid_test";
+        std::filesystem::remove_all(dir);
+
+        veilsight::SceneGridConfig cfg;
+        cfg.warmup_frames = 5;
+        cfg.persist_dir = dir.string();
+        const auto from = box(100, 100, 40, 120);
+        const auto to = box(200, 300, 40, 120);
+
+        float learned = 0.0f;
+        {
+            veilsight::SceneGrid grid(cfg);
+            for (int f = 0; f < 6; ++f) {
+                grid.begin_frame("cam/0");
+                grid.observe_transition("cam/0", 640, 480, from, to);
+            }
+            learned = grid.association_cost("cam/0", 640, 480, from, to).raw_cost;
+        }
+        check(learned > 0.0f, "warm grid should produce a cost");
+
+        veilsight::SceneGrid restarted(cfg);
+        restarted.begin_frame("cam/0");
+        const float reloaded = restarted.association_cost("cam/0", 640, 480, from, to).raw_cost;
+        check(std::fabs(reloaded - learned) < 1e-5f, "restarted grid should skip warmup with the saved statistics");
+
+        cfg.persist_dir.clear();
+        veilsight::SceneGrid cold(cfg);
+        cold.begin_frame("cam/0");
+        check(cold.association_cost("cam/0", 640, 480, from, to).raw_cost == 0.0f,
+              "grid without persistence should still warm up");
+        std::filesystem::remove_all(dir);
+    }
+
     void test_bytetrack_preserves_id_after_short_miss() {
         veilsight::ByteTrackModuleConfig cfg;
         cfg.high_thresh = 0.6f;
@@ -333,6 +666,198 @@ namespace {
               "ByteTrack should preserve person track ID after short miss");
     }
 
+    cv::Mat dense(const veilsight::KalmanCovariance& m) {
+        cv::Mat out(8, 8, CV_64F);
+        for (int i = 0; i < 8; ++i) {
+            for (int j = 0; j < 8; ++j) out.at<double>(i, j) = m(i, j);
+        }
+        return out;
+    }
+
+    cv::Mat dense(const veilsight::KalmanMean& m) {
+        cv::Mat out(8, 1, CV_64F);
+        for (int i = 0; i < 8; ++i) out.at<double>(i, 0) = m(i, 0);
+        return out;
+    }
+
+    bool near_dense(const cv::Mat& got, const cv::Mat& expected) {
+        for (int i = 0; i < expected.rows; ++i) {
+            for (int j = 0; j < expected.cols; ++j) {
+                const double e = expected.at<double>(i, j);
+                if (std::fabs(got.at<double>(i, j) - e) > 1e-3 * (1.0 + std::fabs(e))) return false;
+            }
+        }
+        return true;
+    }
+
+    void test_byte_kalman_filter_matches_dense_reference() {
+        constexpr int kStates = 6;
+        constexpr double kPos = veilsight::ByteKalmanFilter::kStdWeightPosition;
+        constexpr double kVel = veilsight::ByteKalmanFilter::kStdWeightVelocity;
+        std::mt19937 rng(13);
+        std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+
+        veilsight::ByteKalmanFilter kf;
+        std::vector<veilsight::KalmanState> states(kStates);
+        std::vector<veilsight::KalmanState*> lanes;
+        for (auto& state : states) {
+            const cv::Vec4f xyah(500.0f + 400.0f * unit(rng), 300.0f + 200.0f * unit(rng),
+                                 0.45f + 0.1f * unit(rng), 175.0f + 100.0f * unit(rng));
+            kf.initiate(xyah, state.mean, state.covariance);
+            const std::array<float, 4> velocity_scale = {5.0f, 5.0f, 0.01f, 2.0f};
+            for (int i = 0; i < 4; ++i) state.mean(i + 4, 0) = velocity_scale[static_cast<size_t>(i)] * unit(rng);
+            // Random SPD covariance: the initial diagonal plus A A^T.
+            cv::Matx<float, 8, 8> a;
+            for (int i = 0; i < 8; ++i) {
+                for (int j = 0; j < 8; ++j) a(i, j) = 3.0f * unit(rng);
+            }
+            for (int i = 0; i < 8; ++i) {
+                for (int j = 0; j < 8; ++j) {
+                    float sum = 0.0f;
+                    for (int k = 0; k < 8; ++k) sum += a(i, k) * a(j, k);
+                    state.covariance(i, j) += sum;
+                }
+            }
+            lanes.push_back(&state);
+        }
+
+        cv::Mat f = cv::Mat::eye(8, 8, CV_64F);
+        for (int i = 0; i < 4; ++i) f.at<double>(i, i + 4) = 1.0;
+        cv::Mat h = cv::Mat::zeros(4, 8, CV_64F);
+        for (int i = 0; i < 4; ++i) h.at<double>(i, i) = 1.0;
+
+        std::vector<cv::Mat> mean_ref;
+        std::vector<cv::Mat> cov_ref;
+        for (const auto& state : states) {
+            const double height = std::max(1.0, static_cast<double>(state.mean(3, 0)));
+            const double pos = kPos * height;
+            const double vel = kVel * height;
+            const std::array<double, 8> q = {pos * pos, pos * pos, 1e-4, pos * pos, vel * vel, vel * vel, 1e-10, vel * vel};
+            cv::Mat noise = cv::Mat::zeros(8, 8, CV_64F);
+            for (int i = 0; i < 8; ++i) noise.at<double>(i, i) = q[static_cast<size_t>(i)];
+            mean_ref.push_back(f * dense(state.mean));
+            cov_ref.push_back(f * dense(state.covariance) * f.t() + noise);
+        }
+
+        kf.predict(lanes);
+        bool predict_ok = true;
+        for (int t = 0; t < kStates; ++t) {
+            predict_ok = predict_ok && near_dense(dense(states[static_cast<size_t>(t)].mean), mean_ref[static_cast<size_t>(t)]) &&
+                         near_dense(dense(states[static_cast<size_t>(t)].covariance), cov_ref[static_cast<size_t>(t)]);
+        }
+        check(predict_ok, "batched Kalman predict should match F P F^T + Q");
+
+        bool update_ok = true;
+        for (auto& state : states) {
+            const cv::Vec4f z(state.mean(0, 0) + 4.0f * unit(rng), state.mean(1, 0) + 4.0f * unit(rng),
+                              state.mean(2, 0) + 0.02f * unit(rng), state.mean(3, 0) + 4.0f * unit(rng));
+            const double pos = kPos * std::max(1.0, static_cast<double>(state.mean(3, 0)));
+            cv::Mat r = cv::Mat::zeros(4, 4, CV_64F);
+            r.at<double>(0, 0) = pos * pos;
+            r.at<double>(1, 1) = pos * pos;
+            r.at<double>(2, 2) = 1e-2;
+            r.at<double>(3, 3) = pos * pos;
+            cv::Mat measurement(4, 1, CV_64F);
+            for (int i = 0; i < 4; ++i) measurement.at<double>(i, 0) = z[i];
+
+            const cv::Mat p = dense(state.covariance);
+            const cv::Mat x = dense(state.mean);
+            const cv::Mat gain = p * h.t() * (h * p * h.t() + r).inv();
+            const cv::Mat x_ref = x + gain * (measurement - h * x);
+            const cv::Mat p_ref = p - gain * h * p;
+
+            kf.update(state.mean, state.covariance, z);
+            update_ok = update_ok && near_dense(dense(state.mean), x_ref) && near_dense(dense(state.covariance), p_ref);
+        }
+        check(update_ok, "Kalman update should match K = P H^T S^-1 applied densely");
+    }
+
+    veilsight::ByteTrackModuleConfig bytetrack_arena_config() {
+        veilsight::ByteTrackModuleConfig cfg;
+        cfg.high_thresh = 0.6f;
+        cfg.low_thresh = 0.1f;
+        cfg.new_track_thresh = 0.6f;
+        cfg.match_iou_thresh = 0.3f;
+        cfg.track_buffer = 3;
+        cfg.fuse_score = false;
+        cfg.scene_grid.enabled = false;
+        return cfg;
+    }
+
+    void test_bytetrack_expires_lost_tracks_and_recycles_slots() {
+        auto tracker = veilsight::create_bytetrack_tracker(bytetrack_arena_config());
+
+        const auto first = tracker->update(frame(1), {box(100, 50, 80, 180, 0.9f)});
+        check(first.size() == 1, "ByteTrack should start a track");
+        int64_t frame_id = 2;
+        for (; frame_id <= 6; ++frame_id) {
+            check(tracker->update(frame(frame_id), {}).empty(), "ByteTrack should not emit lost tracks");
+        }
+
+        // The lost track has outlived track_buffer, so its slot is recycled for the returning person,
+        // who must get a fresh id rather than the expired one.
+        const auto back = tracker->update(frame(frame_id++), {box(100, 50, 80, 180, 0.9f)});
+        check(back.size() == 1 && !first.empty() && back[0].id != first[0].id,
+              "ByteTrack should give a new id after the lost track expires");
+
+        // Repeated expiry and re-creation keeps issuing fresh ids from recycled slots.
+        int last_id = back.empty() ? 0 : back[0].id;
+        for (int cycle = 0; cycle < 3; ++cycle) {
+            for (int miss = 0; miss < 5; ++miss) tracker->update(frame(frame_id++), {});
+            const auto out = tracker->update(frame(frame_id++), {box(300, 50, 80, 180, 0.9f)});
+            check(out.size() == 1 && out[0].id > last_id, "recycled ByteTrack slots should carry new ids");
+            if (!out.empty()) last_id = out[0].id;
+        }
+    }
+
+    void test_bytetrack_removes_shorter_lived_duplicate_track() {
+        auto cfg = bytetrack_arena_config();
+        cfg.track_buffer = 30;
+        cfg.duplicate_iou_thresh = 0.3f;
+        auto tracker = veilsight::create_bytetrack_tracker(cfg);
+
+        int64_t frame_id = 1;
+        int long_id = -1;
+        for (; frame_id <= 20; ++frame_id) {
+            const auto out = tracker->update(frame(frame_id), {box(100, 50, 50, 100, 0.9f)});
+            if (!out.empty()) long_id = out[0].id;
+        }
+
+        // The long-lived track goes lost while a new one approaches and ends up overlapping it.
+        int short_id = -1;
+        bool removed_short = false;
+        for (float x = 260.0f; x >= 120.0f; x -= 20.0f, ++frame_id) {
+            const auto out = tracker->update(frame(frame_id), {box(x, 50, 50, 100, 0.9f)});
+            if (out.empty()) {
+                removed_short = short_id >= 0;
+                break;
+            }
+            short_id = out[0].id;
+        }
+        check(short_id >= 0 && short_id != long_id, "approaching person should start its own track");
+        check(removed_short, "tracked duplicate of a longer-lived lost track should be removed");
+
+        const auto out = tracker->update(frame(frame_id + 1), {box(120, 50, 50, 100, 0.9f)});
+        check(out.size() == 1 && out[0].id == long_id,
+              "longer-lived lost track should take the detection once its duplicate is removed");
+    }
+
+    void test_bytetrack_outputs_tracks_in_activation_order() {
+        auto tracker = veilsight::create_bytetrack_tracker(bytetrack_arena_config());
+
+        tracker->update(frame(1), {box(100, 50, 80, 180, 0.9f), box(400, 50, 80, 180, 0.9f)});
+        tracker->update(frame(2), {box(400, 50, 80, 180, 0.9f)});
+        const auto out = tracker->update(frame(3),
+                                         {box(100, 50, 80, 180, 0.9f),
+                                          box(400, 50, 80, 180, 0.9f),
+                                          box(700, 50, 80, 180, 0.9f)});
+
+        check(out.size() == 3, "ByteTrack should emit kept, new and re-found tracks");
+        check(out.size() == 3 && std::fabs(out[0].x - 400.0f) < 1.0f && std::fabs(out[1].x - 700.0f) < 1.0f &&
+                  std::fabs(out[2].x - 100.0f) < 1.0f,
+              "ByteTrack should list kept tracks first, then new tracks, then re-found tracks");
+    }
+
     void test_bytetrack_uses_low_score_detections_with_fuse_score() {
         veilsight::ByteTrackModuleConfig cfg;
         cfg.high_thresh = 0.6f;
@@ -372,25 +897,129 @@ namespace {
         check(!out.empty() && out[0].w > 116.0f,
               "ByteTrack should not clamp full-body width to the old face-oriented 1.45x limit");
     }
+
+    void test_bytetrack_keeps_ids_for_a_crowd() {
+        veilsight::ByteTrackModuleConfig cfg;
+        cfg.fuse_score = false;
+        cfg.scene_grid.enabled = false;
+        auto tracker = veilsight::create_bytetrack_tracker(cfg);
+
+        std::vector<int> first_ids;
+        bool stable = true;
+        for (int t = 1; t <= 8; ++t) {
+            std::vector<veilsight::Box> detections;
+            for (int r = 0; r < 10; ++r) {
+                for (int c = 0; c < 15; ++c) {
+                    detections.push_back(box(c * 120.0f + 2.0f * t, r * 200.0f + static_cast<float>(t), 60, 150, 0.9f));
+                }
+            }
+            auto out = tracker->update(frame(t), detections);
+            std::sort(out.begin(), out.end(), [](const veilsight::Box& a, const veilsight::Box& b) {
+                return a.y < b.y - 50.0f || (std::fabs(a.y - b.y) <= 50.0f && a.x < b.x);
+            });
+            std::vector<int> ids;
+            for (const auto& b : out) ids.push_back(b.id);
+            if (t == 2) first_ids = ids;
+            if (t > 2) stable = stable && ids == first_ids;
+        }
+        check(first_ids.size() == 150, "ByteTrack should confirm every track in a 150-person crowd");
+        check(stable, "ByteTrack should keep every crowd id while all tracks move together");
+    }
+
+    veilsight::OCSortModuleConfig ocsort_test_config() {
+        veilsight::OCSortModuleConfig cfg;
+        cfg.det_thresh = 0.5f;
+        cfg.low_det_thresh = 0.1f;
+        cfg.iou_threshold = 0.3f;
+        cfg.low_iou_threshold = 0.2f;
+        cfg.min_hits = 1;
+        cfg.max_age = 10;
+        cfg.min_box_area = 100.0f;
+        return cfg;
+    }
+
+    void test_tracker_factory_creates_ocsort() {
+        veilsight::TrackerModuleConfig cfg;
+        cfg.type = "ocsort";
+        const auto factory = veilsight::create_tracker_factory(cfg);
+        check(factory != nullptr && factory->create() != nullptr, "tracker factory should create OC-SORT trackers");
+    }
+
+    void test_ocsort_recovers_id_after_occlusion() {
+        auto tracker = veilsight::create_ocsort_tracker(ocsort_test_config());
+
+        int id = -1;
+        bool steady = true;
+        for (int t = 1; t <= 6; ++t) {
+            const auto out = tracker->update(frame(t), {box(100.0f + 12.0f * t, 50, 60, 160, 0.9f)});
+            steady = steady && out.size() == 1 && (id < 0 || out[0].id == id);
+            if (!out.empty()) id = out[0].id;
+        }
+        check(steady, "OC-SORT should keep one id for a steadily moving person");
+
+        for (int t = 7; t <= 10; ++t) {
+            check(tracker->update(frame(t), {}).empty(), "OC-SORT should not emit tracks without observations");
+        }
+        const auto back = tracker->update(frame(11), {box(100.0f + 12.0f * 11, 50, 60, 160, 0.9f)});
+        check(back.size() == 1 && back[0].id == id, "OC-SORT should re-associate the track after a short occlusion");
+
+        const auto next = tracker->update(frame(12), {box(100.0f + 12.0f * 12, 50, 60, 160, 0.9f)});
+        check(next.size() == 1 && next[0].id == id, "OC-SORT should keep following the track after re-update");
+    }
+
+    void test_ocsort_byte_pass_uses_low_score_detections() {
+        auto cfg = ocsort_test_config();
+        auto with_byte = veilsight::create_ocsort_tracker(cfg);
+        const auto out1 = with_byte->update(frame(1), {box(100, 50, 80, 180, 0.9f)});
+        const auto out2 = with_byte->update(frame(2), {box(104, 50, 80, 180, 0.3f)});
+        check(out1.size() == 1 && out2.size() == 1 && out1[0].id == out2[0].id,
+              "OC-SORT use_byte should keep a track alive on a low-score detection");
+
+        cfg.use_byte = false;
+        auto without_byte = veilsight::create_ocsort_tracker(cfg);
+        (void)without_byte->update(frame(1), {box(100, 50, 80, 180, 0.9f)});
+        check(without_byte->update(frame(2), {box(104, 50, 80, 180, 0.3f)}).empty(),
+              "OC-SORT without use_byte should ignore low-score detections");
+    }
 }
 
 int main() {
     test_detector_factory_creates_yolox_factory();
     test_detector_factory_creates_uhd_factory();
+    test_letterbox_kernel_matches_opencv_reference();
+    test_letterbox_cache_keeps_alternating_source_sizes();
+    test_nms_keeps_best_box_and_respects_top_k();
+    test_nms_hard_and_soft_modes();
+    test_fast_math_matches_std_within_tolerance();
     test_yolox_ncnn_detector_loads_and_runs();
     test_uhd_ncnn_detector_loads_and_runs();
     test_yolox_detects_people_in_store_fixture();
     test_uhd_runs_on_store_fixture();
     test_association_returns_deterministic_matches();
+    test_solve_assignment_matches_brute_force();
+    test_association_solves_components_independently();
+    test_association_prices_gated_pairs_like_dense_solve();
     test_grid_disabled_equals_baseline_association();
     test_grid_soft_cost_changes_ambiguous_association();
+    test_grid_costs_match_per_pair_costs_across_components();
     test_grid_cost_cannot_force_match_past_threshold();
     test_score_fusion_does_not_raise_iou_threshold();
     test_grid_cost_does_not_raise_iou_threshold();
     test_bottom_center_cell_mapping_clamps_edges();
+    test_scene_grid_decays_lazily();
+    test_scene_grid_block_matches_pair_costs();
+    test_scene_grid_persists_across_restart();
+    test_byte_kalman_filter_matches_dense_reference();
     test_bytetrack_preserves_id_after_short_miss();
     test_bytetrack_uses_low_score_detections_with_fuse_score();
+    test_bytetrack_expires_lost_tracks_and_recycles_slots();
+    test_bytetrack_removes_shorter_lived_duplicate_track();
+    test_bytetrack_outputs_tracks_in_activation_order();
     test_bytetrack_allows_person_scale_change_without_face_clamp();
+    test_bytetrack_keeps_ids_for_a_crowd();
+    test_tracker_factory_creates_ocsort();
+    test_ocsort_recovers_id_after_occlusion();
+    test_ocsort_byte_pass_uses_low_score_detections();
 
     if (g_failures != 0) {
         std::cerr << "[FAIL] total failures: " << g_failures << "\n";